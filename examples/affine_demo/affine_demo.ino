@@ -0,0 +1,114 @@
+/**
+ * @file affine_demo.ino
+ * @brief Rotate, zoom and perspective floor with the affine scanout mode
+ *
+ * One 160x120 RGB332 texture is uploaded once. The FPGA then maps every
+ * screen pixel to a texel through a fixed-point matrix, so the host only
+ * writes registers:
+ *
+ *  - rotozoom: setAffineRotZoom() each frame, 19 register writes;
+ *  - floor: a per-line table (start texel and step for each line) gives a
+ *    perspective plane moving forward, 960 bytes per frame.
+ *
+ * The two effects alternate every five seconds.
+ *
+ * Hardware: Papilio Arcade board (ESP32-S3 + FPGA), affine scanout bitstream
+ */
+
+#include <HQVGA.h>
+
+#define SPI_CLK   12
+#define SPI_MOSI  11
+#define SPI_MISO  9
+#define SPI_CS    10
+
+const unsigned WIDTH = 160;
+const unsigned HEIGHT = 120;
+const unsigned HORIZON = 40;
+const uint32_t FRAME_MS = 20;
+
+static VGA_class::pixel_t texture[WIDTH * HEIGHT];
+static VGA_class::AffineLine floorLines[HEIGHT];
+
+// 16-texel checkerboard with a ring pattern; the last column holds the sky
+// colours the floor mode samples above the horizon
+static void makeTexture() {
+    for (unsigned y = 0; y < HEIGHT; y++) {
+        for (unsigned x = 0; x < WIDTH; x++) {
+            int dx = (int)x - 80, dy = (int)y - 60;
+            bool check = ((x >> 4) ^ (y >> 4)) & 1;
+            VGA_class::pixel_t c = check ? 0x14 : 0x08;
+            if (((dx * dx + dy * dy) >> 6) % 6 == 0) c = YELLOW;
+            texture[y * WIDTH + x] = c;
+        }
+        texture[y * WIDTH + WIDTH - 1] = (y < 20) ? 0x03 : (y < 40) ? 0x27 : 0x6F;
+    }
+}
+
+static bool rotozoom(float t) {
+    float zoom = 1.25f + sinf(t * 0.7f);
+    return VGA.setAffineRotZoom(t, zoom, WIDTH / 2, HEIGHT / 2);
+}
+
+static bool floorPlane(float t) {
+    float camZ = t * 40;
+    for (unsigned y = 0; y < HEIGHT; y++) {
+        VGA_class::AffineLine& l = floorLines[y];
+        if (y < HORIZON) {
+            // Sky: one texel of the sky column, no horizontal step
+            l.u = (WIDTH - 1) * 256 + 128;
+            l.v = (y * 256) + 128;
+            l.dudx = l.dvdx = 0;
+            continue;
+        }
+        // Distance of the floor seen on this line falls off as 1/y
+        float z = 2400.0f / (y - HORIZON + 1);
+        float step = z / WIDTH;
+        l.dudx = lroundf(step * 256);
+        l.dvdx = 0;
+        l.u = lroundf((WIDTH / 2 - step * WIDTH / 2) * 256);
+        l.v = lroundf((z + camZ) * 256);
+    }
+    return VGA.setAffineLines(0, HEIGHT, floorLines);
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    VGA.begin(nullptr, SPI_CS, SPI_CLK, SPI_MOSI, SPI_MISO);
+    VGA.enableHardwareCS();
+    VGA.setBusClock(40000000);
+    VGA.setGeometry(WIDTH, HEIGHT, HQVGA_FORMAT_RGB332, 6);
+
+    makeTexture();
+    VGA.uploadImage(0, 0, WIDTH, HEIGHT, texture);
+    VGA.setVideoMode(2);
+
+    if (!rotozoom(0)) {
+        Serial.println("Affine scanout not supported by this bitstream");
+        while (true) delay(1000);
+    }
+}
+
+void loop() {
+    static uint32_t lastFrame = 0;
+    static uint32_t lastReport = 0;
+    static uint32_t frames = 0;
+
+    if (millis() - lastFrame < FRAME_MS) return;
+    lastFrame = millis();
+
+    float t = millis() / 1000.0f;
+    if ((millis() / 5000) & 1)
+        floorPlane(t);
+    else
+        rotozoom(t);
+    frames++;
+
+    if (millis() - lastReport >= 1000) {
+        lastReport = millis();
+        Serial.printf("%u frames/s\n", frames);
+        frames = 0;
+    }
+}
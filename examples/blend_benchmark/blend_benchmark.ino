@@ -0,0 +1,146 @@
+/**
+ * @file blend_benchmark.ino
+ * @brief RGB332 blend kernels: timing against a naive per-channel blend
+ *
+ * Times each HQVGA_Blend.h kernel over the full 160x120 shadow buffer and
+ * compares it with the obvious per-pixel version (unpack R/G/B, weight,
+ * divide, repack), then shows the effects on screen: a translucent panel,
+ * a blended sprite and a fade-out.
+ *
+ * Hardware: Papilio Arcade board with HDMI output
+ * Display: 160x120 scaled to 720p via FPGA
+ */
+
+#include <HQVGA_TFT_eSPI.h>
+#include <HQVGA_Blend.h>
+
+HQVGA_TFT tft;
+HQVGA_Sprite<32, 32> ball(&tft);
+
+const int RUNS = 20;
+
+// Reference: per-channel alpha blend, level out of 16
+static uint8_t naiveBlend(uint8_t src, uint8_t dst, uint8_t level) {
+    unsigned r = ((src >> 5) * level + (dst >> 5) * (16 - level) + 8) / 16;
+    unsigned g = (((src >> 2) & 7) * level + ((dst >> 2) & 7) * (16 - level) + 8) / 16;
+    unsigned b = ((src & 3) * level + (dst & 3) * (16 - level) + 8) / 16;
+    return (r << 5) | (g << 2) | b;
+}
+
+static void report(const char* name, unsigned long us) {
+    unsigned long pixels = (unsigned long)HQVGA_FRAMEBUFFER_SIZE * RUNS;
+    Serial.printf("%-22s %7lu us/frame  %6.2f ns/pixel\n",
+                  name, us / RUNS, us * 1000.0 / pixels);
+}
+
+static void fillTestPattern() {
+    uint8_t* fb = tft.getFrameBuffer();
+    for (unsigned i = 0; i < HQVGA_FRAMEBUFFER_SIZE; i++) fb[i] = (uint8_t)(i * 37);
+}
+
+void runBenchmarks() {
+    static uint8_t src[HQVGA_FRAMEBUFFER_SIZE];
+    for (unsigned i = 0; i < HQVGA_FRAMEBUFFER_SIZE; i++) src[i] = (uint8_t)(i * 11);
+    uint8_t* fb = tft.getFrameBuffer();
+    unsigned long t;
+
+    Serial.println("\n--- RGB332 blend, full 160x120 frame ---");
+
+    fillTestPattern();
+    t = micros();
+    for (int n = 0; n < RUNS; n++)
+        for (unsigned i = 0; i < HQVGA_FRAMEBUFFER_SIZE; i++) fb[i] = naiveBlend(src[i], fb[i], 4);
+    report("naive alpha 25%", micros() - t);
+
+    HQVGA_BlendLUT quarter;
+    quarter.setAlpha(4);
+    fillTestPattern();
+    t = micros();
+    for (int n = 0; n < RUNS; n++) hqvgaBlendRow(fb, src, HQVGA_FRAMEBUFFER_SIZE, quarter);
+    report("LUT alpha 25%", micros() - t);
+
+    fillTestPattern();
+    t = micros();
+    for (int n = 0; n < RUNS; n++) hqvgaAverageRow(fb, src, HQVGA_FRAMEBUFFER_SIZE);
+    report("average 50%", micros() - t);
+
+    HQVGA_BlendLUT add;
+    add.setAdditive();
+    fillTestPattern();
+    t = micros();
+    for (int n = 0; n < RUNS; n++) hqvgaBlendRow(fb, src, HQVGA_FRAMEBUFFER_SIZE, add);
+    report("LUT additive", micros() - t);
+
+    HQVGA_BlendLUT mul;
+    mul.setMultiply();
+    fillTestPattern();
+    t = micros();
+    for (int n = 0; n < RUNS; n++) hqvgaBlendRow(fb, src, HQVGA_FRAMEBUFFER_SIZE, mul);
+    report("LUT multiply", micros() - t);
+
+    fillTestPattern();
+    t = micros();
+    for (int n = 0; n < RUNS; n++)
+        for (unsigned i = 0; i < HQVGA_FRAMEBUFFER_SIZE; i++) fb[i] = naiveBlend(0x00, fb[i], 8);
+    report("naive fade 50%", micros() - t);
+
+    HQVGA_ColorLUT half;
+    half.setFade(8);
+    fillTestPattern();
+    t = micros();
+    for (int n = 0; n < RUNS; n++) hqvgaMapRow(fb, HQVGA_FRAMEBUFFER_SIZE, half);
+    report("LUT fade 50%", micros() - t);
+
+    // The tables must agree with the reference exactly
+    bool match = true;
+    for (int s = 0; s < 256 && match; s++)
+        for (int d = 0; d < 256 && match; d++)
+            match = quarter.apply(s, d) == naiveBlend(s, d, 4);
+    Serial.printf("LUT matches reference: %s\n", match ? "yes" : "NO");
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println("Blend benchmark starting...");
+
+    tft.begin();
+
+    tft.startBuffered();
+    runBenchmarks();
+    tft.endBuffered();
+
+    // Sprite: a filled circle on a black (transparent) background
+    ball.fillSprite(TFT_BLACK);
+    for (int y = 0; y < 32; y++)
+        for (int x = 0; x < 32; x++)
+            if ((x - 16) * (x - 16) + (y - 16) * (y - 16) < 196) ball.drawPixel(x, y, TFT_YELLOW);
+}
+
+void loop() {
+    // Background stripes
+    tft.startBuffered();
+    for (unsigned x = 0; x < HQVGA_WIDTH; x += 16) {
+        tft.fillRect(x, 0, 8, HQVGA_HEIGHT, TFT_BLUE);
+        tft.fillRect(x + 8, 0, 8, HQVGA_HEIGHT, TFT_RED);
+    }
+
+    // Translucent panel and a half-transparent sprite
+    tft.fillRectAlpha(20, 20, 120, 30, TFT_WHITE, 96);
+    HQVGA_BlendLUT half;
+    half.setAlpha(8);
+    ball.pushSpriteBlend(64, 70, half, TFT_BLACK);
+    tft.endBuffered();
+    tft.syncBuffer();
+    delay(2000);
+
+    // Fade out, always from the original frame so rounding doesn't stall
+    static HQVGA_Shadow frame;
+    frame = tft.getSurface();
+    for (int level = 15; level >= 0; level--) {
+        tft.startBuffered();
+        tft.pushSurface(frame, 0, 0);
+        tft.fadeScreen(level);
+        tft.endBuffered();
+        tft.syncBuffer();
+    }
+}
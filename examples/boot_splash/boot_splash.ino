@@ -0,0 +1,66 @@
+/**
+ * @file boot_splash.ino
+ * @brief Keep the bitstream's boot splash, or draw one on older builds
+ *
+ * A bitstream built with a splash shows it as soon as the FPGA is
+ * configured, before this sketch has run at all:
+ *
+ *   gateware/tools/splash2mem.py logo.png -o build/splash
+ *
+ * writes the VRAM init files and prints the video_top_modular parameters
+ * for them (boot mode 2, geometry, scale, viewport). begin() leaves VRAM
+ * alone, so the splash stays up while the sketch starts; here it is only
+ * drawn from the host when the bitstream has none. After a few seconds
+ * the sketch moves on to its own screen. setBootMode() chooses what an
+ * FPGA reset comes up in, here the framebuffer so the splash returns.
+ *
+ * Hardware: Papilio Arcade board (ESP32-S3 + FPGA)
+ */
+
+#include <HQVGA.h>
+
+#define SPI_CLK   12
+#define SPI_MOSI  11
+#define SPI_MISO  9
+#define SPI_CS    10
+
+const uint32_t SPLASH_MS = 3000;
+
+// Host-drawn stand-in for a bitstream without a splash
+static void drawSplash() {
+    VGA.setBackgroundColor(BLACK);
+    VGA.clear();
+    for (int r = 0; r < 40; r += 4) {
+        VGA.setColor(r & 4 ? CYAN : BLUE);
+        VGA.drawRect(80 - r - 20, 60 - r / 2 - 10, 2 * r + 40, r + 20);
+    }
+    VGA.setColor(WHITE);
+    VGA.printtext(48, 56, "PAPILIO");
+}
+
+void setup() {
+    Serial.begin(115200);
+    uint32_t start = millis();
+
+    VGA.begin(nullptr, SPI_CS, SPI_CLK, SPI_MOSI, SPI_MISO);
+
+    if (VGA.hasBootSplash()) {
+        Serial.println("Boot splash from the bitstream");
+    } else {
+        Serial.println("No boot splash in this bitstream - drawing one");
+        drawSplash();
+    }
+    VGA.setBootMode(2);
+
+    // Sketch start-up work would go here, with the splash on screen
+    while (millis() - start < SPLASH_MS) delay(10);
+
+    VGA.setBackgroundColor(BLUE);
+    VGA.clear();
+    VGA.setColor(YELLOW);
+    VGA.printtext(8, 8, "Ready");
+}
+
+void loop() {
+    delay(100);
+}
@@ -21,13 +21,9 @@ void setup() {
     VGA.waitForFPGA();
     VGA.setVideoMode(2);  // Framebuffer mode
     
-    // Draw the image
+    // Draw the image (burst upload straight from flash)
     Serial.println("Drawing image...");
-    for (int y = 0; y < IMAGE_HEIGHT; y++) {
-        for (int x = 0; x < IMAGE_WIDTH; x++) {
-            VGA.putPixel(x, y, imageData[y][x]);
-        }
-    }
+    VGA.uploadImage(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT, &imageData[0][0]);
     
     Serial.println("Done!");
 }
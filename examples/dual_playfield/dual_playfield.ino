@@ -0,0 +1,115 @@
+/**
+ * @file dual_playfield.ino
+ * @brief Parallax scrolling with the two 4bpp framebuffer layers
+ *
+ * A sky and hills background goes into layer 0 and a row of trees into
+ * layer 1, each uploaded once. Layer 1 uses palette bank 1 with index 0
+ * transparent, so the hills show between the trees. Every frame only the
+ * scroll registers change: the trees move at twice the speed of the hills,
+ * for eight register writes per frame instead of a 9,600-byte upload.
+ * Both scrolls are made in one state update, so they always show from
+ * the same frame.
+ *
+ * Hardware: Papilio Arcade board (ESP32-S3 + FPGA), dual playfield bitstream
+ */
+
+#include <HQVGA.h>
+
+#define SPI_CLK   12
+#define SPI_MOSI  11
+#define SPI_MISO  9
+#define SPI_CS    10
+
+const unsigned WIDTH = 160;
+const unsigned HEIGHT = 120;
+const uint8_t SCALE = 6;
+const uint32_t FRAME_MS = 20;
+
+static VGA_class::pixel_t image[WIDTH * HEIGHT];
+
+// Bank 0: sky bands and two hill greens. Bank 1: transparent, trunk,
+// leaves, ground.
+static const VGA_class::pixel_t skyPalette[] = { 0x0B, 0x2F, 0x53, 0x77, 0x9B, 0xDB, 0x30, 0x14 };
+static const VGA_class::pixel_t treePalette[] = { 0x00, 0x64, 0x0C, 0x88 };
+
+static void drawBackground() {
+    for (unsigned y = 0; y < HEIGHT; y++) {
+        for (unsigned x = 0; x < WIDTH; x++) {
+            // Two rows of hills, periods 80 and 40 so the layer wraps cleanly
+            int far = 64 + abs((int)(x % 80) - 40) / 2;
+            int near = 84 + abs((int)((x + 20) % 40) - 20) / 2;
+            VGA_class::pixel_t c = y / 14;
+            if ((int)y >= far) c = 6;
+            if ((int)y >= near) c = 7;
+            image[y * WIDTH + x] = c;
+        }
+    }
+    VGA.setLayer(0);
+    VGA.uploadImage(0, 0, WIDTH, HEIGHT, image);
+}
+
+static void drawTrees() {
+    for (unsigned y = 0; y < HEIGHT; y++) {
+        for (unsigned x = 0; x < WIDTH; x++) {
+            int tx = x % 40 - 20, ty = (int)y - 78;
+            VGA_class::pixel_t c = 0;
+            if (tx * tx + ty * ty < 100) c = 2;
+            else if (tx >= -2 && tx < 2 && y >= 84) c = 1;
+            if (y >= 104) c = ((x + y) & 4) ? 3 : 1;
+            image[y * WIDTH + x] = c;
+        }
+    }
+    VGA.setLayer(1);
+    VGA.uploadImage(0, 0, WIDTH, HEIGHT, image);
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    VGA.begin(nullptr, SPI_CS, SPI_CLK, SPI_MOSI, SPI_MISO);
+    VGA.enableHardwareCS();
+    VGA.setBusClock(40000000);
+    VGA.setGeometry(WIDTH, HEIGHT, HQVGA_FORMAT_INDEXED4, SCALE);
+    if (!VGA.enableDualPlayfield()) {
+        Serial.println("Dual playfield not supported by this bitstream");
+        while (true) delay(1000);
+    }
+
+    for (uint8_t i = 0; i < sizeof(skyPalette); i++) VGA.setPaletteEntry(i, skyPalette[i], 0);
+    for (uint8_t i = 0; i < sizeof(treePalette); i++) VGA.setPaletteEntry(i, treePalette[i], 1);
+    VGA.setLayerPaletteBank(0, 0);
+    VGA.setLayerPaletteBank(1, 1);
+    VGA.setLayerTransparent(0, -1);
+    VGA.setLayerTransparent(1, 0);
+    VGA.setFrontLayer(1);
+
+    drawBackground();
+    drawTrees();
+    VGA.setVideoMode(2);
+}
+
+void loop() {
+    static uint32_t lastFrame = 0;
+    static uint32_t lastReport = 0;
+    static uint32_t frames = 0;
+    static uint32_t t = 0;
+
+    if (millis() - lastFrame < FRAME_MS) return;
+    lastFrame = millis();
+
+    // Both layers move in the same frame
+    t++;
+    {
+        VGA_class::StateUpdate update(VGA);
+        VGA.setLayerScroll(0, t / 2, 0);
+        VGA.setLayerScroll(1, t, 0);
+    }
+    frames++;
+
+    if (millis() - lastReport >= 1000) {
+        lastReport = millis();
+        Serial.printf("%u frames/s\n", frames);
+        frames = 0;
+    }
+}
@@ -0,0 +1,82 @@
+/**
+ * @file linestream_demo.ino
+ * @brief 320x240 "race the beam" output through the line stream mode
+ *
+ * The image is never stored anywhere: each line is rendered on demand just
+ * before the FPGA scans it out of a four-line ring, so 320x240 works
+ * without a full-frame VRAM. Lines that arrive too late show up as border
+ * coloured stripes and are counted; the sketch prints the count every
+ * second for tuning the bus clock, format and scale.
+ *
+ * At 4bpp a line is 160 bytes, 640 on the wire with the 4-byte Wishbone
+ * framing, against about 67 us per source line at 3x in 720p, so expect
+ * underflows until the link gets faster; 8bpp doubles the traffic.
+ *
+ * Hardware: Papilio Arcade board (ESP32-S3 + FPGA), line stream bitstream
+ */
+
+#include <HQVGA.h>
+
+#define SPI_CLK   12
+#define SPI_MOSI  11
+#define SPI_MISO  9
+#define SPI_CS    10
+
+const unsigned WIDTH = 320;
+const unsigned HEIGHT = 240;
+const uint8_t SCALE = 3;
+const unsigned BAR = 16;
+
+struct Scene {
+    uint32_t phase;
+};
+
+static Scene scene;
+
+// Diagonal stripes in the 16 default palette colours with a white bar
+// bouncing over them
+static void renderLine(unsigned y, VGA_class::pixel_t* line, void* ctx) {
+    const Scene* s = (const Scene*)ctx;
+
+    unsigned span = 2 * (HEIGHT - BAR);
+    unsigned barY = (s->phase * 2) % span;
+    if (barY >= HEIGHT - BAR) barY = span - barY;
+
+    if (y >= barY && y < barY + BAR) {
+        memset(line, 15, WIDTH);
+        return;
+    }
+    for (unsigned x = 0; x < WIDTH; x++) {
+        line[x] = ((x + y + s->phase) >> 4) & 0x0F;
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    VGA.begin(nullptr, SPI_CS, SPI_CLK, SPI_MOSI, SPI_MISO);
+    VGA.enableHardwareCS();
+    VGA.setBusClock(40000000);
+    VGA.setBorderColor(BLACK);
+
+    if (!VGA.beginLineStream(WIDTH, HEIGHT, HQVGA_FORMAT_INDEXED4, SCALE)) {
+        Serial.println("Line stream not supported by this bitstream");
+        while (true) delay(1000);
+    }
+    Serial.printf("Streaming %ux%u at %ux\n", WIDTH, HEIGHT, SCALE);
+}
+
+void loop() {
+    static uint32_t lastReport = 0;
+    static uint32_t lines = 0;
+
+    scene.phase = millis() / 16;
+    lines += VGA.streamLines(renderLine, &scene);
+
+    if (millis() - lastReport >= 1000) {
+        lastReport = millis();
+        Serial.printf("%u lines/s, %u underflows\n", lines, VGA.getStreamUnderflows(true));
+        lines = 0;
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * @file link_resync.ino
+ * @brief Recover the picture after an FPGA reset or bitstream reload
+ *
+ * The sketch keeps its screen in a host-side surface and uploads changed
+ * regions from it. Once a second isAlive() reads the epoch register back;
+ * if the FPGA was reset in the meantime it reads 0 instead of the token
+ * begin() wrote, and resync() puts the display back: border colour and
+ * the rest of the register state are replayed, and the surface goes up
+ * again as bursts.
+ *
+ * In the Virtual Papilio, --fpga-reset 3 resets the FPGA three seconds in.
+ *
+ * Hardware: Papilio Arcade board (ESP32-S3 + FPGA), epoch register bitstream
+ */
+
+#include <HQVGA.h>
+#include <HQVGA_Surface.h>
+
+#define SPI_CLK   12
+#define SPI_MOSI  11
+#define SPI_MISO  9
+#define SPI_CS    10
+
+const uint32_t CHECK_MS = 1000;
+
+static HQVGA_Surface<HQVGA_FormatRGB332, 160, 120> screen;
+
+static void drawScreen() {
+    for (int y = 0; y < 120; y++) {
+        for (int x = 0; x < 160; x++) {
+            screen.setPixelFast(x, y, ((x / 20) << 5) | ((y / 15) << 2) | ((x + y) / 80));
+        }
+    }
+    screen.fillRect(0, 108, 160, 12, BLACK);
+}
+
+void setup() {
+    Serial.begin(115200);
+
+    VGA.begin(nullptr, SPI_CS, SPI_CLK, SPI_MOSI, SPI_MISO);
+    VGA.setBorderColor(BLUE);
+    drawScreen();
+    screen.present(VGA);
+}
+
+void loop() {
+    static uint32_t lastCheck = 0;
+    static unsigned seconds = 0;
+
+    if (millis() - lastCheck < CHECK_MS) return;
+    lastCheck = millis();
+
+    if (!VGA.isAlive()) {
+        uint32_t start = millis();
+        if (VGA.resync(screen.pixels, screen.stride())) {
+            Serial.printf("FPGA was reset - display restored in %lu ms\n",
+                          (unsigned long)(millis() - start));
+        } else {
+            Serial.println("FPGA not answering");
+            return;
+        }
+    }
+
+    // Uptime bar along the bottom, drawn in the surface first
+    seconds = (seconds + 1) % 156;
+    screen.fillRect(2, 110, 156, 8, BLACK);
+    screen.fillRect(2, 110, seconds, 8, GREEN);
+    screen.presentRegion(VGA, 0, 108, 160, 12);
+}
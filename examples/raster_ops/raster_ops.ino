@@ -0,0 +1,100 @@
+/**
+ * @file raster_ops.ino
+ * @brief XOR rubber-band box and colour-keyed sprite stamps, no readback
+ *
+ * Two uses of the framebuffer raster ops:
+ *
+ *  - ROP_XOR: a selection box glides over a picture. Drawing it again at
+ *    the old spot removes it, so nothing under it is saved or restored.
+ *  - ROP_KEY: once a second a sprite with a black background is stamped
+ *    with uploadImage(); the black pixels are skipped on the FPGA, so the
+ *    picture shows through without the host reading VRAM.
+ *
+ * Hardware: Papilio Arcade board (ESP32-S3 + FPGA), raster op bitstream
+ */
+
+#include <HQVGA.h>
+
+#define SPI_CLK   12
+#define SPI_MOSI  11
+#define SPI_MISO  9
+#define SPI_CS    10
+
+const int WIDTH = 160;
+const int HEIGHT = 120;
+const int BOX_W = 40, BOX_H = 28;
+const int STAR = 11;
+const uint32_t FRAME_MS = 20;
+
+static VGA_class::pixel_t picture[WIDTH * HEIGHT];
+static VGA_class::pixel_t star[STAR * STAR];
+
+static void makeImages() {
+    for (int y = 0; y < HEIGHT; y++)
+        for (int x = 0; x < WIDTH; x++)
+            picture[y * WIDTH + x] = (((x >> 3) ^ (y >> 3)) & 1) ? 0x49 : ((y * 2) & 0xE0) | (x >> 5);
+
+    // Plus-shaped star on black, the key colour
+    for (int y = 0; y < STAR; y++)
+        for (int x = 0; x < STAR; x++) {
+            int dx = abs(x - STAR / 2), dy = abs(y - STAR / 2);
+            star[y * STAR + x] = (dx + dy <= 2 || dx == 0 || dy == 0) ? YELLOW : BLACK;
+        }
+}
+
+// Outline drawn so each pixel is written once: XOR would cancel corners
+static void box(int x, int y) {
+    VGA.setColor(WHITE);
+    VGA.drawLine(x, y, x + BOX_W - 1, y);
+    VGA.drawLine(x, y + BOX_H - 1, x + BOX_W - 1, y + BOX_H - 1);
+    VGA.drawLine(x, y + 1, x, y + BOX_H - 2);
+    VGA.drawLine(x + BOX_W - 1, y + 1, x + BOX_W - 1, y + BOX_H - 2);
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    VGA.begin(nullptr, SPI_CS, SPI_CLK, SPI_MOSI, SPI_MISO);
+    VGA.enableHardwareCS();
+    VGA.setBusClock(40000000);
+    VGA.setGeometry(WIDTH, HEIGHT, HQVGA_FORMAT_RGB332, 6);
+
+    makeImages();
+    VGA.uploadImage(0, 0, WIDTH, HEIGHT, picture);
+    VGA.setVideoMode(2);
+
+    if (!VGA.setRasterOp(VGA_class::ROP_XOR)) {
+        Serial.println("Raster ops not supported by this bitstream");
+        while (true) delay(1000);
+    }
+    VGA.setRasterOp(VGA_class::ROP_REPLACE);
+}
+
+void loop() {
+    static uint32_t lastFrame = 0;
+    static uint32_t lastStamp = 0;
+    static int boxX = -1, boxY = -1;
+
+    if (millis() - lastFrame < FRAME_MS) return;
+    lastFrame = millis();
+    float t = millis() / 1000.0f;
+
+    VGA_class::BusSession bus(VGA);
+
+    // Take the box off, stamp under it, put it back at the new spot
+    VGA.setRasterOp(VGA_class::ROP_XOR);
+    if (boxX >= 0) box(boxX, boxY);
+
+    if (millis() - lastStamp >= 1000) {
+        lastStamp = millis();
+        VGA.setRasterOp(VGA_class::ROP_KEY, BLACK);
+        VGA.uploadImage(random(WIDTH - STAR), random(HEIGHT - STAR), STAR, STAR, star);
+        VGA.setRasterOp(VGA_class::ROP_XOR);
+    }
+
+    boxX = (WIDTH - BOX_W) / 2 + (int)(50 * sinf(t));
+    boxY = (HEIGHT - BOX_H) / 2 + (int)(35 * sinf(t * 1.3f));
+    box(boxX, boxY);
+    VGA.setRasterOp(VGA_class::ROP_REPLACE);
+}
@@ -0,0 +1,88 @@
+// Papilio HDMI Text Page Flip Example
+// Redraws a full-screen text dashboard every update without tearing.
+// Each screen is written into the page that is not on screen, then
+// flipTextPage() shows it at the next vertical sync, so the 2080 cell
+// writes never appear as a rolling partial update.
+
+#include <Arduino.h>
+#include <HDMIController.h>
+
+// SPI Pin Configuration for ESP32-S3 (adjust for your board)
+#define SPI_CLK   12   // SCK
+#define SPI_MOSI  11   // MOSI
+#define SPI_MISO  9    // MISO
+#define SPI_CS    10   // CS
+
+#define TEXT_COLS 80
+#define TEXT_ROWS 26
+#define BARS      8
+
+HDMIController hdmi(nullptr, SPI_CS, SPI_CLK, SPI_MOSI, SPI_MISO);
+
+bool pageFlip = false;
+
+// One full screen: title, a row of bar graphs and a status line
+void drawDashboard(uint32_t frame) {
+  HDMIController::BusSession bus(hdmi);
+  char line[TEXT_COLS + 1];
+
+  for (uint8_t y = 0; y < TEXT_ROWS; y++) {
+    hdmi.setCursor(0, y);
+    if (y == 0) {
+      hdmi.setTextColor(HDMI_COLOR_WHITE, HDMI_COLOR_BLUE);
+      snprintf(line, sizeof(line), " Papilio HDMI dashboard%*s", TEXT_COLS - 23, "");
+    } else if (y == TEXT_ROWS - 1) {
+      hdmi.setTextColor(HDMI_COLOR_BLACK, HDMI_COLOR_LIGHT_GRAY);
+      // The counter wraps at 8 digits so the line stays TEXT_COLS wide
+      snprintf(line, sizeof(line), " frame %-8lu %-12s%*s",
+               (unsigned long)(frame % 100000000UL),
+               pageFlip ? "page flip" : "single page", TEXT_COLS - 28, "");
+    } else {
+      // Bars rise from row 23; each is 8 columns wide with a 2 column gap
+      for (uint8_t x = 0; x < TEXT_COLS; x++) {
+        uint8_t bar = x / 10;
+        uint8_t level = 11 + 10 * sin((frame + bar * 9) * 0.08f);
+        bool lit = bar < BARS && (x % 10) >= 1 && (x % 10) <= 8 &&
+                   y >= 2 && y <= 23 && (23 - y) < level;
+        line[x] = lit ? '#' : ' ';
+      }
+      line[TEXT_COLS] = 0;
+      hdmi.setTextColor(y < 8 ? HDMI_COLOR_LIGHT_RED : HDMI_COLOR_LIGHT_GREEN,
+                        HDMI_COLOR_BLACK);
+    }
+    hdmi.print(line);
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("Papilio HDMI Text Page Flip Example");
+
+  hdmi.begin();
+  delay(100);
+  hdmi.enableTextMode();
+  delay(100);
+
+  // Draw the first screen on page 0, then start double buffering
+  drawDashboard(0);
+  pageFlip = hdmi.flipTextPage();
+  Serial.println(pageFlip ? "Page flip enabled" : "Single text page - updates will roll");
+}
+
+void loop() {
+  static uint32_t frame = 1;
+  static uint32_t lastReport = 0;
+  static uint32_t frames = 0;
+
+  drawDashboard(frame++);
+  if (pageFlip) {
+    hdmi.flipTextPage();
+  }
+
+  frames++;
+  if (millis() - lastReport >= 1000) {
+    lastReport = millis();
+    Serial.printf("%u screens/s\n", frames);
+    frames = 0;
+  }
+}
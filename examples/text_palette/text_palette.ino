@@ -0,0 +1,98 @@
+// Papilio HDMI Text Palette Example
+// Fades a text screen in, then flashes an alarm banner, by changing only
+// the text palette. The 2080 character and attribute cells are written
+// once in setup(); every effect after that is a palette write of at most
+// 48 bytes, taken by the gateware at the next vertical sync.
+
+#include <Arduino.h>
+#include <HDMIController.h>
+
+// SPI Pin Configuration for ESP32-S3 (adjust for your board)
+#define SPI_CLK   12   // SCK
+#define SPI_MOSI  11   // MOSI
+#define SPI_MISO  9    // MISO
+#define SPI_CS    10   // CS
+
+// Palette entries used as roles rather than fixed colors
+#define COLOR_BACK    HDMI_COLOR_BLACK
+#define COLOR_TEXT    HDMI_COLOR_LIGHT_GRAY
+#define COLOR_TITLE   HDMI_COLOR_YELLOW
+#define COLOR_ALARM   HDMI_COLOR_RED
+
+HDMIController hdmi(nullptr, SPI_CS, SPI_CLK, SPI_MOSI, SPI_MISO);
+
+const uint32_t THEME_TEXT  = 0xC0C0C0;
+const uint32_t THEME_TITLE = 0xFFD040;
+const uint32_t THEME_ALARM = 0xFF2020;
+
+static uint32_t scale(uint32_t rgb, uint8_t level) {
+  uint8_t r = ((rgb >> 16) & 0xFF) * level / 255;
+  uint8_t g = ((rgb >> 8) & 0xFF) * level / 255;
+  uint8_t b = (rgb & 0xFF) * level / 255;
+  return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+// Text and title entries at one brightness, in a single burst
+static bool setLevel(uint8_t level) {
+  uint8_t rgb[16 * 3];
+  uint32_t text = scale(THEME_TEXT, level);
+  uint32_t title = scale(THEME_TITLE, level);
+  for (uint8_t i = 0; i < 16; i++) {
+    uint32_t c = text;
+    if (i == COLOR_BACK) c = 0;
+    else if (i == COLOR_TITLE) c = title;
+    else if (i == COLOR_ALARM) c = scale(THEME_ALARM, level);
+    rgb[i * 3] = c >> 16;
+    rgb[i * 3 + 1] = c >> 8;
+    rgb[i * 3 + 2] = c;
+  }
+  return hdmi.setTextPalette(rgb);
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("Papilio HDMI Text Palette Example");
+
+  hdmi.begin();
+  delay(100);
+  hdmi.enableTextMode();
+  delay(100);
+
+  // Start dark so the screen can be drawn unseen
+  if (!setLevel(0)) {
+    Serial.println("Fixed CGA palette in this bitstream - no palette effects");
+  }
+
+  {
+    HDMIController::BusSession bus(hdmi);
+    char line[81];
+    for (uint8_t y = 0; y < 26; y++) {
+      hdmi.setCursor(0, y);
+      if (y == 1) {
+        hdmi.setTextColor(COLOR_TITLE, COLOR_BACK);
+        snprintf(line, sizeof(line), "%-80s", "   Plant status");
+      } else if (y == 12) {
+        hdmi.setTextColor(COLOR_BACK, COLOR_ALARM);
+        snprintf(line, sizeof(line), "%-80s", "   ALARM: pressure high in loop 2");
+      } else {
+        hdmi.setTextColor(COLOR_TEXT, COLOR_BACK);
+        snprintf(line, sizeof(line), "   Loop %-2u  %5u kPa  %3u C%-52s", y, 180 + y * 7, 40 + y, "");
+      }
+      hdmi.print(line);
+    }
+  }
+
+  // Fade in over half a second, one palette upload per step
+  for (uint16_t level = 0; level <= 255; level += 15) {
+    setLevel(level);
+    delay(30);
+  }
+}
+
+void loop() {
+  // Flash the alarm banner: one palette entry, three bytes
+  static bool on = false;
+  on = !on;
+  hdmi.setTextPaletteColor(COLOR_ALARM, on ? THEME_ALARM : scale(THEME_ALARM, 64));
+  delay(400);
+}
@@ -0,0 +1,173 @@
+/**
+ * @file virtual_papilio_calibrate.ino
+ * @brief Measure the link costs the Virtual Papilio host backend charges
+ *
+ * Times each Arduino-ESP32 call the library drives the FPGA link with
+ * (SPI transactions, transfer(), writeBytes(), CS toggles, short delays)
+ * with the CPU cycle counter, and prints them in the cost file format read
+ * by the host runner:
+ *
+ *   extras/virtual_papilio/build/gfx_demo/gfx_demo --costs costs.txt
+ *
+ * Copy the lines between the markers into costs.txt. The "# check" lines
+ * time a few whole library operations; build this sketch for the host too
+ * and run it with the new cost file to see how close the model gets.
+ *
+ * The cost measurements keep CS high, so the FPGA sees no frames.
+ *
+ * Hardware: Papilio Arcade board (ESP32-S3 + FPGA)
+ */
+
+#include <SPI.h>
+#include <HQVGA.h>
+
+#define SPI_CLK   12
+#define SPI_MOSI  11
+#define SPI_MISO  9
+#define SPI_CS    10
+
+const int RUNS = 2000;
+const uint32_t BUS_HZ = 8000000;
+
+SPIClass* fpgaSPI = NULL;
+static uint8_t buf[256];
+static double cyclesPerUs;
+static double byteUs;
+
+static double usSince(uint32_t start) {
+    return (ESP.getCycleCount() - start) / cyclesPerUs;
+}
+
+static void printCost(const char* name, double us) {
+    Serial.printf("%-18s %.3f\n", name, us < 0 ? 0.0 : us);
+}
+
+static void measureCosts() {
+    SPISettings fast(BUS_HZ, MSBFIRST, SPI_MODE0);
+    SPISettings slow(BUS_HZ / 2, MSBFIRST, SPI_MODE0);
+    double begin = 0, change = 0, end = 0;
+    uint32_t t;
+
+    // Same clock every time, then alternating clocks
+    for (int i = 0; i < RUNS; i++) {
+        t = ESP.getCycleCount();
+        fpgaSPI->beginTransaction(fast);
+        begin += usSince(t);
+        t = ESP.getCycleCount();
+        fpgaSPI->endTransaction();
+        end += usSince(t);
+    }
+    for (int i = 0; i < RUNS; i++) {
+        t = ESP.getCycleCount();
+        fpgaSPI->beginTransaction((i & 1) ? slow : fast);
+        change += usSince(t);
+        fpgaSPI->endTransaction();
+    }
+    begin /= RUNS;
+    printCost("beginTransaction", begin);
+    printCost("clockChange", change / RUNS - begin);
+    printCost("endTransaction", end / RUNS);
+
+    t = ESP.getCycleCount();
+    for (int i = 0; i < RUNS; i++) digitalWrite(SPI_CS, HIGH);
+    printCost("digitalWrite", usSince(t) / RUNS);
+
+    fpgaSPI->beginTransaction(fast);
+    t = ESP.getCycleCount();
+    for (int i = 0; i < RUNS; i++) fpgaSPI->transfer(0xFF);
+    printCost("transferCall", usSince(t) / RUNS - byteUs);
+
+    t = ESP.getCycleCount();
+    for (int i = 0; i < RUNS; i++) fpgaSPI->writeBytes(buf, 4);
+    double call = usSince(t) / RUNS - 4 * byteUs;
+    printCost("writeBytesCall", call);
+
+    t = ESP.getCycleCount();
+    for (int i = 0; i < RUNS / 8; i++) fpgaSPI->writeBytes(buf, sizeof(buf));
+    printCost("fifoRefill", (usSince(t) / (RUNS / 8) - sizeof(buf) * byteUs - call) /
+                                (sizeof(buf) / 64 - 1));
+    fpgaSPI->endTransaction();
+
+    t = ESP.getCycleCount();
+    for (int i = 0; i < RUNS / 2; i++) {
+        fpgaSPI->setHwCs(true);
+        fpgaSPI->setHwCs(false);
+    }
+    printCost("setHwCs", usSince(t) / RUNS);
+    pinMode(SPI_CS, OUTPUT);
+    digitalWrite(SPI_CS, HIGH);
+
+    t = ESP.getCycleCount();
+    for (int i = 0; i < RUNS; i++) delayMicroseconds(2);
+    printCost("delayOverhead", usSince(t) / RUNS - 2);
+
+    volatile unsigned long sink = 0;
+    t = ESP.getCycleCount();
+    for (int i = 0; i < RUNS; i++) sink += micros();
+    printCost("timeRead", usSince(t) / RUNS);
+}
+
+// Whole operations, for comparing the model against the board
+static void runChecks() {
+    static VGA_class::pixel_t frame[160 * 120];
+    for (int i = 0; i < 160 * 120; i++) frame[i] = i;
+    uint32_t t;
+
+    VGA.begin(fpgaSPI, SPI_CS, SPI_CLK, SPI_MOSI, SPI_MISO);
+
+    t = ESP.getCycleCount();
+    VGA.clear();
+    Serial.printf("# check: VGA.clear()                 %9.1f us\n", usSince(t));
+
+    t = ESP.getCycleCount();
+    for (int i = 0; i < 1000; i++) VGA.putPixel(i % 160, i / 160, i);
+    Serial.printf("# check: 1000 x putPixel()           %9.1f us\n", usSince(t));
+
+    t = ESP.getCycleCount();
+    VGA.uploadImage(0, 0, 160, 120, frame);
+    Serial.printf("# check: uploadImage() 160x120       %9.1f us\n", usSince(t));
+
+    if (VGA.enableHardwareCS()) {
+        t = ESP.getCycleCount();
+        VGA.uploadImage(0, 0, 160, 120, frame);
+        Serial.printf("# check: uploadImage() 160x120 hwCS  %9.1f us\n", usSince(t));
+        VGA.enableHardwareCS(false);
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    fpgaSPI = new SPIClass(HSPI);
+    fpgaSPI->begin(SPI_CLK, SPI_MISO, SPI_MOSI, SPI_CS);
+    pinMode(SPI_CS, OUTPUT);
+    digitalWrite(SPI_CS, HIGH);
+
+    cyclesPerUs = ESP.getCpuFreqMHz();
+    // The SPI clock is 80 MHz divided by an integer
+    byteUs = 8.0 / (80.0 / ((80000000 + BUS_HZ - 1) / BUS_HZ));
+    memset(buf, 0xFF, sizeof(buf));
+
+    Serial.println("----- 8< ----- costs.txt -----");
+    Serial.printf("# Virtual Papilio link costs, measured at %u MHz\n", ESP.getCpuFreqMHz());
+    measureCosts();
+}
+
+// loopOverhead is the time between loop() calls, so it is measured here
+void loop() {
+    static uint32_t last = 0;
+    static int passes = -1;
+    static double total = 0;
+
+    uint32_t now = ESP.getCycleCount();
+    if (passes >= 0) total += (now - last) / cyclesPerUs;
+    last = ESP.getCycleCount();
+
+    if (++passes == RUNS) {
+        printCost("loopOverhead", total / RUNS);
+        Serial.println("----- 8< -----");
+        runChecks();
+    }
+    if (passes > RUNS) delay(1000);
+}
@@ -0,0 +1,108 @@
+#!/usr/bin/env bash
+# Build an example sketch for the Virtual Papilio host backend.
+#
+#   extras/virtual_papilio/build.sh examples/spaceinvaders_hqvga
+#   VP_LIBS=~/Arduino/libraries/Adafruit_GFX_Library \
+#       extras/virtual_papilio/build.sh examples/gfx_demo
+#
+# The binary lands in extras/virtual_papilio/build/<sketch>/<sketch>.
+#
+# Environment:
+#   VP_LIBS     colon-separated library checkouts (Adafruit GFX, lvgl, ...);
+#               each is added to the include path and its sources compiled,
+#               skipping examples/, tests/, demos/ and docs/
+#   VP_EXCLUDE  colon-separated source file globs to skip
+#               (default: the Adafruit display drivers that need BusIO)
+#   CC, CXX, VP_CFLAGS
+#
+# Library objects are cached; delete the build directory after changing
+# library headers.
+
+set -eo pipefail
+
+VP_DIR=$(cd "$(dirname "$0")" && pwd)
+REPO=$(cd "$VP_DIR/../.." && pwd)
+
+if [ $# -lt 1 ] || [ ! -d "$1" ]; then
+    echo "usage: $0 <sketch directory>" >&2
+    exit 1
+fi
+
+SKETCH_DIR=$(cd "$1" && pwd)
+NAME=$(basename "$SKETCH_DIR")
+OUT="$VP_DIR/build/$NAME"
+mkdir -p "$OUT/obj"
+
+CC=${CC:-gcc}
+CXX=${CXX:-g++}
+IFS=: read -r -a LIBS <<< "${VP_LIBS:-}"
+IFS=: read -r -a EXCLUDES <<< "${VP_EXCLUDE:-Adafruit_SPITFT*:Adafruit_GrayOLED*}"
+
+FLAGS=(-O2 -g -DVIRTUAL_PAPILIO -DESP32 -DARDUINO=10819 -DARDUINO_ARCH_ESP32
+       -DLV_CONF_INCLUDE_SIMPLE -I"$VP_DIR/shim" -I"$REPO/src" -I"$SKETCH_DIR")
+for lib in "${LIBS[@]}"; do
+    [ -n "$lib" ] && FLAGS+=(-I"$lib" -I"$lib/src")
+done
+read -r -a EXTRA <<< "${VP_CFLAGS:-}"
+FLAGS+=("${EXTRA[@]}")
+
+# ---- Sketch: the main .ino then the rest, with prototypes, as the IDE does
+INO_MAIN="$SKETCH_DIR/$NAME.ino"
+if [ ! -f "$INO_MAIN" ]; then
+    echo "$0: no $NAME.ino in $SKETCH_DIR" >&2
+    exit 1
+fi
+INOS=("$INO_MAIN")
+for ino in "$SKETCH_DIR"/*.ino; do
+    if [ "$ino" != "$INO_MAIN" ]; then INOS+=("$ino"); fi
+done
+SKETCH_CPP="$OUT/sketch.cpp"
+{
+    echo "#include <Arduino.h>"
+    for ino in "${INOS[@]}"; do
+        awk -v file="$ino" -f "$VP_DIR/prototypes.awk" "$ino" "$ino"
+    done
+} > "$SKETCH_CPP"
+
+# ---- Compile
+OBJS=()
+
+compile() {
+    local src=$1 cached=$2
+    local obj="$OUT/obj/$(echo "${src#/}" | tr '/ ' '__').o"
+    if [ -z "$cached" ] || [ ! "$obj" -nt "$src" ]; then
+        case "$src" in
+            *.c) "$CC" -std=gnu99 "${FLAGS[@]}" -c "$src" -o "$obj" ;;
+            *)   "$CXX" -std=gnu++17 "${FLAGS[@]}" -c "$src" -o "$obj" ;;
+        esac
+    fi
+    OBJS+=("$obj")
+}
+
+excluded() {
+    local base pat
+    base=$(basename "$1")
+    # Adafruit GFX #includes its font table from the .cpp
+    [ "$base" = glcdfont.c ] && return 0
+    for pat in "${EXCLUDES[@]}"; do
+        # shellcheck disable=SC2053
+        [[ "$base" == $pat ]] && return 0
+    done
+    return 1
+}
+
+for src in "$VP_DIR"/host/*.cpp "$REPO"/src/*.cpp "$SKETCH_CPP"; do
+    compile "$src"
+done
+
+for lib in "${LIBS[@]}"; do
+    [ -z "$lib" ] && continue
+    while IFS= read -r src; do
+        excluded "$src" || compile "$src" cached
+    done < <(find "$lib" \( -name examples -o -name tests -o -name test -o -name demos \
+                           -o -name docs -o -name env_support -o -name .git \) -prune \
+                        -o \( -name '*.c' -o -name '*.cpp' \) -print | sort)
+done
+
+"$CXX" "${OBJS[@]}" -o "$OUT/$NAME" -lm
+echo "$OUT/$NAME"
@@ -0,0 +1,292 @@
+/**
+ * @file arduino.cpp
+ * @brief Virtual Papilio: virtual clock, GPIO, Serial and the cost table
+ */
+
+#include <Arduino.h>
+#include <VirtualPapilio.h>
+
+#include <stdarg.h>
+#include <string>
+#include <vector>
+
+namespace vp {
+
+VP_LinkCosts costs;
+VP_Stats stats;
+
+static double nowUs = 0;
+static uint8_t pinLevels[64];
+static bool pinsInit = false;
+static std::vector<VP_FPGA*> devices;
+static std::string serialInput;
+static size_t serialPos = 0;
+static bool serialQuiet = false;
+
+double now() { return nowUs; }
+
+void advance(double us) { nowUs += us; }
+
+void charge(double us) {
+    nowUs += us;
+    stats.linkUs += us;
+}
+
+VP_FPGA* device(int csPin) {
+    for (VP_FPGA* d : devices) {
+        if (d->csPin() == csPin) return d;
+    }
+    return nullptr;
+}
+
+VP_FPGA* attach(int csPin) {
+    VP_FPGA* d = device(csPin);
+    if (!d) {
+        d = new VP_FPGA(csPin);
+        devices.push_back(d);
+    }
+    return d;
+}
+
+int deviceCount() { return devices.size(); }
+
+VP_FPGA* deviceAt(int index) { return devices[index]; }
+
+int pinLevel(int pin) {
+    if (!pinsInit) {
+        memset(pinLevels, HIGH, sizeof(pinLevels));
+        pinsInit = true;
+    }
+    return (pin >= 0 && pin < 64) ? pinLevels[pin] : HIGH;
+}
+
+static void setPinLevel(int pin, uint8_t level) {
+    pinLevel(pin);
+    if (pin >= 0 && pin < 64) pinLevels[pin] = level;
+}
+
+void setSerialInput(const char* text) {
+    serialInput = text;
+    serialPos = 0;
+}
+
+void setSerialQuiet(bool quiet) { serialQuiet = quiet; }
+
+} // namespace vp
+
+// ===== Time =====
+
+unsigned long millis(void) {
+    vp::advance(vp::costs.timeRead);
+    return (unsigned long)(vp::now() / 1000.0);
+}
+
+unsigned long micros(void) {
+    vp::advance(vp::costs.timeRead);
+    return (unsigned long)vp::now();
+}
+
+void delay(uint32_t ms) { vp::advance(ms * 1000.0); }
+
+void delayMicroseconds(uint32_t us) {
+    // The library only busy-waits to pace the bus, so this is link time
+    vp::charge(us + vp::costs.delayOverhead);
+}
+
+void yield(void) {}
+
+void vTaskDelay(TickType_t ticks) { delay(ticks * portTICK_PERIOD_MS); }
+
+uint32_t EspClass::getCycleCount() { return (uint32_t)(vp::now() * 240.0); }
+
+EspClass ESP;
+
+// ===== GPIO =====
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    val = val ? HIGH : LOW;
+    VP_FPGA* d = vp::device(pin);
+    if (d) {
+        vp::charge(vp::costs.digitalWrite);
+        if (val != vp::pinLevel(pin)) d->select(val == LOW);
+    } else {
+        vp::advance(vp::costs.digitalWrite);
+    }
+    vp::setPinLevel(pin, val);
+}
+
+int digitalRead(uint8_t pin) { return vp::pinLevel(pin); }
+
+uint16_t analogRead(uint8_t pin) { return (uint16_t)(vp::now() * 7.0) & 0x0FFF; }
+
+// ===== Memory =====
+
+void* heap_caps_malloc(size_t size, uint32_t caps) { return malloc(size); }
+
+void* heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps) {
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void heap_caps_free(void* ptr) { free(ptr); }
+
+void* ps_malloc(size_t size) { return malloc(size); }
+
+// ===== Math =====
+
+// Fixed seed so runs are repeatable; randomSeed() still reseeds
+static uint32_t rngState = 1;
+
+void randomSeed(unsigned long seed) {
+    if (seed) rngState = seed;
+}
+
+long random(long howbig) {
+    if (howbig <= 0) return 0;
+    rngState = rngState * 1103515245u + 12345u;
+    return (rngState >> 1) % howbig;
+}
+
+long random(long howsmall, long howbig) {
+    if (howsmall >= howbig) return howsmall;
+    return random(howbig - howsmall) + howsmall;
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    if (in_max == in_min) return out_min;
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+// ===== Print / Serial =====
+
+size_t Print::printf(const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    if ((size_t)len < sizeof(buf)) return write((const uint8_t*)buf, len);
+
+    std::vector<char> big(len + 1);
+    va_start(args, format);
+    vsnprintf(big.data(), big.size(), format, args);
+    va_end(args);
+    return write((const uint8_t*)big.data(), len);
+}
+
+size_t Print::print(long v, int base) {
+    if (base == 10) return printf("%ld", v);
+    return print((unsigned long)v, base);
+}
+
+size_t Print::print(unsigned long v, int base) {
+    return print(String(v, (unsigned char)(base < 2 ? 10 : base)));
+}
+
+size_t Print::print(long long v, int base) {
+    if (base == 10) return printf("%lld", v);
+    return print((unsigned long long)v, base);
+}
+
+size_t Print::print(unsigned long long v, int base) {
+    if (base == 16) return printf("%llx", v);
+    return printf("%llu", v);
+}
+
+size_t Print::print(double v, int digits) { return printf("%.*f", digits, v); }
+
+int HardwareSerial::available() {
+    if (_port != 0) return 0;
+    return vp::serialInput.size() - vp::serialPos;
+}
+
+int HardwareSerial::read() {
+    if (!available()) return -1;
+    return (uint8_t)vp::serialInput[vp::serialPos++];
+}
+
+int HardwareSerial::peek() {
+    if (!available()) return -1;
+    return (uint8_t)vp::serialInput[vp::serialPos];
+}
+
+size_t HardwareSerial::write(uint8_t c) { return write(&c, 1); }
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (_port == 0 && !vp::serialQuiet) fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+HardwareSerial Serial2(2);
+
+// ===== Cost table =====
+
+struct CostField {
+    const char* name;
+    double VP_LinkCosts::*field;
+};
+
+static const CostField costFields[] = {
+    { "beginTransaction", &VP_LinkCosts::beginTransaction },
+    { "clockChange",      &VP_LinkCosts::clockChange },
+    { "endTransaction",   &VP_LinkCosts::endTransaction },
+    { "digitalWrite",     &VP_LinkCosts::digitalWrite },
+    { "transferCall",     &VP_LinkCosts::transferCall },
+    { "writeBytesCall",   &VP_LinkCosts::writeBytesCall },
+    { "fifoRefill",       &VP_LinkCosts::fifoRefill },
+    { "setHwCs",          &VP_LinkCosts::setHwCs },
+    { "delayOverhead",    &VP_LinkCosts::delayOverhead },
+    { "timeRead",         &VP_LinkCosts::timeRead },
+    { "loopOverhead",     &VP_LinkCosts::loopOverhead },
+};
+
+bool VP_LinkCosts::load(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "virtual papilio: cannot open cost file %s\n", path);
+        return false;
+    }
+
+    char line[160];
+    int lineNo = 0;
+    bool ok = true;
+    while (fgets(line, sizeof(line), f)) {
+        lineNo++;
+        char name[64];
+        double value;
+        if (line[0] == '#' || sscanf(line, "%63s", name) != 1) continue;
+        if (sscanf(line, "%63s %lf", name, &value) != 2) {
+            fprintf(stderr, "%s:%d: expected \"name value\"\n", path, lineNo);
+            ok = false;
+            continue;
+        }
+        if (strcmp(name, "apbHz") == 0) {
+            apbHz = (uint32_t)value;
+            continue;
+        }
+        bool known = false;
+        for (const CostField& c : costFields) {
+            if (strcmp(name, c.name) == 0) {
+                this->*c.field = value;
+                known = true;
+            }
+        }
+        if (!known) {
+            fprintf(stderr, "%s:%d: unknown cost \"%s\"\n", path, lineNo, name);
+            ok = false;
+        }
+    }
+    fclose(f);
+    return ok;
+}
+
+void VP_LinkCosts::print(FILE* out) const {
+    for (const CostField& c : costFields) {
+        fprintf(out, "%-18s %.3f\n", c.name, this->*c.field);
+    }
+    fprintf(out, "%-18s %u\n", "apbHz", apbHz);
+}
@@ -0,0 +1,684 @@
+/**
+ * @file fpga.cpp
+ * @brief Virtual Papilio: Wishbone-over-SPI decoder and framebuffer model
+ *
+ * Mirrors gateware/src/video_top_modular.v and wb_video_framebuffer.v.
+ * Test pattern and text mode registers are accepted and count as screen
+ * updates, but frames are always rendered from the framebuffer (or, while
+ * line streaming, from the lines the beam has scanned).
+ */
+
+#include <VirtualPapilio.h>
+#include <HQVGA.h>
+
+// Framebuffer control block: 0x0030-0x004F, palette in the top half
+#define FB_CTRL_END 0x0050
+#define LS_REG_END  0x0060
+#define LS_LINES    4
+// Dual playfield registers, palette bank 1 in the top half
+#define LAYER_END   0x0080
+#define AFF_END     0x00A0
+#define WIN_END     0x00B0
+#define LINK_END    0x00B8
+
+// CRC-16/CCITT of one write, as crc16_write() in video_top_modular.v
+static uint16_t linkCrc(uint16_t crc, uint16_t addr, uint8_t data) {
+    const uint8_t bytes[3] = { (uint8_t)(addr >> 8), (uint8_t)addr, data };
+    for (uint8_t b : bytes) {
+        crc ^= b << 8;
+        for (int k = 0; k < 8; k++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+// Frame layout per timing preset, as in hdmi_timing.v
+struct BeamTiming {
+    unsigned vTotal, vStart;
+    double frameUs;
+};
+static const BeamTiming beamTimings[4] = {
+    { 525, 35, 800.0 * 525 / 25.175 },
+    { 750, 25, 1650.0 * 750 / 74.25 },
+    { 1125, 41, 2200.0 * 1125 / 74.25 },
+    { 666, 29, 1040.0 * 666 / 50.0 },
+};
+
+VP_FPGA::VP_FPGA(int csPin)
+    : dirty(false), earlyReads(0), badCommands(0), partialFrames(0), injectedErrors(0),
+      streamLines(0), streamUnderflows(0), minReadGapUs(1.0), linkErrorRate(0.0),
+      overdraw(nullptr), _csPin(csPin), _selected(false),
+      _state(0), _cmd(0), _addr(0), _addrDoneUs(0), _videoMode(0), _timing(1), _width(160),
+      _height(120), _format(0), _scale(6), _border(0), _wmask(0x03), _viewX(160), _viewY(0),
+      _lsEnable(false), _lsActive(false), _lsLineOk(false), _lsWrSlot(0), _lsRdSlot(0),
+      _lsPending(0), _lsNext(0), _lsUnder(0), _beamLine(0), _layerCtrl(0), _affCtrl(0),
+      _winBase(0), _winW(1), _winH(1), _winRow(0), _winCol(0), _winLine(0),
+      _rop(0), _ropKey(0), _hold(0), _crcSnap(0), _bootMode(0), _epoch(0),
+      _linkCrc(0xFFFF), _linkExpLo(0), _linkStatus(0), _linkErrors(0), _linkChecks(0),
+      _faultSeed(0x2545F491) {
+    // Power-on palette from wb_video_framebuffer.v
+    static const uint8_t defaultPalette[16] = { 0x00, 0x02, 0x14, 0x16, 0xA0, 0xA2, 0xA8, 0xB6,
+                                                0x49, 0x4B, 0x5D, 0x5F, 0xE9, 0xEB, 0xFD, 0xFF };
+    memcpy(_palette, defaultPalette, sizeof(_palette));
+    memcpy(_palette1, defaultPalette, sizeof(_palette1));
+    memset(_layerRegs, 0, sizeof(_layerRegs));
+    _layerRegs[HQVGA_LAYER_REG_STRIDE] = 0x30;  // layer 1: bank 1, index 0 transparent
+    memset(_affParams, 0, sizeof(_affParams));
+    _affParams[2] = _affParams[5] = 0x100;      // identity
+    memset(_affTable, 0, sizeof(_affTable));
+    memset(_vram, 0, sizeof(_vram));
+    memset(_lsRing, 0, sizeof(_lsRing));
+    memset(_lsScreen, 0, sizeof(_lsScreen));
+    memset(_lsBlank, 0, sizeof(_lsBlank));
+}
+
+void VP_FPGA::reconfigure() {
+    // Everything the bitstream holds goes back to power-on; the run's
+    // counters, the profiler and the beam (tied to virtual time) carry on
+    VP_FPGA* fresh = new VP_FPGA(_csPin);
+    fresh->earlyReads = earlyReads;
+    fresh->badCommands = badCommands;
+    fresh->partialFrames = partialFrames;
+    fresh->injectedErrors = injectedErrors;
+    fresh->streamLines = streamLines;
+    fresh->streamUnderflows = streamUnderflows;
+    fresh->minReadGapUs = minReadGapUs;
+    fresh->linkErrorRate = linkErrorRate;
+    fresh->_faultSeed = _faultSeed;
+    fresh->overdraw = overdraw;
+    fresh->_beamLine = _beamLine;
+    fresh->dirty = true;
+    *this = *fresh;
+    delete fresh;
+}
+
+void VP_FPGA::select(bool asserted) {
+    // The bridge restarts its frame on every CS assertion
+    if (_selected && !asserted && _state != 0) partialFrames++;
+    _selected = asserted;
+    _state = 0;
+}
+
+uint8_t VP_FPGA::shift(uint8_t mosi, double nowUs) {
+    uint8_t miso = 0x00;
+    runBeam(nowUs);
+
+    switch (_state) {
+    case 0:
+        _cmd = mosi;
+        if (_cmd > 0x01) badCommands++;
+        break;
+    case 1:
+        _addr = mosi << 8;
+        break;
+    case 2:
+        _addr |= mosi;
+        _addrDoneUs = nowUs;
+        break;
+    default:
+        if (_cmd == 0x01) {
+            if (linkErrorRate > 0) {
+                // xorshift32: the same faults on every run
+                _faultSeed ^= _faultSeed << 13;
+                _faultSeed ^= _faultSeed >> 17;
+                _faultSeed ^= _faultSeed << 5;
+                if ((_faultSeed >> 8) < linkErrorRate * (1u << 24)) {
+                    mosi ^= 1 << (_faultSeed & 7);
+                    injectedErrors++;
+                }
+            }
+            write(_addr, mosi);
+        } else if (nowUs - _addrDoneUs < minReadGapUs ||
+                   (_addr >= HQVGA_FB_BASE && _addr < HQVGA_LINE_BASE &&
+                    nowUs - _addrDoneUs < vramReadUs())) {
+            earlyReads++;
+            miso = 0xFF;
+        } else {
+            miso = read(_addr);
+        }
+        vp::stats.wishboneFrames++;
+        break;
+    }
+
+    // Re-arm for the next CMD byte after DATA
+    _state = (_state + 1) & 3;
+    return miso;
+}
+
+void VP_FPGA::resolution(unsigned& h, unsigned& v) const {
+    static const unsigned presets[4][2] = { { 640, 480 }, { 1280, 720 }, { 1920, 1080 }, { 800, 600 } };
+    h = presets[_timing][0];
+    v = presets[_timing][1];
+}
+
+// A VRAM read waits for a clock the scanout leaves free; in the worst case
+// (affine scanout, or the first line of a scaled source line) that is the
+// next horizontal blank, one scanline away
+double VP_FPGA::vramReadUs() const {
+    const BeamTiming& t = beamTimings[_timing];
+    return t.frameUs / t.vTotal;
+}
+
+void VP_FPGA::writeVram(unsigned offset, uint8_t data) {
+    if (offset >= sizeof(_vram)) return;
+    uint8_t keep = (_wmask & 0x02 ? 0x00 : 0xF0) | (_wmask & 0x01 ? 0x00 : 0x0F);
+    switch (_rop) {
+    case 1: data ^= _vram[offset]; break;
+    case 2: data &= _vram[offset]; break;
+    case 3: data |= _vram[offset]; break;
+    case 4:
+        // Whole byte in 8bpp, each nibble on its own in 4bpp
+        if (_format) {
+            if ((data & 0xF0) == (_ropKey & 0xF0)) keep |= 0xF0;
+            if ((data & 0x0F) == (_ropKey & 0x0F)) keep |= 0x0F;
+        } else if (data == _ropKey) {
+            keep = 0xFF;
+        }
+        break;
+    }
+    uint8_t v = (_vram[offset] & keep) | (data & ~keep);
+    if (overdraw) profile(offset, _wmask, _vram[offset], v);
+    if (v != _vram[offset]) dirty = true;
+    _vram[offset] = v;
+    vp::stats.vramWrites++;
+}
+
+void VP_FPGA::write(uint16_t addr, uint8_t data) {
+    if (addr > HQVGA_REG_EPOCH && addr < LINK_END) {
+        switch (addr) {
+        case HQVGA_REG_LINK_CTRL:
+            if (data & 0x01) {
+                _linkCrc = 0xFFFF;
+                _linkStatus = 0;
+            }
+            break;
+        case HQVGA_REG_LINK_CRC_LO: _linkExpLo = data; break;
+        case HQVGA_REG_LINK_CRC_HI:
+            _linkChecks++;
+            _linkStatus = 0x02;
+            if ((uint16_t)(data << 8 | _linkExpLo) != _linkCrc) {
+                _linkStatus |= 0x01;
+                _linkErrors++;
+            }
+            break;
+        default: _linkErrors = _linkChecks = 0; break;
+        }
+        return;
+    }
+    _linkCrc = linkCrc(_linkCrc, addr, data);
+
+    if (addr >= HQVGA_LINE_BASE) {
+        if (_lsEnable && addr < HQVGA_LINE_BASE + HQVGA_LINE_MAX_BYTES) {
+            _lsRing[_lsWrSlot][addr - HQVGA_LINE_BASE] = data;
+        } else if (addr >= HQVGA_AFF_TABLE && addr < HQVGA_AFF_TABLE + sizeof(_affTable)) {
+            uint8_t& slot = _affTable[addr - HQVGA_AFF_TABLE];
+            if (slot != data && (_affCtrl & 0x03) == 0x03) dirty = true;
+            slot = data;
+        }
+        return;
+    }
+    if (addr >= HQVGA_FB_BASE) {
+        writeVram(addr - HQVGA_FB_BASE, data);
+        return;
+    }
+
+    if (addr == HQVGA_REG_WIN_DATA) {
+        // Write at the pointer, then step along the row, down, and back
+        // to the top-left after the last row
+        writeVram(_winRow + _winCol, data);
+        if (++_winCol >= _winW) {
+            _winCol = 0;
+            if (++_winLine >= _winH) {
+                _winLine = 0;
+                _winRow = _winBase;
+            } else {
+                _winRow += _format ? (_width + 1) / 2 : _width;
+            }
+        }
+        return;
+    }
+
+    vp::stats.regWrites++;
+    if (addr < 0x0010) {
+        if ((addr & 0x0F) == 0x01) {
+            // Stock bitstream: only the 74.25MHz presets (TIMING_PRESETS)
+            if ((0x06 >> (data & 0x03)) & 1)
+                _timing = data & 0x03;
+        } else if (addr == HQVGA_REG_BOOT) {
+            _bootMode = data & 0x03;
+        } else if (addr >= HQVGA_REG_FRAME_CRC && addr <= HQVGA_REG_FRAME_COUNT) {
+            // Frame CRC and count are read only
+        } else {
+            if ((data & 0x03) != _videoMode) dirty = true;
+            _videoMode = data & 0x03;
+        }
+        return;
+    }
+    if (addr < HQVGA_REG_FB_WIDTH_LO) {
+        // Test pattern / text mode: not rendered, but it is a screen update
+        dirty = true;
+        return;
+    }
+    if (addr == HQVGA_REG_EPOCH) {
+        _epoch = data;
+        return;
+    }
+    if (addr >= WIN_END) return;
+    if (addr >= AFF_END) {
+        switch (addr) {
+        case HQVGA_REG_WIN_BASE_LO: _winBase = (_winBase & 0x7F00) | data; break;
+        case HQVGA_REG_WIN_BASE_HI: _winBase = (_winBase & 0xFF) | ((data & 0x7F) << 8); break;
+        case HQVGA_REG_WIN_W_LO:    _winW = (_winW & 0x100) | data; break;
+        case HQVGA_REG_WIN_W_HI:    _winW = (_winW & 0xFF) | ((data & 0x01) << 8); break;
+        case HQVGA_REG_WIN_H_LO:    _winH = (_winH & 0x100) | data; break;
+        case HQVGA_REG_WIN_H_HI:    _winH = (_winH & 0xFF) | ((data & 0x01) << 8); break;
+        case HQVGA_REG_ROP:         _rop = data & 0x07; return;
+        case HQVGA_REG_ROP_KEY:     _ropKey = data; return;
+        case HQVGA_REG_STATE_CTRL:  _hold = data & 0x01; return;
+        default: return;
+        }
+        // Any geometry write rewinds the pointer
+        _winRow = _winBase;
+        _winCol = _winLine = 0;
+        return;
+    }
+    if (addr >= LAYER_END) {
+        unsigned i = (addr - HQVGA_REG_AFF_U0) / 4, byte = addr & 3;
+        if (addr == HQVGA_REG_AFF_CTRL) {
+            if ((data & 0x07) != _affCtrl) dirty = true;
+            _affCtrl = data & 0x07;
+        } else if (addr >= HQVGA_REG_AFF_U0 && i < 6 && byte < 3) {
+            uint32_t v = ((uint32_t)_affParams[i] & ~(0xFFu << (8 * byte))) | (data << (8 * byte));
+            int32_t sv = (int32_t)(v << 8) >> 8;  // sign-extend 24 bits
+            if (sv != _affParams[i]) dirty = true;
+            _affParams[i] = sv;
+        }
+        return;
+    }
+    if (addr >= HQVGA_REG_FB_PALETTE1) {
+        if (_palette1[addr & 0x0F] != data) dirty = true;
+        _palette1[addr & 0x0F] = data;
+        return;
+    }
+    if (addr >= HQVGA_REG_LAYER_CTRL) {
+        if (addr == HQVGA_REG_LAYER_CTRL) {
+            data &= 0x03;
+            if (data != _layerCtrl) dirty = true;
+            _layerCtrl = data;
+        } else if (addr < HQVGA_REG_L0_CTRL + 2 * HQVGA_LAYER_REG_STRIDE) {
+            // CTRL keeps 6 bits, scroll HI bytes 1
+            unsigned reg = (addr - HQVGA_REG_L0_CTRL) % HQVGA_LAYER_REG_STRIDE;
+            data &= reg == 0 ? 0x3F : (reg & 1) ? 0xFF : 0x01;
+            uint8_t& slot = _layerRegs[addr - HQVGA_REG_L0_CTRL];
+            if (slot != data) dirty = true;
+            slot = data;
+        }
+        return;
+    }
+    if (addr >= FB_CTRL_END) {
+        switch (addr) {
+        case HQVGA_REG_LS_CTRL:
+            // Starting begins at line 0 of the next frame
+            if ((data & 0x01) == _lsEnable) break;
+            _lsEnable = data & 0x01;
+            _lsWrSlot = 0;
+            _lsPending = 0;
+            _lsNext = 0;
+            _lsUnder = 0;
+            _lsActive = false;
+            _lsLineOk = false;
+            _lsRdSlot = 0;
+            dirty = true;
+            break;
+        case HQVGA_REG_LS_CREDIT:
+            if (_lsEnable && _lsPending < LS_LINES) {
+                _lsWrSlot = (_lsWrSlot + 1) % LS_LINES;
+                _lsPending++;
+                if (++_lsNext >= _height) _lsNext = 0;
+                dirty = true;
+            }
+            break;
+        case HQVGA_REG_LS_UNDER_LO:
+        case HQVGA_REG_LS_UNDER_HI:
+            _lsUnder = 0;
+            break;
+        }
+        return;
+    }
+
+    if (addr >= HQVGA_REG_FB_PALETTE) {
+        if (_palette[addr & 0x0F] != data) dirty = true;
+        _palette[addr & 0x0F] = data;
+        return;
+    }
+
+    switch (addr) {
+    case HQVGA_REG_FB_WIDTH_LO:  _width = (_width & 0x100) | data; break;
+    case HQVGA_REG_FB_WIDTH_HI:  _width = (_width & 0xFF) | ((data & 0x01) << 8); break;
+    case HQVGA_REG_FB_HEIGHT_LO: _height = (_height & 0x100) | data; break;
+    case HQVGA_REG_FB_HEIGHT_HI: _height = (_height & 0xFF) | ((data & 0x01) << 8); break;
+    case HQVGA_REG_FB_FORMAT:    _format = data & 0x01; break;
+    case HQVGA_REG_FB_SCALE:     _scale = data & 0x0F; break;
+    case HQVGA_REG_FB_VIEW_X_LO: _viewX = (_viewX & 0xF00) | data; break;
+    case HQVGA_REG_FB_VIEW_X_HI: _viewX = (_viewX & 0xFF) | ((data & 0x0F) << 8); break;
+    case HQVGA_REG_FB_VIEW_Y_LO: _viewY = (_viewY & 0xF00) | data; break;
+    case HQVGA_REG_FB_VIEW_Y_HI: _viewY = (_viewY & 0xFF) | ((data & 0x0F) << 8); break;
+    case HQVGA_REG_FB_BORDER:    _border = data; break;
+    case HQVGA_REG_FB_WMASK:     _wmask = data & 0x03; return;
+    default:                     return;
+    }
+    dirty = true;
+}
+
+// Attribute one VRAM byte write to the pixels its nibble enables cover
+void VP_FPGA::profile(unsigned offset, uint8_t enables, uint8_t before, uint8_t after) {
+    if (_format != HQVGA_FORMAT_INDEXED4) {
+        if (!enables) return;
+        if (offset < _width * _height) overdraw->record(offset, before == after);
+        else overdraw->_passOffscreen++;
+        return;
+    }
+
+    unsigned stride = (_width + 1) / 2;
+    unsigned y = offset / stride, x = (offset % stride) * 2;
+    for (int nibble = 0; nibble < 2; nibble++, x++) {
+        uint8_t bit = nibble ? 0x01 : 0x02, shift = nibble ? 0 : 4;
+        if (!(enables & bit)) continue;
+        if (y < _height && x < _width) {
+            overdraw->record(y * _width + x, ((before >> shift) & 0x0F) == ((after >> shift) & 0x0F));
+        } else {
+            overdraw->_passOffscreen++;
+        }
+    }
+}
+
+uint8_t VP_FPGA::read(uint16_t addr) const {
+    vp::stats.reads++;
+    if (addr >= HQVGA_LINE_BASE) return 0x00;
+    if (addr >= HQVGA_FB_BASE) {
+        unsigned offset = addr - HQVGA_FB_BASE;
+        return offset < sizeof(_vram) ? _vram[offset] : 0x00;
+    }
+    if (addr < 0x0010) {
+        switch (addr) {
+        case 0x0001:                return _timing;
+        case HQVGA_REG_BOOT:        return _bootMode;
+        case HQVGA_REG_FRAME_CRC:   _crcSnap = frameCrc(); return _crcSnap & 0xFF;
+        case HQVGA_REG_FRAME_CRC + 1:
+        case HQVGA_REG_FRAME_CRC + 2:
+        case HQVGA_REG_FRAME_CRC + 3:
+            return (_crcSnap >> (8 * (addr - HQVGA_REG_FRAME_CRC))) & 0xFF;
+        case HQVGA_REG_FRAME_COUNT: return (_beamLine / beamTimings[_timing].vTotal) & 0xFF;
+        default:                    return _videoMode;
+        }
+    }
+    if (addr == HQVGA_REG_EPOCH) return _epoch;
+    if (addr > HQVGA_REG_EPOCH && addr < LINK_END) {
+        switch (addr) {
+        case HQVGA_REG_LINK_CTRL:      return 0x80 | _linkStatus;
+        case HQVGA_REG_LINK_CRC_LO:    return _linkCrc & 0xFF;
+        case HQVGA_REG_LINK_CRC_HI:    return _linkCrc >> 8;
+        case HQVGA_REG_LINK_ERRORS_LO: return _linkErrors & 0xFF;
+        case HQVGA_REG_LINK_ERRORS_HI: return _linkErrors >> 8;
+        case HQVGA_REG_LINK_CHECKS_LO: return _linkChecks & 0xFF;
+        default:                       return _linkChecks >> 8;
+        }
+    }
+    if (addr < HQVGA_REG_FB_WIDTH_LO || addr >= WIN_END) return 0x00;
+    if (addr >= AFF_END) {
+        switch (addr) {
+        case HQVGA_REG_WIN_BASE_LO: return _winBase & 0xFF;
+        case HQVGA_REG_WIN_BASE_HI: return _winBase >> 8;
+        case HQVGA_REG_WIN_W_LO:    return _winW & 0xFF;
+        case HQVGA_REG_WIN_W_HI:    return _winW >> 8;
+        case HQVGA_REG_WIN_H_LO:    return _winH & 0xFF;
+        case HQVGA_REG_WIN_H_HI:    return _winH >> 8;
+        case HQVGA_REG_ROP:         return _rop;
+        case HQVGA_REG_ROP_KEY:     return _ropKey;
+        case HQVGA_REG_STATE_CTRL:  return _hold;
+        default:                    return 0x00;
+        }
+    }
+    if (addr >= LAYER_END) {
+        unsigned i = (addr - HQVGA_REG_AFF_U0) / 4, byte = addr & 3;
+        if (addr == HQVGA_REG_AFF_CTRL) return _affCtrl;
+        if (addr >= HQVGA_REG_AFF_U0 && i < 6 && byte < 3) return (_affParams[i] >> (8 * byte)) & 0xFF;
+        return 0x00;
+    }
+    if (addr >= HQVGA_REG_FB_PALETTE1) return _palette1[addr & 0x0F];
+    if (addr == HQVGA_REG_LAYER_CTRL) return _layerCtrl;
+    if (addr >= HQVGA_REG_LAYER_CTRL) {
+        unsigned i = addr - HQVGA_REG_L0_CTRL;
+        return i < 2 * HQVGA_LAYER_REG_STRIDE ? _layerRegs[i] : 0x00;
+    }
+    if (addr >= FB_CTRL_END) {
+        switch (addr) {
+        case HQVGA_REG_LS_CTRL:     return _lsEnable;
+        case HQVGA_REG_LS_CREDIT:   return LS_LINES - _lsPending;
+        case HQVGA_REG_LS_NEXT_LO:  return _lsNext & 0xFF;
+        case HQVGA_REG_LS_NEXT_HI:  return _lsNext >> 8;
+        case HQVGA_REG_LS_UNDER_LO: return _lsUnder & 0xFF;
+        case HQVGA_REG_LS_UNDER_HI: return (_lsUnder >> 8) & 0xFF;
+        case HQVGA_REG_LS_LINES:    return LS_LINES;
+        default:                    return 0x00;
+        }
+    }
+    if (addr >= HQVGA_REG_FB_PALETTE) return _palette[addr & 0x0F];
+
+    unsigned h, v;
+    resolution(h, v);
+    switch (addr) {
+    case HQVGA_REG_FB_WIDTH_LO:  return _width & 0xFF;
+    case HQVGA_REG_FB_WIDTH_HI:  return _width >> 8;
+    case HQVGA_REG_FB_HEIGHT_LO: return _height & 0xFF;
+    case HQVGA_REG_FB_HEIGHT_HI: return _height >> 8;
+    case HQVGA_REG_FB_FORMAT:    return _format;
+    case HQVGA_REG_FB_SCALE:     return _scale;
+    case HQVGA_REG_FB_VIEW_X_LO: return _viewX & 0xFF;
+    case HQVGA_REG_FB_VIEW_X_HI: return _viewX >> 8;
+    case HQVGA_REG_FB_VIEW_Y_LO: return _viewY & 0xFF;
+    case HQVGA_REG_FB_VIEW_Y_HI: return _viewY >> 8;
+    case HQVGA_REG_FB_BORDER:    return _border;
+    case HQVGA_REG_FB_WMASK:     return _wmask;
+    case HQVGA_REG_FB_HRES_LO:   return h & 0xFF;
+    case HQVGA_REG_FB_HRES_HI:   return h >> 8;
+    case HQVGA_REG_FB_VRES_LO:   return v & 0xFF;
+    case HQVGA_REG_FB_VRES_HI:   return v >> 8;
+    default:                     return 0x00;
+    }
+}
+
+uint8_t VP_FPGA::pixel(unsigned x, unsigned y) const {
+    if (_lsActive) {
+        if (y >= 511 || _lsBlank[y]) return _border;
+        const uint8_t* row = _lsScreen[y];
+        if (_format != HQVGA_FORMAT_INDEXED4) return x < 512 ? row[x] : _border;
+        uint8_t b = row[(x >> 1) & 0x1FF];
+        return _palette[(x & 1) ? (b & 0x0F) : (b >> 4)];
+    }
+    if (_affCtrl & 0x01) return affinePixel(x, y);
+    if (dualPlayfield()) return layerPixel(x, y);
+    if (_format == HQVGA_FORMAT_INDEXED4) {
+        unsigned offset = y * ((_width + 1) / 2) + (x >> 1);
+        if (offset >= sizeof(_vram)) return _border;
+        uint8_t b = _vram[offset];
+        return _palette[(x & 1) ? (b & 0x0F) : (b >> 4)];
+    }
+    unsigned offset = y * _width + x;
+    return offset < sizeof(_vram) ? _vram[offset] : _border;
+}
+
+uint32_t VP_FPGA::frameCrc() const {
+    static uint32_t table[256];
+    if (!table[1]) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? (c >> 1) ^ 0xEDB88320 : c >> 1;
+            table[i] = c;
+        }
+    }
+    if (_videoMode != 2) return 0;
+
+    unsigned h, v;
+    resolution(h, v);
+    unsigned scale = _scale ? _scale : 1;
+    uint32_t crc = 0xFFFFFFFF;
+    for (unsigned oy = 0; oy < v; oy++) {
+        bool rowIn = oy >= _viewY && oy < _viewY + _height * scale;
+        for (unsigned ox = 0; ox < h; ox++) {
+            uint8_t c = _border;
+            if (rowIn && ox >= _viewX && ox < _viewX + _width * scale)
+                c = pixel((ox - _viewX) / scale, (oy - _viewY) / scale);
+            // RGB332 to RGB888 as in wb_video_framebuffer.v
+            uint8_t r = c >> 5, g = (c >> 2) & 7, b = c & 3;
+            uint8_t rgb[3] = { (uint8_t)((r << 5) | (r << 2) | (r >> 1)),
+                               (uint8_t)((g << 5) | (g << 2) | (g >> 1)),
+                               (uint8_t)((b << 6) | (b << 4) | (b << 2) | b) };
+            for (int i = 0; i < 3; i++) crc = (crc >> 8) ^ table[(crc ^ rgb[i]) & 0xFF];
+        }
+    }
+    return ~crc;
+}
+
+// Texel under image pixel (x, y) in affine scanout. The RTL accumulates
+// the same sums; in wrap mode its incremental folding matches a modulo
+// while the host keeps the steps below the image size.
+uint8_t VP_FPGA::affinePixel(unsigned x, unsigned y) const {
+    int64_t u, v;
+    if (_affCtrl & 0x02) {
+        const uint8_t* e = _affTable + (y & 0xFF) * 8;
+        int16_t f[4];
+        for (int k = 0; k < 4; k++) f[k] = (int16_t)(e[2 * k] | (e[2 * k + 1] << 8));
+        u = (int64_t)f[0] * 16 + (int64_t)x * f[2];
+        v = (int64_t)f[1] * 16 + (int64_t)x * f[3];
+    } else {
+        const int32_t* p = _affParams;
+        u = p[0] + (int64_t)x * p[2] + (int64_t)y * p[4];
+        v = p[1] + (int64_t)x * p[3] + (int64_t)y * p[5];
+    }
+
+    int64_t tu = u >> 8, tv = v >> 8;
+    if (_affCtrl & 0x04) {
+        tu = tu < 0 ? 0 : tu >= _width ? _width - 1 : tu;
+        tv = tv < 0 ? 0 : tv >= _height ? _height - 1 : tv;
+    } else {
+        tu %= _width;
+        tv %= _height;
+        if (tu < 0) tu += _width;
+        if (tv < 0) tv += _height;
+    }
+
+    if (_format == HQVGA_FORMAT_INDEXED4) {
+        unsigned offset = tv * ((_width + 1) / 2) + (tu >> 1);
+        uint8_t b = offset < sizeof(_vram) ? _vram[offset] : 0;
+        return _palette[(tu & 1) ? (b & 0x0F) : (b >> 4)];
+    }
+    unsigned offset = tv * _width + tu;
+    return offset < sizeof(_vram) ? _vram[offset] : 0;
+}
+
+// Both layers are read per source pixel, so the RTL needs scale 2 or more
+bool VP_FPGA::dualPlayfield() const {
+    return (_layerCtrl & 0x01) && _format == HQVGA_FORMAT_INDEXED4 && _scale > 1;
+}
+
+// Composite the two playfields as the dual playfield scanout does
+uint8_t VP_FPGA::layerPixel(unsigned x, unsigned y) const {
+    unsigned stride = (_width + 1) / 2;
+    uint8_t color[2];
+    bool solid[2];
+    for (int n = 0; n < 2; n++) {
+        const uint8_t* r = _layerRegs + n * HQVGA_LAYER_REG_STRIDE;
+        unsigned sx = r[1] | (r[2] << 8), sy = r[3] | (r[4] << 8);
+        unsigned lx = (x + sx) % _width, ly = (y + sy) % _height;
+        unsigned offset = n * stride * _height + ly * stride + (lx >> 1);
+        uint8_t b = offset < sizeof(_vram) ? _vram[offset] : 0;
+        uint8_t index = (lx & 1) ? (b & 0x0F) : (b >> 4);
+        color[n] = (r[0] & 0x20) ? _palette1[index] : _palette[index];
+        solid[n] = !((r[0] & 0x10) && index == (r[0] & 0x0F));
+    }
+    int front = (_layerCtrl & 0x02) ? 0 : 1;
+    if (solid[front]) return color[front];
+    if (solid[!front]) return color[!front];
+    return _border;
+}
+
+bool VP_FPGA::writePPM(const char* path, unsigned zoom) const {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    if (zoom < 1) zoom = 1;
+
+    fprintf(f, "P6\n%u %u\n255\n", _width * zoom, _height * zoom);
+    uint8_t* row = new uint8_t[_width * zoom * 3];
+    for (unsigned y = 0; y < _height; y++) {
+        for (unsigned x = 0; x < _width; x++) {
+            // Same bit replication as the RTL's RGB332 to RGB888 expansion
+            uint8_t c = pixel(x, y);
+            uint8_t r = c >> 5, g = (c >> 2) & 0x07, b = c & 0x03;
+            uint8_t rgb[3] = { (uint8_t)((r << 5) | (r << 2) | (r >> 1)),
+                               (uint8_t)((g << 5) | (g << 2) | (g >> 1)),
+                               (uint8_t)(b * 0x55) };
+            for (unsigned z = 0; z < zoom; z++) memcpy(&row[(x * zoom + z) * 3], rgb, 3);
+        }
+        for (unsigned z = 0; z < zoom; z++) fwrite(row, 3, _width * zoom, f);
+    }
+    delete[] row;
+    return fclose(f) == 0;
+}
+
+// One output line of the frame; v = 0 is the start of vsync
+void VP_FPGA::beamLine(unsigned v) {
+    if (v == 0) {
+        streamRetire();
+        if (_lsEnable) _lsActive = true;
+        return;
+    }
+    if (!_lsActive) return;
+
+    const BeamTiming& t = beamTimings[_timing];
+    unsigned scale = _scale ? _scale : 1;
+    int rel = (int)v - (int)t.vStart - (int)_viewY;
+    if (rel < 0) return;
+
+    unsigned scaledH = _height * scale;
+    if ((unsigned)rel == scaledH) {
+        streamRetire();
+    } else if ((unsigned)rel < scaledH && rel % scale == 0) {
+        // A new source line: free the one on screen, show the next buffer
+        streamRetire();
+        unsigned y = rel / scale;
+        if (y >= 511) return;
+        if (_lsPending) {
+            memcpy(_lsScreen[y], _lsRing[_lsRdSlot], sizeof(_lsScreen[y]));
+            _lsBlank[y] = false;
+            _lsLineOk = true;
+            streamLines++;
+        } else {
+            _lsBlank[y] = true;
+            _lsUnder++;
+            streamUnderflows++;
+            if (++_lsNext >= _height) _lsNext = 0;
+        }
+    }
+}
+
+void VP_FPGA::streamRetire() {
+    if (!_lsLineOk) return;
+    _lsLineOk = false;
+    _lsPending--;
+    _lsRdSlot = (_lsRdSlot + 1) % LS_LINES;
+}
+
+void VP_FPGA::runBeam(double nowUs) {
+    const BeamTiming& t = beamTimings[_timing];
+    uint64_t target = (uint64_t)(nowUs * t.vTotal / t.frameUs);
+
+    // Nothing to scan unless streaming; just keep the beam position
+    if (!_lsEnable && !_lsActive) {
+        _beamLine = target;
+        return;
+    }
+    while (_beamLine < target) {
+        _beamLine++;
+        beamLine(_beamLine % t.vTotal);
+    }
+}
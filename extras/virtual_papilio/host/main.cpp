@@ -0,0 +1,363 @@
+/**
+ * @file main.cpp
+ * @brief Virtual Papilio: runs a sketch's setup()/loop() and reports
+ *        predicted on-device frame rate and SPI time per frame
+ *
+ * A frame is a loop() pass that changed what is on screen (VRAM, palette,
+ * geometry, video mode or a committed stream line). Frame rate is frames per virtual second after
+ * setup(), so millis()-paced sketches report their paced rate; the link
+ * ceiling is the rate the SPI time alone would allow.
+ *
+ * With --overdraw every loop() pass that wrote VRAM is profiled per pixel
+ * (see VP_Overdraw) and the heatmap is written next to the frames.
+ *
+ *   ./sketch [--seconds S] [--loops N] [--frames DIR] [--dump-every N]
+ *            [--zoom Z] [--costs FILE] [--cpu-scale X] [--serial-input TEXT]
+ *            [--report FILE] [--min-fps F] [--overdraw] [--hot N]
+ *            [--fpga-reset S] [--link-errors P] [--quiet]
+ */
+
+#include <Arduino.h>
+#include <VirtualPapilio.h>
+
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct Options {
+    double seconds = 10.0;
+    uint64_t loops = 0;
+    const char* framesDir = nullptr;
+    unsigned dumpEvery = 0;
+    unsigned zoom = 1;
+    double cpuScale = 0.0;
+    const char* report = nullptr;
+    double minFps = 0.0;
+    bool overdraw = false;
+    unsigned hot = 5;
+    double fpgaReset = -1.0;
+    double linkErrors = 0.0;
+    bool quiet = false;
+};
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --seconds S         virtual run time after setup() (default 10)\n"
+            "  --loops N           stop after N loop() calls instead\n"
+            "  --frames DIR        write frames to DIR as PPM (last.ppm at exit; created if missing)\n"
+            "  --dump-every N      also write every Nth frame (needs --frames)\n"
+            "  --zoom Z            scale written frames by Z\n"
+            "  --costs FILE        link costs measured by virtual_papilio_calibrate\n"
+            "  --cpu-scale X       charge host CPU time of loop() times X (0 = link only)\n"
+            "  --serial-input TEXT bytes for Serial.read()\n"
+            "  --report FILE       write the results as JSON\n"
+            "  --min-fps F         exit with status 2 if predicted FPS < F\n"
+            "  --overdraw          profile writes per pixel, write overdraw.ppm\n"
+            "  --hot N             hot regions listed by --overdraw (default 5)\n"
+            "  --fpga-reset S      reset the FPGA(s) S virtual seconds after setup()\n"
+            "  --link-errors P     after setup(), flip a bit in P of all write frames\n"
+            "  --quiet             hide the sketch's Serial output\n",
+            argv0);
+}
+
+static bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (a == "--quiet") {
+            opt.quiet = true;
+        } else if (a == "--overdraw") {
+            opt.overdraw = true;
+        } else if (!hasValue) {
+            return false;
+        } else if (a == "--seconds") {
+            opt.seconds = atof(argv[++i]);
+        } else if (a == "--loops") {
+            opt.loops = strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--frames") {
+            opt.framesDir = argv[++i];
+        } else if (a == "--dump-every") {
+            opt.dumpEvery = atoi(argv[++i]);
+        } else if (a == "--zoom") {
+            opt.zoom = atoi(argv[++i]);
+        } else if (a == "--costs") {
+            if (!vp::costs.load(argv[++i])) return false;
+        } else if (a == "--cpu-scale") {
+            opt.cpuScale = atof(argv[++i]);
+        } else if (a == "--serial-input") {
+            vp::setSerialInput(argv[++i]);
+        } else if (a == "--report") {
+            opt.report = argv[++i];
+        } else if (a == "--min-fps") {
+            opt.minFps = atof(argv[++i]);
+        } else if (a == "--hot") {
+            opt.hot = atoi(argv[++i]);
+        } else if (a == "--fpga-reset") {
+            opt.fpgaReset = atof(argv[++i]);
+        } else if (a == "--link-errors") {
+            opt.linkErrors = atof(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// mkdir -p: create dir and any missing parents
+static bool makeDirs(const char* dir) {
+    std::string path = dir;
+    for (size_t i = 1; i <= path.size(); i++) {
+        if (i < path.size() && path[i] != '/') continue;
+        std::string part = path.substr(0, i);
+        if (mkdir(part.c_str(), 0777) != 0 && errno != EEXIST) return false;
+    }
+    struct stat st;
+    if (stat(dir, &st) != 0) return false;
+    if (!S_ISDIR(st.st_mode)) {
+        errno = ENOTDIR;
+        return false;
+    }
+    return true;
+}
+
+// DIR/name.ppm, or DIR/name_cs<pin>.ppm when there is more than one FPGA
+static void imagePath(char* path, size_t size, const char* dir, const char* name, const VP_FPGA* d) {
+    if (vp::deviceCount() > 1) {
+        snprintf(path, size, "%s/%s_cs%d.ppm", dir, name, d->csPin());
+    } else {
+        snprintf(path, size, "%s/%s.ppm", dir, name);
+    }
+}
+
+static void dumpFrames(const Options& opt, const char* name) {
+    if (!opt.framesDir) return;
+    for (int i = 0; i < vp::deviceCount(); i++) {
+        VP_FPGA* d = vp::deviceAt(i);
+        char path[512];
+        imagePath(path, sizeof(path), opt.framesDir, name, d);
+        if (!d->writePPM(path, opt.zoom)) fprintf(stderr, "virtual papilio: cannot write %s\n", path);
+    }
+}
+
+static void reportOverdraw(const Options& opt, FILE* out) {
+    for (int i = 0; i < vp::deviceCount(); i++) {
+        VP_FPGA* d = vp::deviceAt(i);
+        const VP_Overdraw* od = d->overdraw;
+        if (vp::deviceCount() > 1) fprintf(out, "--- overdraw, CS %d\n", d->csPin());
+        if (!od->frames()) {
+            fprintf(out, "overdraw         no VRAM writes after setup()\n");
+            continue;
+        }
+
+        fprintf(out, "overdraw         %.2fx (%llu pixel writes over %llu frames)\n", od->overdraw(),
+                (unsigned long long)od->writes(), (unsigned long long)od->frames());
+        fprintf(out, "redundant writes %.1f %% stored the value already there\n",
+                100.0 * od->redundantShare());
+        fprintf(out, "coverage         %.1f %% of the screen written per frame\n",
+                100.0 * od->distinct() / od->frames() / (d->width() * d->height()));
+        if (od->offscreenWrites()) {
+            fprintf(out, "offscreen        %llu writes outside the visible framebuffer\n",
+                    (unsigned long long)od->offscreenWrites());
+        }
+
+        std::vector<VP_Overdraw::Region> hot(opt.hot);
+        unsigned n = od->hotRegions(d->width(), d->height(), hot.data(), opt.hot);
+        if (n) fprintf(out, "hot regions      writes/frame  overdraw  redundant\n");
+        for (unsigned r = 0; r < n; r++) {
+            char rect[32];
+            snprintf(rect, sizeof(rect), "%ux%u+%u+%u", hot[r].w, hot[r].h, hot[r].x, hot[r].y);
+            fprintf(out, "  %-14s %12.1f %8.2fx %9.1f %%\n", rect, hot[r].writesPerFrame,
+                    hot[r].overdraw, 100.0 * hot[r].redundant);
+        }
+
+        char path[512];
+        imagePath(path, sizeof(path), opt.framesDir ? opt.framesDir : ".", "overdraw", d);
+        if (od->writePPM(path, d->width(), d->height(), opt.zoom)) {
+            fprintf(out, "heatmap          %s\n", path);
+        } else {
+            fprintf(stderr, "virtual papilio: cannot write %s\n", path);
+        }
+    }
+}
+
+static bool anyDirty() {
+    bool dirty = false;
+    for (int i = 0; i < vp::deviceCount(); i++) {
+        dirty |= vp::deviceAt(i)->dirty;
+        vp::deviceAt(i)->dirty = false;
+    }
+    return dirty;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        usage(argv[0]);
+        return 1;
+    }
+    vp::setSerialQuiet(opt.quiet);
+    if (opt.framesDir && !makeDirs(opt.framesDir)) {
+        fprintf(stderr, "virtual papilio: cannot create %s: %s\n", opt.framesDir, strerror(errno));
+        return 1;
+    }
+
+    setup();
+    VP_Stats setupStats = vp::stats;
+    double setupUs = vp::now();
+    anyDirty();
+    if (opt.overdraw) {
+        for (int i = 0; i < vp::deviceCount(); i++) vp::deviceAt(i)->overdraw = new VP_Overdraw();
+    }
+    for (int i = 0; i < vp::deviceCount(); i++) vp::deviceAt(i)->linkErrorRate = opt.linkErrors;
+
+    // Run loop() on the virtual clock, sampling link time per pass
+    uint64_t loops = 0, frames = 0;
+    double frameLinkUs = 0, maxFrameLinkUs = 0;
+    double endUs = setupUs + opt.seconds * 1e6;
+    typedef std::chrono::steady_clock Clock;
+
+    while (opt.loops ? loops < opt.loops : vp::now() < endUs) {
+        if (opt.fpgaReset >= 0 && vp::now() >= setupUs + opt.fpgaReset * 1e6) {
+            fprintf(stderr, "virtual papilio: FPGA reset at %.3f s\n", vp::now() / 1e6);
+            for (int i = 0; i < vp::deviceCount(); i++) vp::deviceAt(i)->reconfigure();
+            opt.fpgaReset = -1.0;
+        }
+        double linkBefore = vp::stats.linkUs;
+        Clock::time_point t0 = Clock::now();
+        loop();
+        if (opt.cpuScale > 0) {
+            std::chrono::duration<double, std::micro> host = Clock::now() - t0;
+            vp::advance(host.count() * opt.cpuScale);
+        }
+        vp::advance(vp::costs.loopOverhead);
+        loops++;
+        for (int i = 0; i < vp::deviceCount(); i++) vp::deviceAt(i)->runBeam(vp::now());
+        for (int i = 0; i < vp::deviceCount(); i++) {
+            if (vp::deviceAt(i)->overdraw) vp::deviceAt(i)->overdraw->endPass();
+        }
+
+        if (anyDirty()) {
+            double link = vp::stats.linkUs - linkBefore;
+            frames++;
+            frameLinkUs += link;
+            if (link > maxFrameLinkUs) maxFrameLinkUs = link;
+            if (opt.dumpEvery && frames % opt.dumpEvery == 0) {
+                char name[32];
+                snprintf(name, sizeof(name), "frame_%06llu", (unsigned long long)frames);
+                dumpFrames(opt, name);
+            }
+        }
+    }
+    dumpFrames(opt, "last");
+    fflush(stdout);
+
+    // Report
+    double runUs = vp::now() - setupUs;
+    double runS = runUs / 1e6;
+    double linkUs = vp::stats.linkUs - setupStats.linkUs;
+    double fps = runS > 0 ? frames / runS : 0;
+    double avgFrameMs = frames ? frameLinkUs / frames / 1000.0 : 0;
+    double ceiling = avgFrameMs > 0 ? 1000.0 / avgFrameMs : 0;
+    uint64_t earlyReads = 0, badCommands = 0, partialFrames = 0, injectedErrors = 0;
+    uint64_t streamLines = 0, streamUnderflows = 0;
+    for (int i = 0; i < vp::deviceCount(); i++) {
+        earlyReads += vp::deviceAt(i)->earlyReads;
+        badCommands += vp::deviceAt(i)->badCommands;
+        partialFrames += vp::deviceAt(i)->partialFrames;
+        injectedErrors += vp::deviceAt(i)->injectedErrors;
+        streamLines += vp::deviceAt(i)->streamLines;
+        streamUnderflows += vp::deviceAt(i)->streamUnderflows;
+    }
+
+    FILE* out = stderr;
+    fprintf(out, "\n=== Virtual Papilio ===\n");
+    fprintf(out, "setup()          %.3f s virtual, %.1f ms on the link\n", setupUs / 1e6,
+            setupStats.linkUs / 1000.0);
+    fprintf(out, "run              %.3f s virtual, %llu loop() calls\n", runS,
+            (unsigned long long)loops);
+    fprintf(out, "frames           %llu\n", (unsigned long long)frames);
+    fprintf(out, "predicted FPS    %.2f\n", fps);
+    fprintf(out, "SPI time/frame   %.3f ms avg, %.3f ms max\n", avgFrameMs, maxFrameLinkUs / 1000.0);
+    fprintf(out, "link ceiling     %.2f FPS\n", ceiling);
+    fprintf(out, "link busy        %.1f %%\n", runUs > 0 ? 100.0 * linkUs / runUs : 0.0);
+    fprintf(out, "bytes            %llu (%llu Wishbone frames, %llu transactions)\n",
+            (unsigned long long)(vp::stats.bytes - setupStats.bytes),
+            (unsigned long long)(vp::stats.wishboneFrames - setupStats.wishboneFrames),
+            (unsigned long long)(vp::stats.transactions - setupStats.transactions));
+    if (earlyReads || badCommands || partialFrames) {
+        fprintf(out, "PROTOCOL         %llu early reads, %llu bad commands, %llu partial frames\n",
+                (unsigned long long)earlyReads, (unsigned long long)badCommands,
+                (unsigned long long)partialFrames);
+    }
+    if (injectedErrors) {
+        fprintf(out, "link errors      %llu write frames corrupted\n",
+                (unsigned long long)injectedErrors);
+    }
+    if (streamLines || streamUnderflows) {
+        fprintf(out, "line stream      %llu lines scanned, %llu underflows (%.1f %%)\n",
+                (unsigned long long)streamLines, (unsigned long long)streamUnderflows,
+                100.0 * streamUnderflows / (streamLines + streamUnderflows));
+    }
+    if (opt.overdraw) reportOverdraw(opt, out);
+
+    // Overdraw summed over all FPGAs, for the JSON report
+    uint64_t pixelWrites = 0, distinct = 0, redundant = 0;
+    for (int i = 0; i < vp::deviceCount(); i++) {
+        const VP_Overdraw* od = vp::deviceAt(i)->overdraw;
+        if (!od) continue;
+        pixelWrites += od->writes();
+        distinct += od->distinct();
+        redundant += od->redundantWrites();
+    }
+
+    if (opt.report) {
+        FILE* f = fopen(opt.report, "w");
+        if (f) {
+            fprintf(f,
+                    "{\n"
+                    "  \"setup_s\": %.6f,\n"
+                    "  \"run_s\": %.6f,\n"
+                    "  \"loops\": %llu,\n"
+                    "  \"frames\": %llu,\n"
+                    "  \"fps\": %.4f,\n"
+                    "  \"spi_ms_per_frame\": %.4f,\n"
+                    "  \"spi_ms_per_frame_max\": %.4f,\n"
+                    "  \"link_ceiling_fps\": %.4f,\n"
+                    "  \"link_busy\": %.4f,\n"
+                    "  \"bytes\": %llu,\n"
+                    "  \"early_reads\": %llu,\n"
+                    "  \"bad_commands\": %llu,\n"
+                    "  \"partial_frames\": %llu",
+                    setupUs / 1e6, runS, (unsigned long long)loops, (unsigned long long)frames,
+                    fps, avgFrameMs, maxFrameLinkUs / 1000.0, ceiling,
+                    runUs > 0 ? linkUs / runUs : 0.0,
+                    (unsigned long long)(vp::stats.bytes - setupStats.bytes),
+                    (unsigned long long)earlyReads, (unsigned long long)badCommands,
+                    (unsigned long long)partialFrames);
+            if (streamLines || streamUnderflows) {
+                fprintf(f, ",\n  \"stream_lines\": %llu,\n  \"stream_underflows\": %llu",
+                        (unsigned long long)streamLines, (unsigned long long)streamUnderflows);
+            }
+            if (opt.overdraw) {
+                fprintf(f, ",\n  \"overdraw\": %.4f,\n  \"redundant_writes\": %.4f",
+                        distinct ? (double)pixelWrites / distinct : 0.0,
+                        pixelWrites ? (double)redundant / pixelWrites : 0.0);
+            }
+            fprintf(f, "\n}\n");
+            fclose(f);
+        } else {
+            fprintf(stderr, "virtual papilio: cannot write %s\n", opt.report);
+        }
+    }
+
+    if (opt.minFps > 0 && fps < opt.minFps) {
+        fprintf(out, "FAIL: %.2f FPS is below the %.2f FPS budget\n", fps, opt.minFps);
+        return 2;
+    }
+    return 0;
+}
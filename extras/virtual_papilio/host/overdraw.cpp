@@ -0,0 +1,135 @@
+/**
+ * @file overdraw.cpp
+ * @brief Virtual Papilio: per-pixel write counting for overdraw profiling
+ */
+
+#include <VirtualPapilio.h>
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+VP_Overdraw::VP_Overdraw()
+    : _pass(new uint16_t[MAX_PIXELS]), _passRedundant(new uint16_t[MAX_PIXELS]),
+      _heatWrites(new uint32_t[MAX_PIXELS]), _heatFrames(new uint32_t[MAX_PIXELS]),
+      _heatRedundant(new uint32_t[MAX_PIXELS]), _touched(new unsigned[MAX_PIXELS]) {
+    memset(_pass, 0, MAX_PIXELS * sizeof(*_pass));
+    memset(_passRedundant, 0, MAX_PIXELS * sizeof(*_passRedundant));
+    reset();
+}
+
+VP_Overdraw::~VP_Overdraw() {
+    delete[] _pass;
+    delete[] _passRedundant;
+    delete[] _heatWrites;
+    delete[] _heatFrames;
+    delete[] _heatRedundant;
+    delete[] _touched;
+}
+
+void VP_Overdraw::record(unsigned pixel, bool redundant) {
+    if (pixel >= MAX_PIXELS) {
+        _passOffscreen++;
+        return;
+    }
+    if (_pass[pixel] == 0) _touched[_touchedCount++] = pixel;
+    if (_pass[pixel] < UINT16_MAX) _pass[pixel]++;
+    if (redundant && _passRedundant[pixel] < UINT16_MAX) _passRedundant[pixel]++;
+}
+
+bool VP_Overdraw::endPass() {
+    _offscreen += _passOffscreen;
+    _passOffscreen = 0;
+    if (!_touchedCount) return false;
+
+    for (unsigned i = 0; i < _touchedCount; i++) {
+        unsigned p = _touched[i];
+        _writes += _pass[p];
+        _redundant += _passRedundant[p];
+        _heatWrites[p] += _pass[p];
+        _heatRedundant[p] += _passRedundant[p];
+        _heatFrames[p]++;
+        _pass[p] = 0;
+        _passRedundant[p] = 0;
+    }
+    _distinct += _touchedCount;
+    _touchedCount = 0;
+    _frames++;
+    return true;
+}
+
+void VP_Overdraw::reset() {
+    // Drop the pass in progress too, so setup() traffic is not counted
+    for (unsigned i = 0; i < _touchedCount; i++) {
+        _pass[_touched[i]] = 0;
+        _passRedundant[_touched[i]] = 0;
+    }
+    memset(_heatWrites, 0, MAX_PIXELS * sizeof(*_heatWrites));
+    memset(_heatFrames, 0, MAX_PIXELS * sizeof(*_heatFrames));
+    memset(_heatRedundant, 0, MAX_PIXELS * sizeof(*_heatRedundant));
+    _touchedCount = 0;
+    _passOffscreen = 0;
+    _frames = _writes = _distinct = _redundant = _offscreen = 0;
+}
+
+unsigned VP_Overdraw::hotRegions(unsigned width, unsigned height, Region* out, unsigned n) const {
+    std::vector<Region> tiles;
+    if (!_frames || width * height > MAX_PIXELS) return 0;
+
+    for (unsigned ty = 0; ty < height; ty += TILE) {
+        for (unsigned tx = 0; tx < width; tx += TILE) {
+            Region r = { tx, ty, std::min(TILE, width - tx), std::min(TILE, height - ty), 0, 0, 0 };
+            uint64_t writes = 0, frames = 0, redundant = 0;
+            for (unsigned y = ty; y < ty + r.h; y++) {
+                for (unsigned x = tx; x < tx + r.w; x++) {
+                    writes += _heatWrites[y * width + x];
+                    frames += _heatFrames[y * width + x];
+                    redundant += _heatRedundant[y * width + x];
+                }
+            }
+            if (!writes) continue;
+            r.writesPerFrame = (double)writes / _frames;
+            r.overdraw = (double)writes / frames;
+            r.redundant = (double)redundant / writes;
+            tiles.push_back(r);
+        }
+    }
+
+    std::sort(tiles.begin(), tiles.end(), [](const Region& a, const Region& b) {
+        return a.writesPerFrame > b.writesPerFrame;
+    });
+    n = std::min<unsigned>(n, tiles.size());
+    std::copy(tiles.begin(), tiles.begin() + n, out);
+    return n;
+}
+
+bool VP_Overdraw::writePPM(const char* path, unsigned width, unsigned height, unsigned zoom) const {
+    static const uint8_t ramp[4][3] = { { 0, 64, 255 }, { 0, 224, 64 }, { 255, 224, 0 }, { 255, 32, 0 } };
+
+    if (width * height > MAX_PIXELS) return false;
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    if (zoom < 1) zoom = 1;
+
+    fprintf(f, "P6\n%u %u\n255\n", width * zoom, height * zoom);
+    std::vector<uint8_t> row(width * zoom * 3);
+    for (unsigned y = 0; y < height; y++) {
+        for (unsigned x = 0; x < width; x++) {
+            unsigned p = y * width + x;
+            uint8_t rgb[3] = { 0, 0, 0 };
+            if (_heatFrames[p]) {
+                // Interpolate the ramp between whole overdraw levels
+                double level = std::min(3.0, (double)_heatWrites[p] / _heatFrames[p] - 1.0);
+                int lo = (int)level, hi = std::min(lo + 1, 3);
+                double t = level - lo;
+                double bright = 0.25 + 0.75 * _heatFrames[p] / _frames;
+                for (int c = 0; c < 3; c++) {
+                    rgb[c] = (uint8_t)(bright * (ramp[lo][c] + t * (ramp[hi][c] - ramp[lo][c])));
+                }
+            }
+            for (unsigned z = 0; z < zoom; z++) memcpy(&row[(x * zoom + z) * 3], rgb, 3);
+        }
+        for (unsigned z = 0; z < zoom; z++) fwrite(row.data(), 3, width * zoom, f);
+    }
+    return fclose(f) == 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file spi.cpp
+ * @brief Virtual Papilio: SPIClass priced by the link-cost model
+ */
+
+#include <SPI.h>
+#include <VirtualPapilio.h>
+
+SPIClass SPI(FSPI);
+
+// The ESP32 SPI peripheral moves at most this much per FIFO load
+static const uint32_t FIFO_BYTES = 64;
+
+SPIClass::SPIClass(uint8_t spi_bus)
+    : _busNum(spi_bus), _ss(-1), _hwCs(false), _clockHz(1000000) {}
+
+bool SPIClass::begin(int8_t sck, int8_t miso, int8_t mosi, int8_t ss) {
+    _ss = ss;
+    // Whatever is on this bus's SS pin is a Papilio
+    if (ss >= 0) vp::attach(ss);
+    return true;
+}
+
+void SPIClass::end() { _hwCs = false; }
+
+void SPIClass::setHwCs(bool use) {
+    vp::charge(vp::costs.setHwCs);
+    _hwCs = use;
+}
+
+void SPIClass::setFrequency(uint32_t freq) {
+    // The clock is APB divided by an integer, rounded down to what fits
+    uint32_t apb = vp::costs.apbHz;
+    uint32_t div = freq >= apb ? 1 : (apb + freq - 1) / freq;
+    _clockHz = apb / div;
+}
+
+void SPIClass::beginTransaction(SPISettings settings) {
+    uint32_t old = _clockHz;
+    setFrequency(settings._clock);
+    vp::charge(vp::costs.beginTransaction);
+    if (_clockHz != old) vp::charge(vp::costs.clockChange);
+    vp::stats.transactions++;
+}
+
+void SPIClass::endTransaction() {
+    vp::charge(vp::costs.endTransaction);
+}
+
+uint8_t SPIClass::shift(uint8_t out) {
+    // Every attached FPGA whose CS is low sees the byte; the last answer wins
+    uint8_t in = 0x00;
+    double t = vp::now();
+    for (int i = 0; i < vp::deviceCount(); i++) {
+        VP_FPGA* d = vp::deviceAt(i);
+        if (vp::pinLevel(d->csPin()) == LOW) in = d->shift(out, t);
+    }
+    vp::charge(8.0e6 / _clockHz);
+    vp::stats.bytes++;
+    return in;
+}
+
+void SPIClass::shiftBlock(const uint8_t* data, uint8_t* in, uint32_t size) {
+    // Hardware CS frames each FIFO load separately, as the ESP32 driver does
+    VP_FPGA* hw = _hwCs ? vp::device(_ss) : nullptr;
+    vp::charge(vp::costs.writeBytesCall);
+
+    for (uint32_t done = 0; done < size; done += FIFO_BYTES) {
+        uint32_t n = size - done < FIFO_BYTES ? size - done : FIFO_BYTES;
+        if (done) vp::charge(vp::costs.fifoRefill);
+        if (hw) hw->select(true);
+        for (uint32_t i = 0; i < n; i++) {
+            uint8_t out = data ? data[done + i] : 0xFF;
+            uint8_t b;
+            if (hw && vp::pinLevel(_ss) != LOW) {
+                b = hw->shift(out, vp::now());
+                vp::charge(8.0e6 / _clockHz);
+                vp::stats.bytes++;
+            } else {
+                b = shift(out);
+            }
+            if (in) in[done + i] = b;
+        }
+        if (hw) hw->select(false);
+    }
+}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+    vp::charge(vp::costs.transferCall);
+    return shift(data);
+}
+
+uint16_t SPIClass::transfer16(uint16_t data) {
+    vp::charge(vp::costs.transferCall);
+    uint16_t hi = shift(data >> 8);
+    return (hi << 8) | shift(data & 0xFF);
+}
+
+uint32_t SPIClass::transfer32(uint32_t data) {
+    uint8_t out[4] = { (uint8_t)(data >> 24), (uint8_t)(data >> 16), (uint8_t)(data >> 8),
+                       (uint8_t)data };
+    uint8_t in[4];
+    vp::charge(vp::costs.transferCall);
+    for (int i = 0; i < 4; i++) in[i] = shift(out[i]);
+    return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | in[3];
+}
+
+void SPIClass::transfer(void* data, uint32_t size) {
+    shiftBlock((const uint8_t*)data, (uint8_t*)data, size);
+}
+
+void SPIClass::transferBytes(const uint8_t* data, uint8_t* out, uint32_t size) {
+    shiftBlock(data, out, size);
+}
+
+void SPIClass::write(uint8_t data) { transfer(data); }
+
+void SPIClass::write16(uint16_t data) { transfer16(data); }
+
+void SPIClass::write32(uint32_t data) { transfer32(data); }
+
+void SPIClass::writeBytes(const uint8_t* data, uint32_t size) { shiftBlock(data, nullptr, size); }
+
+void SPIClass::writePixels(const void* data, uint32_t size) {
+    shiftBlock((const uint8_t*)data, nullptr, size);
+}
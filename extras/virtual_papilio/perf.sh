@@ -0,0 +1,128 @@
+#!/usr/bin/env bash
+# Automated performance run: build each sketch for the Virtual Papilio, run
+# it for a fixed stretch of virtual time and tabulate predicted FPS and SPI
+# time per frame. Reports and last frames go to build/<sketch>/.
+#
+#   extras/virtual_papilio/perf.sh                  # the default set
+#   extras/virtual_papilio/perf.sh bricks_hqvga     # any examples/ sketch
+#
+# A budget ("sketch:min_fps" in VP_BUDGETS, space separated) turns a slow
+# run into a failure, e.g. VP_BUDGETS="spaceinvaders_hqvga:9 gfx_demo:5".
+# Sketches whose libraries are not in VP_LIBS are skipped, not failed.
+#
+# Self-checking sketches (VP_CHECKS, default kernel_benchmark) run first,
+# once per kernel build (host SIMD and HQVGA_KERNELS_SWAR), and fail the
+# run unless they print a line starting with PASS. VP_CHECKS="" skips them.
+# The gateware testbenches (gateware/sim/run.sh) run with them and are
+# reported as skipped when Icarus Verilog is not installed; VP_SIM=0 skips
+# them outright.
+#
+# Environment: VP_LIBS (see build.sh), VP_SECONDS (default 20),
+#              VP_COSTS (cost file from virtual_papilio_calibrate),
+#              VP_CHECKS, VP_SIM
+
+set -o pipefail
+
+VP_DIR=$(cd "$(dirname "$0")" && pwd)
+REPO=$(cd "$VP_DIR/../.." && pwd)
+SECONDS_RUN=${VP_SECONDS:-20}
+
+if [ $# -gt 0 ]; then
+    SKETCHES=("$@")
+else
+    SKETCHES=(spaceinvaders_hqvga gfx_demo lvgl_demo)
+fi
+
+budget_for() {
+    local entry
+    for entry in ${VP_BUDGETS:-}; do
+        [ "${entry%%:*}" = "$1" ] && echo "${entry#*:}" && return
+    done
+    echo 0
+}
+
+# Pull one number out of the runner's JSON report
+field() {
+    sed -n "s/.*\"$2\": \([0-9.]*\).*/\1/p" "$1"
+}
+
+read -r -a CHECKS <<< "${VP_CHECKS-kernel_benchmark}"
+
+status=0
+rows=()
+if [ "${VP_SIM:-1}" != 0 ]; then
+    mkdir -p "$VP_DIR/build"
+    SIM_OUT="$VP_DIR/build/sim" "$REPO/gateware/sim/run.sh" > "$VP_DIR/build/sim.log" 2>&1
+    case $? in
+        0)  rows+=("$(printf '%-24s %s' "gateware sim" "check passed")") ;;
+        77) rows+=("$(printf '%-24s %s' "gateware sim" "skipped: iverilog not found")") ;;
+        *)  rows+=("$(printf '%-24s %s' "gateware sim" "CHECK FAILED, see $VP_DIR/build/sim.log")")
+            status=1 ;;
+    esac
+fi
+
+for name in "${CHECKS[@]}"; do
+    for flags in "" "-DHQVGA_KERNELS_SWAR"; do
+        label="$name${flags:+ ${flags#-D}}"
+        out="$VP_DIR/build/$name"
+        mkdir -p "$out"
+
+        if ! VP_CFLAGS="${VP_CFLAGS:-} $flags" "$VP_DIR/build.sh" "$REPO/examples/$name" \
+                > "$out/build.log" 2>&1; then
+            rows+=("$(printf '%-24s %s' "$label" "BUILD FAILED, see $out/build.log")")
+            status=1
+            continue
+        fi
+        if "$out/$name" --loops 1 > "$out/check.log" 2>&1 && grep -q '^PASS' "$out/check.log"; then
+            rows+=("$(printf '%-24s %s' "$label" "check passed")")
+        else
+            rows+=("$(printf '%-24s %s' "$label" "CHECK FAILED, see $out/check.log")")
+            status=1
+        fi
+    done
+done
+
+for name in "${SKETCHES[@]}"; do
+    out="$VP_DIR/build/$name"
+    mkdir -p "$out"
+
+    if ! "$VP_DIR/build.sh" "$REPO/examples/$name" > "$out/build.log" 2>&1; then
+        if grep -q "No such file or directory" "$out/build.log"; then
+            rows+=("$(printf '%-24s %s' "$name" "skipped: $(grep -o '[A-Za-z0-9_./]*\.h: No such file' "$out/build.log" | head -1)")")
+        else
+            rows+=("$(printf '%-24s %s' "$name" "BUILD FAILED, see $out/build.log")")
+            status=1
+        fi
+        continue
+    fi
+
+    args=(--seconds "$SECONDS_RUN" --quiet --frames "$out" --report "$out/report.json"
+          --min-fps "$(budget_for "$name")")
+    [ -n "${VP_COSTS:-}" ] && args+=(--costs "$VP_COSTS")
+
+    "$out/$name" "${args[@]}" > "$out/run.log" 2>&1
+    rc=$?
+    if [ $rc -ne 0 ] && [ $rc -ne 2 ]; then
+        rows+=("$(printf '%-24s %s' "$name" "RUN FAILED ($rc), see $out/run.log")")
+        status=1
+        continue
+    fi
+
+    r="$out/report.json"
+    line=$(printf '%-24s %8.2f %10.3f %10.3f %10.2f' "$name" "$(field "$r" fps)" \
+           "$(field "$r" spi_ms_per_frame)" "$(field "$r" spi_ms_per_frame_max)" \
+           "$(field "$r" link_ceiling_fps)")
+    if [ $rc -eq 2 ]; then
+        line="$line  below budget $(budget_for "$name") FPS"
+        status=1
+    fi
+    if grep -q PROTOCOL "$out/run.log"; then
+        line="$line  $(grep PROTOCOL "$out/run.log" | sed 's/^PROTOCOL *//')"
+        status=1
+    fi
+    rows+=("$line")
+done
+
+printf '%-24s %8s %10s %10s %10s\n' sketch FPS "SPI ms" "max ms" ceiling
+printf '%s\n' "${rows[@]}"
+exit $status
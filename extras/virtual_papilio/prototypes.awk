@@ -0,0 +1,96 @@
+# Turn an .ino into C++ the way the Arduino IDE does: emit a prototype for
+# every top-level function just before the first function definition, so
+# functions can be called before they are defined. Run over the file twice:
+#
+#   awk -v file=sketch.ino -f prototypes.awk sketch.ino sketch.ino
+#
+# Functions with default arguments get no prototype (the definition's
+# defaults would then be a redefinition), which matches the IDE.
+
+# Strip comments and string/char literals so braces inside them don't count
+function code_of(line,    out, i, c, n, q) {
+    out = ""
+    n = length(line)
+    for (i = 1; i <= n; i++) {
+        c = substr(line, i, 1)
+        if (in_block) {
+            if (c == "*" && substr(line, i + 1, 1) == "/") { in_block = 0; i++ }
+            continue
+        }
+        if (c == "/" && substr(line, i + 1, 1) == "/") break
+        if (c == "/" && substr(line, i + 1, 1) == "*") { in_block = 1; i++; continue }
+        if (c == "\"" || c == "'") {
+            q = c
+            out = out q
+            for (i++; i <= n; i++) {
+                c = substr(line, i, 1)
+                if (c == "\\") { i++; continue }
+                if (c == q) break
+            }
+            out = out q
+            continue
+        }
+        out = out c
+    }
+    return out
+}
+
+function count(s, ch,    t) {
+    t = s
+    return gsub(ch, "", t)
+}
+
+function is_header(code,    first) {
+    if (code !~ /^[A-Za-z_][A-Za-z0-9_:<>*&, \t]*[ \t*&][A-Za-z_][A-Za-z0-9_]*[ \t]*\([^;]*\)[ \t]*(const)?[ \t]*\{?[ \t]*$/)
+        return 0
+    first = code
+    sub(/[ \t(].*/, "", first)
+    if (first ~ /^(if|else|for|while|switch|return|do|case|typedef|struct|class|enum|union|using|namespace|template|new|delete)$/)
+        return 0
+    return 1
+}
+
+# Pass 1: find top-level definitions
+NR == FNR {
+    code = code_of($0)
+    if (depth == 0 && pending != "") {
+        if (code ~ /^[ \t]*\{/) {
+            protos[nprotos++] = pending
+            if (!first_def) first_def = pending_line
+        }
+        if (code !~ /^[ \t]*$/) pending = ""
+    }
+    if (depth == 0 && is_header(code)) {
+        header = code
+        sub(/[ \t]*\{?[ \t]*$/, "", header)
+        params = header
+        sub(/^[^(]*\(/, "", params)
+        if (params !~ /=/) {
+            if (code ~ /\{[ \t]*$/) {
+                protos[nprotos++] = header ";"
+                if (!first_def) first_def = FNR
+            } else {
+                pending = header ";"
+                pending_line = FNR
+            }
+        }
+    }
+    depth += count(code, "\\{") - count(code, "\\}")
+    next
+}
+
+# Pass 2: copy the file, inserting the prototypes
+FNR == 1 {
+    printf "#line 1 \"%s\"\n", file
+}
+
+{
+    if (FNR == first_def && nprotos) {
+        for (i = 0; i < nprotos; i++) {
+            if (protos[i] !~ /^(void|int)[ \t]+(setup|loop)[ \t]*\(/)
+                print protos[i]
+        }
+        printf "#line %d \"%s\"\n", FNR, file
+    }
+    print
+}
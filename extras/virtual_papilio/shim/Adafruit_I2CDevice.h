@@ -0,0 +1,7 @@
+/**
+ * @file Adafruit_I2CDevice.h
+ * @brief Virtual Papilio: empty stand-in for the Adafruit BusIO header
+ *
+ * Adafruit_GFX.h includes it for the SPI/I2C display drivers, which the
+ * host build does not compile; HQVGA_GFX only needs the core GFX class.
+ */
@@ -0,0 +1,148 @@
+/**
+ * @file Arduino.h
+ * @brief Virtual Papilio: the slice of the Arduino-ESP32 core the library
+ *        and examples use, running on a virtual clock
+ *
+ * Time only moves when the sketch spends it: delay(), delayMicroseconds(),
+ * SPI traffic (priced by the link-cost model in VirtualPapilio.h) and a
+ * small fixed cost per millis()/micros() call so polling loops terminate.
+ *
+ * The C part is safe to include from C, which LVGL does through
+ * LV_TICK_CUSTOM_INCLUDE.
+ */
+
+#ifndef VIRTUAL_PAPILIO_ARDUINO_H
+#define VIRTUAL_PAPILIO_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <inttypes.h>
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+#define PI 3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define PROGMEM
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+#define SERIAL_8N1 0x800001c
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef unsigned int word;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield(void);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+
+void* heap_caps_malloc(size_t size, uint32_t caps);
+void* heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps);
+void heap_caps_free(void* ptr);
+void* ps_malloc(size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+
+#include <algorithm>
+#include <cmath>
+
+#include "pgmspace.h"
+#include "WString.h"
+#include "Print.h"
+#include "freertos_shim.h"
+
+using std::abs;
+using std::max;
+using std::min;
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+/**
+ * @brief Serial port: TX goes to stdout, RX is fed from --serial-input
+ */
+class HardwareSerial : public Print {
+public:
+    explicit HardwareSerial(int port) : _port(port) {}
+
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1,
+               int8_t txPin = -1) {}
+    void end() {}
+
+    int available();
+    int read();
+    int peek();
+    void flush() { fflush(stdout); }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    operator bool() const { return true; }
+
+private:
+    int _port;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+
+/**
+ * @brief ESP object: cycle counter on the virtual clock at 240 MHz
+ */
+class EspClass {
+public:
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getFreeHeap() { return 320 * 1024; }
+    uint32_t getFreePsram() { return 8 * 1024 * 1024; }
+    void restart() { exit(0); }
+};
+
+extern EspClass ESP;
+
+inline uint32_t getCpuFrequencyMhz() { return 240; }
+
+// Sketch entry points (the runner in host/main.cpp calls these)
+void setup();
+void loop();
+
+#endif // __cplusplus
+
+#endif // VIRTUAL_PAPILIO_ARDUINO_H
@@ -0,0 +1,91 @@
+/**
+ * @file SPI.h
+ * @brief Virtual Papilio: Arduino-ESP32 SPIClass wired to the FPGA model
+ *
+ * Every call is charged to the virtual clock by the link-cost model, and
+ * the bytes go to whichever virtual FPGA has its CS asserted: the GPIO
+ * level of the pin named as SS in begin(), or the peripheral itself while
+ * setHwCs(true) is in effect (one assertion per 64-byte FIFO load, as the
+ * ESP32 driver does).
+ */
+
+#ifndef VIRTUAL_PAPILIO_SPI_H
+#define VIRTUAL_PAPILIO_SPI_H
+
+#include "Arduino.h"
+
+#define SPI_MODE0 0
+#define SPI_MODE1 1
+#define SPI_MODE2 2
+#define SPI_MODE3 3
+
+#define SPI_LSBFIRST 0
+#define SPI_MSBFIRST 1
+#ifndef LSBFIRST
+#define LSBFIRST SPI_LSBFIRST
+#define MSBFIRST SPI_MSBFIRST
+#endif
+
+#define FSPI 0
+#define HSPI 1
+
+struct spi_t;
+
+class SPISettings {
+public:
+    SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = SPI_MSBFIRST,
+                uint8_t dataMode = SPI_MODE0)
+        : _clock(clock), _bitOrder(bitOrder), _dataMode(dataMode) {}
+
+    uint32_t _clock;
+    uint8_t _bitOrder;
+    uint8_t _dataMode;
+};
+
+class SPIClass {
+public:
+    explicit SPIClass(uint8_t spi_bus = HSPI);
+
+    bool begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1);
+    void end();
+
+    void setHwCs(bool use);
+    void setFrequency(uint32_t freq);
+    void setDataMode(uint8_t dataMode) {}
+    void setBitOrder(uint8_t bitOrder) {}
+
+    void beginTransaction(SPISettings settings);
+    void endTransaction();
+
+    uint8_t transfer(uint8_t data);
+    uint16_t transfer16(uint16_t data);
+    uint32_t transfer32(uint32_t data);
+    void transfer(void* data, uint32_t size);
+    void transferBytes(const uint8_t* data, uint8_t* out, uint32_t size);
+
+    void write(uint8_t data);
+    void write16(uint16_t data);
+    void write32(uint32_t data);
+    void writeBytes(const uint8_t* data, uint32_t size);
+    void writePixels(const void* data, uint32_t size);
+
+    int8_t pinSS() const { return _ss; }
+    spi_t* bus() { return nullptr; }
+
+    // Model state (read by the runner's report)
+    uint32_t clockHz() const { return _clockHz; }
+    bool hwCs() const { return _hwCs; }
+
+private:
+    uint8_t shift(uint8_t out);
+    void shiftBlock(const uint8_t* data, uint8_t* in, uint32_t size);
+
+    uint8_t _busNum;
+    int8_t _ss;
+    bool _hwCs;
+    uint32_t _clockHz;
+};
+
+extern SPIClass SPI;
+
+#endif // VIRTUAL_PAPILIO_SPI_H
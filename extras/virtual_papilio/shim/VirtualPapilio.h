@@ -0,0 +1,292 @@
+/**
+ * @file VirtualPapilio.h
+ * @brief Virtual Papilio: FPGA model, link-cost model and virtual clock
+ *
+ * The host backend runs the unmodified library and sketches on Linux. SPI
+ * traffic is decoded by VP_FPGA, a software model of video_top_modular's
+ * Wishbone register map and VRAM, and every Arduino call that touches the
+ * link is charged to a virtual clock using VP_LinkCosts. The runner
+ * (host/main.cpp) turns that into predicted on-device frame rates.
+ *
+ * Sketches can include this header (guarded by VIRTUAL_PAPILIO, which the
+ * build script defines) to inspect the model, e.g. in a host-only check.
+ */
+
+#ifndef VIRTUAL_PAPILIO_H
+#define VIRTUAL_PAPILIO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief What each link operation costs on the board, in microseconds
+ *
+ * The defaults are estimates for Arduino-ESP32 2.x on an ESP32-S3 at
+ * 240 MHz. Run examples/virtual_papilio_calibrate on real hardware and pass
+ * its output to the runner with --costs to replace them with measurements.
+ */
+struct VP_LinkCosts {
+    double beginTransaction = 1.2;  // bus lock + SPI register setup
+    double clockChange = 6.0;       // extra when the clock differs from the last transaction
+    double endTransaction = 0.4;
+    double digitalWrite = 0.3;
+    double transferCall = 1.1;      // one transfer()/write() call, excluding its clocks
+    double writeBytesCall = 1.6;    // one writeBytes() call, excluding its clocks
+    double fifoRefill = 0.6;        // each further 64-byte FIFO load in writeBytes()
+    double setHwCs = 0.8;
+    double delayOverhead = 0.1;     // added to every delayMicroseconds()
+    double timeRead = 0.1;          // one millis()/micros() call
+    double loopOverhead = 1.0;      // one pass of the Arduino loop task
+    uint32_t apbHz = 80000000;      // SPI clock source, divided down to the requested clock
+
+    // "name value" lines, '#' comments; unknown names are reported
+    bool load(const char* path);
+    void print(FILE* out) const;
+};
+
+/**
+ * @brief Totals the runner samples around setup() and each loop()
+ */
+struct VP_Stats {
+    double linkUs = 0;            // time the CPU spent driving the link
+    uint64_t bytes = 0;           // bytes clocked out
+    uint64_t transactions = 0;    // beginTransaction() calls
+    uint64_t wishboneFrames = 0;  // CMD|ADDR|ADDR|DATA frames decoded (all devices)
+    uint64_t vramWrites = 0;
+    uint64_t regWrites = 0;
+    uint64_t reads = 0;
+};
+
+/**
+ * @brief Write profiler: counts framebuffer writes per pixel per frame
+ *
+ * Enabled with --overdraw. Every VRAM write is attributed to the pixels
+ * its nibble enables cover, and at the end of each loop() pass that wrote
+ * VRAM the pass is folded into per-pixel totals. From those the runner
+ * reports the overdraw ratio (pixel writes per distinct pixel written),
+ * the share of writes that stored the value already there, the hottest
+ * tiles, and a heatmap image.
+ */
+class VP_Overdraw {
+public:
+    // Tile size for the hot-region ranking
+    static const unsigned TILE = 16;
+
+    struct Region {
+        unsigned x, y, w, h;
+        double writesPerFrame;  // pixel writes per profiled frame
+        double overdraw;        // writes per distinct pixel written
+        double redundant;       // share of writes that changed nothing
+    };
+
+    VP_Overdraw();
+    ~VP_Overdraw();
+
+    void record(unsigned pixel, bool redundant);
+    // Fold the current pass into the totals; returns false if it wrote nothing
+    bool endPass();
+    void reset();
+
+    uint64_t frames() const { return _frames; }
+    uint64_t writes() const { return _writes; }
+    uint64_t distinct() const { return _distinct; }
+    uint64_t redundantWrites() const { return _redundant; }
+    uint64_t offscreenWrites() const { return _offscreen; }
+    double overdraw() const { return _distinct ? (double)_writes / _distinct : 0.0; }
+    double redundantShare() const { return _writes ? (double)_redundant / _writes : 0.0; }
+
+    // The n hottest TILE x TILE regions of a width x height screen
+    unsigned hotRegions(unsigned width, unsigned height, Region* out, unsigned n) const;
+
+    // Heatmap: hue from overdraw (blue 1x, green 2x, yellow 3x, red 4x+),
+    // brightness from how often the pixel was written; never written is black
+    bool writePPM(const char* path, unsigned width, unsigned height, unsigned zoom = 1) const;
+
+    // Pixel indices beyond this are counted as offscreen
+    static const unsigned MAX_PIXELS = 32512 * 2;
+
+private:
+    friend class VP_FPGA;
+
+    uint16_t* _pass;          // writes in the current pass
+    uint16_t* _passRedundant; // same-value writes in the current pass
+    uint32_t* _heatWrites;    // totals over all profiled frames
+    uint32_t* _heatFrames;    // frames in which the pixel was written
+    uint32_t* _heatRedundant;
+    unsigned* _touched;       // pixels written in the current pass
+    unsigned _touchedCount;
+    uint64_t _passOffscreen;
+
+    uint64_t _frames, _writes, _distinct, _redundant, _offscreen;
+};
+
+/**
+ * @brief One FPGA on the far end of a CS pin
+ *
+ * Decodes CMD | ADDR_HIGH | ADDR_LOW | DATA frames and re-arms for a new
+ * CMD after each DATA byte. Register behaviour follows video_top_modular.v
+ * and wb_video_framebuffer.v, including their limits: a read's DATA byte
+ * clocked out less than minReadGapUs after its address (one scanline for
+ * VRAM, which waits for a free read-port clock) returns 0xFF and is
+ * counted, since the Wishbone cycle would not have finished.
+ *
+ * The line stream ring is modelled against a beam derived from the virtual
+ * clock and the timing preset, so lines that arrive late underflow just as
+ * they would on the board. Clock-domain crossing latency is not modelled.
+ */
+class VP_FPGA {
+public:
+    explicit VP_FPGA(int csPin);
+
+    int csPin() const { return _csPin; }
+
+    void select(bool asserted);
+    uint8_t shift(uint8_t mosi, double nowUs);
+
+    // FPGA reset / bitstream reload: registers and VRAM to power-on
+    void reconfigure();
+
+    // Register/VRAM state
+    uint8_t videoMode() const { return _videoMode; }
+    unsigned width() const { return _width; }
+    unsigned height() const { return _height; }
+    uint8_t format() const { return _format; }
+    const uint8_t* vram() const { return _vram; }
+    uint8_t pixel(unsigned x, unsigned y) const;  // RGB332, palette applied
+
+    // CRC32 of the active picture, as frame_crc.v computes it (0 outside
+    // framebuffer mode, which is not rendered)
+    uint32_t frameCrc() const;
+
+    // Framebuffer as binary PPM, each pixel zoom x zoom
+    bool writePPM(const char* path, unsigned zoom = 1) const;
+
+    // Advance the beam to nowUs, scanning any line stream lines it passes
+    void runBeam(double nowUs);
+    bool streaming() const { return _lsActive; }
+
+    // Set by any write that changes what is on screen
+    bool dirty;
+
+    // Protocol health
+    uint64_t earlyReads;     // DATA byte inside the read latency
+    uint64_t badCommands;    // CMD byte other than 0x00/0x01
+    uint64_t partialFrames;  // CS released mid-frame
+    uint64_t injectedErrors; // write DATA bytes corrupted by linkErrorRate
+
+    // Line stream totals (not cleared by the host)
+    uint64_t streamLines;      // source lines scanned from a buffer
+    uint64_t streamUnderflows; // source lines scanned with no buffer
+
+    double minReadGapUs;
+
+    // Share of write frames whose DATA byte gets one bit flipped on the way
+    // in, to exercise the link check (0 = clean link)
+    double linkErrorRate;
+
+    // Write profiler, nullptr unless profiling
+    VP_Overdraw* overdraw;
+
+private:
+    void profile(unsigned offset, uint8_t enables, uint8_t before, uint8_t after);
+    double vramReadUs() const;
+    void write(uint16_t addr, uint8_t data);
+    void writeVram(unsigned offset, uint8_t data);
+    uint8_t read(uint16_t addr) const;
+    void resolution(unsigned& h, unsigned& v) const;
+    void beamLine(unsigned v);
+    void streamRetire();
+    bool dualPlayfield() const;
+    uint8_t layerPixel(unsigned x, unsigned y) const;
+    uint8_t affinePixel(unsigned x, unsigned y) const;
+
+    int _csPin;
+    bool _selected;
+    uint8_t _state;
+    uint8_t _cmd;
+    uint16_t _addr;
+    double _addrDoneUs;
+
+    uint8_t _videoMode, _timing;
+    unsigned _width, _height;
+    uint8_t _format, _scale, _border, _wmask;
+    unsigned _viewX, _viewY;
+    uint8_t _palette[16];
+    uint8_t _vram[32512];
+
+    // Line stream: host-side registers, ring, and what was scanned
+    bool _lsEnable, _lsActive, _lsLineOk;
+    uint8_t _lsWrSlot, _lsRdSlot, _lsPending;
+    unsigned _lsNext, _lsUnder;
+    uint64_t _beamLine;  // output lines since power-on
+    uint8_t _lsRing[4][512];
+    uint8_t _lsScreen[511][512];
+    bool _lsBlank[511];
+
+    // Dual playfield: LAYER_CTRL, then CTRL and scroll bytes of each layer
+    uint8_t _layerCtrl;
+    uint8_t _layerRegs[10];
+    uint8_t _palette1[16];
+
+    // Affine scanout: AFF_CTRL, U0 V0 DUDX DVDX DUDY DVDY and the line table
+    uint8_t _affCtrl;
+    int32_t _affParams[6];
+    uint8_t _affTable[2048];
+
+    // Write window: base, width in bytes, height, and the pointer
+    unsigned _winBase, _winW, _winH;
+    unsigned _winRow, _winCol, _winLine;
+
+    // Raster op applied to VRAM writes, and its colour key
+    uint8_t _rop, _ropKey;
+
+    // STATE_CTRL.HOLD; frames are drawn whole here, so a release latches
+    // at once and PENDING always reads 0
+    uint8_t _hold;
+
+    // Upper frame CRC bytes, snapshotted by a read of the low byte
+    mutable uint32_t _crcSnap;
+
+    // Boot register: mode at reset; the model has no splash
+    uint8_t _bootMode;
+
+    // Epoch register: host token, cleared by reconfigure()
+    uint8_t _epoch;
+
+    // Link check: running CRC-16, expected low byte, [1] compared /
+    // [0] mismatch, counters; and the fault injector's PRNG state
+    uint16_t _linkCrc;
+    uint8_t _linkExpLo, _linkStatus;
+    uint16_t _linkErrors, _linkChecks;
+    uint32_t _faultSeed;
+};
+
+namespace vp {
+
+extern VP_LinkCosts costs;
+extern VP_Stats stats;
+
+// Virtual time since power-on
+double now();
+void advance(double us);
+// advance() that also counts as link time
+void charge(double us);
+
+// Device lookup for a CS pin (nullptr if nothing is attached there)
+VP_FPGA* device(int csPin);
+VP_FPGA* attach(int csPin);
+int deviceCount();
+VP_FPGA* deviceAt(int index);
+
+// Level of a GPIO as last written (pins idle high)
+int pinLevel(int pin);
+
+// Bytes the sketch will read back from Serial.available()/read()
+void setSerialInput(const char* text);
+// Silence sketch Serial output (the runner's own report still prints)
+void setSerialQuiet(bool quiet);
+
+} // namespace vp
+
+#endif // VIRTUAL_PAPILIO_H
@@ -0,0 +1,74 @@
+/**
+ * @file WString.h
+ * @brief Virtual Papilio: Arduino String on top of std::string
+ */
+
+#ifndef VIRTUAL_PAPILIO_WSTRING_H
+#define VIRTUAL_PAPILIO_WSTRING_H
+
+#include <string>
+#include <stdio.h>
+
+class String {
+public:
+    String(const char* s = "") : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    explicit String(char c) : _s(1, c) {}
+    explicit String(int v, unsigned char base = 10) : _s(format(v, base)) {}
+    explicit String(unsigned v, unsigned char base = 10) : _s(format((long)v, base)) {}
+    explicit String(long v, unsigned char base = 10) : _s(format(v, base)) {}
+    explicit String(unsigned long v, unsigned char base = 10) : _s(format((long)v, base)) {}
+    explicit String(double v, unsigned char decimals = 2) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+        _s = buf;
+    }
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned length() const { return _s.length(); }
+    char charAt(unsigned i) const { return i < _s.length() ? _s[i] : 0; }
+    char operator[](unsigned i) const { return charAt(i); }
+    int indexOf(char c, unsigned from = 0) const {
+        size_t p = _s.find(c, from);
+        return p == std::string::npos ? -1 : (int)p;
+    }
+    String substring(unsigned from, unsigned to = 0xFFFFFFFF) const {
+        if (from > _s.length()) return String();
+        return String(_s.substr(from, to > from ? to - from : 0));
+    }
+    long toInt() const { return atol(_s.c_str()); }
+    float toFloat() const { return atof(_s.c_str()); }
+
+    String& operator+=(const String& o) { _s += o._s; return *this; }
+    String& operator+=(const char* o) { _s += o; return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+    String& operator+=(int v) { _s += format(v, 10); return *this; }
+    friend String operator+(String a, const String& b) { return a += b; }
+    friend String operator+(String a, const char* b) { return a += b; }
+    friend String operator+(String a, char b) { return a += b; }
+    friend String operator+(String a, int b) { return a += b; }
+    bool operator==(const String& o) const { return _s == o._s; }
+    bool operator==(const char* o) const { return _s == o; }
+    bool operator!=(const String& o) const { return _s != o._s; }
+
+private:
+    static std::string format(long v, unsigned char base) {
+        char buf[66];
+        if (base == 10) {
+            snprintf(buf, sizeof(buf), "%ld", v);
+        } else if (base == 16) {
+            snprintf(buf, sizeof(buf), "%lx", v);
+        } else {
+            unsigned long u = v;
+            int i = sizeof(buf) - 1;
+            buf[i] = 0;
+            do { buf[--i] = "0123456789abcdefghijklmnopqrstuvwxyz"[u % base]; u /= base; } while (u);
+            return std::string(buf + i);
+        }
+        return std::string(buf);
+    }
+
+    std::string _s;
+};
+
+#endif // VIRTUAL_PAPILIO_WSTRING_H
@@ -0,0 +1,61 @@
+/**
+ * @file freertos_shim.h
+ * @brief Virtual Papilio: the FreeRTOS calls the library makes, single-core
+ *
+ * The virtual board has one thread, so task creation always fails and
+ * callers take their inline fallback (HQVGA_MultiDisplay does). Semaphores
+ * are plain counters.
+ */
+
+#ifndef VIRTUAL_PAPILIO_FREERTOS_SHIM_H
+#define VIRTUAL_PAPILIO_FREERTOS_SHIM_H
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void (*TaskFunction_t)(void*);
+typedef void* TaskHandle_t;
+
+struct VP_Semaphore {
+    UBaseType_t count;
+    UBaseType_t max;
+};
+typedef VP_Semaphore* SemaphoreHandle_t;
+
+#define pdPASS  1
+#define pdFAIL  0
+#define pdTRUE  1
+#define pdFALSE 0
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*,
+                                          UBaseType_t, TaskHandle_t*, BaseType_t) {
+    return pdFAIL;
+}
+inline void vTaskDelete(TaskHandle_t) {}
+inline UBaseType_t uxTaskPriorityGet(TaskHandle_t) { return 1; }
+void vTaskDelay(TickType_t ticks);
+
+inline SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) {
+    return new VP_Semaphore{initial, max};
+}
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return xSemaphoreCreateCounting(1, 1); }
+inline void vSemaphoreDelete(SemaphoreHandle_t s) { delete s; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+    if (s->count >= s->max) return pdFALSE;
+    s->count++;
+    return pdTRUE;
+}
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t) {
+    // Nothing else can run to give it, so an empty semaphore never fills
+    if (!s->count) return pdFALSE;
+    s->count--;
+    return pdTRUE;
+}
+
+#endif // VIRTUAL_PAPILIO_FREERTOS_SHIM_H
@@ -0,0 +1,30 @@
+/**
+ * @file pgmspace.h
+ * @brief Virtual Papilio: flash and RAM share one address space, as on ESP32
+ */
+
+#ifndef VIRTUAL_PAPILIO_PGMSPACE_H
+#define VIRTUAL_PAPILIO_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define F(s) (s)
+
+#define pgm_read_byte(addr)    (*(const uint8_t*)(addr))
+#define pgm_read_word(addr)    (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr)   (*(const uint32_t*)(addr))
+#define pgm_read_float(addr)   (*(const float*)(addr))
+#define pgm_read_ptr(addr)     (*(void* const*)(addr))
+#define pgm_read_pointer(addr) (*(void* const*)(addr))
+
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcpy_P strcpy
+
+#endif // VIRTUAL_PAPILIO_PGMSPACE_H
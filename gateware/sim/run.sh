@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+# Compile and run the self-checking testbenches in this directory with
+# Icarus Verilog. Each one must exit 0 and print a line starting with PASS.
+#
+#   gateware/sim/run.sh                    # all testbenches
+#   gateware/sim/run.sh tb_tmds_encoder    # just one
+#
+# Logs go to $SIM_OUT (default /tmp/papilio_sim). Exits 0 when every
+# testbench passes, 1 on any failure and 77 when iverilog or vvp is not
+# installed, so callers can report a skip rather than a pass.
+
+set -o pipefail
+
+SIM_DIR=$(cd "$(dirname "$0")" && pwd)
+SRC="$SIM_DIR/../src"
+OUT=${SIM_OUT:-/tmp/papilio_sim}
+
+# Sources each testbench needs besides itself
+sources_for() {
+    case "$1" in
+        tb_tmds_encoder) echo "$SRC/tmds_encoder.v $SRC/tmds_encoder_pipelined.v" ;;
+        *)               return 1 ;;
+    esac
+}
+
+if ! command -v iverilog > /dev/null || ! command -v vvp > /dev/null; then
+    echo "skipped: iverilog not found"
+    exit 77
+fi
+
+if [ $# -gt 0 ]; then
+    BENCHES=("$@")
+else
+    BENCHES=(tb_tmds_encoder)
+fi
+
+mkdir -p "$OUT"
+status=0
+for tb in "${BENCHES[@]}"; do
+    if ! srcs=$(sources_for "$tb"); then
+        printf '%-24s %s\n' "$tb" "unknown testbench"
+        status=1
+        continue
+    fi
+    # shellcheck disable=SC2086
+    if ! iverilog -g2012 -o "$OUT/$tb.vvp" "$SIM_DIR/$tb.v" $srcs > "$OUT/$tb.build.log" 2>&1; then
+        printf '%-24s %s\n' "$tb" "BUILD FAILED, see $OUT/$tb.build.log"
+        status=1
+        continue
+    fi
+    if vvp -n "$OUT/$tb.vvp" > "$OUT/$tb.log" 2>&1 && grep -q '^PASS' "$OUT/$tb.log"; then
+        printf '%-24s %s\n' "$tb" "passed"
+    else
+        printf '%-24s %s\n' "$tb" "FAILED, see $OUT/$tb.log"
+        status=1
+    fi
+done
+exit $status
@@ -0,0 +1,194 @@
+// tb_tmds_encoder.v
+// Self-checking testbench for tmds_encoder_pipelined.v
+//
+// Drives tmds_encoder.v and tmds_encoder_pipelined.v with the same raster
+// (random pixels, solid runs, ramps and 0x00/0xFF alternation, with every
+// {c1, c0} combination in the blanking) and checks each pipelined symbol:
+//   - it equals the tmds_encoder.v symbol from two clocks earlier
+//   - in blanking it is the control symbol for {c1, c0}
+//   - in active video it decodes back to the pixel that went in
+//   - the running disparity of the 10-bit stream stays within +/-8
+//     (DC balance), counted from the symbols themselves
+//
+//   gateware/sim/run.sh tb_tmds_encoder
+//
+// Prints PASS, or stops at the first mismatch with $fatal (non-zero exit).
+
+`timescale 1ns / 1ps
+
+module tb_tmds_encoder;
+
+    // tmds_encoder.v registers once, the pipelined encoder three times
+    localparam EXTRA    = 2;
+    localparam H_ACTIVE = 64;
+    localparam H_BLANK  = 16;
+    localparam LINES    = 400;
+
+    reg        clk  = 1'b0;
+    reg        rst  = 1'b1;
+    reg        de   = 1'b0;
+    reg  [7:0] data = 8'd0;
+    reg        c0   = 1'b0;
+    reg        c1   = 1'b0;
+
+    wire [9:0] ref_out;
+    wire [9:0] pipe_out;
+
+    tmds_encoder ref_enc (
+        .clk(clk), .rst(rst), .video_active(de), .data_in(data),
+        .c0(c0), .c1(c1), .tmds_out(ref_out)
+    );
+
+    tmds_encoder_pipelined dut (
+        .clk(clk), .rst(rst), .video_active(de), .data_in(data),
+        .c0(c0), .c1(c1), .tmds_out(pipe_out)
+    );
+
+    always #5 clk = ~clk;
+
+    // ==========================================================================
+    // Reference helpers
+    // ==========================================================================
+    function [9:0] ctrl_symbol;
+        input [1:0] ctrl;  // {c1, c0}
+        begin
+            case (ctrl)
+                2'b00: ctrl_symbol = 10'b1101010100;
+                2'b01: ctrl_symbol = 10'b0010101011;
+                2'b10: ctrl_symbol = 10'b0101010100;
+                2'b11: ctrl_symbol = 10'b1010101011;
+            endcase
+        end
+    endfunction
+
+    // Inverse of the 8b/10b video encoding
+    function [7:0] decode;
+        input [9:0] sym;
+        reg [7:0] d;
+        integer i;
+        begin
+            d = sym[9] ? ~sym[7:0] : sym[7:0];
+            decode[0] = d[0];
+            for (i = 1; i < 8; i = i + 1)
+                decode[i] = sym[8] ? (d[i] ^ d[i-1]) : ~(d[i] ^ d[i-1]);
+        end
+    endfunction
+
+    // Ones minus zeros of a symbol
+    function integer balance;
+        input [9:0] sym;
+        integer i;
+        begin
+            balance = -10;
+            for (i = 0; i < 10; i = i + 1)
+                balance = balance + 2 * sym[i];
+        end
+    endfunction
+
+    // ==========================================================================
+    // Checker
+    // ==========================================================================
+    // Inputs and reference symbols of the last EXTRA + 1 clocks, [0] newest
+    reg        de_h   [0:EXTRA];
+    reg  [7:0] data_h [0:EXTRA];
+    reg  [1:0] ctrl_h [0:EXTRA];
+    reg  [9:0] ref_h  [0:EXTRA];
+
+    integer filled    = 0;
+    integer disparity = 0;
+    integer symbols   = 0;
+    integer active    = 0;
+    integer worst     = 0;
+    integer k;
+
+    task check;
+        begin
+            for (k = EXTRA; k > 0; k = k - 1) begin
+                de_h[k]   = de_h[k-1];
+                data_h[k] = data_h[k-1];
+                ctrl_h[k] = ctrl_h[k-1];
+                ref_h[k]  = ref_h[k-1];
+            end
+            de_h[0]   = de;
+            data_h[0] = data;
+            ctrl_h[0] = {c1, c0};
+            ref_h[0]  = ref_out;
+
+            if (filled < EXTRA) begin
+                filled = filled + 1;
+            end else begin
+                symbols = symbols + 1;
+                if (pipe_out !== ref_h[EXTRA])
+                    $fatal(1, "symbol %0d: pipelined %b, tmds_encoder %b",
+                           symbols, pipe_out, ref_h[EXTRA]);
+
+                if (!de_h[EXTRA]) begin
+                    disparity = 0;
+                    if (pipe_out !== ctrl_symbol(ctrl_h[EXTRA]))
+                        $fatal(1, "symbol %0d: control %b for {c1,c0}=%b",
+                               symbols, pipe_out, ctrl_h[EXTRA]);
+                end else begin
+                    active = active + 1;
+                    if (decode(pipe_out) !== data_h[EXTRA])
+                        $fatal(1, "symbol %0d: %b decodes to %h, sent %h",
+                               symbols, pipe_out, decode(pipe_out), data_h[EXTRA]);
+                    disparity = disparity + balance(pipe_out);
+                    if (disparity > worst) worst = disparity;
+                    if (-disparity > worst) worst = -disparity;
+                    if (disparity > 8 || disparity < -8)
+                        $fatal(1, "symbol %0d: running disparity %0d", symbols, disparity);
+                end
+            end
+        end
+    endtask
+
+    // ==========================================================================
+    // Stimulus
+    // ==========================================================================
+    // Inputs change just after a rising edge, are sampled on the next one,
+    // and the new outputs are checked 1ns after it
+    task pixel;
+        input       active_in;
+        input [7:0] value;
+        input [1:0] ctrl;
+        begin
+            de   = active_in;
+            data = value;
+            {c1, c0} = ctrl;
+            @(posedge clk);
+            #1;
+            check;
+        end
+    endtask
+
+    integer line, x;
+    integer seed = 32'h5eed;
+    reg [7:0] value;
+
+    initial begin
+        repeat (4) @(posedge clk);
+        #1;
+        rst = 1'b0;
+
+        for (line = 0; line < LINES; line = line + 1) begin
+            for (x = 0; x < H_ACTIVE; x = x + 1) begin
+                case (line % 5)
+                    0: value = $random(seed);
+                    1: value = line * 37;                  // solid run
+                    2: value = x * 4 + line;               // ramp
+                    3: value = (x & 1) ? 8'hFF : 8'h00;    // worst-case swing
+                    4: value = (x < H_ACTIVE / 2) ? 8'h10 : 8'hEF;
+                endcase
+                pixel(1'b1, value, 2'b00);
+            end
+            // Blanking walks through every control symbol
+            for (x = 0; x < H_BLANK; x = x + 1)
+                pixel(1'b0, 8'h00, (x + line) & 2'b11);
+        end
+
+        $display("PASS: %0d symbols, %0d active, worst running disparity %0d",
+                 symbols, active, worst);
+        $finish;
+    end
+
+endmodule
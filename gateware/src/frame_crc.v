@@ -0,0 +1,93 @@
+// ==============================================================================
+// frame_crc.v - Per-Frame CRC32 of the Active Picture
+// ==============================================================================
+// Runs a CRC32 (IEEE 802.3, as zlib's crc32()) over every active pixel sent
+// to the PHY, bytes R, G, B, left to right and top to bottom. At the start
+// of vertical sync the finished value and a frame count are latched and
+// handed to the Wishbone clock domain, where they stay until the next frame.
+//
+// A static screen gives the same CRC every frame, so the host can confirm
+// what is on screen with a 4-byte read instead of reading VRAM back.
+// ==============================================================================
+
+module frame_crc
+(
+    // Pixel clock domain
+    input             I_pix_clk       ,
+    input             I_rst_n         ,
+    input      [7:0]  I_rgb_r         ,
+    input      [7:0]  I_rgb_g         ,
+    input      [7:0]  I_rgb_b         ,
+    input             I_rgb_de        ,
+    input             I_rgb_vs        ,
+
+    // Wishbone clock domain
+    input             I_wb_clk        ,
+    output reg [31:0] O_crc           ,  // CRC of the last complete frame
+    output reg [7:0]  O_frames           // frames latched, wraps
+);
+
+// Reflected CRC32 (polynomial 0xEDB88320) of one pixel, R first, LSB first
+function [31:0] crc32_pixel;
+    input [31:0] crc;
+    input [23:0] rgb;
+    integer b, k;
+    reg [31:0] c;
+    reg [7:0] d;
+    begin
+        c = crc;
+        for (b = 0; b < 3; b = b + 1) begin
+            d = rgb[23 - 8*b -: 8];
+            for (k = 0; k < 8; k = k + 1) begin
+                c = (c[0] ^ d[k]) ? ((c >> 1) ^ 32'hEDB88320) : (c >> 1);
+            end
+        end
+        crc32_pixel = c;
+    end
+endfunction
+
+// ==============================================================================
+// Pixel clock domain
+// ==============================================================================
+reg [31:0] crc_run;
+reg [31:0] crc_frame;
+reg [7:0]  frame_cnt;
+reg        frame_tgl;
+reg        vs_prev;
+
+always @(posedge I_pix_clk or negedge I_rst_n) begin
+    if (!I_rst_n) begin
+        crc_run   <= 32'hFFFFFFFF;
+        crc_frame <= 32'd0;
+        frame_cnt <= 8'd0;
+        frame_tgl <= 1'b0;
+        vs_prev   <= 1'b0;
+    end else begin
+        vs_prev <= I_rgb_vs;
+        if (I_rgb_vs && !vs_prev) begin
+            crc_frame <= ~crc_run;
+            crc_run   <= 32'hFFFFFFFF;
+            frame_cnt <= frame_cnt + 1'b1;
+            frame_tgl <= !frame_tgl;
+        end else if (I_rgb_de) begin
+            crc_run <= crc32_pixel(crc_run, {I_rgb_r, I_rgb_g, I_rgb_b});
+        end
+    end
+end
+
+// ==============================================================================
+// Wishbone clock domain
+// ==============================================================================
+// crc_frame and frame_cnt hold still for a whole frame after the toggle,
+// so they are sampled once the toggle has crossed
+reg [2:0] tgl_sync;
+
+always @(posedge I_wb_clk) begin
+    tgl_sync <= {tgl_sync[1:0], frame_tgl};
+    if (tgl_sync[2] != tgl_sync[1]) begin
+        O_crc    <= crc_frame;
+        O_frames <= frame_cnt;
+    end
+end
+
+endmodule
@@ -4,7 +4,8 @@
 // Simple Dual-Port Block RAM for framebuffer with separate read/write clocks.
 // Uses Gowin SDPB primitive for reliable cross-clock-domain operation.
 //
-// Size: 19,200 bytes (160x120 RGB332)
+// Size: DEPTH x DATA_WIDTH (wb_video_framebuffer uses two 32,512 x 4 banks)
+// Contents: undefined at power-on, or loaded from INIT_FILE by synthesis
 // Write port: Wishbone clock (27 MHz)
 // Read port: Pixel clock (74.25 MHz)
 // ==============================================================================
@@ -12,7 +13,8 @@
 module framebuffer_ram #(
     parameter ADDR_WIDTH = 15,
     parameter DATA_WIDTH = 8,
-    parameter DEPTH = 19200
+    parameter DEPTH = 19200,
+    parameter INIT_FILE = ""        // $readmemh contents at configuration
 )(
     // Write port (Wishbone clock domain)
     input                       wr_clk,
@@ -32,6 +34,12 @@ module framebuffer_ram #(
 (* syn_ramstyle = "block_ram" *)
 reg [DATA_WIDTH-1:0] mem [0:DEPTH-1];
 
+// Optional power-on contents, one hex word per line (see splash2mem.py)
+initial begin
+    if (INIT_FILE != "")
+        $readmemh(INIT_FILE, mem);
+end
+
 // Write port - synchronous write
 always @(posedge wr_clk) begin
     if (wr_en && wr_addr < DEPTH) begin
@@ -44,7 +52,7 @@ always @(posedge rd_clk) begin
     if (rd_en && rd_addr < DEPTH) begin
         rd_data <= mem[rd_addr];
     end else begin
-        rd_data <= 8'd0;
+        rd_data <= {DATA_WIDTH{1'b0}};
     end
 end
 
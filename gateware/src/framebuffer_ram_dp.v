@@ -0,0 +1,60 @@
+// ==============================================================================
+// framebuffer_ram_dp.v - Gowin DPB-based Framebuffer Memory with Write-Side Read
+// ==============================================================================
+// framebuffer_ram with the write port also reading, so the Wishbone side can
+// read-modify-write VRAM (raster ops) without taking the scanout read port.
+// Maps to a Gowin DPB (true dual-port) block instead of SDPB. Like
+// framebuffer_ram, INIT_FILE gives it power-on contents.
+//
+// Write port: Wishbone clock (27 MHz); wr_rd_data is the word at wr_addr on
+//             the previous clock (read-first)
+// Read port: Pixel clock (74.25 MHz)
+// ==============================================================================
+
+module framebuffer_ram_dp #(
+    parameter ADDR_WIDTH = 15,
+    parameter DATA_WIDTH = 8,
+    parameter DEPTH = 19200,
+    parameter INIT_FILE = ""        // $readmemh contents at configuration
+)(
+    // Write port (Wishbone clock domain)
+    input                       wr_clk,
+    input                       wr_en,
+    input  [ADDR_WIDTH-1:0]     wr_addr,
+    input  [DATA_WIDTH-1:0]     wr_data,
+    output reg [DATA_WIDTH-1:0] wr_rd_data,
+
+    // Read port (Pixel clock domain)
+    input                       rd_clk,
+    input                       rd_en,
+    input  [ADDR_WIDTH-1:0]     rd_addr,
+    output reg [DATA_WIDTH-1:0] rd_data
+);
+
+(* syn_ramstyle = "block_ram" *)
+reg [DATA_WIDTH-1:0] mem [0:DEPTH-1];
+
+// Optional power-on contents, one hex word per line (see splash2mem.py)
+initial begin
+    if (INIT_FILE != "")
+        $readmemh(INIT_FILE, mem);
+end
+
+// Write port - synchronous write, registered read of the same address
+always @(posedge wr_clk) begin
+    if (wr_en && wr_addr < DEPTH) begin
+        mem[wr_addr] <= wr_data;
+    end
+    wr_rd_data <= mem[wr_addr];
+end
+
+// Read port - synchronous read with registered output
+always @(posedge rd_clk) begin
+    if (rd_en && rd_addr < DEPTH) begin
+        rd_data <= mem[rd_addr];
+    end else begin
+        rd_data <= {DATA_WIDTH{1'b0}};
+    end
+end
+
+endmodule
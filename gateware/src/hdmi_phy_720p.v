@@ -6,25 +6,34 @@
 //
 // This module handles:
 //   - PLL clock generation (27MHz -> 371.25MHz serial, 74.25MHz pixel)
-//   - Video timing generation for 720p@60Hz
-//   - TMDS encoding (open source)
+//   - Video timing generation (hdmi_timing.v presets, 720p@60Hz default)
+//   - TMDS encoding (open source, pipelined by default)
 //   - 10:1 serialization
 //   - LVDS differential output
 //
 // Interface:
 //   - Input: RGB888 pixel data + data enable
+//   - Input: timing preset (see hdmi_timing.v). 720p60 (1) and 1080p30 (2)
+//     share the 74.25MHz pixel clock and can be switched at runtime.
 //   - Output: TMDS differential pairs
 //
+// O_hs/O_vs are always active-high; the preset's sync polarity is applied
+// at the TMDS encoder so video sources never have to care about it.
+//
 // Note: Some Gowin primitives are unavoidable (rPLL, CLKDIV, OSER10, ELVDS_OBUF)
 // as they are required for clock generation and LVDS output on Gowin FPGAs.
 // However, all logic (TMDS encoding, timing) is open source.
 // ==============================================================================
 
 module hdmi_phy_720p
+#(
+    parameter TMDS_PIPELINED = 1  // 1 = tmds_encoder_pipelined, 0 = tmds_encoder
+)
 (
     // Reference clock
     input             I_clk           , // 27MHz reference clock
     input             I_rst_n         ,
+    input      [1:0]  I_timing_preset , // hdmi_timing.v preset (1 = 720p60)
     
     // Video input interface (directly from video source)
     input      [7:0]  I_rgb_r         , // Red channel
@@ -45,6 +54,8 @@ module hdmi_phy_720p
     output            O_vs            , // Vertical sync
     output     [11:0] O_active_x      , // Active area X coordinate
     output     [11:0] O_active_y      , // Active area Y coordinate
+    output     [11:0] O_h_res         , // Active width of current preset
+    output     [11:0] O_v_res         , // Active height of current preset
     
     // HDMI TMDS outputs
     output            O_tmds_clk_p    ,
@@ -53,18 +64,6 @@ module hdmi_phy_720p
     output     [2:0]  O_tmds_data_n   
 );
 
-// ==============================================================================
-// Parameters - 720p@60Hz timing
-// ==============================================================================
-localparam H_TOTAL    = 12'd1650;
-localparam H_SYNC     = 12'd40;
-localparam H_BPORCH   = 12'd220;
-localparam H_ACTIVE   = 12'd1280;
-localparam V_TOTAL    = 12'd750;
-localparam V_SYNC     = 12'd5;
-localparam V_BPORCH   = 12'd20;
-localparam V_ACTIVE   = 12'd720;
-
 // ==============================================================================
 // PLL and clock generation
 // 27MHz input -> 371.25MHz serial clock -> /5 = 74.25MHz pixel clock
@@ -100,49 +99,51 @@ assign O_pix_clk = pix_clk;
 assign O_pix_clk_5x = serial_clk;
 
 // ==============================================================================
-// 720p timing generator
+// Timing generator (runtime preset)
 // ==============================================================================
-reg [11:0] h_cnt;
-reg [11:0] v_cnt;
-reg        hdmi_vs;
-reg        hdmi_hs;
-reg        hdmi_de;
+reg  [1:0]  preset_sync1, preset_sync2;
+wire [11:0] h_cnt;
+wire [11:0] v_cnt;
+wire [11:0] h_start, v_start;
+wire        timing_hs, timing_vs, sync_neg;
+wire        hdmi_de;
 
+// Preset comes from the Wishbone clock domain
 always @(posedge pix_clk or negedge hdmi_rst_n) begin
     if (!hdmi_rst_n) begin
-        h_cnt <= 12'd0;
-        v_cnt <= 12'd0;
+        preset_sync1 <= 2'd1;
+        preset_sync2 <= 2'd1;
     end else begin
-        if (h_cnt >= H_TOTAL - 1) begin
-            h_cnt <= 12'd0;
-            if (v_cnt >= V_TOTAL - 1)
-                v_cnt <= 12'd0;
-            else
-                v_cnt <= v_cnt + 1'b1;
-        end else begin
-            h_cnt <= h_cnt + 1'b1;
-        end
+        preset_sync1 <= I_timing_preset;
+        preset_sync2 <= preset_sync1;
     end
 end
 
-always @(posedge pix_clk or negedge hdmi_rst_n) begin
-    if (!hdmi_rst_n) begin
-        hdmi_hs <= 1'b0;
-        hdmi_vs <= 1'b0;
-        hdmi_de <= 1'b0;
-    end else begin
-        hdmi_hs <= (h_cnt < H_SYNC);
-        hdmi_vs <= (v_cnt < V_SYNC);
-        hdmi_de <= (h_cnt >= H_SYNC + H_BPORCH) && 
-                   (h_cnt < H_SYNC + H_BPORCH + H_ACTIVE) &&
-                   (v_cnt >= V_SYNC + V_BPORCH) && 
-                   (v_cnt < V_SYNC + V_BPORCH + V_ACTIVE);
-    end
-end
+hdmi_timing u_timing (
+    .clk_pixel      (pix_clk        ),
+    .rst            (~hdmi_rst_n    ),
+    .preset         (preset_sync2   ),
+    .hsync          (timing_hs      ),
+    .vsync          (timing_vs      ),
+    .video_active   (hdmi_de        ),
+    .sync_neg       (sync_neg       ),
+    .h_cnt          (h_cnt          ),
+    .v_cnt          (v_cnt          ),
+    .pixel_x        (               ),
+    .pixel_y        (               ),
+    .h_res          (O_h_res        ),
+    .v_res          (O_v_res        ),
+    .h_start        (h_start        ),
+    .v_start        (v_start        )
+);
+
+// Active-high syncs for video sources
+wire hdmi_hs = timing_hs ^ sync_neg;
+wire hdmi_vs = timing_vs ^ sync_neg;
 
 // Active area pixel coordinates
-wire [11:0] active_x = h_cnt - (H_SYNC + H_BPORCH);
-wire [11:0] active_y = v_cnt - (V_SYNC + V_BPORCH);
+wire [11:0] active_x = h_cnt - h_start;
+wire [11:0] active_y = v_cnt - v_start;
 
 // Output timing signals
 assign O_h_cnt = h_cnt;
@@ -158,6 +159,48 @@ assign O_active_y = active_y;
 // ==============================================================================
 wire [9:0] tmds_r, tmds_g, tmds_b;
 
+// Sync is carried on the blue channel at line level (preset polarity)
+wire enc_hs = I_rgb_hs ^ sync_neg;
+wire enc_vs = I_rgb_vs ^ sync_neg;
+
+generate
+if (TMDS_PIPELINED) begin : g_tmds_pipelined
+
+// Red channel encoder
+tmds_encoder_pipelined enc_r (
+    .clk(pix_clk),
+    .rst(~hdmi_rst_n),
+    .video_active(I_rgb_de),
+    .data_in(I_rgb_r),
+    .c0(1'b0),
+    .c1(1'b0),
+    .tmds_out(tmds_r)
+);
+
+// Green channel encoder
+tmds_encoder_pipelined enc_g (
+    .clk(pix_clk),
+    .rst(~hdmi_rst_n),
+    .video_active(I_rgb_de),
+    .data_in(I_rgb_g),
+    .c0(1'b0),
+    .c1(1'b0),
+    .tmds_out(tmds_g)
+);
+
+// Blue channel encoder (carries sync signals)
+tmds_encoder_pipelined enc_b (
+    .clk(pix_clk),
+    .rst(~hdmi_rst_n),
+    .video_active(I_rgb_de),
+    .data_in(I_rgb_b),
+    .c0(enc_hs),
+    .c1(enc_vs),
+    .tmds_out(tmds_b)
+);
+
+end else begin : g_tmds_single
+
 // Red channel encoder
 tmds_encoder enc_r (
     .clk(pix_clk),
@@ -186,11 +229,14 @@ tmds_encoder enc_b (
     .rst(~hdmi_rst_n),
     .video_active(I_rgb_de),
     .data_in(I_rgb_b),
-    .c0(I_rgb_hs),
-    .c1(I_rgb_vs),
+    .c0(enc_hs),
+    .c1(enc_vs),
     .tmds_out(tmds_b)
 );
 
+end
+endgenerate
+
 // ==============================================================================
 // 10:1 Serialization using OSER10 primitives
 // ==============================================================================
@@ -1,79 +1,117 @@
 // hdmi_timing.v
-// HDMI/DVI timing generator for 640x480@60Hz
-// Pixel clock: 25.175 MHz (we'll use 27MHz / 2 = 13.5MHz as approximation, or generate proper clock)
+// HDMI/DVI timing generator with runtime-selectable presets
+//
+// Presets (preset input):
+//   0 = 640x480@60     (25.175 MHz pixel clock, negative sync)
+//   1 = 1280x720@60    (74.25 MHz pixel clock,  positive sync)
+//   2 = 1920x1080@30   (74.25 MHz pixel clock,  positive sync)
+//   3 = 800x600@72     (50 MHz pixel clock,     positive sync)
+//
+// 720p60 and 1080p30 share the 74.25 MHz pixel clock from TMDS_rPLL, so they
+// can be switched at runtime without touching the PLL. 640x480 and 800x600
+// need a matching PLL (see TMDS_rPLL_250.v for the ~50 MHz 800x600 clock).
+//
+// Counters start at the beginning of the sync pulse (same convention as
+// hdmi_phy_720p.v): [sync][back porch][active][front porch].
+// hsync/vsync are driven at line level (preset polarity applied);
+// sync_neg tells the caller which polarity is in use.
+// A preset change takes effect immediately; the counters wrap at the new
+// totals, so the sink resynchronises within one frame.
 
 module hdmi_timing (
-    input wire clk_pixel,  // 25.175 MHz pixel clock
+    input wire clk_pixel,
     input wire rst,
+    input wire [1:0] preset,
     output reg hsync,
     output reg vsync,
     output reg video_active,
-    output reg [9:0] pixel_x,
-    output reg [9:0] pixel_y
+    output reg sync_neg,
+    output reg [11:0] h_cnt,
+    output reg [11:0] v_cnt,
+    output reg [11:0] pixel_x,
+    output reg [11:0] pixel_y,
+    output reg [11:0] h_res,
+    output reg [11:0] v_res,
+    output wire [11:0] h_start,  // First active column in h_cnt terms
+    output wire [11:0] v_start   // First active line in v_cnt terms
 );
 
-    // 640x480@60Hz timing parameters
-    // Horizontal timing (pixels)
-    localparam H_ACTIVE     = 640;
-    localparam H_FRONT      = 16;
-    localparam H_SYNC       = 96;
-    localparam H_BACK       = 48;
-    localparam H_TOTAL      = H_ACTIVE + H_FRONT + H_SYNC + H_BACK; // 800
-    
-    // Vertical timing (lines)
-    localparam V_ACTIVE     = 480;
-    localparam V_FRONT      = 10;
-    localparam V_SYNC       = 2;
-    localparam V_BACK       = 33;
-    localparam V_TOTAL      = V_ACTIVE + V_FRONT + V_SYNC + V_BACK; // 525
-    
-    reg [9:0] h_count;
-    reg [9:0] v_count;
-    
+    // Preset table
+    reg [11:0] h_total, h_sync, h_bporch;
+    reg [11:0] v_total, v_sync, v_bporch;
+    reg        neg;
+
+    always @(*) begin
+        case (preset)
+            2'd0: begin  // 640x480@60
+                h_res = 12'd640;  h_total = 12'd800;  h_sync = 12'd96; h_bporch = 12'd48;
+                v_res = 12'd480;  v_total = 12'd525;  v_sync = 12'd2;  v_bporch = 12'd33;
+                neg   = 1'b1;
+            end
+            2'd2: begin  // 1920x1080@30
+                h_res = 12'd1920; h_total = 12'd2200; h_sync = 12'd44; h_bporch = 12'd148;
+                v_res = 12'd1080; v_total = 12'd1125; v_sync = 12'd5;  v_bporch = 12'd36;
+                neg   = 1'b0;
+            end
+            2'd3: begin  // 800x600@72
+                h_res = 12'd800;  h_total = 12'd1040; h_sync = 12'd120; h_bporch = 12'd64;
+                v_res = 12'd600;  v_total = 12'd666;  v_sync = 12'd6;   v_bporch = 12'd23;
+                neg   = 1'b0;
+            end
+            default: begin  // 1280x720@60
+                h_res = 12'd1280; h_total = 12'd1650; h_sync = 12'd40; h_bporch = 12'd220;
+                v_res = 12'd720;  v_total = 12'd750;  v_sync = 12'd5;  v_bporch = 12'd20;
+                neg   = 1'b0;
+            end
+        endcase
+    end
+
+    assign h_start = h_sync + h_bporch;
+    assign v_start = v_sync + v_bporch;
+
     always @(posedge clk_pixel or posedge rst) begin
         if (rst) begin
-            h_count <= 0;
-            v_count <= 0;
-            hsync <= 1;
-            vsync <= 1;
+            h_cnt <= 0;
+            v_cnt <= 0;
+            hsync <= 0;
+            vsync <= 0;
+            sync_neg <= 0;
             video_active <= 0;
             pixel_x <= 0;
             pixel_y <= 0;
         end else begin
             // Horizontal counter
-            if (h_count == H_TOTAL - 1) begin
-                h_count <= 0;
+            if (h_cnt >= h_total - 1) begin
+                h_cnt <= 0;
                 // Vertical counter
-                if (v_count == V_TOTAL - 1)
-                    v_count <= 0;
+                if (v_cnt >= v_total - 1)
+                    v_cnt <= 0;
                 else
-                    v_count <= v_count + 1;
+                    v_cnt <= v_cnt + 1;
             end else begin
-                h_count <= h_count + 1;
+                h_cnt <= h_cnt + 1;
             end
-            
-            // Generate hsync (negative polarity)
-            hsync <= ~((h_count >= (H_ACTIVE + H_FRONT)) && 
-                      (h_count < (H_ACTIVE + H_FRONT + H_SYNC)));
-            
-            // Generate vsync (negative polarity)
-            vsync <= ~((v_count >= (V_ACTIVE + V_FRONT)) && 
-                      (v_count < (V_ACTIVE + V_FRONT + V_SYNC)));
-            
+
+            // Sync pulses at line level
+            hsync <= (h_cnt < h_sync) ^ neg;
+            vsync <= (v_cnt < v_sync) ^ neg;
+            sync_neg <= neg;
+
             // Generate video active
-            video_active <= (h_count < H_ACTIVE) && (v_count < V_ACTIVE);
-            
+            video_active <= (h_cnt >= h_start) && (h_cnt < h_start + h_res) &&
+                            (v_cnt >= v_start) && (v_cnt < v_start + v_res);
+
             // Output pixel coordinates
-            if (h_count < H_ACTIVE)
-                pixel_x <= h_count;
+            if (h_cnt >= h_start && h_cnt < h_start + h_res)
+                pixel_x <= h_cnt - h_start;
             else
                 pixel_x <= 0;
-                
-            if (v_count < V_ACTIVE)
-                pixel_y <= v_count;
+
+            if (v_cnt >= v_start && v_cnt < v_start + v_res)
+                pixel_y <= v_cnt - v_start;
             else
                 pixel_y <= 0;
         end
     end
-    
+
 endmodule
@@ -0,0 +1,155 @@
+// tmds_encoder_pipelined.v
+// Pipelined TMDS encoder for DVI/HDMI video transmission
+// Implements the same TMDS 8b/10b algorithm as tmds_encoder.v, split into
+// three register stages so each stage has a short combinational path:
+//
+//   Stage 1: register input, count ones in data_in
+//   Stage 2: choose XOR/XNOR transition minimisation, count ones in q_m
+//   Stage 3: DC balance (running disparity) and control symbol insertion
+//
+// Latency is 3 pixel clocks (tmds_encoder.v has 1). All channels of a link
+// must use the same encoder so the RGB lanes stay aligned. This closes timing
+// comfortably at 74.25 MHz (720p60 / 1080p30) on GW2A-18C and leaves headroom
+// for higher pixel clocks.
+
+module tmds_encoder_pipelined (
+    input wire clk,
+    input wire rst,
+    input wire video_active,
+    input wire [7:0] data_in,
+    input wire c0,  // Control bit 0 (hsync for channel 0)
+    input wire c1,  // Control bit 1 (vsync for channel 0)
+    output reg [9:0] tmds_out
+);
+
+    // Count ones in 8-bit data
+    function [3:0] count_ones;
+        input [7:0] data;
+        integer i;
+        begin
+            count_ones = 0;
+            for (i = 0; i < 8; i = i + 1)
+                count_ones = count_ones + data[i];
+        end
+    endfunction
+
+    // XOR operation for encoding
+    function [8:0] xor_encode;
+        input [7:0] data;
+        integer i;
+        begin
+            xor_encode[0] = data[0];
+            for (i = 1; i < 8; i = i + 1)
+                xor_encode[i] = data[i] ^ xor_encode[i-1];
+            xor_encode[8] = 1'b1;
+        end
+    endfunction
+
+    // XNOR operation for encoding
+    function [8:0] xnor_encode;
+        input [7:0] data;
+        integer i;
+        begin
+            xnor_encode[0] = data[0];
+            for (i = 1; i < 8; i = i + 1)
+                xnor_encode[i] = ~(data[i] ^ xnor_encode[i-1]);
+            xnor_encode[8] = 1'b0;
+        end
+    endfunction
+
+    // ==========================================================================
+    // Stage 1: Register input and count ones
+    // ==========================================================================
+    reg [7:0] data_s1;
+    reg [3:0] ones_s1;
+    reg       de_s1;
+    reg [1:0] ctrl_s1;
+
+    always @(posedge clk or posedge rst) begin
+        if (rst) begin
+            data_s1 <= 8'd0;
+            ones_s1 <= 4'd0;
+            de_s1   <= 1'b0;
+            ctrl_s1 <= 2'b00;
+        end else begin
+            data_s1 <= data_in;
+            ones_s1 <= count_ones(data_in);
+            de_s1   <= video_active;
+            ctrl_s1 <= {c1, c0};
+        end
+    end
+
+    // ==========================================================================
+    // Stage 2: Transition minimisation
+    // ==========================================================================
+    wire [8:0] q_m = (ones_s1 > 4 || (ones_s1 == 4 && data_s1[0] == 0)) ?
+                     xnor_encode(data_s1) : xor_encode(data_s1);
+
+    reg [8:0] q_m_s2;
+    reg [3:0] q_m_ones_s2;
+    reg       de_s2;
+    reg [1:0] ctrl_s2;
+
+    always @(posedge clk or posedge rst) begin
+        if (rst) begin
+            q_m_s2      <= 9'd0;
+            q_m_ones_s2 <= 4'd0;
+            de_s2       <= 1'b0;
+            ctrl_s2     <= 2'b00;
+        end else begin
+            q_m_s2      <= q_m;
+            q_m_ones_s2 <= count_ones(q_m[7:0]);
+            de_s2       <= de_s1;
+            ctrl_s2     <= ctrl_s1;
+        end
+    end
+
+    // ==========================================================================
+    // Stage 3: DC balance
+    // ==========================================================================
+    reg signed [4:0] disparity;
+
+    always @(posedge clk or posedge rst) begin
+        if (rst) begin
+            disparity <= 0;
+            tmds_out <= 10'b1101010100; // Control code for c0=0, c1=0
+        end else begin
+            if (!de_s2) begin
+                // Control period - send control codes
+                disparity <= 0;
+                case (ctrl_s2)
+                    2'b00: tmds_out <= 10'b1101010100;
+                    2'b01: tmds_out <= 10'b0010101011;
+                    2'b10: tmds_out <= 10'b0101010100;
+                    2'b11: tmds_out <= 10'b1010101011;
+                endcase
+            end else begin
+                // Video period - encode data
+                if (disparity == 0 || q_m_ones_s2 == 4) begin
+                    tmds_out[9] <= ~q_m_s2[8];
+                    tmds_out[8] <= q_m_s2[8];
+                    tmds_out[7:0] <= q_m_s2[8] ? q_m_s2[7:0] : ~q_m_s2[7:0];
+
+                    if (q_m_s2[8] == 0)
+                        disparity <= disparity + (4 - q_m_ones_s2) + (4 - q_m_ones_s2);
+                    else
+                        disparity <= disparity + q_m_ones_s2 - (8 - q_m_ones_s2);
+                end else begin
+                    if ((disparity > 0 && q_m_ones_s2 > 4) ||
+                        (disparity < 0 && q_m_ones_s2 < 4)) begin
+                        tmds_out[9] <= 1'b1;
+                        tmds_out[8] <= q_m_s2[8];
+                        tmds_out[7:0] <= ~q_m_s2[7:0];
+                        disparity <= disparity + {q_m_s2[8], 1'b0} + (8 - q_m_ones_s2) - q_m_ones_s2;
+                    end else begin
+                        tmds_out[9] <= 1'b0;
+                        tmds_out[8] <= q_m_s2[8];
+                        tmds_out[7:0] <= q_m_s2[7:0];
+                        disparity <= disparity - {~q_m_s2[8], 1'b0} + q_m_ones_s2 - (8 - q_m_ones_s2);
+                    end
+                end
+            end
+        end
+    end
+
+endmodule
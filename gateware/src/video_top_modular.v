@@ -5,7 +5,8 @@
 //   - hdmi_phy_720p.v   - Shared HDMI physical layer with open-source TMDS
 //   - wb_video_testpattern.v - Test pattern generator (optional)
 //   - wb_video_text.v   - Text mode 80x26 (optional)
-//   - wb_video_framebuffer.v - 160x120 RGB332 framebuffer (optional)
+//   - wb_video_framebuffer.v - Configurable RGB332/4bpp framebuffer (optional)
+//   - frame_crc.v       - Per-frame CRC32 of the output (optional)
 //
 // Users can pick and choose which video modes to include in their design.
 // The video mode mux allows runtime switching between modes via Wishbone.
@@ -13,7 +14,26 @@
 // This is an EXAMPLE - modify for your specific needs.
 // ==============================================================================
 
-module video_top_modular
+module video_top_modular #(
+    // Boot splash: video mode at configuration and reset, and the power-on
+    // framebuffer and text contents. gateware/tools/splash2mem.py prints
+    // the values for an image or text screen; the defaults show the test
+    // pattern with VRAM and text RAM undefined.
+    parameter BOOT_MODE      = 0,
+    parameter BOOT_WIDTH     = 160,
+    parameter BOOT_HEIGHT    = 120,
+    parameter BOOT_FORMAT    = 0,
+    parameter BOOT_SCALE     = 6,
+    parameter BOOT_VIEW_X    = 160,
+    parameter BOOT_VIEW_Y    = 0,
+    parameter SPLASH_HI_FILE = "",
+    parameter SPLASH_LO_FILE = "",
+    parameter CHAR_INIT_FILE = "",
+    parameter ATTR_INIT_FILE = "",
+    // Timing presets the PLL in this build can clock, one bit per preset
+    // (bit n = preset n). The stock 74.25MHz PLL runs 720p60 and 1080p30.
+    parameter TIMING_PRESETS = 4'b0110
+)
 (
     // System
     input             I_clk           , // 27MHz system clock
@@ -42,13 +62,29 @@ module video_top_modular
 // Address map:
 //   0x0000-0x000F : Mode control (this module)
 //   0x0010-0x001F : Test pattern registers
-//   0x0020-0x00FF : Text mode registers + char RAM
-//   0x0100-0x7FFF : Framebuffer (word-aligned: pixel_addr * 4)
+//   0x0020-0x002F : Text mode registers + char RAM
+//   0x0030-0x004F : Framebuffer control registers + 4bpp palette
+//   0x0050-0x005F : Framebuffer line stream registers
+//   0x0060-0x006F : Framebuffer dual playfield registers
+//   0x0070-0x007F : Framebuffer palette bank 1
+//   0x0080-0x009F : Framebuffer affine scanout registers
+//   0x00A0-0x00AF : Framebuffer write window, raster ops and state control
+//   0x00B0        : Epoch (this module)
+//   0x00B1-0x00B7 : Link check (this module)
+//   0x00B8-0x00FF : Reserved (acked, reads 0)
+//   0x0100-0x7FFF : Framebuffer VRAM (byte addressed)
+//   0x8000-0x81FF : Line stream write line
+//   0x8800-0x8FFF : Affine line table (rest of 0x8000-0xFFFF acked, ignored)
 
 localparam ADDR_MODE_CTRL   = 16'h0000;
 localparam ADDR_TP_BASE     = 16'h0010;
 localparam ADDR_TEXT_BASE   = 16'h0020;
+localparam ADDR_FB_CTRL     = 16'h0030;
+localparam ADDR_EPOCH       = 16'h00B0;
+localparam ADDR_LINK_BASE   = 16'h00B1;
+localparam ADDR_RSVD_BASE   = 16'h00B8;
 localparam ADDR_FB_BASE     = 16'h0100;
+localparam ADDR_LINE_BASE   = 16'h8000;
 
 // ==============================================================================
 // Video mode control register
@@ -57,15 +93,91 @@ localparam ADDR_FB_BASE     = 16'h0100;
 //   [1:0] = Video mode select:
 //           0 = Test pattern
 //           1 = Text mode
-//           2 = Framebuffer
+//           2 = Framebuffer (VRAM or line stream, see wb_video_framebuffer.v)
 //           3 = Reserved
+//
+// Timing register at 0x0001:
+//   [1:0] = hdmi_timing.v preset (0=640x480, 1=720p60, 2=1080p30, 3=800x600)
+//           720p60 and 1080p30 share the 74.25MHz pixel clock. Writes of a
+//           preset not in TIMING_PRESETS are ignored, so the host can read
+//           back whether it took.
+//
+// Boot register at 0x0002:
+//   [1:0] = Video mode set at reset (BOOT_MODE at configuration). Kept
+//           through I_rst_n, so the host can choose what a reset shows.
+//   [6]   = Text page 0 loaded at configuration (read only)
+//   [7]   = Framebuffer VRAM loaded at configuration (read only)
+//
+// Frame CRC at 0x0004-0x0007 (read only, little endian):
+//   CRC32 of the last complete frame as sent to the PHY (see frame_crc.v).
+//   Reading 0x0004 snapshots the other three bytes, so read it first.
+// Frame count at 0x0008 (read only): frames latched, wraps at 256.
+//
+// The other addresses below 0x0010 alias the mode register.
+//
+// Epoch register at 0x00B0:
+//   [7:0] = Written by the host, cleared by reset and configuration. A
+//           host that writes a non-zero value and later reads 0 knows the
+//           FPGA lost its state and has to be set up again.
+//
+// Link check at 0x00B1-0x00B7: a CRC-16/CCITT (polynomial 0x1021, init
+// 0xFFFF, MSB first) runs over ADDR_HI, ADDR_LO and DATA of every write
+// that completes outside this block. The host restarts it, sends a burst,
+// then writes the CRC it computed; a mismatch means the burst was
+// corrupted on the way and can be sent again.
+//   0x00B1 W: [0] restart the CRC and clear the status
+//          R: [7] present (1), [1] compared since restart, [0] mismatch
+//   0x00B2 W: expected CRC low byte     R: running CRC low byte
+//   0x00B3 W: expected CRC high byte, compares   R: running CRC high byte
+//   0x00B4-0x00B5 R: mismatches, 0x00B6-0x00B7 R: compares (16-bit LE,
+//          any write clears both)
 
 reg [1:0] video_mode;
+reg [1:0] timing_preset;
+reg [7:0] epoch;
+
+reg [15:0] link_crc;
+reg [7:0]  link_exp_lo;
+reg        link_done;
+reg        link_fail;
+reg [15:0] link_errors;
+reg [15:0] link_checks;
+
+// CRC-16/CCITT of one write: address high, address low, data
+function [15:0] crc16_write;
+    input [15:0] crc;
+    input [23:0] bytes;
+    integer k;
+    reg [15:0] c;
+    begin
+        c = crc;
+        for (k = 23; k >= 0; k = k - 1) begin
+            c = (c[15] ^ bytes[k]) ? ({c[14:0], 1'b0} ^ 16'h1021) : {c[14:0], 1'b0};
+        end
+        crc16_write = c;
+    end
+endfunction
+
+localparam BOOT_SPLASH = (SPLASH_HI_FILE != "") || (SPLASH_LO_FILE != "");
+localparam BOOT_TEXT   = (CHAR_INIT_FILE != "");
+
+// Not reset: loaded with BOOT_MODE at configuration, written through 0x0002
+reg [1:0] boot_mode = BOOT_MODE;
+reg       boot_load;
+always @(posedge I_wb_clk) begin
+    if (I_wb_stb && I_wb_cyc && I_wb_we && I_wb_adr == 16'h0002)
+        boot_mode <= I_wb_dat[1:0];
+end
 
 wire wb_mode_sel = (I_wb_adr < ADDR_TP_BASE);
 wire wb_tp_sel   = (I_wb_adr >= ADDR_TP_BASE) && (I_wb_adr < ADDR_TEXT_BASE);
-wire wb_text_sel = (I_wb_adr >= ADDR_TEXT_BASE) && (I_wb_adr < ADDR_FB_BASE);
-wire wb_fb_sel   = (I_wb_adr >= ADDR_FB_BASE);
+wire wb_text_sel = (I_wb_adr >= ADDR_TEXT_BASE) && (I_wb_adr < ADDR_FB_CTRL);
+wire wb_fb_ctrl_sel = (I_wb_adr >= ADDR_FB_CTRL) && (I_wb_adr < ADDR_EPOCH);
+wire wb_epoch_sel = (I_wb_adr == ADDR_EPOCH);
+wire wb_link_sel = (I_wb_adr >= ADDR_LINK_BASE) && (I_wb_adr < ADDR_RSVD_BASE);
+wire wb_rsvd_sel = (I_wb_adr >= ADDR_RSVD_BASE) && (I_wb_adr < ADDR_FB_BASE);
+wire wb_fb_sel   = (I_wb_adr >= ADDR_FB_BASE) && (I_wb_adr < ADDR_LINE_BASE);
+wire wb_line_sel = (I_wb_adr >= ADDR_LINE_BASE);
 
 // ==============================================================================
 // Instantiate HDMI PHY (always needed)
@@ -75,6 +187,7 @@ wire pix_clk_5x;
 wire hdmi_rst_n;
 wire [11:0] h_cnt, v_cnt;
 wire [11:0] active_x, active_y;
+wire [11:0] h_res, v_res;
 wire phy_de, phy_hs, phy_vs;
 
 // Video input to PHY (selected by mode mux)
@@ -85,6 +198,7 @@ hdmi_phy_720p u_hdmi_phy
 (
     .I_clk          (I_clk          ),
     .I_rst_n        (I_rst_n        ),
+    .I_timing_preset(timing_preset  ),
     
     .I_rgb_r        (rgb_r          ),
     .I_rgb_g        (rgb_g          ),
@@ -103,6 +217,8 @@ hdmi_phy_720p u_hdmi_phy
     .O_vs           (phy_vs         ),
     .O_active_x     (active_x       ),
     .O_active_y     (active_y       ),
+    .O_h_res        (h_res          ),
+    .O_v_res        (v_res          ),
     
     .O_tmds_clk_p   (O_tmds_clk_p   ),
     .O_tmds_clk_n   (O_tmds_clk_n   ),
@@ -153,8 +269,12 @@ wire text_ack;
 wire [7:0] text_dat;
 wire [7:0] text_rgb_r, text_rgb_g, text_rgb_b;
 wire text_rgb_de, text_rgb_hs, text_rgb_vs;
+wire fb_hold;  // STATE_CTRL.HOLD, from the framebuffer below
 
-wb_video_text u_text_mode
+wb_video_text #(
+    .CHAR_INIT_FILE (CHAR_INIT_FILE ),
+    .ATTR_INIT_FILE (ATTR_INIT_FILE )
+) u_text_mode
 (
     .I_wb_clk       (I_wb_clk       ),
     .I_wb_rst       (~I_rst_n       ),
@@ -165,6 +285,7 @@ wb_video_text u_text_mode
     .I_wb_cyc       (I_wb_cyc       ),
     .O_wb_ack       (text_ack       ),
     .O_wb_dat       (text_dat       ),
+    .I_hold         (fb_hold        ),
     
     .I_pix_clk      (pix_clk        ),
     .I_rst_n        (hdmi_rst_n     ),
@@ -190,15 +311,28 @@ wire [7:0] fb_dat;
 wire [7:0] fb_rgb_r, fb_rgb_g, fb_rgb_b;
 wire fb_rgb_de, fb_rgb_hs, fb_rgb_vs;
 
-wb_video_framebuffer u_framebuffer
+wb_video_framebuffer #(
+    .BOOT_WIDTH     (BOOT_WIDTH     ),
+    .BOOT_HEIGHT    (BOOT_HEIGHT    ),
+    .BOOT_FORMAT    (BOOT_FORMAT    ),
+    .BOOT_SCALE     (BOOT_SCALE     ),
+    .BOOT_VIEW_X    (BOOT_VIEW_X    ),
+    .BOOT_VIEW_Y    (BOOT_VIEW_Y    ),
+    .SPLASH_HI_FILE (SPLASH_HI_FILE ),
+    .SPLASH_LO_FILE (SPLASH_LO_FILE )
+) u_framebuffer
 (
     .I_wb_clk       (I_wb_clk       ),
     .I_wb_rst       (~I_rst_n       ),
-    .I_wb_adr       (I_wb_adr[14:0] - ADDR_FB_BASE[14:0]),
+    .I_wb_adr       (wb_fb_ctrl_sel ? (I_wb_adr[14:0] - ADDR_FB_CTRL[14:0]) :
+                     wb_line_sel    ? I_wb_adr[14:0]
+                                    : (I_wb_adr[14:0] - ADDR_FB_BASE[14:0])),
     .I_wb_dat       (I_wb_dat       ),
     .I_wb_we        (I_wb_we        ),
-    .I_wb_stb       (I_wb_stb && wb_fb_sel),
+    .I_wb_stb       (I_wb_stb && (wb_fb_sel || wb_fb_ctrl_sel || wb_line_sel)),
     .I_wb_cyc       (I_wb_cyc       ),
+    .I_wb_ctrl      (wb_fb_ctrl_sel ),
+    .I_wb_line      (wb_line_sel    ),
     .O_wb_ack       (fb_ack         ),
     .O_wb_dat       (fb_dat         ),
     
@@ -208,6 +342,8 @@ wb_video_framebuffer u_framebuffer
     .I_v_cnt        (v_cnt          ),
     .I_active_x     (active_x       ),
     .I_active_y     (active_y       ),
+    .I_h_res        (h_res          ),
+    .I_v_res        (v_res          ),
     .I_de           (phy_de         ),
     .I_hs           (phy_hs         ),
     .I_vs           (phy_vs         ),
@@ -217,18 +353,31 @@ wb_video_framebuffer u_framebuffer
     .O_rgb_b        (fb_rgb_b       ),
     .O_rgb_de       (fb_rgb_de      ),
     .O_rgb_hs       (fb_rgb_hs      ),
-    .O_rgb_vs       (fb_rgb_vs      )
+    .O_rgb_vs       (fb_rgb_vs      ),
+    .O_hold         (fb_hold        )
 );
 
 // ==============================================================================
 // Video Mode Multiplexer
 // ==============================================================================
-reg [1:0] video_mode_sync;
+// The mode switches at the start of a frame, never mid-picture, and is held
+// with the framebuffer state while STATE_CTRL.HOLD is set
+reg [1:0] video_mode_s1, video_mode_sync;
+reg [1:0] hold_sync;
+reg       mode_vs_prev;
 always @(posedge pix_clk or negedge hdmi_rst_n) begin
-    if (!hdmi_rst_n)
-        video_mode_sync <= 2'd0;
-    else
-        video_mode_sync <= video_mode;
+    if (!hdmi_rst_n) begin
+        video_mode_s1   <= BOOT_MODE;
+        video_mode_sync <= BOOT_MODE;
+        hold_sync       <= 2'b00;
+        mode_vs_prev    <= 1'b0;
+    end else begin
+        video_mode_s1 <= video_mode;
+        hold_sync     <= {hold_sync[0], fb_hold};
+        mode_vs_prev  <= phy_vs;
+        if (phy_vs && !mode_vs_prev && !hold_sync[1])
+            video_mode_sync <= video_mode_s1;
+    end
 end
 
 always @(posedge pix_clk or negedge hdmi_rst_n) begin
@@ -277,6 +426,28 @@ always @(posedge pix_clk or negedge hdmi_rst_n) begin
     end
 end
 
+// ==============================================================================
+// Frame CRC (on what the PHY is sent)
+// ==============================================================================
+wire [31:0] frame_crc_val;
+wire [7:0]  frame_count;
+reg  [23:0] frame_crc_snap;
+
+frame_crc u_frame_crc
+(
+    .I_pix_clk      (pix_clk        ),
+    .I_rst_n        (hdmi_rst_n     ),
+    .I_rgb_r        (rgb_r          ),
+    .I_rgb_g        (rgb_g          ),
+    .I_rgb_b        (rgb_b          ),
+    .I_rgb_de       (rgb_de         ),
+    .I_rgb_vs       (rgb_vs         ),
+
+    .I_wb_clk       (I_wb_clk       ),
+    .O_crc          (frame_crc_val  ),
+    .O_frames       (frame_count    )
+);
+
 // ==============================================================================
 // Wishbone Response Multiplexer
 // ==============================================================================
@@ -284,15 +455,101 @@ wire mode_ack = wb_mode_sel && I_wb_stb && I_wb_cyc;
 
 always @(posedge I_wb_clk or negedge I_rst_n) begin
     if (!I_rst_n) begin
-        video_mode <= 2'd0;
+        video_mode <= BOOT_MODE;
+        boot_load <= 1'b1;
+        timing_preset <= 2'd1;
+        epoch <= 8'd0;
+        link_crc <= 16'hFFFF;
+        link_exp_lo <= 8'd0;
+        link_done <= 1'b0;
+        link_fail <= 1'b0;
+        link_errors <= 16'd0;
+        link_checks <= 16'd0;
+        frame_crc_snap <= 24'd0;
         O_wb_ack <= 1'b0;
         O_wb_dat <= 8'd0;
     end else begin
+        // After a reset, take the mode the boot register asks for
+        boot_load <= 1'b0;
+        if (boot_load)
+            video_mode <= boot_mode;
+
+        // Link check: every write the host sees acked goes into the CRC
+        if (I_wb_stb && I_wb_cyc && I_wb_we && O_wb_ack && !wb_link_sel)
+            link_crc <= crc16_write(link_crc, {I_wb_adr, I_wb_dat});
+
         // Mode register access
         if (wb_mode_sel && I_wb_stb && I_wb_cyc) begin
+            case (I_wb_adr[3:0])
+                4'h1: begin
+                    if (I_wb_we && TIMING_PRESETS[I_wb_dat[1:0]])
+                        timing_preset <= I_wb_dat[1:0];
+                    O_wb_dat <= {6'b0, timing_preset};
+                end
+                4'h2: O_wb_dat <= {BOOT_SPLASH ? 1'b1 : 1'b0, BOOT_TEXT ? 1'b1 : 1'b0,
+                                   4'b0, boot_mode};
+                4'h4: begin
+                    if (!O_wb_ack) begin
+                        O_wb_dat <= frame_crc_val[7:0];
+                        frame_crc_snap <= frame_crc_val[31:8];
+                    end
+                end
+                4'h5: O_wb_dat <= frame_crc_snap[7:0];
+                4'h6: O_wb_dat <= frame_crc_snap[15:8];
+                4'h7: O_wb_dat <= frame_crc_snap[23:16];
+                4'h8: O_wb_dat <= frame_count;
+                default: begin
+                    if (I_wb_we)
+                        video_mode <= I_wb_dat[1:0];
+                    O_wb_dat <= {6'b0, video_mode};
+                end
+            endcase
+            O_wb_ack <= !O_wb_ack;
+        end
+        // Epoch register
+        else if (wb_epoch_sel && I_wb_stb && I_wb_cyc) begin
             if (I_wb_we)
-                video_mode <= I_wb_dat[1:0];
-            O_wb_dat <= {6'b0, video_mode};
+                epoch <= I_wb_dat;
+            O_wb_dat <= epoch;
+            O_wb_ack <= !O_wb_ack;
+        end
+        // Link check registers
+        else if (wb_link_sel && I_wb_stb && I_wb_cyc) begin
+            if (I_wb_we && !O_wb_ack) begin
+                case (I_wb_adr[2:0])
+                    3'h1: if (I_wb_dat[0]) begin
+                        link_crc <= 16'hFFFF;
+                        link_done <= 1'b0;
+                        link_fail <= 1'b0;
+                    end
+                    3'h2: link_exp_lo <= I_wb_dat;
+                    3'h3: begin
+                        link_done <= 1'b1;
+                        link_fail <= {I_wb_dat, link_exp_lo} != link_crc;
+                        link_checks <= link_checks + 1'b1;
+                        if ({I_wb_dat, link_exp_lo} != link_crc)
+                            link_errors <= link_errors + 1'b1;
+                    end
+                    default: begin
+                        link_errors <= 16'd0;
+                        link_checks <= 16'd0;
+                    end
+                endcase
+            end
+            case (I_wb_adr[2:0])
+                3'h1: O_wb_dat <= {1'b1, 5'b0, link_done, link_fail};
+                3'h2: O_wb_dat <= link_crc[7:0];
+                3'h3: O_wb_dat <= link_crc[15:8];
+                3'h4: O_wb_dat <= link_errors[7:0];
+                3'h5: O_wb_dat <= link_errors[15:8];
+                3'h6: O_wb_dat <= link_checks[7:0];
+                default: O_wb_dat <= link_checks[15:8];
+            endcase
+            O_wb_ack <= !O_wb_ack;
+        end
+        // Reserved range - ack so the bridge never stalls, read as 0
+        else if (wb_rsvd_sel && I_wb_stb && I_wb_cyc) begin
+            O_wb_dat <= 8'd0;
             O_wb_ack <= !O_wb_ack;
         end
         // Mux sub-module responses
@@ -304,7 +561,7 @@ always @(posedge I_wb_clk or negedge I_rst_n) begin
             O_wb_ack <= text_ack;
             O_wb_dat <= text_dat;
         end
-        else if (wb_fb_sel) begin
+        else if (wb_fb_sel || wb_fb_ctrl_sel || wb_line_sel) begin
             O_wb_ack <= fb_ack;
             O_wb_dat <= fb_dat;
         end
@@ -44,6 +44,7 @@ hdmi_phy_720p u_hdmi_phy
 (
     .I_clk          (I_clk          ),
     .I_rst_n        (I_rst_n        ),
+    .I_timing_preset(2'd1           ), // 720p60
     
     .I_rgb_r        (rgb_r          ),
     .I_rgb_g        (rgb_g          ),
@@ -62,6 +63,8 @@ hdmi_phy_720p u_hdmi_phy
     .O_vs           (phy_vs         ),
     .O_active_x     (active_x       ),
     .O_active_y     (active_y       ),
+    .O_h_res        (               ), // Not used
+    .O_v_res        (               ), // Not used
     
     .O_tmds_clk_p   (O_tmds_clk_p   ),
     .O_tmds_clk_n   (O_tmds_clk_n   ),
@@ -56,16 +56,24 @@ module wb_hdmi_colorbar (
     
     // HDMI timing generator
     wire hsync, vsync, video_active;
-    wire [9:0] pixel_x, pixel_y;
+    wire [11:0] pixel_x, pixel_y;
     
     hdmi_timing u_timing (
         .clk_pixel(clk_pixel),
         .rst(rst),
+        .preset(2'd0),  // 640x480@60
         .hsync(hsync),
         .vsync(vsync),
         .video_active(video_active),
+        .sync_neg(),
+        .h_cnt(),
+        .v_cnt(),
         .pixel_x(pixel_x),
-        .pixel_y(pixel_y)
+        .pixel_y(pixel_y),
+        .h_res(),
+        .v_res(),
+        .h_start(),
+        .v_start()
     );
     
     // Color bar generator
@@ -74,8 +82,8 @@ module wb_hdmi_colorbar (
     color_bar_generator u_colorbar (
         .clk(clk_pixel),
         .video_active(video_active),
-        .pixel_x(pixel_x),
-        .pixel_y(pixel_y),
+        .pixel_x(pixel_x[9:0]),
+        .pixel_y(pixel_y[9:0]),
         .enable(enable),
         .red(red),
         .green(green),
@@ -1,37 +1,195 @@
 // ==============================================================================
 // wb_video_framebuffer.v - Wishbone Framebuffer Video Generator
 // ==============================================================================
-// Standalone 160x120 RGB332 framebuffer with Wishbone interface.
-// Scaled 6x to 960x720 and centered in 1280x720 (160px black borders).
+// Framebuffer with runtime-configurable geometry, colour depth, integer scale,
+// viewport position and border colour. Default is 160x120 RGB332 scaled 6x to
+// 960x720 and centered in 1280x720 (160px borders), matching earlier builds.
+// The power-on geometry and VRAM contents are parameters, so a build can
+// show a boot splash from the moment the FPGA is configured.
 //
 // This module can be instantiated independently - just connect it to the
 // shared HDMI PHY layer (hdmi_phy_720p.v).
 //
-// Wishbone Interface:
-//   Address range: 0x0000 - 0x4AFF (19,200 pixels)
-//   Direct byte addressing: Pixel at (x,y) = address (y*160 + x)
-//   Each pixel is 8-bit RGB332: RRRGGGBB
+// Wishbone Interface (I_wb_ctrl = 0): VRAM
+//   Address range: 0x0000 - 0x7EFF (32,512 bytes)
+//   8bpp: pixel at (x,y) = address (y*width + x), RGB332 RRRGGGBB
+//   4bpp: pixel at (x,y) = address (y*((width+1)/2) + x/2), even x in the
+//         high nibble, odd x in the low nibble, palette index 0-15.
+//   Writes honour WMASK so a single 4bpp pixel can be written without a
+//   read-modify-write on the host, and go through the raster op (ROP).
+//   Reads return the VRAM byte. The read port belongs to scanout, so a read
+//   holds off its ack until scanout leaves the port idle for a clock: on a
+//   repeated line of a scaled image, in blanking or during line streaming,
+//   that is at once; otherwise at the latest in the next horizontal blank.
 //
-// Memory: 19,200 bytes for 160x120 framebuffer
-// Output: Scaled to 960x720, centered in 1280x720 (160px black borders)
+// Wishbone Interface (I_wb_ctrl = 1): Registers
+//   0x00: WIDTH_LO      [7:0]  Source width in pixels
+//   0x01: WIDTH_HI      [0]    Source width bit 8
+//   0x02: HEIGHT_LO     [7:0]  Source height in lines
+//   0x03: HEIGHT_HI     [0]    Source height bit 8
+//   0x04: FORMAT        [0]    0 = 8bpp RGB332, 1 = 4bpp indexed
+//   0x05: SCALE         [3:0]  Integer scale factor (1-15, 0 treated as 1)
+//   0x06: VIEW_X_LO     [7:0]  Left edge of the image in the active area
+//   0x07: VIEW_X_HI     [3:0]
+//   0x08: VIEW_Y_LO     [7:0]  Top edge of the image in the active area
+//   0x09: VIEW_Y_HI     [3:0]
+//   0x0A: BORDER        [7:0]  RGB332 colour outside the image
+//   0x0B: WMASK         [1:0]  VRAM write mask: [1] = high nibble, [0] = low
+//   0x0C: HRES_LO (RO)         Active width of the current timing preset
+//   0x0D: HRES_HI (RO)
+//   0x0E: VRES_LO (RO)         Active height of the current timing preset
+//   0x0F: VRES_HI (RO)
+//   0x10-0x1F: PALETTE         RGB332 colour for 4bpp index 0-15
+//   0x20: LS_CTRL       [0]    Line stream enable (see below)
+//   0x21: LS_CREDIT            R: free line buffers, W: commit the write line
+//   0x22: LS_NEXT_LO (RO)      Source line the next commit will be shown on
+//   0x23: LS_NEXT_HI (RO) [0]
+//   0x24: LS_UNDER_LO          Lines shown without data; a write clears both
+//   0x25: LS_UNDER_HI
+//   0x26: LS_LINES (RO)        Line buffers in the ring (4)
+//   0x30: LAYER_CTRL    [0]    Dual playfield enable (4bpp, scale 2 or more)
+//                       [1]    0 = layer 1 in front, 1 = layer 0 in front
+//   0x31: L0_CTRL       [3:0]  Layer 0 transparent index
+//                       [4]    Layer 0 transparency enable
+//                       [5]    Layer 0 palette bank
+//   0x32: L0_SCROLL_X_LO       Layer 0 horizontal scroll (0 to WIDTH-1)
+//   0x33: L0_SCROLL_X_HI [0]
+//   0x34: L0_SCROLL_Y_LO       Layer 0 vertical scroll (0 to HEIGHT-1)
+//   0x35: L0_SCROLL_Y_HI [0]
+//   0x36-0x3A: L1_CTRL, L1_SCROLL_X_LO/HI, L1_SCROLL_Y_LO/HI, as for layer 0
+//   0x40-0x4F: PALETTE1        Palette bank 1, same layout as PALETTE
+//   0x50: AFF_CTRL      [0]    Affine scanout enable
+//                       [1]    Per-line parameters from the line table
+//                       [2]    0 = wrap texels, 1 = clamp to the edge
+//   0x54-0x56: AFF_U0          Texel u of image pixel (0,0), LO/MID/HI
+//   0x58-0x5A: AFF_V0          Texel v of image pixel (0,0)
+//   0x5C-0x5E: AFF_DUDX        u step per source pixel
+//   0x60-0x62: AFF_DVDX        v step per source pixel
+//   0x64-0x66: AFF_DUDY        u step per source line
+//   0x68-0x6A: AFF_DVDY        v step per source line
+//              All signed 24-bit with 8 fraction bits (0x000100 = 1 texel)
+//   0x70: WIN_BASE_LO          Write window: VRAM byte offset of the top-left
+//   0x71: WIN_BASE_HI   [6:0]
+//   0x72: WIN_W_LO             Window width in bytes (1-511)
+//   0x73: WIN_W_HI      [0]
+//   0x74: WIN_H_LO             Window height in rows (1-511)
+//   0x75: WIN_H_HI      [0]
+//   0x76: WIN_DATA (WO)        Write the byte at the window pointer
+//   0x77: ROP           [2:0]  VRAM write mode: 0 = replace, 1 = XOR,
+//                              2 = AND, 3 = OR, 4 = skip if equal to KEY
+//   0x78: ROP_KEY              Transparent colour for ROP 4
+//   0x79: STATE_CTRL    [0]    HOLD: keep showing the latched display state
+//                       [1]    PENDING (RO): released, not latched yet
+//
+// Raster ops: XOR, AND and OR combine the written byte with the one in
+// VRAM. The VRAM write port reads as well, so the read-modify-write takes
+// one extra Wishbone clock and never touches the scanout read port. ROP 4
+// drops writes of the key colour; in 4bpp each nibble is compared on its
+// own, so KEY should hold the transparent index in both nibbles. WMASK
+// applies on top. The ROP covers VRAM and WIN_DATA writes only.
+//
+// Write window: WIN_DATA writes VRAM at the window pointer (honouring
+// WMASK) and advances it along the row, then to the start of the next row
+// one stride down, and after the last row back to the top-left. Writing
+// any of 0x70-0x75 rewinds the pointer. A rectangle of any width then
+// goes up as one stream of frames to a single address, and an upload that
+// covers the whole window leaves the pointer ready for the next one.
+//
+// Line stream (I_wb_line = 1): 0x000-0x1FF is the write line, one byte per
+// 8bpp pixel or two 4bpp pixels, laid out like one VRAM row.
+//   With LS_CTRL set, scanout reads from a ring of LS_LINES line buffers
+//   instead of VRAM, from the next frame on, so width x height is not bound
+//   by VRAM. The host fills the write line, then commits it to LS_CREDIT;
+//   commits are shown in order on consecutive source lines, wrapping from
+//   the last line of a frame to line 0 of the next. A buffer is freed once
+//   its line has been scanned scale times. A source line that comes up with
+//   no committed buffer is drawn in the border colour and counted as an
+//   underflow, and LS_NEXT skips past it so the host can catch up. Commits
+//   with no free buffer are dropped. Geometry, format, scale, palette and
+//   viewport are shared with VRAM scanout; the image must fit on screen.
+//
+// Affine line table (I_wb_line = 1): 0x800-0xFFF, 8 bytes per source line
+// (up to 256 lines): U, V as signed 12.4, then DUDX, DVDX as signed 8.8,
+// each LO then HI. In per-line mode each source line starts at (U, V) and
+// steps by (DUDX, DVDX); AFF_U0 to AFF_DVDY are not used.
+//
+// Affine scanout: with AFF_CTRL[0] set, image pixel (x, y) shows texel
+//   u = U0 + x * DUDX + y * DUDY,  v = V0 + x * DVDX + y * DVDY
+// of the WIDTH x HEIGHT image in VRAM, so rotation, zoom and shear cost a
+// few register writes per frame. Clamp mode repeats the edge texels. Wrap
+// mode tiles the image; it wraps incrementally, so U0/V0 must lie inside
+// the image and every step must be smaller than its size (the host
+// reduces them). Texel addressing uses one multiplier. Takes precedence
+// over dual playfield; the line stream takes precedence over both.
+//
+// Dual playfield: with LAYER_CTRL[0] set in 4bpp, VRAM holds two WIDTH x
+// HEIGHT playfields, layer 0 at offset 0 and layer 1 at stride * height.
+// Each is scrolled on its own, wrapping at the playfield edges, and looked
+// up in its own palette bank. The front layer shows the back one through
+// its transparent index; where both are transparent the border colour
+// shows. Each source pixel reads layer 0 on its first clock and layer 1 on
+// its second, so at scale 1 only layer 0 is shown, unscrolled.
+//
+// Line cache: in plain VRAM scanout each source line is read from VRAM once,
+// on its first scaled output line, and kept in a 512-byte line cache that
+// the other scale - 1 lines replay. Those lines leave the VRAM read port to
+// host readback. A write to a line already cached shows from its next
+// source line or the next frame. Dual playfield reads both layers on the
+// first two clocks of each source pixel and leaves the rest free; affine
+// scanout uses the port on every active clock.
+//
+// Geometry registers are latched into the pixel domain at the start of each
+// frame, so a reconfiguration never shows a half-old, half-new picture. The
+// same latch covers viewport, border, layers, scroll and affine parameters,
+// and both palettes, which scanout reads from a copy taken there. While
+// STATE_CTRL.HOLD is set the latch is skipped, so a multi-register update
+// lands all at once at the first frame start after HOLD is cleared; PENDING
+// reads 1 until then. O_hold lets the top level hold its video mode too.
+// The affine line table and the line stream are not held.
+// Outside line stream mode the host is responsible for keeping
+// stride * height within VRAM_SIZE.
+//
+// Memory: 32,512 bytes (two 4-bit banks) - e.g. 160x120 @ 8bpp,
+//         240x120 @ 8bpp, 320x180 @ 4bpp or 320x200 @ 4bpp.
+//         Dual playfield fits two 160x120 or 240x120 layers.
+//         Plus a 2 KB line stream ring, e.g. 320x240 @ 8bpp 2x or
+//         480x360 @ 4bpp 2x streamed without a full-frame buffer.
+//         Plus a 2 KB affine line table (256 lines) and a 512-byte
+//         scanout line cache.
 //
 // Usage: Instantiate this module and hdmi_phy_720p, connect RGB outputs
 //        from this module to the PHY's RGB inputs.
 // ==============================================================================
 
-module wb_video_framebuffer
+module wb_video_framebuffer #(
+    // Power-on geometry and VRAM contents (boot splash). The defaults are
+    // 160x120 RGB332 at 6x, centered in 720p, with VRAM undefined.
+    // SPLASH_HI/LO_FILE hold the high and low nibble of each VRAM byte
+    // for $readmemh; gateware/tools/splash2mem.py writes them from an
+    // image along with the matching BOOT_* values.
+    parameter BOOT_WIDTH     = 160,
+    parameter BOOT_HEIGHT    = 120,
+    parameter BOOT_FORMAT    = 0,
+    parameter BOOT_SCALE     = 6,
+    parameter BOOT_VIEW_X    = 160,
+    parameter BOOT_VIEW_Y    = 0,
+    parameter SPLASH_HI_FILE = "",
+    parameter SPLASH_LO_FILE = ""
+)
 (
     // Wishbone slave interface
     input             I_wb_clk        ,
     input             I_wb_rst        ,
-    input      [14:0] I_wb_adr        , // 15-bit for word-aligned addressing
+    input      [14:0] I_wb_adr        , // VRAM byte offset or register index
     input      [7:0]  I_wb_dat        ,
     input             I_wb_we         ,
     input             I_wb_stb        ,
     input             I_wb_cyc        ,
+    input             I_wb_ctrl       , // 1 = register access, 0 = VRAM
+    input             I_wb_line       , // 1 = line stream write line
     output reg        O_wb_ack        ,
     output reg [7:0]  O_wb_dat        ,
-    
+
     // Video timing inputs (from HDMI PHY)
     input             I_pix_clk       ,
     input             I_rst_n         ,
@@ -39,137 +197,780 @@ module wb_video_framebuffer
     input      [11:0] I_v_cnt         ,
     input      [11:0] I_active_x      ,
     input      [11:0] I_active_y      ,
+    input      [11:0] I_h_res         ,
+    input      [11:0] I_v_res         ,
     input             I_de            ,
     input             I_hs            ,
     input             I_vs            ,
-    
+
     // RGB output (directly to HDMI PHY)
     output reg [7:0]  O_rgb_r         ,
     output reg [7:0]  O_rgb_g         ,
     output reg [7:0]  O_rgb_b         ,
     output reg        O_rgb_de        ,
     output reg        O_rgb_hs        ,
-    output reg        O_rgb_vs        
+    output reg        O_rgb_vs        ,
+
+    // STATE_CTRL.HOLD (Wishbone clock domain)
+    output            O_hold
 );
 
 // ==============================================================================
 // Parameters
 // ==============================================================================
-localparam H_SYNC     = 12'd40;
-localparam H_BPORCH   = 12'd220;
-localparam H_ACTIVE   = 12'd1280;
-localparam V_SYNC     = 12'd5;
-localparam V_BPORCH   = 12'd20;
-localparam V_ACTIVE   = 12'd720;
+localparam VRAM_SIZE  = 32512;  // 0x0100-0x7FFF window in the top-level map
+
+// Power-on geometry (BOOT_* parameters)
+localparam [8:0]  DEF_WIDTH  = BOOT_WIDTH;
+localparam [8:0]  DEF_HEIGHT = BOOT_HEIGHT;
+localparam        DEF_FORMAT = (BOOT_FORMAT != 0);
+localparam [3:0]  DEF_SCALE  = BOOT_SCALE;
+localparam [11:0] DEF_VIEW_X = BOOT_VIEW_X;
+localparam [11:0] DEF_VIEW_Y = BOOT_VIEW_Y;
+
+// Line stream ring: LS_LINES buffers of 512 bytes (one 511-pixel 8bpp row)
+localparam LS_LINES   = 3'd4;
+
+// ==============================================================================
+// Control registers (Wishbone clock domain)
+// ==============================================================================
+reg [8:0]  cfg_width;
+reg [8:0]  cfg_height;
+reg        cfg_format;
+reg [3:0]  cfg_scale;
+reg [11:0] cfg_view_x;
+reg [11:0] cfg_view_y;
+reg [7:0]  cfg_border;
+reg [1:0]  cfg_wmask;
+reg [1:0]  cfg_layer_ctrl;
+reg [5:0]  cfg_l0_ctrl, cfg_l1_ctrl;
+reg [8:0]  cfg_l0_sx, cfg_l0_sy;
+reg [8:0]  cfg_l1_sx, cfg_l1_sy;
+reg [2:0]  cfg_aff_ctrl;
+reg [23:0] cfg_aff_u0, cfg_aff_v0;
+reg [23:0] cfg_aff_dudx, cfg_aff_dvdx;
+reg [23:0] cfg_aff_dudy, cfg_aff_dvdy;
+reg [14:0] cfg_win_base;
+reg [8:0]  cfg_win_w, cfg_win_h;
+reg [2:0]  cfg_rop;
+reg [7:0]  cfg_rop_key;
+reg        cfg_hold;
+reg        commit_pend, commit_ref;   // STATE_CTRL.PENDING
+reg [2:0]  latch_sync;
+
+assign O_hold = cfg_hold;
+
+// 4bpp palettes (written from Wishbone, copied to pal_act / pal1_act at
+// frame start for scanout). Bank 1 starts as a copy of bank 0.
+reg [7:0] palette  [0:15];
+reg [7:0] palette1 [0:15];
+reg [7:0] pal_act  [0:15];
+reg [7:0] pal1_act [0:15];
+integer   pal_i;
+
+initial begin
+    palette[0]  = 8'h00;  // Black
+    palette[1]  = 8'h02;  // Blue
+    palette[2]  = 8'h14;  // Green
+    palette[3]  = 8'h16;  // Cyan
+    palette[4]  = 8'hA0;  // Red
+    palette[5]  = 8'hA2;  // Magenta
+    palette[6]  = 8'hA8;  // Brown
+    palette[7]  = 8'hB6;  // Light gray
+    palette[8]  = 8'h49;  // Dark gray
+    palette[9]  = 8'h4B;  // Light blue
+    palette[10] = 8'h5D;  // Light green
+    palette[11] = 8'h5F;  // Light cyan
+    palette[12] = 8'hE9;  // Light red
+    palette[13] = 8'hEB;  // Light magenta
+    palette[14] = 8'hFD;  // Yellow
+    palette[15] = 8'hFF;  // White
+    for (pal_i = 0; pal_i < 16; pal_i = pal_i + 1) begin
+        palette1[pal_i] = palette[pal_i];
+        pal_act[pal_i]  = palette[pal_i];
+        pal1_act[pal_i] = palette[pal_i];
+    end
+end
+
+// Active resolution from the pixel domain (static, double-flopped)
+reg [11:0] h_res_s1, h_res_s2;
+reg [11:0] v_res_s1, v_res_s2;
+
+always @(posedge I_wb_clk) begin
+    h_res_s1 <= I_h_res;
+    h_res_s2 <= h_res_s1;
+    v_res_s1 <= I_v_res;
+    v_res_s2 <= v_res_s1;
+end
+
+wire wb_valid = I_wb_stb && I_wb_cyc;
+wire wb_reg_write = wb_valid && I_wb_we && I_wb_ctrl;
+
+always @(posedge I_wb_clk or posedge I_wb_rst) begin
+    if (I_wb_rst) begin
+        cfg_width  <= DEF_WIDTH;
+        cfg_height <= DEF_HEIGHT;
+        cfg_format <= DEF_FORMAT;
+        cfg_scale  <= DEF_SCALE;
+        cfg_view_x <= DEF_VIEW_X;
+        cfg_view_y <= DEF_VIEW_Y;
+        cfg_border <= 8'h00;
+        cfg_wmask  <= 2'b11;
+        cfg_layer_ctrl <= 2'b00;
+        cfg_l0_ctrl    <= 6'h00;   // bank 0, opaque
+        cfg_l1_ctrl    <= 6'h30;   // bank 1, index 0 transparent
+        cfg_l0_sx      <= 9'd0;
+        cfg_l0_sy      <= 9'd0;
+        cfg_l1_sx      <= 9'd0;
+        cfg_l1_sy      <= 9'd0;
+        cfg_aff_ctrl   <= 3'd0;
+        cfg_aff_u0     <= 24'd0;
+        cfg_aff_v0     <= 24'd0;
+        cfg_aff_dudx   <= 24'h000100;  // identity
+        cfg_aff_dvdx   <= 24'd0;
+        cfg_aff_dudy   <= 24'd0;
+        cfg_aff_dvdy   <= 24'h000100;
+        cfg_win_base   <= 15'd0;
+        cfg_win_w      <= 9'd1;
+        cfg_win_h      <= 9'd1;
+        cfg_rop        <= 3'd0;
+        cfg_rop_key    <= 8'h00;
+        cfg_hold       <= 1'b0;
+    end else if (wb_reg_write) begin
+        case (I_wb_adr[6:0])
+            7'h00: cfg_width[7:0]   <= I_wb_dat;
+            7'h01: cfg_width[8]     <= I_wb_dat[0];
+            7'h02: cfg_height[7:0]  <= I_wb_dat;
+            7'h03: cfg_height[8]    <= I_wb_dat[0];
+            7'h04: cfg_format       <= I_wb_dat[0];
+            7'h05: cfg_scale        <= I_wb_dat[3:0];
+            7'h06: cfg_view_x[7:0]  <= I_wb_dat;
+            7'h07: cfg_view_x[11:8] <= I_wb_dat[3:0];
+            7'h08: cfg_view_y[7:0]  <= I_wb_dat;
+            7'h09: cfg_view_y[11:8] <= I_wb_dat[3:0];
+            7'h0A: cfg_border       <= I_wb_dat;
+            7'h0B: cfg_wmask        <= I_wb_dat[1:0];
+            7'h30: cfg_layer_ctrl   <= I_wb_dat[1:0];
+            7'h31: cfg_l0_ctrl      <= I_wb_dat[5:0];
+            7'h32: cfg_l0_sx[7:0]   <= I_wb_dat;
+            7'h33: cfg_l0_sx[8]     <= I_wb_dat[0];
+            7'h34: cfg_l0_sy[7:0]   <= I_wb_dat;
+            7'h35: cfg_l0_sy[8]     <= I_wb_dat[0];
+            7'h36: cfg_l1_ctrl      <= I_wb_dat[5:0];
+            7'h37: cfg_l1_sx[7:0]   <= I_wb_dat;
+            7'h38: cfg_l1_sx[8]     <= I_wb_dat[0];
+            7'h39: cfg_l1_sy[7:0]   <= I_wb_dat;
+            7'h3A: cfg_l1_sy[8]     <= I_wb_dat[0];
+            7'h50: cfg_aff_ctrl        <= I_wb_dat[2:0];
+            7'h54: cfg_aff_u0[7:0]     <= I_wb_dat;
+            7'h55: cfg_aff_u0[15:8]    <= I_wb_dat;
+            7'h56: cfg_aff_u0[23:16]   <= I_wb_dat;
+            7'h58: cfg_aff_v0[7:0]     <= I_wb_dat;
+            7'h59: cfg_aff_v0[15:8]    <= I_wb_dat;
+            7'h5A: cfg_aff_v0[23:16]   <= I_wb_dat;
+            7'h5C: cfg_aff_dudx[7:0]   <= I_wb_dat;
+            7'h5D: cfg_aff_dudx[15:8]  <= I_wb_dat;
+            7'h5E: cfg_aff_dudx[23:16] <= I_wb_dat;
+            7'h60: cfg_aff_dvdx[7:0]   <= I_wb_dat;
+            7'h61: cfg_aff_dvdx[15:8]  <= I_wb_dat;
+            7'h62: cfg_aff_dvdx[23:16] <= I_wb_dat;
+            7'h64: cfg_aff_dudy[7:0]   <= I_wb_dat;
+            7'h65: cfg_aff_dudy[15:8]  <= I_wb_dat;
+            7'h66: cfg_aff_dudy[23:16] <= I_wb_dat;
+            7'h68: cfg_aff_dvdy[7:0]   <= I_wb_dat;
+            7'h69: cfg_aff_dvdy[15:8]  <= I_wb_dat;
+            7'h6A: cfg_aff_dvdy[23:16] <= I_wb_dat;
+            7'h70: cfg_win_base[7:0]   <= I_wb_dat;
+            7'h71: cfg_win_base[14:8]  <= I_wb_dat[6:0];
+            7'h72: cfg_win_w[7:0]      <= I_wb_dat;
+            7'h73: cfg_win_w[8]        <= I_wb_dat[0];
+            7'h74: cfg_win_h[7:0]      <= I_wb_dat;
+            7'h75: cfg_win_h[8]        <= I_wb_dat[0];
+            7'h77: cfg_rop             <= I_wb_dat[2:0];
+            7'h78: cfg_rop_key         <= I_wb_dat;
+            7'h79: cfg_hold            <= I_wb_dat[0];
+            default: ;
+        endcase
+    end
+end
+
+always @(posedge I_wb_clk) begin
+    if (wb_reg_write && I_wb_adr[6:4] == 3'b001)
+        palette[I_wb_adr[3:0]] <= I_wb_dat;
+    if (wb_reg_write && I_wb_adr[6:4] == 3'b100)
+        palette1[I_wb_adr[3:0]] <= I_wb_dat;
+end
+
+// ==============================================================================
+// Line stream - Wishbone side
+// ==============================================================================
+// All bookkeeping the host sees lives here. The pixel domain reports each
+// freed buffer and each underflow as a toggle; both happen at most once per
+// scanline, far slower than the two-flop synchronisers. Commits go the
+// other way the same way.
+
+reg        ls_enable;
+reg [1:0]  ls_wr_slot;     // buffer behind the write line
+reg [2:0]  ls_pending;     // committed buffers not yet freed
+reg [8:0]  ls_next_line;   // source line the next commit lands on
+reg [15:0] ls_underflows;
+reg        ls_commit_tgl;
+
+reg        ls_free_tgl;    // pixel domain
+reg        ls_under_tgl;   // pixel domain
+reg [2:0]  ls_free_sync, ls_under_sync;
+
+always @(posedge I_wb_clk) begin
+    ls_free_sync  <= {ls_free_sync[1:0], ls_free_tgl};
+    ls_under_sync <= {ls_under_sync[1:0], ls_under_tgl};
+end
+
+wire ls_freed     = ls_free_sync[2] ^ ls_free_sync[1];
+wire ls_underflow = ls_under_sync[2] ^ ls_under_sync[1];
+// STB stays up until the registered ack, so commit on the first clock only
+wire ls_commit    = wb_reg_write && (I_wb_adr[6:0] == 7'h21) && ls_enable &&
+                    (ls_pending != LS_LINES) && !O_wb_ack;
+
+// Commits and underflows each use up one source line
+wire [9:0] ls_next_sum = ls_next_line + ls_commit + (ls_underflow && ls_enable);
+
+always @(posedge I_wb_clk or posedge I_wb_rst) begin
+    if (I_wb_rst) begin
+        ls_enable     <= 1'b0;
+        ls_wr_slot    <= 2'd0;
+        ls_pending    <= 3'd0;
+        ls_next_line  <= 9'd0;
+        ls_underflows <= 16'd0;
+        ls_commit_tgl <= 1'b0;
+    end else if (wb_reg_write && I_wb_adr[6:0] == 7'h20 && I_wb_dat[0] != ls_enable) begin
+        // Starting the stream begins at line 0 of the next frame
+        ls_enable     <= I_wb_dat[0];
+        ls_wr_slot    <= 2'd0;
+        ls_pending    <= 3'd0;
+        ls_next_line  <= 9'd0;
+        ls_underflows <= 16'd0;
+    end else begin
+        if (ls_commit) begin
+            ls_wr_slot    <= ls_wr_slot + 1'b1;
+            ls_commit_tgl <= !ls_commit_tgl;
+        end
+        if (ls_commit && !(ls_freed && ls_pending != 3'd0))
+            ls_pending <= ls_pending + 1'b1;
+        else if (!ls_commit && ls_freed && ls_pending != 3'd0)
+            ls_pending <= ls_pending - 1'b1;
+
+        ls_next_line <= (ls_next_sum >= cfg_height) ? ls_next_sum - cfg_height : ls_next_sum;
+
+        if (wb_reg_write && I_wb_adr[6:1] == 6'h12)
+            ls_underflows <= 16'd0;
+        else if (ls_underflow && ls_enable)
+            ls_underflows <= ls_underflows + 1'b1;
+    end
+end
+
+// ==============================================================================
+// Write window - Wishbone side
+// ==============================================================================
+// The pointer is kept as a row start plus a column, so stepping to the next
+// row is one add of the stride. Geometry writes rewind it on the next clock.
+// Like the text mode's auto-advancing cursor, a data write acts only on the
+// first clock of its cycle.
 
-localparam FB_WIDTH   = 160;
-localparam FB_HEIGHT  = 120;
-localparam FB_SIZE    = FB_WIDTH * FB_HEIGHT;  // 19,200 pixels
+// The 4bpp round-up is done in 10 bits so width 511 gives 256, not 0
+wire [8:0] wb_stride = cfg_format ? (({1'b0, cfg_width} + 10'd1) >> 1) : cfg_width;
 
-localparam SCALE      = 6;
-localparam SCALED_W   = FB_WIDTH * SCALE;      // 960
-localparam SCALED_H   = FB_HEIGHT * SCALE;     // 720
+reg [14:0] win_row;
+reg [8:0]  win_col, win_line;
+reg        win_rewind;
+reg        rmw_pend;
 
-// Framebuffer region in active area
-localparam FB_X_START = (H_ACTIVE - SCALED_W) / 2;  // 160
-localparam FB_X_END   = FB_X_START + SCALED_W;       // 1120
+wire win_sel   = wb_reg_write && I_wb_adr[6:0] == 7'h76;
+wire win_write = win_sel && !O_wb_ack && !rmw_pend;
+
+always @(posedge I_wb_clk or posedge I_wb_rst) begin
+    if (I_wb_rst) begin
+        win_row    <= 15'd0;
+        win_col    <= 9'd0;
+        win_line   <= 9'd0;
+        win_rewind <= 1'b0;
+    end else begin
+        win_rewind <= wb_reg_write && I_wb_adr[6:3] == 4'b1110 && I_wb_adr[2:1] != 2'b11;
+        if (win_rewind) begin
+            win_row  <= cfg_win_base;
+            win_col  <= 9'd0;
+            win_line <= 9'd0;
+        end else if (win_write) begin
+            if (win_col + 1'b1 < cfg_win_w) begin
+                win_col <= win_col + 1'b1;
+            end else begin
+                win_col <= 9'd0;
+                if (win_line + 1'b1 < cfg_win_h) begin
+                    win_line <= win_line + 1'b1;
+                    win_row  <= win_row + wb_stride;
+                end else begin
+                    win_line <= 9'd0;
+                    win_row  <= cfg_win_base;
+                end
+            end
+        end
+    end
+end
 
 // ==============================================================================
-// Framebuffer Memory - Dual-Port RAM Instance
+// Framebuffer Memory - Dual-Port RAM Instances
 // ==============================================================================
 // Write port: Wishbone clock domain (27 MHz)
 // Read port: Pixel clock domain (74.25 MHz)
-// Using separate module for reliable Gowin BSRAM inference
+// Two 4-bit banks give nibble write enables for 4bpp single-pixel writes.
+// The write port also reads, for raster ops: the first clock of an XOR,
+// AND or OR write reads the old byte and the next clock writes the result.
+// Like WIN_DATA, it acts once per cycle.
 
-wire wb_valid = I_wb_stb && I_wb_cyc;
 wire [14:0] wb_pixel_addr = I_wb_adr[14:0];
-wire wb_write_en = wb_valid && I_wb_we && (wb_pixel_addr < FB_SIZE);
+wire [14:0] wb_wr_addr    = win_sel ? win_row + {6'b0, win_col} : wb_pixel_addr;
+wire        wb_vram_write = (wb_valid && I_wb_we && !I_wb_ctrl && !I_wb_line) || win_sel;
+
+wire       rop_rmw   = (cfg_rop == 3'd1) || (cfg_rop == 3'd2) || (cfg_rop == 3'd3);
+wire       rmw_start = rop_rmw && wb_vram_write && !O_wb_ack && !rmw_pend;
+reg [14:0] rmw_addr;
+reg [7:0]  rmw_dat;
+wire [7:0] vram_old;
+
+reg [7:0] rop_out;
+always @(*) begin
+    case (cfg_rop[1:0])
+        2'd1:    rop_out = vram_old ^ rmw_dat;
+        2'd2:    rop_out = vram_old & rmw_dat;
+        default: rop_out = vram_old | rmw_dat;
+    endcase
+end
+
+// Colour key: whole byte in 8bpp, each nibble on its own in 4bpp
+wire key_mode = (cfg_rop == 3'd4);
+wire key_hi   = key_mode && (I_wb_dat[7:4] == cfg_rop_key[7:4]) &&
+                (cfg_format || I_wb_dat[3:0] == cfg_rop_key[3:0]);
+wire key_lo   = key_mode && (I_wb_dat[3:0] == cfg_rop_key[3:0]) &&
+                (cfg_format || I_wb_dat[7:4] == cfg_rop_key[7:4]);
+
+wire [14:0] vram_wr_addr = rmw_pend ? rmw_addr : wb_wr_addr;
+wire [7:0]  vram_wr_data = rmw_pend ? rop_out : I_wb_dat;
+wire        vram_direct  = !rop_rmw && (win_sel ? win_write : wb_vram_write);
+wire wb_write_en = (vram_direct || rmw_pend) && (vram_wr_addr < VRAM_SIZE);
+wire wr_en_hi    = wb_write_en && cfg_wmask[1] && !(vram_direct && key_hi);
+wire wr_en_lo    = wb_write_en && cfg_wmask[0] && !(vram_direct && key_lo);
 
 // Read-side signals
 wire [7:0] fb_read_data;
 wire [14:0] fb_read_addr;
 wire fb_read_en;
 
-// Instantiate dual-port RAM
-framebuffer_ram #(
+framebuffer_ram_dp #(
     .ADDR_WIDTH(15),
+    .DATA_WIDTH(4),
+    .DEPTH(VRAM_SIZE),
+    .INIT_FILE(SPLASH_HI_FILE)
+) u_framebuffer_ram_hi (
+    .wr_clk     (I_wb_clk                    ),
+    .wr_en      (wr_en_hi                    ),
+    .wr_addr    (vram_wr_addr                ),
+    .wr_data    (vram_wr_data[7:4]           ),
+    .wr_rd_data (vram_old[7:4]               ),
+    .rd_clk     (I_pix_clk                   ),
+    .rd_en      (fb_read_en                  ),
+    .rd_addr    (fb_read_addr                ),
+    .rd_data    (fb_read_data[7:4]           )
+);
+
+framebuffer_ram_dp #(
+    .ADDR_WIDTH(15),
+    .DATA_WIDTH(4),
+    .DEPTH(VRAM_SIZE),
+    .INIT_FILE(SPLASH_LO_FILE)
+) u_framebuffer_ram_lo (
+    .wr_clk     (I_wb_clk                    ),
+    .wr_en      (wr_en_lo                    ),
+    .wr_addr    (vram_wr_addr                ),
+    .wr_data    (vram_wr_data[3:0]           ),
+    .wr_rd_data (vram_old[3:0]               ),
+    .rd_clk     (I_pix_clk                   ),
+    .rd_en      (fb_read_en                  ),
+    .rd_addr    (fb_read_addr                ),
+    .rd_data    (fb_read_data[3:0]           )
+);
+
+// Line stream ring, written through the write line window
+wire [7:0]  ls_read_data;
+wire [10:0] ls_read_addr;
+wire        ls_read_en;
+wire        ls_write_en = wb_valid && I_wb_we && I_wb_line && ls_enable &&
+                          (wb_pixel_addr[14:9] == 6'd0);
+
+framebuffer_ram #(
+    .ADDR_WIDTH(11),
+    .DATA_WIDTH(8),
+    .DEPTH(2048)
+) u_line_ram (
+    .wr_clk     (I_wb_clk                         ),
+    .wr_en      (ls_write_en                      ),
+    .wr_addr    ({ls_wr_slot, wb_pixel_addr[8:0]} ),
+    .wr_data    (I_wb_dat                         ),
+    .rd_clk     (I_pix_clk                        ),
+    .rd_en      (ls_read_en                       ),
+    .rd_addr    (ls_read_addr                     ),
+    .rd_data    (ls_read_data                     )
+);
+
+// Affine line table, written through 0x800-0xFFF of the line window
+wire [7:0]  aff_tab_data;
+wire [10:0] aff_tab_addr;
+wire        aff_tab_rd;
+wire        aff_tab_write_en = wb_valid && I_wb_we && I_wb_line &&
+                               (wb_pixel_addr[14:11] == 4'b0001);
+
+framebuffer_ram #(
+    .ADDR_WIDTH(11),
     .DATA_WIDTH(8),
-    .DEPTH(FB_SIZE)
-) u_framebuffer_ram (
-    // Write port (Wishbone clock)
-    .wr_clk     (I_wb_clk       ),
-    .wr_en      (wb_write_en    ),
-    .wr_addr    (wb_pixel_addr  ),
-    .wr_data    (I_wb_dat       ),
-    
-    // Read port (Pixel clock)
-    .rd_clk     (I_pix_clk      ),
-    .rd_en      (fb_read_en     ),
-    .rd_addr    (fb_read_addr   ),
-    .rd_data    (fb_read_data   )
+    .DEPTH(2048)
+) u_affine_table (
+    .wr_clk     (I_wb_clk                ),
+    .wr_en      (aff_tab_write_en        ),
+    .wr_addr    (wb_pixel_addr[10:0]     ),
+    .wr_data    (I_wb_dat                ),
+    .rd_clk     (I_pix_clk               ),
+    .rd_en      (aff_tab_rd              ),
+    .rd_addr    (aff_tab_addr            ),
+    .rd_data    (aff_tab_data            )
 );
 
-// ACK generation (no readback - simple dual port)
+// VRAM readback. The Wishbone side posts the address with a toggle and
+// holds it; the pixel side reads it on a clock scanout leaves free and
+// toggles back with the byte, which stays put until the next request.
+wire       wb_vram_read = wb_valid && !I_wb_we && !I_wb_ctrl && !I_wb_line;
+reg        rb_busy;
+reg [14:0] rb_addr;
+reg        rb_req_tgl;
+reg        rb_done_tgl;   // pixel domain
+reg [7:0]  rb_data;       // pixel domain
+reg [2:0]  rb_done_sync;
+
+always @(posedge I_wb_clk) rb_done_sync <= {rb_done_sync[1:0], rb_done_tgl};
+wire rb_done = rb_done_sync[2] ^ rb_done_sync[1];
+
+// ACK generation; VRAM reads ack once their byte is back, raster op
+// writes once the result is written
 always @(posedge I_wb_clk or posedge I_wb_rst) begin
     if (I_wb_rst) begin
+        O_wb_ack   <= 1'b0;
+        O_wb_dat   <= 8'h00;
+        rb_busy    <= 1'b0;
+        rb_req_tgl <= 1'b0;
+        rmw_pend   <= 1'b0;
+    end else if (rmw_pend) begin
+        O_wb_ack <= 1'b1;
+        rmw_pend <= 1'b0;
+    end else if (rmw_start) begin
         O_wb_ack <= 1'b0;
-        O_wb_dat <= 8'h00;
+        rmw_pend <= 1'b1;
+        rmw_addr <= wb_wr_addr;
+        rmw_dat  <= I_wb_dat;
+    end else if (rb_busy) begin
+        O_wb_ack <= rb_done;
+        O_wb_dat <= rb_data;
+        if (rb_done)
+            rb_busy <= 1'b0;
+    end else if (wb_vram_read) begin
+        O_wb_ack <= 1'b0;
+        if (!O_wb_ack) begin
+            rb_busy    <= 1'b1;
+            rb_addr    <= wb_pixel_addr;
+            rb_req_tgl <= !rb_req_tgl;
+        end
     end else begin
         O_wb_ack <= wb_valid;
-        O_wb_dat <= 8'h00;  // No readback supported
+        if (wb_valid && I_wb_ctrl) begin
+            case (I_wb_adr[6:0])
+                7'h00: O_wb_dat <= cfg_width[7:0];
+                7'h01: O_wb_dat <= {7'b0, cfg_width[8]};
+                7'h02: O_wb_dat <= cfg_height[7:0];
+                7'h03: O_wb_dat <= {7'b0, cfg_height[8]};
+                7'h04: O_wb_dat <= {7'b0, cfg_format};
+                7'h05: O_wb_dat <= {4'b0, cfg_scale};
+                7'h06: O_wb_dat <= cfg_view_x[7:0];
+                7'h07: O_wb_dat <= {4'b0, cfg_view_x[11:8]};
+                7'h08: O_wb_dat <= cfg_view_y[7:0];
+                7'h09: O_wb_dat <= {4'b0, cfg_view_y[11:8]};
+                7'h0A: O_wb_dat <= cfg_border;
+                7'h0B: O_wb_dat <= {6'b0, cfg_wmask};
+                7'h0C: O_wb_dat <= h_res_s2[7:0];
+                7'h0D: O_wb_dat <= {4'b0, h_res_s2[11:8]};
+                7'h0E: O_wb_dat <= v_res_s2[7:0];
+                7'h0F: O_wb_dat <= {4'b0, v_res_s2[11:8]};
+                7'h20: O_wb_dat <= {7'b0, ls_enable};
+                7'h21: O_wb_dat <= {5'b0, LS_LINES - ls_pending};
+                7'h22: O_wb_dat <= ls_next_line[7:0];
+                7'h23: O_wb_dat <= {7'b0, ls_next_line[8]};
+                7'h24: O_wb_dat <= ls_underflows[7:0];
+                7'h25: O_wb_dat <= ls_underflows[15:8];
+                7'h26: O_wb_dat <= {5'b0, LS_LINES};
+                7'h30: O_wb_dat <= {6'b0, cfg_layer_ctrl};
+                7'h31: O_wb_dat <= {2'b0, cfg_l0_ctrl};
+                7'h32: O_wb_dat <= cfg_l0_sx[7:0];
+                7'h33: O_wb_dat <= {7'b0, cfg_l0_sx[8]};
+                7'h34: O_wb_dat <= cfg_l0_sy[7:0];
+                7'h35: O_wb_dat <= {7'b0, cfg_l0_sy[8]};
+                7'h36: O_wb_dat <= {2'b0, cfg_l1_ctrl};
+                7'h37: O_wb_dat <= cfg_l1_sx[7:0];
+                7'h38: O_wb_dat <= {7'b0, cfg_l1_sx[8]};
+                7'h39: O_wb_dat <= cfg_l1_sy[7:0];
+                7'h3A: O_wb_dat <= {7'b0, cfg_l1_sy[8]};
+                7'h50: O_wb_dat <= {5'b0, cfg_aff_ctrl};
+                7'h54: O_wb_dat <= cfg_aff_u0[7:0];
+                7'h55: O_wb_dat <= cfg_aff_u0[15:8];
+                7'h56: O_wb_dat <= cfg_aff_u0[23:16];
+                7'h58: O_wb_dat <= cfg_aff_v0[7:0];
+                7'h59: O_wb_dat <= cfg_aff_v0[15:8];
+                7'h5A: O_wb_dat <= cfg_aff_v0[23:16];
+                7'h5C: O_wb_dat <= cfg_aff_dudx[7:0];
+                7'h5D: O_wb_dat <= cfg_aff_dudx[15:8];
+                7'h5E: O_wb_dat <= cfg_aff_dudx[23:16];
+                7'h60: O_wb_dat <= cfg_aff_dvdx[7:0];
+                7'h61: O_wb_dat <= cfg_aff_dvdx[15:8];
+                7'h62: O_wb_dat <= cfg_aff_dvdx[23:16];
+                7'h64: O_wb_dat <= cfg_aff_dudy[7:0];
+                7'h65: O_wb_dat <= cfg_aff_dudy[15:8];
+                7'h66: O_wb_dat <= cfg_aff_dudy[23:16];
+                7'h68: O_wb_dat <= cfg_aff_dvdy[7:0];
+                7'h69: O_wb_dat <= cfg_aff_dvdy[15:8];
+                7'h6A: O_wb_dat <= cfg_aff_dvdy[23:16];
+                7'h70: O_wb_dat <= cfg_win_base[7:0];
+                7'h71: O_wb_dat <= {1'b0, cfg_win_base[14:8]};
+                7'h72: O_wb_dat <= cfg_win_w[7:0];
+                7'h73: O_wb_dat <= {7'b0, cfg_win_w[8]};
+                7'h74: O_wb_dat <= cfg_win_h[7:0];
+                7'h75: O_wb_dat <= {7'b0, cfg_win_h[8]};
+                7'h77: O_wb_dat <= {5'b0, cfg_rop};
+                7'h78: O_wb_dat <= cfg_rop_key;
+                7'h79: O_wb_dat <= {6'b0, commit_pend, cfg_hold};
+                default: O_wb_dat <= (I_wb_adr[6:4] == 3'b001) ? palette[I_wb_adr[3:0]] :
+                                     (I_wb_adr[6:4] == 3'b100) ? palette1[I_wb_adr[3:0]] : 8'h00;
+            endcase
+        end else begin
+            O_wb_dat <= 8'h00;
+        end
+    end
+end
+
+// ==============================================================================
+// Configuration - synchronised and latched at frame start (pixel domain)
+// ==============================================================================
+reg [8:0]  width_s1, height_s1;
+reg        format_s1;
+reg [3:0]  scale_s1;
+reg [11:0] view_x_s1, view_y_s1;
+reg [7:0]  border_s1;
+reg [1:0]  layer_ctrl_s1;
+reg [5:0]  l0_ctrl_s1, l1_ctrl_s1;
+reg [8:0]  l0_sx_s1, l0_sy_s1, l1_sx_s1, l1_sy_s1;
+reg [2:0]  aff_ctrl_s1;
+reg [23:0] aff_u0_s1, aff_v0_s1, aff_dudx_s1, aff_dvdx_s1, aff_dudy_s1, aff_dvdy_s1;
+
+always @(posedge I_pix_clk) begin
+    width_s1  <= cfg_width;
+    height_s1 <= cfg_height;
+    format_s1 <= cfg_format;
+    scale_s1  <= cfg_scale;
+    view_x_s1 <= cfg_view_x;
+    view_y_s1 <= cfg_view_y;
+    border_s1 <= cfg_border;
+    layer_ctrl_s1 <= cfg_layer_ctrl;
+    l0_ctrl_s1 <= cfg_l0_ctrl;
+    l1_ctrl_s1 <= cfg_l1_ctrl;
+    l0_sx_s1 <= cfg_l0_sx;
+    l0_sy_s1 <= cfg_l0_sy;
+    l1_sx_s1 <= cfg_l1_sx;
+    l1_sy_s1 <= cfg_l1_sy;
+    aff_ctrl_s1 <= cfg_aff_ctrl;
+    aff_u0_s1   <= cfg_aff_u0;
+    aff_v0_s1   <= cfg_aff_v0;
+    aff_dudx_s1 <= cfg_aff_dudx;
+    aff_dvdx_s1 <= cfg_aff_dvdx;
+    aff_dudy_s1 <= cfg_aff_dudy;
+    aff_dvdy_s1 <= cfg_aff_dvdy;
+end
+
+reg [8:0]  fb_width, fb_height;
+reg        fb_format;
+reg [3:0]  fb_scale;
+reg [11:0] view_x, view_y;
+reg [7:0]  border;
+reg [8:0]  fb_stride;
+reg [12:0] scaled_w, scaled_h;
+reg        dual;            // dual playfield this frame
+reg        l0_front;
+reg [5:0]  l0_ctrl, l1_ctrl;
+reg [8:0]  l0_sx, l0_sy, l1_sx, l1_sy;
+reg [14:0] l0_row0, l1_row0;  // row offset of each layer's first line
+reg [14:0] l1_base;
+reg        affine;          // affine scanout this frame
+reg        aff_lines, aff_clamp;
+reg [23:0] aff_u0, aff_v0, aff_dudx, aff_dvdx, aff_dudy, aff_dvdy;
+
+reg vs_prev;
+wire vs_rise = I_vs && !vs_prev;
+always @(posedge I_pix_clk) vs_prev <= I_vs;
+
+// HOLD skips the frame-start latch; each latch toggles latch_tgl so the
+// Wishbone side can tell when a released update has landed
+reg [1:0] hold_sync;
+reg       latch_tgl;
+always @(posedge I_pix_clk) hold_sync <= {hold_sync[0], cfg_hold};
+wire state_latch = vs_rise && !hold_sync[1];
+
+always @(posedge I_pix_clk or negedge I_rst_n) begin
+    if (!I_rst_n)
+        latch_tgl <= 1'b0;
+    else if (state_latch)
+        latch_tgl <= !latch_tgl;
+end
+
+always @(posedge I_pix_clk) begin
+    if (state_latch) begin
+        for (pal_i = 0; pal_i < 16; pal_i = pal_i + 1) begin
+            pal_act[pal_i]  <= palette[pal_i];
+            pal1_act[pal_i] <= palette1[pal_i];
+        end
+    end
+end
+
+always @(posedge I_wb_clk) latch_sync <= {latch_sync[1:0], latch_tgl};
+
+always @(posedge I_wb_clk or posedge I_wb_rst) begin
+    if (I_wb_rst) begin
+        commit_pend <= 1'b0;
+        commit_ref  <= 1'b0;
+    end else if (wb_reg_write && I_wb_adr[6:0] == 7'h79 && cfg_hold && !I_wb_dat[0]) begin
+        commit_pend <= 1'b1;
+        commit_ref  <= latch_sync[2];
+    end else if (latch_sync[2] != commit_ref) begin
+        commit_pend <= 1'b0;
+    end
+end
+
+always @(posedge I_pix_clk or negedge I_rst_n) begin
+    if (!I_rst_n) begin
+        fb_width  <= DEF_WIDTH;
+        fb_height <= DEF_HEIGHT;
+        fb_format <= DEF_FORMAT;
+        fb_scale  <= DEF_SCALE;
+        view_x    <= DEF_VIEW_X;
+        view_y    <= DEF_VIEW_Y;
+        border    <= 8'h00;
+        dual      <= 1'b0;
+        l0_front  <= 1'b0;
+        l0_ctrl   <= 6'h00;
+        l1_ctrl   <= 6'h30;
+        l0_sx     <= 9'd0;
+        l0_sy     <= 9'd0;
+        l1_sx     <= 9'd0;
+        l1_sy     <= 9'd0;
+        affine    <= 1'b0;
+        aff_lines <= 1'b0;
+        aff_clamp <= 1'b0;
+    end else if (state_latch) begin
+        fb_width  <= width_s1;
+        fb_height <= height_s1;
+        fb_format <= format_s1;
+        fb_scale  <= (scale_s1 == 4'd0) ? 4'd1 : scale_s1;
+        view_x    <= view_x_s1;
+        view_y    <= view_y_s1;
+        border    <= border_s1;
+        dual      <= layer_ctrl_s1[0] && format_s1 && scale_s1 > 4'd1;
+        l0_front  <= layer_ctrl_s1[1];
+        l0_ctrl   <= l0_ctrl_s1;
+        l1_ctrl   <= l1_ctrl_s1;
+        l0_sx     <= l0_sx_s1;
+        l0_sy     <= l0_sy_s1;
+        l1_sx     <= l1_sx_s1;
+        l1_sy     <= l1_sy_s1;
+        affine    <= aff_ctrl_s1[0];
+        aff_lines <= aff_ctrl_s1[1];
+        aff_clamp <= aff_ctrl_s1[2];
+        aff_u0    <= aff_u0_s1;
+        aff_v0    <= aff_v0_s1;
+        aff_dudx  <= aff_dudx_s1;
+        aff_dvdx  <= aff_dvdx_s1;
+        aff_dudy  <= aff_dudy_s1;
+        aff_dvdy  <= aff_dvdy_s1;
     end
 end
 
+// Derived values (settle during vsync, long before the first active line)
+always @(posedge I_pix_clk) begin
+    fb_stride <= fb_format ? (({1'b0, fb_width} + 10'd1) >> 1) : fb_width;
+    scaled_w  <= fb_width * fb_scale;
+    scaled_h  <= fb_height * fb_scale;
+    l1_base   <= fb_stride * fb_height;
+    l0_row0   <= fb_stride * l0_sy;
+    l1_row0   <= fb_stride * l1_sy;
+end
+
 // ==============================================================================
 // Framebuffer Display - Scaling Logic
 // ==============================================================================
-// We need to read pixels from the framebuffer at 1/6th the rate
+// Each source pixel is repeated fb_scale times horizontally and each source
+// line fb_scale times vertically. Row addresses are accumulated, so no
+// multiplier sits in the scanout path.
 
-reg [2:0] h_scale_cnt;
-reg [2:0] v_scale_cnt;
-reg [7:0] src_x;
-reg [6:0] src_y;
+reg [3:0]  h_scale_cnt;
+reg [3:0]  v_scale_cnt;
+reg [8:0]  src_x;
+reg [14:0] row_base;
+reg        in_v_region;
 
-wire in_fb_region = I_de && (I_active_x >= FB_X_START) && (I_active_x < FB_X_END);
+wire in_h_region = (I_active_x >= view_x) && (I_active_x < view_x + scaled_w);
+wire in_fb_region = I_de && in_h_region && in_v_region;
 
 // Horizontal scaling counter
 always @(posedge I_pix_clk or negedge I_rst_n) begin
     if (!I_rst_n) begin
-        h_scale_cnt <= 3'd0;
-        src_x <= 8'd0;
+        h_scale_cnt <= 4'd0;
+        src_x <= 9'd0;
     end else begin
-        if (I_h_cnt == H_SYNC + H_BPORCH + FB_X_START - 1) begin
-            h_scale_cnt <= 3'd0;
-            src_x <= 8'd0;
-        end else if (in_fb_region && src_x < FB_WIDTH) begin
-            if (h_scale_cnt == 3'd5) begin
-                h_scale_cnt <= 3'd0;
-                src_x <= src_x + 1'b1;
-            end else begin
-                h_scale_cnt <= h_scale_cnt + 1'b1;
-            end
+        if (!in_fb_region) begin
+            h_scale_cnt <= 4'd0;
+            src_x <= 9'd0;
+        end else if (h_scale_cnt == fb_scale - 1'b1) begin
+            h_scale_cnt <= 4'd0;
+            src_x <= src_x + 1'b1;
+        end else begin
+            h_scale_cnt <= h_scale_cnt + 1'b1;
         end
     end
 end
 
-// Vertical scaling - track line ends
+// Vertical scaling - step once per line, at the end of hsync
 reg hs_prev;
 wire hs_tick = !I_hs && hs_prev;
 always @(posedge I_pix_clk) hs_prev <= I_hs;
 
 always @(posedge I_pix_clk or negedge I_rst_n) begin
     if (!I_rst_n) begin
-        v_scale_cnt <= 3'd0;
-        src_y <= 7'd0;
-    end else begin
-        if (I_v_cnt == V_SYNC + V_BPORCH - 1 && I_h_cnt == 0) begin
-            v_scale_cnt <= 3'd0;
-            src_y <= 7'd0;
-        end else if (hs_tick && (I_v_cnt >= V_SYNC + V_BPORCH) && (I_v_cnt < V_SYNC + V_BPORCH + V_ACTIVE)) begin
-            if (v_scale_cnt == 3'd5) begin
-                v_scale_cnt <= 3'd0;
-                if (src_y < FB_HEIGHT - 1)
-                    src_y <= src_y + 1'b1;
+        v_scale_cnt <= 4'd0;
+        row_base <= 15'd0;
+        in_v_region <= 1'b0;
+    end else if (vs_rise) begin
+        in_v_region <= 1'b0;
+    end else if (hs_tick) begin
+        if (I_active_y == view_y) begin
+            v_scale_cnt <= 4'd0;
+            row_base <= 15'd0;
+            in_v_region <= (scaled_h != 13'd0);
+        end else if (in_v_region) begin
+            if (I_active_y >= view_y + scaled_h) begin
+                in_v_region <= 1'b0;
+            end else if (v_scale_cnt == fb_scale - 1'b1) begin
+                v_scale_cnt <= 4'd0;
+                row_base <= row_base + fb_stride;
             end else begin
                 v_scale_cnt <= v_scale_cnt + 1'b1;
             end
@@ -177,49 +978,426 @@ always @(posedge I_pix_clk or negedge I_rst_n) begin
     end
 end
 
-// Calculate framebuffer address: y * 160 + x
-// 160 = 128 + 32 = (1 << 7) + (1 << 5)
-wire [14:0] y_times_128 = {1'b0, src_y, 7'b0};
-wire [14:0] y_times_32  = {3'b0, src_y, 5'b0};
-wire [14:0] fb_addr = y_times_128 + y_times_32 + {7'b0, src_x};
+// 8bpp: one byte per pixel. 4bpp: two pixels per byte, even x in high nibble.
+wire [14:0] fb_addr = fb_format ? (row_base + {7'b0, src_x[8:1]})
+                                : (row_base + {6'b0, src_x});
+
+// ==============================================================================
+// Dual playfield - per-layer scroll position
+// ==============================================================================
+// Each layer keeps its own source position, started at its scroll offset
+// and stepped with src_x / row_base, wrapping at the playfield size.
+
+reg [8:0]  l0_x, l1_x;
+reg [8:0]  l0_y, l1_y;
+reg [14:0] l0_row, l1_row;
+
+wire src_step = in_fb_region && (h_scale_cnt == fb_scale - 1'b1);
+
+always @(posedge I_pix_clk) begin
+    if (!in_fb_region) begin
+        l0_x <= l0_sx;
+        l1_x <= l1_sx;
+    end else if (src_step) begin
+        l0_x <= (l0_x + 1'b1 == fb_width) ? 9'd0 : l0_x + 1'b1;
+        l1_x <= (l1_x + 1'b1 == fb_width) ? 9'd0 : l1_x + 1'b1;
+    end
+end
+
+always @(posedge I_pix_clk) begin
+    if (hs_tick) begin
+        if (I_active_y == view_y) begin
+            l0_y   <= l0_sy;
+            l0_row <= l0_row0;
+            l1_y   <= l1_sy;
+            l1_row <= l1_base + l1_row0;
+        end else if (in_v_region && v_scale_cnt == fb_scale - 1'b1) begin
+            if (l0_y + 1'b1 == fb_height) begin
+                l0_y   <= 9'd0;
+                l0_row <= 15'd0;
+            end else begin
+                l0_y   <= l0_y + 1'b1;
+                l0_row <= l0_row + fb_stride;
+            end
+            if (l1_y + 1'b1 == fb_height) begin
+                l1_y   <= 9'd0;
+                l1_row <= l1_base;
+            end else begin
+                l1_y   <= l1_y + 1'b1;
+                l1_row <= l1_row + fb_stride;
+            end
+        end
+    end
+end
+
+// Layer 0 is read on the first clock of a source pixel, layer 1 on the second
+wire [14:0] l0_addr = l0_row + {7'b0, l0_x[8:1]};
+wire [14:0] l1_addr = l1_row + {7'b0, l1_x[8:1]};
+wire        rd_l1   = (h_scale_cnt == 4'd1);
+
+// ==============================================================================
+// Affine scanout
+// ==============================================================================
+// (u, v) accumulate per source pixel and per source line, the way src_x and
+// row_base do. In wrap mode every add folds the sum back into the image,
+// which is exact while the steps are smaller than the image. The texel
+// address is registered, a clock later than fb_addr; the pipeline's third
+// stage takes that up.
+
+wire [23:0] aff_w8 = {7'b0, fb_width, 8'b0};
+wire [23:0] aff_h8 = {7'b0, fb_height, 8'b0};
+
+function [23:0] aff_step;
+    input [23:0] acc;
+    input [23:0] step;
+    input [23:0] lim;
+    input        wrap;
+    reg   [23:0] sum;
+    begin
+        sum = acc + step;
+        if (!wrap)
+            aff_step = sum;
+        else if (sum[23])
+            aff_step = sum + lim;
+        else if (sum >= lim)
+            aff_step = sum - lim;
+        else
+            aff_step = sum;
+    end
+endfunction
+
+reg [23:0] aff_u, aff_v;          // current source pixel
+reg [23:0] aff_u_row, aff_v_row;  // first pixel of the current source line
+reg [23:0] aff_dx_u, aff_dx_v;    // per-pixel step on the current line
+reg [8:0]  aff_y;                 // source line, indexes the line table
+
+wire aff_first = hs_tick && I_active_y == view_y;
+wire aff_next  = hs_tick && in_v_region && I_active_y != view_y &&
+                 v_scale_cnt == fb_scale - 1'b1;
+
+// Per-line mode: fetch the line's 8 table bytes at the end of hsync, well
+// before the back porch ends
+reg        aff_fetch;
+reg [2:0]  aff_byte;
+reg        aff_got;
+reg [2:0]  aff_got_byte;
+reg [7:0]  aff_fetch_line;
+reg [63:0] aff_entry;
+wire [63:0] aff_entry_next = {aff_tab_data, aff_entry[63:8]};
+
+assign aff_tab_addr = {aff_fetch_line, aff_byte};
+assign aff_tab_rd   = aff_fetch;
+
+always @(posedge I_pix_clk or negedge I_rst_n) begin
+    if (!I_rst_n) begin
+        aff_fetch <= 1'b0;
+        aff_byte  <= 3'd0;
+        aff_got   <= 1'b0;
+    end else begin
+        aff_got      <= aff_fetch;
+        aff_got_byte <= aff_byte;
+        if (aff_lines && (aff_first || aff_next)) begin
+            aff_fetch      <= 1'b1;
+            aff_byte       <= 3'd0;
+            aff_fetch_line <= aff_first ? 8'd0 : aff_y[7:0] + 1'b1;
+        end else if (aff_fetch) begin
+            aff_byte  <= aff_byte + 1'b1;
+            if (aff_byte == 3'd7)
+                aff_fetch <= 1'b0;
+        end
+        if (aff_got)
+            aff_entry <= aff_entry_next;
+    end
+end
+
+always @(posedge I_pix_clk) begin
+    if (aff_first) begin
+        aff_y <= 9'd0;
+    end else if (aff_next) begin
+        aff_y <= aff_y + 1'b1;
+    end
+
+    if (aff_lines) begin
+        // U, V signed 12.4 and steps signed 8.8, widened to 24-bit x.8
+        if (aff_got && aff_got_byte == 3'd7) begin
+            aff_u_row <= {{4{aff_entry_next[15]}}, aff_entry_next[15:0], 4'b0};
+            aff_v_row <= {{4{aff_entry_next[31]}}, aff_entry_next[31:16], 4'b0};
+            aff_dx_u  <= {{8{aff_entry_next[47]}}, aff_entry_next[47:32]};
+            aff_dx_v  <= {{8{aff_entry_next[63]}}, aff_entry_next[63:48]};
+        end
+    end else if (aff_first) begin
+        aff_u_row <= aff_u0;
+        aff_v_row <= aff_v0;
+        aff_dx_u  <= aff_dudx;
+        aff_dx_v  <= aff_dvdx;
+    end else if (aff_next) begin
+        aff_u_row <= aff_step(aff_u_row, aff_dudy, aff_w8, !aff_clamp);
+        aff_v_row <= aff_step(aff_v_row, aff_dvdy, aff_h8, !aff_clamp);
+    end
+
+    if (!in_fb_region) begin
+        aff_u <= aff_u_row;
+        aff_v <= aff_v_row;
+    end else if (src_step) begin
+        aff_u <= aff_step(aff_u, aff_dx_u, aff_w8, !aff_clamp);
+        aff_v <= aff_step(aff_v, aff_dx_v, aff_h8, !aff_clamp);
+    end
+end
+
+// Texel under the current pixel; clamp mode repeats the edges
+wire [8:0] aff_tu = !aff_clamp ? aff_u[16:8] :
+                    aff_u[23] ? 9'd0 :
+                    (aff_u[23:8] >= fb_width) ? fb_width - 1'b1 : aff_u[16:8];
+wire [8:0] aff_tv = !aff_clamp ? aff_v[16:8] :
+                    aff_v[23] ? 9'd0 :
+                    (aff_v[23:8] >= fb_height) ? fb_height - 1'b1 : aff_v[16:8];
+
+reg [14:0] aff_addr;
+reg        aff_nibble;
+reg        aff_rd;
+
+always @(posedge I_pix_clk) begin
+    aff_addr   <= aff_tv * fb_stride + (fb_format ? {7'b0, aff_tu[8:1]} : {6'b0, aff_tu});
+    aff_nibble <= aff_tu[0];
+    aff_rd     <= in_fb_region;
+end
+
+// ==============================================================================
+// Line stream - pixel side
+// ==============================================================================
+// A source line starts where row_base would advance; the buffer that was
+// on screen is freed there, and at the end of the image or frame. Streaming
+// switches on at the first vsync after LS_CTRL is set and off at once.
+
+reg [2:0] ls_en_sync, ls_commit_sync;
+always @(posedge I_pix_clk) begin
+    ls_en_sync     <= {ls_en_sync[1:0], ls_enable};
+    ls_commit_sync <= {ls_commit_sync[1:0], ls_commit_tgl};
+end
+wire ls_committed = ls_commit_sync[2] ^ ls_commit_sync[1];
+
+reg       ls_active;    // this frame is streamed
+reg [2:0] ls_ready;     // committed buffers, including the one on screen
+reg [1:0] ls_rd_slot;
+reg       ls_line_ok;   // the current source line has a buffer
+
+wire ls_line_start = hs_tick && ((I_active_y == view_y && scaled_h != 13'd0) ||
+                     (in_v_region && I_active_y < view_y + scaled_h &&
+                      v_scale_cnt == fb_scale - 1'b1));
+wire ls_line_end   = hs_tick && in_v_region && I_active_y != view_y &&
+                     I_active_y >= view_y + scaled_h;
+wire ls_retire     = ls_line_ok && (ls_line_start || ls_line_end || vs_rise);
+wire [2:0] ls_ready_next = ls_ready + ls_committed - ls_retire;
+
+always @(posedge I_pix_clk or negedge I_rst_n) begin
+    if (!I_rst_n) begin
+        ls_active    <= 1'b0;
+        ls_ready     <= 3'd0;
+        ls_rd_slot   <= 2'd0;
+        ls_line_ok   <= 1'b0;
+        ls_free_tgl  <= 1'b0;
+        ls_under_tgl <= 1'b0;
+    end else if (!ls_en_sync[2]) begin
+        ls_active  <= 1'b0;
+        ls_ready   <= 3'd0;
+        ls_rd_slot <= 2'd0;
+        ls_line_ok <= 1'b0;
+    end else begin
+        if (vs_rise)
+            ls_active <= 1'b1;
+        ls_ready <= ls_ready_next;
+        if (ls_retire) begin
+            ls_rd_slot  <= ls_rd_slot + 1'b1;
+            ls_free_tgl <= !ls_free_tgl;
+        end
+        if (ls_line_start && ls_active) begin
+            ls_line_ok <= (ls_ready_next != 3'd0);
+            if (ls_ready_next == 3'd0)
+                ls_under_tgl <= !ls_under_tgl;
+        end else if (ls_retire) begin
+            ls_line_ok <= 1'b0;
+        end
+    end
+end
 
-// Connect to RAM read port
-assign fb_read_addr = fb_addr;
-assign fb_read_en = in_fb_region;
+// Streamed frames are plain; affine frames are single layer
+wire affine_on = affine && !ls_active;
+wire layers    = dual && !affine && !ls_active;
+wire plain     = !affine && !dual && !ls_active;
+
+// ==============================================================================
+// Line cache and VRAM read port arbitration
+// ==============================================================================
+// The first output line of each source line fills the cache from VRAM; the
+// repeats read the cache. Host readback gets the VRAM port on any clock
+// scanout does not need it.
+
+wire [8:0] col_addr  = fb_format ? {1'b0, src_x[8:1]} : src_x;
+wire       cache_hit = plain && in_v_region && v_scale_cnt != 4'd0;
+wire [7:0] cache_data;
+reg        cache_fill_d1;
+reg [8:0]  col_addr_d1;
+
+always @(posedge I_pix_clk) begin
+    cache_fill_d1 <= plain && in_fb_region && v_scale_cnt == 4'd0;
+    col_addr_d1   <= col_addr;
+end
+
+framebuffer_ram #(
+    .ADDR_WIDTH(9),
+    .DATA_WIDTH(8),
+    .DEPTH(512)
+) u_line_cache (
+    .wr_clk     (I_pix_clk                   ),
+    .wr_en      (cache_fill_d1               ),
+    .wr_addr    (col_addr_d1                 ),
+    .wr_data    (fb_read_data                ),
+    .rd_clk     (I_pix_clk                   ),
+    .rd_en      (in_fb_region && cache_hit   ),
+    .rd_addr    (col_addr                    ),
+    .rd_data    (cache_data                  )
+);
+
+wire scan_rd = affine_on ? aff_rd :
+               layers    ? in_fb_region && h_scale_cnt < 4'd2 :
+               plain     ? in_fb_region && !cache_hit : 1'b0;
+
+reg [2:0] rb_req_sync;
+reg       rb_pending;
+reg       rb_rd;
+wire      rb_grant = rb_pending && !scan_rd;
+
+always @(posedge I_pix_clk or negedge I_rst_n) begin
+    if (!I_rst_n) begin
+        rb_req_sync <= 3'd0;
+        rb_pending  <= 1'b0;
+        rb_rd       <= 1'b0;
+        rb_done_tgl <= 1'b0;
+    end else begin
+        rb_req_sync <= {rb_req_sync[1:0], rb_req_tgl};
+        rb_rd <= rb_grant;
+        if (rb_req_sync[2] ^ rb_req_sync[1])
+            rb_pending <= 1'b1;
+        else if (rb_grant)
+            rb_pending <= 1'b0;
+        if (rb_rd) begin
+            rb_data     <= fb_read_data;
+            rb_done_tgl <= !rb_done_tgl;
+        end
+    end
+end
+
+// Connect to RAM read ports
+assign fb_read_addr = rb_grant  ? rb_addr :
+                      affine_on ? aff_addr :
+                      layers    ? (rd_l1 ? l1_addr : l0_addr) : fb_addr;
+assign fb_read_en = scan_rd || rb_grant;
+assign ls_read_addr = {ls_rd_slot, col_addr};
+assign ls_read_en = in_fb_region && ls_active;
 
 // ==============================================================================
 // Pipeline for framebuffer read
 // ==============================================================================
 // Stage 1: Register flags (RAM has 1-cycle latency)
 reg in_fb_region_d1;
+reg nibble_d1;
+reg stream_d1, blank_d1;
+reg cache_d1;
+reg rd_l0_d1, rd_l1_d1;
+reg [1:0] l_nibble_d1;
+reg aff_nibble_d1;
 reg de_d1, hs_d1, vs_d1;
 
 always @(posedge I_pix_clk) begin
     in_fb_region_d1 <= in_fb_region;
+    stream_d1 <= ls_active;
+    cache_d1 <= cache_hit;
+    blank_d1 <= ls_active && !ls_line_ok;
+    nibble_d1 <= src_x[0];
+    rd_l0_d1 <= (h_scale_cnt == 4'd0);
+    rd_l1_d1 <= rd_l1;
+    if (rd_l1)
+        l_nibble_d1 <= {l1_x[0], l0_x[0]};
+    aff_nibble_d1 <= aff_nibble;
     de_d1 <= I_de;
     hs_d1 <= I_hs;
     vs_d1 <= I_vs;
 end
 
-// Stage 2: Capture RAM output
+// Stage 2: Capture RAM output. In dual playfield mode the layer 0 byte is
+// held until the layer 1 byte arrives, then both move on as a pair.
 reg [7:0] pixel_data;
+reg [7:0] l0_first;
+reg [7:0] l0_data, l1_data;
+reg [1:0] l_nibble;
+reg aff_nibble_d2;
 reg in_fb_region_d2;
+reg nibble_d2;
+reg blank_d2;
 reg de_d2, hs_d2, vs_d2;
 
 always @(posedge I_pix_clk) begin
-    pixel_data <= fb_read_data;
+    pixel_data <= stream_d1 ? ls_read_data :
+                  cache_d1  ? cache_data : fb_read_data;
+    if (rd_l0_d1)
+        l0_first <= fb_read_data;
+    if (rd_l1_d1) begin
+        l0_data  <= l0_first;
+        l1_data  <= fb_read_data;
+        l_nibble <= l_nibble_d1;
+    end
+    aff_nibble_d2 <= aff_nibble_d1;
     in_fb_region_d2 <= in_fb_region_d1;
+    blank_d2 <= blank_d1;
+    nibble_d2 <= nibble_d1;
     de_d2 <= de_d1;
     hs_d2 <= hs_d1;
     vs_d2 <= vs_d1;
 end
 
+// Stage 3: Align plain data with the layer pair. Affine texels reach
+// pixel_data a clock late, which is right on time here.
+reg [7:0] pixel_d3;
+reg in_fb_region_d3;
+reg nibble_d3;
+reg blank_d3;
+reg de_d3, hs_d3, vs_d3;
+
+always @(posedge I_pix_clk) begin
+    pixel_d3 <= pixel_data;
+    in_fb_region_d3 <= in_fb_region_d2;
+    blank_d3 <= blank_d2;
+    nibble_d3 <= nibble_d2;
+    de_d3 <= de_d2;
+    hs_d3 <= hs_d2;
+    vs_d3 <= vs_d2;
+end
+
 // ==============================================================================
-// RGB332 to RGB888 expansion
+// Pixel format decode and RGB332 to RGB888 expansion
 // ==============================================================================
-wire [7:0] exp_r = {pixel_data[7:5], pixel_data[7:5], pixel_data[7:6]};
-wire [7:0] exp_g = {pixel_data[4:2], pixel_data[4:2], pixel_data[4:3]};
-wire [7:0] exp_b = {pixel_data[1:0], pixel_data[1:0], pixel_data[1:0], pixel_data[1:0]};
+wire [3:0] pixel_index = nibble_d3 ? pixel_d3[3:0] : pixel_d3[7:4];
+wire [3:0] aff_index = aff_nibble_d2 ? pixel_data[3:0] : pixel_data[7:4];
+wire [7:0] aff_332 = fb_format ? pal_act[aff_index] : pixel_data;
+
+// Dual playfield: look each layer up in its bank, front layer first
+wire [3:0] l0_index = l_nibble[0] ? l0_data[3:0] : l0_data[7:4];
+wire [3:0] l1_index = l_nibble[1] ? l1_data[3:0] : l1_data[7:4];
+wire [7:0] l0_color = l0_ctrl[5] ? pal1_act[l0_index] : pal_act[l0_index];
+wire [7:0] l1_color = l1_ctrl[5] ? pal1_act[l1_index] : pal_act[l1_index];
+wire       l0_solid = !(l0_ctrl[4] && l0_index == l0_ctrl[3:0]);
+wire       l1_solid = !(l1_ctrl[4] && l1_index == l1_ctrl[3:0]);
+wire [7:0] layer_332 = l0_front ? (l0_solid ? l0_color : l1_solid ? l1_color : border)
+                                : (l1_solid ? l1_color : l0_solid ? l0_color : border);
+
+wire [7:0] pixel_332 = !(de_d3 && in_fb_region_d3) || blank_d3 ? border :
+                       affine_on ? aff_332 :
+                       layers    ? layer_332 :
+                       fb_format ? pal_act[pixel_index] : pixel_d3;
+
+wire [7:0] exp_r = {pixel_332[7:5], pixel_332[7:5], pixel_332[7:6]};
+wire [7:0] exp_g = {pixel_332[4:2], pixel_332[4:2], pixel_332[4:3]};
+wire [7:0] exp_b = {pixel_332[1:0], pixel_332[1:0], pixel_332[1:0], pixel_332[1:0]};
 
 // ==============================================================================
 // Output
@@ -233,11 +1411,11 @@ always @(posedge I_pix_clk or negedge I_rst_n) begin
         O_rgb_hs <= 1'b0;
         O_rgb_vs <= 1'b0;
     end else begin
-        O_rgb_de <= de_d2;
-        O_rgb_hs <= hs_d2;
-        O_rgb_vs <= vs_d2;
-        
-        if (de_d2 && in_fb_region_d2) begin
+        O_rgb_de <= de_d3;
+        O_rgb_hs <= hs_d3;
+        O_rgb_vs <= vs_d3;
+
+        if (de_d3) begin
             O_rgb_r <= exp_r;
             O_rgb_g <= exp_g;
             O_rgb_b <= exp_b;
@@ -19,15 +19,39 @@
 //   0x08: Direct character RAM write (increments pointer)
 //   0x09: Direct attribute RAM write (increments pointer)
 //   0x0A: Clear screen command (write any value)
+//   0x0B: Reserved
+//   0x0C: Page control
+//         [0] display page (taken at the next vertical sync)
+//         [1] write page (cursor, pointer and clear writes)
+//         [2] page on screen (read only)
+//   0x0D: Palette pointer (0-47, byte index into 16 x R,G,B)
+//   0x0E: Palette data (write stores the byte and advances the pointer,
+//         wrapping after the last blue byte; read returns it in place)
+//
+// Character and attribute RAM hold two pages. Both page bits reset to 0, so
+// a host that never writes 0x0C sees a single page. To redraw without
+// tearing, draw into the page not on screen, then point the display page at
+// it; the flip waits for vertical sync and is done once bit 2 matches bit 0.
 //
 // Attribute byte format: [7:4] = background color, [3:0] = foreground color
-// Uses CGA 16-color palette.
+// Colors index a 16-entry RGB888 palette that resets to the CGA colors.
+// Palette writes land in a staging copy that scanout takes at the start of
+// vertical sync. 48 writes over SPI outlast a blanking interval, so the
+// copy is skipped while I_hold (the framebuffer's STATE_CTRL.HOLD) is set:
+// a host that writes the palette under HOLD gets the whole new palette at
+// the first vertical sync after it clears HOLD, and the staging copy is
+// never taken while it is changing.
 //
 // Usage: Instantiate this module and hdmi_phy_720p, connect RGB outputs
 //        from this module to the PHY's RGB inputs.
 // ==============================================================================
 
-module wb_video_text
+module wb_video_text #(
+    // Power-on contents of page 0 for $readmemh, 2080 bytes each, row by
+    // row (see gateware/tools/splash2mem.py). Empty leaves RAM undefined.
+    parameter CHAR_INIT_FILE = "",
+    parameter ATTR_INIT_FILE = ""
+)
 (
     // Wishbone slave interface
     input             I_wb_clk        ,
@@ -39,6 +63,7 @@ module wb_video_text
     input             I_wb_cyc        ,
     output reg        O_wb_ack        ,
     output reg [7:0]  O_wb_dat        ,
+    input             I_hold          , // Wishbone domain, skips the palette copy
     
     // Video timing inputs (from HDMI PHY)
     input             I_pix_clk       ,
@@ -64,17 +89,58 @@ module wb_video_text
 localparam TEXT_COLS = 80;
 localparam TEXT_ROWS = 26;
 localparam TEXT_SIZE = TEXT_COLS * TEXT_ROWS;  // 2080 characters
+localparam TEXT_PAGES = 2;
 
 // ==============================================================================
 // Character and Attribute RAM
 // ==============================================================================
 (* ram_style = "block" *)
-reg [7:0] char_ram [0:TEXT_SIZE-1];
+reg [7:0] char_ram [0:TEXT_PAGES*TEXT_SIZE-1];
 (* ram_style = "block" *)
-reg [7:0] attr_ram [0:TEXT_SIZE-1];
+reg [7:0] attr_ram [0:TEXT_PAGES*TEXT_SIZE-1];
 
-// Note: RAM not pre-initialized - firmware should clear screen on startup
-// Gowin synthesis doesn't support large initialization loops
+// Not cleared at reset - firmware should clear the screen on startup unless
+// page 0 is loaded from CHAR_INIT_FILE / ATTR_INIT_FILE at configuration.
+// Gowin synthesis doesn't support large initialization loops.
+initial begin
+    if (CHAR_INIT_FILE != "")
+        $readmemh(CHAR_INIT_FILE, char_ram, 0, TEXT_SIZE-1);
+    if (ATTR_INIT_FILE != "")
+        $readmemh(ATTR_INIT_FILE, attr_ram, 0, TEXT_SIZE-1);
+end
+
+// ==============================================================================
+// Text Palette
+// ==============================================================================
+// CGA 16-color palette (power-on text palette)
+function [23:0] cga_color;
+    input [3:0] color;
+    begin
+        case (color)
+            4'h0: cga_color = 24'h000000;  // Black
+            4'h1: cga_color = 24'h0000AA;  // Blue
+            4'h2: cga_color = 24'h00AA00;  // Green
+            4'h3: cga_color = 24'h00AAAA;  // Cyan
+            4'h4: cga_color = 24'hAA0000;  // Red
+            4'h5: cga_color = 24'hAA00AA;  // Magenta
+            4'h6: cga_color = 24'hAA5500;  // Brown
+            4'h7: cga_color = 24'hAAAAAA;  // Light gray
+            4'h8: cga_color = 24'h555555;  // Dark gray
+            4'h9: cga_color = 24'h5555FF;  // Light blue
+            4'hA: cga_color = 24'h55FF55;  // Light green
+            4'hB: cga_color = 24'h55FFFF;  // Light cyan
+            4'hC: cga_color = 24'hFF5555;  // Light red
+            4'hD: cga_color = 24'hFF55FF;  // Light magenta
+            4'hE: cga_color = 24'hFFFF55;  // Yellow
+            4'hF: cga_color = 24'hFFFFFF;  // White
+        endcase
+    end
+endfunction
+
+// Staging palette, written from Wishbone; pal_act is the scanout copy
+reg [7:0] pal_stage [0:47];
+reg [7:0] pal_act [0:47];
+reg [5:0] pal_ptr;
 
 // ==============================================================================
 // Wishbone Control Registers
@@ -83,13 +149,18 @@ reg [6:0] cursor_x;
 reg [4:0] cursor_y;
 reg [7:0] default_attr;
 reg [11:0] ram_addr_ptr;
+reg        disp_page;
+reg        write_page;
+reg [1:0]  shown_sync;
 
 wire [11:0] cursor_addr = (cursor_y * TEXT_COLS) + {5'b0, cursor_x};
+wire [12:0] write_base = write_page ? TEXT_SIZE : 13'd0;
 wire wb_valid = I_wb_stb && I_wb_cyc;
 
 // Clear screen state machine
 reg clear_active;
 reg [11:0] clear_addr;
+integer i;
 
 always @(posedge I_wb_clk or posedge I_wb_rst) begin
     if (I_wb_rst) begin
@@ -97,6 +168,11 @@ always @(posedge I_wb_clk or posedge I_wb_rst) begin
         cursor_y <= 5'd0;
         default_attr <= 8'h0F;
         ram_addr_ptr <= 12'd0;
+        disp_page <= 1'b0;
+        write_page <= 1'b0;
+        pal_ptr <= 6'd0;
+        for (i = 0; i < 16; i = i + 1)
+            {pal_stage[i*3], pal_stage[i*3+1], pal_stage[i*3+2]} <= cga_color(i);
         clear_active <= 1'b0;
         clear_addr <= 12'd0;
         O_wb_ack <= 1'b0;
@@ -105,8 +181,8 @@ always @(posedge I_wb_clk or posedge I_wb_rst) begin
         // Clear screen operation
         if (clear_active) begin
             if (clear_addr < TEXT_SIZE) begin
-                char_ram[clear_addr] <= 8'h20;
-                attr_ram[clear_addr] <= default_attr;
+                char_ram[write_base + clear_addr] <= 8'h20;
+                attr_ram[write_base + clear_addr] <= default_attr;
                 clear_addr <= clear_addr + 1;
             end else begin
                 clear_active <= 1'b0;
@@ -125,8 +201,8 @@ always @(posedge I_wb_clk or posedge I_wb_rst) begin
                 4'h3: default_attr <= I_wb_dat;
                 4'h4: begin  // Write character at cursor
                     if (cursor_addr < TEXT_SIZE) begin
-                        char_ram[cursor_addr] <= I_wb_dat;
-                        attr_ram[cursor_addr] <= default_attr;
+                        char_ram[write_base + cursor_addr] <= I_wb_dat;
+                        attr_ram[write_base + cursor_addr] <= default_attr;
                         // Auto-advance cursor
                         if (cursor_x < TEXT_COLS - 1)
                             cursor_x <= cursor_x + 1;
@@ -141,13 +217,13 @@ always @(posedge I_wb_clk or posedge I_wb_rst) begin
                 4'h7: ram_addr_ptr[7:0] <= I_wb_dat;
                 4'h8: begin  // Direct char RAM write
                     if (ram_addr_ptr < TEXT_SIZE) begin
-                        char_ram[ram_addr_ptr] <= I_wb_dat;
+                        char_ram[write_base + ram_addr_ptr] <= I_wb_dat;
                         ram_addr_ptr <= ram_addr_ptr + 1;
                     end
                 end
                 4'h9: begin  // Direct attr RAM write
                     if (ram_addr_ptr < TEXT_SIZE) begin
-                        attr_ram[ram_addr_ptr] <= I_wb_dat;
+                        attr_ram[write_base + ram_addr_ptr] <= I_wb_dat;
                         ram_addr_ptr <= ram_addr_ptr + 1;
                     end
                 end
@@ -155,6 +231,15 @@ always @(posedge I_wb_clk or posedge I_wb_rst) begin
                     clear_active <= 1'b1;
                     clear_addr <= 12'd0;
                 end
+                4'hC: begin
+                    disp_page <= I_wb_dat[0];
+                    write_page <= I_wb_dat[1];
+                end
+                4'hD: pal_ptr <= (I_wb_dat < 8'd48) ? I_wb_dat[5:0] : 6'd0;
+                4'hE: begin
+                    pal_stage[pal_ptr] <= I_wb_dat;
+                    pal_ptr <= (pal_ptr == 6'd47) ? 6'd0 : pal_ptr + 1;
+                end
                 default: ;
             endcase
         end
@@ -165,9 +250,12 @@ always @(posedge I_wb_clk or posedge I_wb_rst) begin
                 4'h1: O_wb_dat <= {1'b0, cursor_x};
                 4'h2: O_wb_dat <= {3'b0, cursor_y};
                 4'h3: O_wb_dat <= default_attr;
-                4'h4: O_wb_dat <= (cursor_addr < TEXT_SIZE) ? char_ram[cursor_addr] : 8'h00;
+                4'h4: O_wb_dat <= (cursor_addr < TEXT_SIZE) ? char_ram[write_base + cursor_addr] : 8'h00;
                 4'h6: O_wb_dat <= {4'b0, ram_addr_ptr[11:8]};
                 4'h7: O_wb_dat <= ram_addr_ptr[7:0];
+                4'hC: O_wb_dat <= {5'b0, shown_sync[1], write_page, disp_page};
+                4'hD: O_wb_dat <= {2'b0, pal_ptr};
+                4'hE: O_wb_dat <= pal_stage[pal_ptr];
                 default: O_wb_dat <= 8'h00;
             endcase
         end
@@ -191,8 +279,39 @@ wire [2:0] font_row = (I_active_y - V_TEXT_START) >> 1;  // / 2 (2x scale)
 
 wire in_text_area = (I_active_y >= V_TEXT_START) && (I_active_y < V_TEXT_END);
 
+// Display page and palette, taken at the start of vertical sync so a flip
+// or palette change never shows half of each. shown_page is synced back
+// for the page control read.
+reg [1:0] disp_sync;
+reg       shown_page;
+reg       vs_prev;
+always @(posedge I_pix_clk or negedge I_rst_n) begin
+    if (!I_rst_n) begin
+        disp_sync <= 2'b00;
+        shown_page <= 1'b0;
+        vs_prev <= 1'b0;
+    end else begin
+        disp_sync <= {disp_sync[0], disp_page};
+        vs_prev <= I_vs;
+        if (I_vs && !vs_prev)
+            shown_page <= disp_sync[1];
+    end
+end
+reg [1:0] pal_hold_sync;
+always @(posedge I_pix_clk) pal_hold_sync <= {pal_hold_sync[0], I_hold};
+
+integer j;
+always @(posedge I_pix_clk) begin
+    if (I_vs && !vs_prev && !pal_hold_sync[1]) begin
+        for (j = 0; j < 48; j = j + 1)
+            pal_act[j] <= pal_stage[j];
+    end
+end
+always @(posedge I_wb_clk) shown_sync <= {shown_sync[0], shown_page};
+
 // Character address
 wire [11:0] text_char_addr = (char_row * TEXT_COLS) + {5'b0, char_col};
+wire [12:0] text_page_addr = (shown_page ? TEXT_SIZE : 13'd0) + text_char_addr;
 
 // Pipeline stage 1: Read character and attribute from RAM
 reg [7:0] char_data_d1;
@@ -202,8 +321,8 @@ reg in_text_d1, de_d1, hs_d1, vs_d1;
 
 always @(posedge I_pix_clk) begin
     if (text_char_addr < TEXT_SIZE) begin
-        char_data_d1 <= char_ram[text_char_addr];
-        attr_data_d1 <= attr_ram[text_char_addr];
+        char_data_d1 <= char_ram[text_page_addr];
+        attr_data_d1 <= attr_ram[text_page_addr];
     end else begin
         char_data_d1 <= 8'h20;
         attr_data_d1 <= 8'h0F;
@@ -262,31 +381,6 @@ wire font_pixel = font_pixels_d3[7 - font_col_d3];
 wire [3:0] fg_color = attr_data_d3[3:0];
 wire [3:0] bg_color = attr_data_d3[7:4];
 
-// CGA 16-color palette
-function [23:0] cga_color;
-    input [3:0] color;
-    begin
-        case (color)
-            4'h0: cga_color = 24'h000000;  // Black
-            4'h1: cga_color = 24'h0000AA;  // Blue
-            4'h2: cga_color = 24'h00AA00;  // Green
-            4'h3: cga_color = 24'h00AAAA;  // Cyan
-            4'h4: cga_color = 24'hAA0000;  // Red
-            4'h5: cga_color = 24'hAA00AA;  // Magenta
-            4'h6: cga_color = 24'hAA5500;  // Brown
-            4'h7: cga_color = 24'hAAAAAA;  // Light gray
-            4'h8: cga_color = 24'h555555;  // Dark gray
-            4'h9: cga_color = 24'h5555FF;  // Light blue
-            4'hA: cga_color = 24'h55FF55;  // Light green
-            4'hB: cga_color = 24'h55FFFF;  // Light cyan
-            4'hC: cga_color = 24'hFF5555;  // Light red
-            4'hD: cga_color = 24'hFF55FF;  // Light magenta
-            4'hE: cga_color = 24'hFFFF55;  // Yellow
-            4'hF: cga_color = 24'hFFFFFF;  // White
-        endcase
-    end
-endfunction
-
 // Pipeline stage 4: Final color output
 always @(posedge I_pix_clk or negedge I_rst_n) begin
     if (!I_rst_n) begin
@@ -303,9 +397,9 @@ always @(posedge I_pix_clk or negedge I_rst_n) begin
         
         if (de_d3 && in_text_d3) begin
             if (font_pixel) begin
-                {O_rgb_r, O_rgb_g, O_rgb_b} <= cga_color(fg_color);
+                {O_rgb_r, O_rgb_g, O_rgb_b} <= {pal_act[fg_color*3], pal_act[fg_color*3+1], pal_act[fg_color*3+2]};
             end else begin
-                {O_rgb_r, O_rgb_g, O_rgb_b} <= cga_color(bg_color);
+                {O_rgb_r, O_rgb_g, O_rgb_b} <= {pal_act[bg_color*3], pal_act[bg_color*3+1], pal_act[bg_color*3+2]};
             end
         end else begin
             O_rgb_r <= 8'd0;
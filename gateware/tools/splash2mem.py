@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+"""Turn a boot splash into memory-init files for video_top_modular.v.
+
+Image splash (framebuffer, video mode 2):
+
+    splash2mem.py logo.png -o build/splash
+    splash2mem.py logo.png -o build/splash --format indexed4 --scale 4
+
+writes build/splash_hi.hex and build/splash_lo.hex, the high and low
+nibble of every VRAM byte, and prints the video_top_modular parameters
+that go with them (geometry, scale and a viewport centered in 720p).
+RGB332 rounds each colour down as the library does; indexed4 picks the
+nearest colour of the framebuffer's power-on palette.
+
+Text splash (text mode, video mode 1):
+
+    splash2mem.py --text screen.txt -o build/splash --attr 0x1F
+
+writes build/splash_char.hex and build/splash_attr.hex for text page 0,
+80x26 characters padded with spaces.
+
+Reads 8-bit PNG (not interlaced) and binary PPM/PGM with no third-party
+modules. The .hex files are for $readmemh, one word per line; pass their
+paths as your synthesis tool resolves them.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+VRAM_SIZE = 32512
+TEXT_COLS, TEXT_ROWS = 80, 26
+SCREEN_W, SCREEN_H = 1280, 720
+
+# Power-on 4bpp palette of wb_video_framebuffer.v (RGB332)
+BOOT_PALETTE = [0x00, 0x02, 0x14, 0x16, 0xA0, 0xA2, 0xA8, 0xB6,
+                0x49, 0x4B, 0x5D, 0x5F, 0xE9, 0xEB, 0xFD, 0xFF]
+
+
+def read_png(data):
+    """Decode an 8-bit, non-interlaced PNG to (width, height, [(r, g, b)])."""
+    pos = 8
+    idat = b""
+    palette = None
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IHDR":
+            width, height, depth, ctype, _, _, interlace = struct.unpack(">IIBBBBB", body)
+        elif kind == b"PLTE":
+            palette = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+        elif kind == b"IDAT":
+            idat += body
+        elif kind == b"IEND":
+            break
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(ctype)
+    if depth != 8 or interlace or channels is None:
+        sys.exit("PNG must be 8 bits per channel and not interlaced")
+
+    raw = zlib.decompress(idat)
+    stride = width * channels
+    prev = bytearray(stride)
+    pixels = []
+    for y in range(height):
+        ftype = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            a = line[i - channels] if i >= channels else 0
+            b = prev[i]
+            c = prev[i - channels] if i >= channels else 0
+            if ftype == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif ftype == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif ftype == 3:
+                line[i] = (line[i] + (a + b) // 2) & 0xFF
+            elif ftype == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                line[i] = (line[i] + pred) & 0xFF
+        prev = line
+        for x in range(width):
+            px = line[x * channels:(x + 1) * channels]
+            if ctype == 3:
+                pixels.append(palette[px[0]])
+            elif channels <= 2:
+                pixels.append((px[0], px[0], px[0]))
+            else:
+                pixels.append((px[0], px[1], px[2]))
+    return width, height, pixels
+
+
+def read_pnm(data):
+    """Decode a binary PPM (P6) or PGM (P5) with maxval 255."""
+    fields = []
+    pos = 2
+    while len(fields) < 3:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b"#":
+            pos = data.index(b"\n", pos)
+            continue
+        end = pos
+        while not data[end:end + 1].isspace():
+            end += 1
+        fields.append(int(data[pos:end]))
+        pos = end
+    width, height, maxval = fields
+    if maxval != 255:
+        sys.exit("PPM/PGM maxval must be 255")
+    body = data[pos + 1:]
+    if data[:2] == b"P5":
+        return width, height, [(v, v, v) for v in body[:width * height]]
+    return width, height, [tuple(body[i:i + 3]) for i in range(0, width * height * 3, 3)]
+
+
+def load_image(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] == b"\x89PNG\r\n\x1a\n":
+        return read_png(data)
+    if data[:2] in (b"P5", b"P6"):
+        return read_pnm(data)
+    sys.exit("%s: not a PNG or binary PPM/PGM" % path)
+
+
+def rgb332(r, g, b):
+    return (r & 0xE0) | ((g >> 5) << 2) | (b >> 6)
+
+
+def expand332(c):
+    r, g, b = c >> 5, (c >> 2) & 7, c & 3
+    return ((r << 5) | (r << 2) | (r >> 1),
+            (g << 5) | (g << 2) | (g >> 1),
+            b * 0x55)
+
+
+def nearest_index(rgb):
+    best, best_d = 0, None
+    for i, c in enumerate(BOOT_PALETTE):
+        d = sum((p - q) ** 2 for p, q in zip(rgb, expand332(c)))
+        if best_d is None or d < best_d:
+            best, best_d = i, d
+    return best
+
+
+def write_hex(path, words, digits):
+    with open(path, "w") as f:
+        for w in words:
+            f.write("%0*X\n" % (digits, w))
+
+
+def image_splash(args):
+    width, height, pixels = load_image(args.image)
+    if width > 511 or height > 511:
+        sys.exit("image is %dx%d; the framebuffer takes up to 511x511" % (width, height))
+
+    indexed = args.format == "indexed4"
+    if indexed:
+        stride = (width + 1) // 2
+        vram = bytearray(stride * height)
+        for y in range(height):
+            for x in range(width):
+                i = nearest_index(pixels[y * width + x])
+                vram[y * stride + x // 2] |= i << 4 if x % 2 == 0 else i
+    else:
+        vram = bytearray(rgb332(*p) for p in pixels)
+    if len(vram) > VRAM_SIZE:
+        sys.exit("%dx%d %s needs %d bytes; VRAM holds %d"
+                 % (width, height, args.format, len(vram), VRAM_SIZE))
+    vram += bytes(VRAM_SIZE - len(vram))
+
+    scale = args.scale or min(15, SCREEN_W // width, SCREEN_H // height)
+    if scale < 1:
+        sys.exit("image does not fit on a %dx%d screen" % (SCREEN_W, SCREEN_H))
+    view_x = max(0, (SCREEN_W - width * scale) // 2)
+    view_y = max(0, (SCREEN_H - height * scale) // 2)
+
+    hi, lo = args.output + "_hi.hex", args.output + "_lo.hex"
+    write_hex(hi, (b >> 4 for b in vram), 1)
+    write_hex(lo, (b & 0x0F for b in vram), 1)
+    print("wrote %s, %s (%dx%d %s, %d bytes used)"
+          % (hi, lo, width, height, args.format, stride * height if indexed else width * height))
+    params = [("BOOT_MODE", 2), ("BOOT_WIDTH", width), ("BOOT_HEIGHT", height),
+              ("BOOT_FORMAT", 1 if indexed else 0), ("BOOT_SCALE", scale),
+              ("BOOT_VIEW_X", view_x), ("BOOT_VIEW_Y", view_y),
+              ("SPLASH_HI_FILE", '"%s"' % os.path.basename(hi)),
+              ("SPLASH_LO_FILE", '"%s"' % os.path.basename(lo))]
+    print_params(params)
+
+
+def text_splash(args):
+    with open(args.text, encoding="latin-1") as f:
+        lines = f.read().split("\n")
+    chars = []
+    for y in range(TEXT_ROWS):
+        line = lines[y] if y < len(lines) else ""
+        line = line.rstrip("\r")[:TEXT_COLS].ljust(TEXT_COLS)
+        chars.extend(ord(c) & 0xFF for c in line)
+
+    char_path, attr_path = args.output + "_char.hex", args.output + "_attr.hex"
+    write_hex(char_path, chars, 2)
+    write_hex(attr_path, [args.attr] * len(chars), 2)
+    print("wrote %s, %s (80x26, attribute 0x%02X)" % (char_path, attr_path, args.attr))
+    print_params([("BOOT_MODE", 1),
+                  ("CHAR_INIT_FILE", '"%s"' % os.path.basename(char_path)),
+                  ("ATTR_INIT_FILE", '"%s"' % os.path.basename(attr_path))])
+
+
+def print_params(params):
+    print("\nvideo_top_modular #(")
+    print(",\n".join("    .%-15s(%s)" % p for p in params))
+    print(") u_video (...);")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("image", nargs="?", help="PNG or binary PPM/PGM splash image")
+    parser.add_argument("--text", help="text file for a text-mode splash (80x26)")
+    parser.add_argument("-o", "--output", required=True,
+                        help="output path prefix, e.g. build/splash")
+    parser.add_argument("--format", choices=("rgb332", "indexed4"), default="rgb332")
+    parser.add_argument("--scale", type=int, default=0,
+                        help="integer scale 1-15 (default: largest that fits 720p)")
+    parser.add_argument("--attr", type=lambda s: int(s, 0), default=0x0F,
+                        help="text attribute, background << 4 | foreground")
+    args = parser.parse_args()
+
+    if args.scale and not 1 <= args.scale <= 15:
+        parser.error("--scale must be 1-15")
+    if args.text:
+        text_splash(args)
+    elif args.image:
+        image_splash(args)
+    else:
+        parser.error("give an image or --text")
+
+
+if __name__ == "__main__":
+    main()
@@ -1,10 +1,31 @@
 #include "HDMIController.h"
 
+// Power-on text palette (CGA), 16 x R,G,B
+static const uint8_t cgaPalette[48] = {
+  0x00, 0x00, 0x00,  0x00, 0x00, 0xAA,  0x00, 0xAA, 0x00,  0x00, 0xAA, 0xAA,
+  0xAA, 0x00, 0x00,  0xAA, 0x00, 0xAA,  0xAA, 0x55, 0x00,  0xAA, 0xAA, 0xAA,
+  0x55, 0x55, 0x55,  0x55, 0x55, 0xFF,  0x55, 0xFF, 0x55,  0x55, 0xFF, 0xFF,
+  0xFF, 0x55, 0x55,  0xFF, 0x55, 0xFF,  0xFF, 0xFF, 0x55,  0xFF, 0xFF, 0xFF
+};
+
+// Power-on 4bpp framebuffer palette (RGB332)
+static const uint8_t fbBootPalette[16] = {
+  0x00, 0x02, 0x14, 0x16, 0xA0, 0xA2, 0xA8, 0xB6,
+  0x49, 0x4B, 0x5D, 0x5F, 0xE9, 0xEB, 0xFD, 0xFF
+};
+
 HDMIController::HDMIController(SPIClass* spi, uint8_t csPin, uint8_t spiClk, uint8_t spiMosi, uint8_t spiMiso)
-  : _spi(spi), _ownSpi(false), _cs(csPin), _clk(spiClk), _mosi(spiMosi), _miso(spiMiso) {
+  : _spi(spi), _ownSpi(false), _cs(csPin), _clk(spiClk), _mosi(spiMosi), _miso(spiMiso),
+    _fbWidth(FB_WIDTH), _fbHeight(FB_HEIGHT), _fbStride(FB_WIDTH),
+    _fbFormat(FB_FORMAT_RGB332), _fbScale(6), _fbWmask(0x03), _textPal(-1),
+    _fbKnown(false), _frameCrc(-1),
+    _mode(0), _timing(VIDEO_TIMING_720P), _pattern(0), _textAttr(0x0F), _textRgbSet(false),
+    _fbViewX(160), _fbViewY(0), _fbBorder(0), _epochReg(-1), _epoch(0) {
   if (_spi == nullptr) {
     _ownSpi = true; // will create in begin()
   }
+  memcpy(_textRgb, cgaPalette, sizeof(_textRgb));
+  memcpy(_fbPalette, fbBootPalette, sizeof(_fbPalette));
 }
 
 HDMIController::~HDMIController() {
@@ -22,12 +43,25 @@ void HDMIController::begin() {
   if (_spi) {
     _spi->begin(_clk, _miso, _mosi, _cs);
   }
+  _bus.attach(_spi, _cs);
 
   pinMode(_cs, OUTPUT);
   digitalWrite(_cs, HIGH);
   
   // Wait for FPGA to be ready
   waitForFPGA(5000);
+  
+  // Bitstreams without framebuffer registers alias the epoch register
+  // onto the text controller, so leave it alone there
+  if (readFramebufferGeometry()) {
+    _mode = getVideoMode() & 0x03;
+    _timing = getVideoTiming();
+    _pattern = getVideoPattern();
+    _textAttr = wishboneRead8(REG_CHARRAM_ATTR);
+    _epochReg = armEpoch();
+  } else {
+    _epochReg = 0;
+  }
 }
 
 bool HDMIController::waitForFPGA(unsigned long timeoutMs) {
@@ -80,6 +114,7 @@ bool HDMIController::isLEDBusy() {
 }
 
 void HDMIController::setVideoPattern(uint8_t pattern) {
+  _pattern = pattern;
   wishboneWrite8(REG_VIDEO_PATTERN, pattern);
 }
 
@@ -95,6 +130,11 @@ uint8_t HDMIController::getVideoStatus() {
 void HDMIController::wishboneWrite8(uint16_t address, uint8_t data) {
   if (!_spi) return;
 
+  if (_bus.fast()) {
+    _bus.write(address, data);
+    return;
+  }
+
   _spi->beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
   digitalWrite(_cs, LOW);
 
@@ -112,6 +152,8 @@ uint8_t HDMIController::wishboneRead8(uint16_t address) {
   uint8_t data = 0;
   if (!_spi) return data;
 
+  if (_bus.fast()) return _bus.read(address, 2);
+
   _spi->beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
   digitalWrite(_cs, LOW);
 
@@ -127,6 +169,18 @@ uint8_t HDMIController::wishboneRead8(uint16_t address) {
   return data;
 }
 
+bool HDMIController::enableHardwareCS(bool enable) {
+  return _bus.enableHardwareCS(enable);
+}
+
+void HDMIController::beginBus() {
+  _bus.begin();
+}
+
+void HDMIController::endBus() {
+  _bus.end();
+}
+
 // ============= Text Mode Functions =============
 
 void HDMIController::enableTextMode() {
@@ -153,6 +207,7 @@ void HDMIController::setCursor(uint8_t x, uint8_t y) {
 
 void HDMIController::setTextColor(uint8_t foreground, uint8_t background) {
   uint8_t attr = ((background & 0x0F) << 4) | (foreground & 0x0F);
+  _textAttr = attr;
   wishboneWrite8(REG_CHARRAM_ATTR, attr);
 }
 
@@ -200,6 +255,59 @@ uint8_t HDMIController::getCursorY() {
   return wishboneRead8(REG_CHARRAM_CURSOR_Y);
 }
 
+bool HDMIController::flipTextPage(bool wait) {
+  // Show the page just drawn, draw into the other one next
+  uint8_t writePage = (wishboneRead8(REG_CHARRAM_PAGE) >> 1) & 0x01;
+  uint8_t page = writePage | ((writePage ^ 0x01) << 1);
+  wishboneWrite8(REG_CHARRAM_PAGE, page);
+  if ((wishboneRead8(REG_CHARRAM_PAGE) & 0x03) != page) {
+    return false;  // single-page bitstream
+  }
+  // The new write page stays on screen until vertical sync
+  unsigned long start = millis();
+  while (wait && isTextFlipPending() && millis() - start < 100) {
+    delayMicroseconds(500);
+  }
+  return true;
+}
+
+bool HDMIController::isTextFlipPending() {
+  uint8_t page = wishboneRead8(REG_CHARRAM_PAGE);
+  return (page & 0x01) != ((page >> 2) & 0x01);
+}
+
+bool HDMIController::setTextPalette(const uint8_t* rgb, uint8_t first, uint8_t count) {
+  if (first >= 16) return false;
+  if (count > 16 - first) count = 16 - first;
+  BusSession bus(*this);
+  if (_textPal < 0) {
+    // The pointer reads back 0 on bitstreams with the fixed palette
+    wishboneWrite8(REG_CHARRAM_PAL_ADDR, 47);
+    _textPal = wishboneRead8(REG_CHARRAM_PAL_ADDR) == 47;
+  }
+  if (!_textPal) return false;
+  memcpy(_textRgb + first * 3, rgb, count * 3);
+  _textRgbSet = true;
+  // Scanout copies the palette at every vertical sync that is not held,
+  // and the writes take longer than one blanking interval
+  wishboneWrite8(REG_STATE_CTRL, 0x01);
+  wishboneWrite8(REG_CHARRAM_PAL_ADDR, first * 3);
+  for (uint8_t i = 0; i < count * 3; i++) {
+    wishboneWrite8(REG_CHARRAM_PAL_DATA, rgb[i]);
+  }
+  wishboneWrite8(REG_STATE_CTRL, 0x00);
+  return true;
+}
+
+bool HDMIController::setTextPaletteColor(uint8_t index, uint32_t rgb888) {
+  uint8_t rgb[3] = { (uint8_t)(rgb888 >> 16), (uint8_t)(rgb888 >> 8), (uint8_t)rgb888 };
+  return setTextPalette(rgb, index, 1);
+}
+
+bool HDMIController::resetTextPalette() {
+  return setTextPalette(cgaPalette);
+}
+
 void HDMIController::writeCustomFont(uint8_t charCode, const uint8_t fontData[8]) {
   // Character codes 0-7 are custom characters
   if (charCode > 7) return;
@@ -228,6 +336,7 @@ void HDMIController::writeCustomFont(uint8_t charCode, const uint8_t fontData[8]
 // ============= Video Mode Functions =============
 
 void HDMIController::setVideoMode(uint8_t mode) {
+  _mode = mode & 0x03;
   wishboneWrite8(REG_VIDEO_MODE, mode);
 }
 
@@ -235,6 +344,115 @@ uint8_t HDMIController::getVideoMode() {
   return wishboneRead8(REG_VIDEO_MODE);
 }
 
+bool HDMIController::setVideoTiming(uint8_t preset) {
+  if (preset > VIDEO_TIMING_800X600) return false;
+  wishboneWrite8(REG_VIDEO_TIMING, preset);
+  if (getVideoTiming() != preset) return false;
+  _timing = preset;
+  return true;
+}
+
+uint8_t HDMIController::getVideoTiming() {
+  return wishboneRead8(REG_VIDEO_TIMING) & 0x03;
+}
+
+bool HDMIController::hasFrameCrc() {
+  if (_frameCrc < 0) {
+    // Bitstreams without the CRC decode 0x0004-0x0008 as the video mode
+    // register, which never changes on its own; a frame counter moves
+    // within 100 ms at any timing preset
+    _frameCrc = 0;
+    if (_fbKnown) {
+      uint8_t frame = getFrameCount();
+      unsigned long start = millis();
+      while (!_frameCrc && millis() - start < 100) {
+        delay(1);
+        _frameCrc = getFrameCount() != frame;
+      }
+    }
+  }
+  return _frameCrc > 0;
+}
+
+uint32_t HDMIController::readFrameCrc() {
+  if (!hasFrameCrc()) return 0;
+  // The low byte snapshots the other three, so all four are one frame's
+  BusSession bus(*this);
+  uint32_t crc = 0;
+  for (uint8_t i = 0; i < 4; i++) {
+    crc |= (uint32_t)wishboneRead8(REG_FRAME_CRC + i) << (8 * i);
+  }
+  return crc;
+}
+
+uint8_t HDMIController::getFrameCount() {
+  return wishboneRead8(REG_FRAME_COUNT);
+}
+
+bool HDMIController::expectFrameCrc(uint32_t expected, unsigned long timeoutMs) {
+  if (!hasFrameCrc()) return false;
+  unsigned long start = millis();
+  do {
+    if (readFrameCrc() == expected) return true;
+    delay(1);
+  } while (millis() - start < timeoutMs);
+  return false;
+}
+
+// ============= Reset Recovery =============
+
+bool HDMIController::armEpoch() {
+  // A new token each time, never 0 (reset) or 0xFF (MISO with no FPGA)
+  _epoch = _epoch % 0xFE + 1;
+  wishboneWrite8(REG_EPOCH, _epoch);
+  return wishboneRead8(REG_EPOCH) == _epoch;
+}
+
+bool HDMIController::isAlive() {
+  return _epochReg <= 0 || wishboneRead8(REG_EPOCH) == _epoch;
+}
+
+bool HDMIController::resync(unsigned long timeoutMs) {
+  if (_epochReg <= 0) return false;
+
+  // The token reads back once the FPGA is configured and out of reset
+  unsigned long start = millis();
+  while (!armEpoch()) {
+    if (millis() - start >= timeoutMs) return false;
+    delay(10);
+  }
+
+  BusSession bus(*this);
+  wishboneWrite8(REG_VIDEO_TIMING, _timing);
+  wishboneWrite8(REG_VIDEO_PATTERN, _pattern);
+  wishboneWrite8(REG_CHARRAM_ATTR, _textAttr);
+  if (_textRgbSet) {
+    wishboneWrite8(REG_STATE_CTRL, 0x01);
+    wishboneWrite8(REG_CHARRAM_PAL_ADDR, 0);
+    for (uint8_t i = 0; i < 48; i++) {
+      wishboneWrite8(REG_CHARRAM_PAL_DATA, _textRgb[i]);
+    }
+    wishboneWrite8(REG_STATE_CTRL, 0x00);
+  }
+
+  wishboneWrite8(REG_FB_WIDTH_LO, _fbWidth & 0xFF);
+  wishboneWrite8(REG_FB_WIDTH_HI, _fbWidth >> 8);
+  wishboneWrite8(REG_FB_HEIGHT_LO, _fbHeight & 0xFF);
+  wishboneWrite8(REG_FB_HEIGHT_HI, _fbHeight >> 8);
+  wishboneWrite8(REG_FB_FORMAT, _fbFormat);
+  wishboneWrite8(REG_FB_SCALE, _fbScale);
+  setFramebufferViewport(_fbViewX, _fbViewY);
+  wishboneWrite8(REG_FB_BORDER, _fbBorder);
+  for (uint8_t i = 0; i < 16; i++) {
+    wishboneWrite8(REG_FB_PALETTE + i, _fbPalette[i]);
+  }
+  wishboneWrite8(REG_FB_WMASK, 0x03);
+  _fbWmask = 0x03;
+
+  wishboneWrite8(REG_VIDEO_MODE, _mode);
+  return true;
+}
+
 // ============= Framebuffer Functions =============
 
 void HDMIController::enableFramebuffer() {
@@ -242,32 +460,129 @@ void HDMIController::enableFramebuffer() {
 }
 
 void HDMIController::clearFramebuffer(uint8_t color) {
-  // Write color to all 19,200 pixels (160 x 120)
-  // Using direct byte addressing (pixel index = address offset)
-  for (uint16_t y = 0; y < FB_HEIGHT; y++) {
-    for (uint16_t x = 0; x < FB_WIDTH; x++) {
-      uint16_t pixelIndex = y * FB_WIDTH + x;
-      uint16_t addr = FB_BASE_ADDR + pixelIndex;  // Direct byte addressing
-      wishboneWrite8(addr, color);
-    }
+  // Write every VRAM byte of the current layout (19,200 for 160x120 RGB332)
+  // Using direct byte addressing (byte offset = address offset)
+  uint8_t fill = (_fbFormat == FB_FORMAT_INDEXED4) ? (color & 0x0F) * 0x11 : color;
+  if (_fbWmask != 0x03) {
+    wishboneWrite8(REG_FB_WMASK, 0x03);
+    _fbWmask = 0x03;
+  }
+  uint16_t size = _fbStride * _fbHeight;
+  for (uint16_t offset = 0; offset < size; offset++) {
+    wishboneWrite8(FB_BASE_ADDR + offset, fill);
   }
 }
 
-void HDMIController::setPixel(uint8_t x, uint8_t y, uint8_t color) {
-  if (x >= FB_WIDTH || y >= FB_HEIGHT) return;
-  uint16_t pixelIndex = y * FB_WIDTH + x;
-  uint16_t addr = FB_BASE_ADDR + pixelIndex;  // Direct byte addressing
+void HDMIController::setPixel(uint16_t x, uint16_t y, uint8_t color) {
+  if (x >= _fbWidth || y >= _fbHeight) return;
+  uint8_t mask = 0x03;
+  uint16_t addr;
+  if (_fbFormat == FB_FORMAT_INDEXED4) {
+    // Two pixels per byte: even x in the high nibble, written via the mask
+    mask = (x & 1) ? 0x01 : 0x02;
+    addr = FB_BASE_ADDR + y * _fbStride + (x >> 1);
+    color = (color & 0x0F) * 0x11;
+  } else {
+    addr = FB_BASE_ADDR + y * _fbStride + x;  // Direct byte addressing
+  }
+  if (mask != _fbWmask) {
+    wishboneWrite8(REG_FB_WMASK, mask);
+    _fbWmask = mask;
+  }
   wishboneWrite8(addr, color);
 }
 
-void HDMIController::fillRect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t color) {
-  for (uint8_t py = y; py < y + h && py < FB_HEIGHT; py++) {
-    for (uint8_t px = x; px < x + w && px < FB_WIDTH; px++) {
+void HDMIController::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t color) {
+  for (uint16_t py = y; py < y + h && py < _fbHeight; py++) {
+    for (uint16_t px = x; px < x + w && px < _fbWidth; px++) {
       setPixel(px, py, color);
     }
   }
 }
 
+bool HDMIController::setFramebufferGeometry(uint16_t width, uint16_t height, uint8_t format, uint8_t scale) {
+  format &= 0x01;
+  uint16_t stride = (format == FB_FORMAT_INDEXED4) ? (width + 1) / 2 : width;
+  if (width == 0 || width > 511 || height == 0 || height > 511 ||
+      (uint32_t)stride * height > FB_VRAM_SIZE) {
+    return false;
+  }
+  if (scale < 1) scale = 1;
+  if (scale > 15) scale = 15;
+
+  wishboneWrite8(REG_FB_WIDTH_LO, width & 0xFF);
+  wishboneWrite8(REG_FB_WIDTH_HI, width >> 8);
+  wishboneWrite8(REG_FB_HEIGHT_LO, height & 0xFF);
+  wishboneWrite8(REG_FB_HEIGHT_HI, height >> 8);
+  wishboneWrite8(REG_FB_FORMAT, format);
+  wishboneWrite8(REG_FB_SCALE, scale);
+
+  _fbWidth = width;
+  _fbHeight = height;
+  _fbStride = stride;
+  _fbFormat = format;
+  _fbScale = scale;
+
+  // Center in the active area of the current timing preset
+  uint16_t hres = wishboneRead8(REG_FB_HRES_LO) | ((wishboneRead8(REG_FB_HRES_HI) & 0x0F) << 8);
+  uint16_t vres = wishboneRead8(REG_FB_VRES_LO) | ((wishboneRead8(REG_FB_VRES_HI) & 0x0F) << 8);
+  if (hres == 0 || vres == 0) {
+    hres = 1280;
+    vres = 720;
+  }
+  uint16_t w = width * scale;
+  uint16_t h = height * scale;
+  setFramebufferViewport(w < hres ? (hres - w) / 2 : 0, h < vres ? (vres - h) / 2 : 0);
+  return true;
+}
+
+void HDMIController::setFramebufferViewport(uint16_t x, uint16_t y) {
+  _fbViewX = x & 0x0FFF;
+  _fbViewY = y & 0x0FFF;
+  wishboneWrite8(REG_FB_VIEW_X_LO, x & 0xFF);
+  wishboneWrite8(REG_FB_VIEW_X_HI, (x >> 8) & 0x0F);
+  wishboneWrite8(REG_FB_VIEW_Y_LO, y & 0xFF);
+  wishboneWrite8(REG_FB_VIEW_Y_HI, (y >> 8) & 0x0F);
+}
+
+void HDMIController::setFramebufferBorder(uint8_t color) {
+  _fbBorder = color;
+  wishboneWrite8(REG_FB_BORDER, color);
+}
+
+void HDMIController::setFramebufferPalette(uint8_t index, uint8_t color) {
+  _fbPalette[index & 0x0F] = color;
+  wishboneWrite8(REG_FB_PALETTE + (index & 0x0F), color);
+}
+
+bool HDMIController::readFramebufferGeometry() {
+  uint16_t width = wishboneRead8(REG_FB_WIDTH_LO) | ((wishboneRead8(REG_FB_WIDTH_HI) & 0x01) << 8);
+  uint16_t height = wishboneRead8(REG_FB_HEIGHT_LO) | ((wishboneRead8(REG_FB_HEIGHT_HI) & 0x01) << 8);
+  uint8_t format = wishboneRead8(REG_FB_FORMAT) & 0x01;
+  uint8_t scale = wishboneRead8(REG_FB_SCALE) & 0x0F;
+  uint16_t hres = wishboneRead8(REG_FB_HRES_LO) | ((wishboneRead8(REG_FB_HRES_HI) & 0x0F) << 8);
+
+  // Older bitstreams alias 0x0030-0x00FF onto the text controller; only
+  // trust the registers when the active width is a real timing preset
+  bool known = (hres == 640 || hres == 800 || hres == 1280 || hres == 1920);
+  _fbKnown = known;
+  uint16_t stride = (format == FB_FORMAT_INDEXED4) ? (width + 1) / 2 : width;
+  if (!known || width == 0 || height == 0 || (uint32_t)stride * height > FB_VRAM_SIZE) {
+    return false;  // Keep the 160x120 RGB332 defaults
+  }
+
+  _fbWidth = width;
+  _fbHeight = height;
+  _fbStride = stride;
+  _fbFormat = format;
+  _fbScale = scale ? scale : 1;
+  _fbWmask = wishboneRead8(REG_FB_WMASK) & 0x03;
+  _fbViewX = wishboneRead8(REG_FB_VIEW_X_LO) | ((wishboneRead8(REG_FB_VIEW_X_HI) & 0x0F) << 8);
+  _fbViewY = wishboneRead8(REG_FB_VIEW_Y_LO) | ((wishboneRead8(REG_FB_VIEW_Y_HI) & 0x0F) << 8);
+  _fbBorder = wishboneRead8(REG_FB_BORDER);
+  return true;
+}
+
 void HDMIController::drawColorBars() {
   // RGB332 colors for standard color bars
   const uint8_t colors[8] = {
@@ -281,10 +596,10 @@ void HDMIController::drawColorBars() {
     0x00   // Black  (000 000 00)
   };
   
-  const uint8_t barWidth = FB_WIDTH / 8;  // 20 pixels per bar
+  const uint16_t barWidth = _fbWidth >= 8 ? _fbWidth / 8 : 1;  // 20 pixels per bar at 160 wide
   
-  for (uint8_t y = 0; y < FB_HEIGHT; y++) {
-    for (uint8_t x = 0; x < FB_WIDTH; x++) {
+  for (uint16_t y = 0; y < _fbHeight; y++) {
+    for (uint16_t x = 0; x < _fbWidth; x++) {
       uint8_t barIndex = x / barWidth;
       if (barIndex > 7) barIndex = 7;
       setPixel(x, y, colors[barIndex]);
@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include <SPI.h>
+#include "WishboneBus.h"
 
 // SPI Wishbone Protocol Commands
 #define CMD_WRITE 0x01
@@ -16,6 +17,10 @@
 
 // Video mode control register (0x0000-0x000F)
 #define REG_VIDEO_MODE      0x0000
+#define REG_VIDEO_TIMING    0x0001
+#define REG_VIDEO_BOOT      0x0002  // [1:0] mode at reset, [6] text / [7] VRAM splash (RO)
+#define REG_FRAME_CRC       0x0004  // 4 bytes LE, read 0x0004 first (RO)
+#define REG_FRAME_COUNT     0x0008  // frames latched, wraps (RO)
 
 // 8-bit Wishbone Register Addresses - HDMI Video/Test Pattern (0x0010-0x001F)
 #define REG_VIDEO_PATTERN  0x0010
@@ -34,22 +39,64 @@
 #define REG_CHARRAM_ATTR_DATA 0x0029
 #define REG_CHARRAM_FONT_ADDR 0x002A
 #define REG_CHARRAM_FONT_DATA 0x002B
+#define REG_CHARRAM_PAGE      0x002C  // [0] display, [1] write, [2] on screen (RO)
+#define REG_CHARRAM_PAL_ADDR  0x002D  // byte index 0-47 into 16 x R,G,B
+#define REG_CHARRAM_PAL_DATA  0x002E  // write advances REG_CHARRAM_PAL_ADDR
 
 // Video modes
 #define VIDEO_MODE_TEST_PATTERN  0x00
 #define VIDEO_MODE_TEXT          0x01
 #define VIDEO_MODE_FRAMEBUFFER   0x02
 
+// Output timing presets (REG_VIDEO_TIMING, see gateware hdmi_timing.v)
+// 720p60 and 1080p30 share the 74.25MHz pixel clock; the others need a
+// bitstream built with the matching PLL.
+#define VIDEO_TIMING_480P      0x00  // 640x480@60
+#define VIDEO_TIMING_720P      0x01  // 1280x720@60 (default)
+#define VIDEO_TIMING_1080P30   0x02  // 1920x1080@30
+#define VIDEO_TIMING_800X600   0x03  // 800x600@72
+
 // Test pattern modes (when in test pattern video mode)
 #define PATTERN_COLOR_BARS  0x00
 #define PATTERN_GRID        0x01
 #define PATTERN_GRAYSCALE   0x02
 #define PATTERN_TEXT_MODE   0x03
 
-// Framebuffer constants
+// Framebuffer constants (power-on geometry; see getFramebufferWidth/Height)
 #define FB_WIDTH   160
 #define FB_HEIGHT  120
 #define FB_BASE_ADDR  0x0100
+#define FB_VRAM_SIZE  32512
+
+// 8-bit Wishbone Register Addresses - Framebuffer control (0x0030-0x004F)
+#define REG_FB_WIDTH_LO    0x0030
+#define REG_FB_WIDTH_HI    0x0031
+#define REG_FB_HEIGHT_LO   0x0032
+#define REG_FB_HEIGHT_HI   0x0033
+#define REG_FB_FORMAT      0x0034
+#define REG_FB_SCALE       0x0035
+#define REG_FB_VIEW_X_LO   0x0036
+#define REG_FB_VIEW_X_HI   0x0037
+#define REG_FB_VIEW_Y_LO   0x0038
+#define REG_FB_VIEW_Y_HI   0x0039
+#define REG_FB_BORDER      0x003A
+#define REG_FB_WMASK       0x003B
+#define REG_FB_HRES_LO     0x003C
+#define REG_FB_HRES_HI     0x003D
+#define REG_FB_VRES_LO     0x003E
+#define REG_FB_VRES_HI     0x003F
+#define REG_FB_PALETTE     0x0040
+
+// State hold: [0] hold display state (framebuffer, video mode and text
+// palette) until cleared, [1] commit pending (RO)
+#define REG_STATE_CTRL     0x00A9
+
+// Epoch register: host token, cleared by FPGA reset
+#define REG_EPOCH          0x00B0
+
+// Framebuffer pixel formats
+#define FB_FORMAT_RGB332    0x00  // 8bpp
+#define FB_FORMAT_INDEXED4  0x01  // 4bpp, 16-entry RGB332 palette
 
 // Text colors (4-bit: [3]=bright, [2]=red, [1]=green, [0]=blue)
 #define HDMI_COLOR_BLACK         0x00
@@ -98,6 +145,21 @@ public:
   uint8_t getCursorX();
   uint8_t getCursorY();
   
+  // Text page flip: shows the page being written at the next vertical sync
+  // and moves writes to the other page. The first call starts double
+  // buffering. Waits until the flip is on screen unless wait is false.
+  // Returns false if the bitstream has a single text page.
+  bool flipTextPage(bool wait = true);
+  bool isTextFlipPending();
+  
+  // Text palette: the 16 attribute colors as RGB888 (power-on: CGA).
+  // rgb holds count R,G,B triples for entries first..first+count-1. The
+  // writes are made under the state hold, so the whole change shows at one
+  // vertical sync. Returns false if the bitstream has the fixed CGA palette.
+  bool setTextPalette(const uint8_t* rgb, uint8_t first = 0, uint8_t count = 16);
+  bool setTextPaletteColor(uint8_t index, uint32_t rgb888);
+  bool resetTextPalette();
+  
   // Custom font functions (for LCD createChar support)
   void writeCustomFont(uint8_t charCode, const uint8_t fontData[8]);
   
@@ -105,13 +167,51 @@ public:
   void setVideoMode(uint8_t mode);
   uint8_t getVideoMode();
   
-  // Framebuffer functions (160x120 RGB332)
+  // Output timing preset (VIDEO_TIMING_*). The bitstream ignores presets
+  // its PLL cannot clock (480p and 800x600 on the stock build); returns
+  // false if the preset did not read back and the old timing stays.
+  bool setVideoTiming(uint8_t preset);
+  uint8_t getVideoTiming();
+  
+  // Frame checksum: CRC32 (as zlib crc32()) of the last complete frame's
+  // active pixels, R, G, B. Record it from a known-good screen, then
+  // expectFrameCrc() polls until a frame matches or the timeout ends.
+  // hasFrameCrc() is false on bitstreams without it (no framebuffer
+  // registers, or a frame count that does not advance); readFrameCrc()
+  // then returns 0 and expectFrameCrc() false.
+  bool hasFrameCrc();
+  uint32_t readFrameCrc();
+  uint8_t getFrameCount();
+  bool expectFrameCrc(uint32_t expected, unsigned long timeoutMs = 100);
+  
+  // Reset recovery: begin() writes a token to the epoch register, which an
+  // FPGA reset clears, and isAlive() reads it back. After a false,
+  // resync() waits for the FPGA and replays the video mode, timing, test
+  // pattern, text color, text palette and framebuffer geometry, viewport,
+  // border and palette last set. Text and VRAM contents are not kept, so
+  // redraw them afterwards. isAlive() is always true and resync() false on
+  // bitstreams without the epoch register.
+  bool isAlive();
+  bool resync(unsigned long timeoutMs = 5000);
+  
+  // Framebuffer functions (160x120 RGB332 by default)
   void enableFramebuffer();
   void clearFramebuffer(uint8_t color = 0x00);
-  void setPixel(uint8_t x, uint8_t y, uint8_t color);
-  void fillRect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t color);
+  void setPixel(uint16_t x, uint16_t y, uint8_t color);
+  void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t color);
   void drawColorBars();
   
+  // Framebuffer geometry (width/height/format are read back in begin())
+  // Colors are RGB332 in FB_FORMAT_RGB332, palette indices in FB_FORMAT_INDEXED4.
+  bool setFramebufferGeometry(uint16_t width, uint16_t height,
+                              uint8_t format = FB_FORMAT_RGB332, uint8_t scale = 1);
+  void setFramebufferViewport(uint16_t x, uint16_t y);
+  void setFramebufferBorder(uint8_t color);
+  void setFramebufferPalette(uint8_t index, uint8_t color);
+  uint16_t getFramebufferWidth() const { return _fbWidth; }
+  uint16_t getFramebufferHeight() const { return _fbHeight; }
+  uint8_t getFramebufferFormat() const { return _fbFormat; }
+  
   // RGB332 color helper: r(0-7), g(0-7), b(0-3)
   static uint8_t rgb332(uint8_t r, uint8_t g, uint8_t b) {
     return ((r & 0x07) << 5) | ((g & 0x07) << 2) | (b & 0x03);
@@ -120,12 +220,48 @@ public:
   // Wishbone register access (public for HDMILiquidCrystal scroll functions)
   void wishboneWrite8(uint16_t address, uint8_t data);
   uint8_t wishboneRead8(uint16_t address);
+  
+  // Low-latency bus path (same scheme as VGA_class)
+  // Hardware CS sends each frame as one polled burst; the CS pin must be
+  // the SS pin the SPIClass was begun with. Returns false if unsupported.
+  bool enableHardwareCS(bool enable = true);
+  void setBusClock(uint32_t hz) { _bus.setClock(hz); }
+  void beginBus();
+  void endBus();
+  
+  // Holds the bus for a batch of register updates (cursor, scroll, ...)
+  class BusSession {
+  public:
+    explicit BusSession(HDMIController& hdmi) : _hdmi(hdmi) { _hdmi.beginBus(); }
+    ~BusSession() { _hdmi.endBus(); }
+  private:
+    BusSession(const BusSession&);
+    BusSession& operator=(const BusSession&);
+    HDMIController& _hdmi;
+  };
 
 private:
   SPIClass* _spi;
   bool _ownSpi;
   uint8_t _cs;
   uint8_t _clk, _mosi, _miso;
+  WishboneBus _bus;
+  uint16_t _fbWidth, _fbHeight, _fbStride;
+  uint8_t _fbFormat, _fbScale, _fbWmask;
+  int8_t _textPal;  // text palette present: -1 unknown, 0 no, 1 yes
+  bool _fbKnown;    // framebuffer registers present
+  int8_t _frameCrc; // frame CRC present: -1 unknown, 0 no, 1 yes
+  // Last values written, replayed by resync()
+  uint8_t _mode, _timing, _pattern, _textAttr;
+  uint8_t _textRgb[48];
+  bool _textRgbSet;
+  uint16_t _fbViewX, _fbViewY;
+  uint8_t _fbBorder;
+  uint8_t _fbPalette[16];
+  int8_t _epochReg;  // epoch register present: -1 unknown, 0 no, 1 yes
+  uint8_t _epoch;
+  bool readFramebufferGeometry();
+  bool armEpoch();
   void wishboneWrite(uint32_t address, uint32_t data);
   uint32_t wishboneRead(uint32_t address);
 };
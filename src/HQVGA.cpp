@@ -8,6 +8,7 @@
  */
 
 #include "HQVGA.h"
+#include "HQVGA_Kernels.h"
 #include <pgmspace.h>
 
 #define ABS(x) ((x)>0?(x):-1*(x))
@@ -209,13 +210,39 @@ static const uint8_t font8x8[] PROGMEM = {
     0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
 };
 
+// Power-on 4bpp palette of wb_video_framebuffer.v, both banks
+static const VGA_class::pixel_t bootPalette[16] = {
+	0x00, 0x02, 0x14, 0x16, 0xA0, 0xA2, 0xA8, 0xB6,
+	0x49, 0x4B, 0x5D, 0x5F, 0xE9, 0xEB, 0xFD, 0xFF
+};
+
 VGA_class::VGA_class() 
 	: _spi(nullptr), _ownSpi(false), _cs(10), _clk(12), _mosi(11), _miso(9),
-	  _wbBase(HQVGA_WISHBONE_BASE), fg(WHITE), bg(BLACK), 
-	  blitOffset(0), blitw(0), cblit(0) {
+	  _wbBase(HQVGA_WISHBONE_BASE),
+	  _width(VGA_HSIZE), _height(VGA_VSIZE), _stride(VGA_HSIZE),
+	  _format(HQVGA_FORMAT_RGB332), _scale(6), _wmask(0x03), _known(false),
+	  fg(WHITE), bg(BLACK), 
+	  blitx(0), blity(0), blitw(0), cblit(0), _blitFill(0),
+	  _win(-1), _winBase(0), _winW(0), _winH(0), _winFill(0),
+	  _lsLine(nullptr), _lsWidth(0), _lsHeight(0), _lsFormat(HQVGA_FORMAT_RGB332),
+	  _dual(false), _layer(0), _layerCtrl(0), _affine(false), _rop(ROP_REPLACE),
+	  _hold(-1), _stateDepth(0), _frameCrc(-1), _readback(-1),
+	  _mode(2), _viewX(160), _viewY(0), _border(0), _affCtrl(0), _ropKey(0), _lsScale(1),
+	  _epochReg(-1), _epoch(0), _linkCheck(false), _frameBursts(0) {
+	// Power-on layer setup: layer 0 opaque in bank 0, layer 1 in bank 1
+	// with index 0 transparent
+	_lCtrl[0] = 0x00;
+	_lCtrl[1] = 0x30;
+	memcpy(_palette[0], bootPalette, sizeof(bootPalette));
+	memcpy(_palette[1], bootPalette, sizeof(bootPalette));
+	memset(_scroll, 0, sizeof(_scroll));
+	memset(_affParams, 0, sizeof(_affParams));
+	_affParams[2] = _affParams[5] = 0x100;
+	memset(&_linkStats, 0, sizeof(_linkStats));
 }
 
 VGA_class::~VGA_class() {
+	delete[] _lsLine;
 	if (_ownSpi && _spi) {
 		delete _spi;
 	}
@@ -237,6 +264,7 @@ void VGA_class::begin(SPIClass* spi, uint8_t csPin, uint8_t spiClk,
 		_spi = spi;
 		_ownSpi = false;
 	}
+	_bus.attach(_spi, _cs);
 	
 	pinMode(_cs, OUTPUT);
 	digitalWrite(_cs, HIGH);
@@ -244,10 +272,21 @@ void VGA_class::begin(SPIClass* spi, uint8_t csPin, uint8_t spiClk,
 	// Wait for FPGA to be ready (handles bootloader delay and polling)
 	waitForFPGA(5000);
 	
+	// Pick up whatever framebuffer layout the FPGA is configured for
+	bool known = readGeometry();
+	
 	// Set framebuffer mode
 	setVideoMode(2);
 	delay(50);
 	setVideoMode(2);  // Double-write for reliability
+	
+	// Bitstreams without geometry registers alias the epoch register onto
+	// the text controller, so leave it alone there
+	_epochReg = known && armEpoch();
+	
+	// Without the border register to probe with, bursts get one CS per frame
+	_frameBursts = known ? -1 : 0;
+	_bus.setFrameBursts(false);
 }
 
 bool VGA_class::waitForFPGA(unsigned long timeoutMs) {
@@ -279,44 +318,588 @@ bool VGA_class::waitForFPGA(unsigned long timeoutMs) {
 
 uint8_t VGA_class::getVideoMode() {
 	// Read from video mode control register at address 0x0000
+	return readRegister(HQVGA_REG_VIDEO_MODE) & 0x03;
+}
+
+void VGA_class::setVideoMode(uint8_t mode) {
+	// Write to video mode control register at address 0x0000
+	// Mode values: 0=TestPattern, 1=Text, 2=Framebuffer
+	_mode = mode & 0x03;
+	writeRegister(HQVGA_REG_VIDEO_MODE, _mode);
+}
+
+bool VGA_class::hasBootSplash() {
+	// Older bitstreams alias the register onto the video mode (bit 7 clear)
+	return readRegister(HQVGA_REG_BOOT) & 0x80;
+}
+
+void VGA_class::setBootMode(uint8_t mode) {
+	writeRegister(HQVGA_REG_BOOT, mode & 0x03);
+}
+
+uint8_t VGA_class::getBootMode() {
+	return readRegister(HQVGA_REG_BOOT) & 0x03;
+}
+
+void VGA_class::writeRegister(uint16_t addr, uint8_t data) {
+	// Control register write (absolute Wishbone address)
+	if (fastBus()) {
+		_bus.write(addr, data);
+		return;
+	}
+	
 	// Use same settings as HDMIController which works reliably
 	_spi->beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
 	digitalWrite(_cs, LOW);
 	
-	_spi->transfer(0x00);  // CMD: Read command
-	_spi->transfer(0x00);  // ADDR_HIGH: 0x00
-	_spi->transfer(0x00);  // ADDR_LOW: 0x00
-	delayMicroseconds(2);  // Wait for Wishbone read
-	uint8_t mode = _spi->transfer(0x00);  // DATA: read result
+	_spi->transfer(0x01);                  // CMD: Write command
+	_spi->transfer((addr >> 8) & 0xFF);    // ADDR_HIGH
+	_spi->transfer(addr & 0xFF);           // ADDR_LOW
+	_spi->transfer(data);                  // DATA
 	
 	digitalWrite(_cs, HIGH);
 	_spi->endTransaction();
-	
-	return mode & 0x03;
 }
 
-void VGA_class::setVideoMode(uint8_t mode) {
-	// Write to video mode control register at address 0x0000
-	// Mode values: 0=TestPattern, 1=Text, 2=Framebuffer
-	// Use same settings as HDMIController which works reliably
+uint8_t VGA_class::readRegister(uint16_t addr) {
+	// Control register read (absolute Wishbone address)
+	if (fastBus())
+		return _bus.read(addr, 2);
+	
 	_spi->beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
 	digitalWrite(_cs, LOW);
 	
-	_spi->transfer(0x01);  // CMD: Write command
-	_spi->transfer(0x00);  // ADDR_HIGH: 0x00
-	_spi->transfer(0x00);  // ADDR_LOW: 0x00
-	_spi->transfer(mode & 0x03);  // DATA: video mode (0-2)
+	_spi->transfer(0x00);                  // CMD: Read command
+	_spi->transfer((addr >> 8) & 0xFF);    // ADDR_HIGH
+	_spi->transfer(addr & 0xFF);           // ADDR_LOW
+	delayMicroseconds(2);                  // Wait for Wishbone read
+	uint8_t result = _spi->transfer(0x00); // DATA: read result
 	
 	digitalWrite(_cs, HIGH);
 	_spi->endTransaction();
+	
+	return result;
+}
+
+bool VGA_class::enableHardwareCS(bool enable) {
+	return _bus.enableHardwareCS(enable);
+}
+
+void VGA_class::beginBus() {
+	_bus.begin();
+}
+
+void VGA_class::endBus() {
+	_bus.end();
+}
+
+bool VGA_class::readGeometry() {
+	unsigned width = readRegister(HQVGA_REG_FB_WIDTH_LO) |
+	                 ((readRegister(HQVGA_REG_FB_WIDTH_HI) & 0x01) << 8);
+	unsigned height = readRegister(HQVGA_REG_FB_HEIGHT_LO) |
+	                  ((readRegister(HQVGA_REG_FB_HEIGHT_HI) & 0x01) << 8);
+	uint8_t format = readRegister(HQVGA_REG_FB_FORMAT) & 0x01;
+	uint8_t scale = readRegister(HQVGA_REG_FB_SCALE) & 0x0F;
+	unsigned hres = readRegister(HQVGA_REG_FB_HRES_LO) |
+	                ((readRegister(HQVGA_REG_FB_HRES_HI) & 0x0F) << 8);
+	
+	// Bitstreams without geometry registers alias this range onto the text
+	// controller, so only trust the values if the active width is a real one
+	bool known = (hres == 640 || hres == 800 || hres == 1280 || hres == 1920);
+	_known = known;
+	_winW = 0;
+	unsigned stride = (format == HQVGA_FORMAT_INDEXED4) ? (width + 1) / 2 : width;
+	if (!known || width == 0 || height == 0 || stride * height > HQVGA_VRAM_SIZE) {
+		// Older bitstream without geometry registers: fixed 160x120 RGB332
+		_width = VGA_HSIZE;
+		_height = VGA_VSIZE;
+		_stride = VGA_HSIZE;
+		_format = HQVGA_FORMAT_RGB332;
+		_scale = 6;
+		_dual = false;
+		_layer = 0;
+		return false;
+	}
+	
+	_width = width;
+	_height = height;
+	_stride = stride;
+	_format = format;
+	_scale = scale ? scale : 1;
+	_wmask = readRegister(HQVGA_REG_FB_WMASK) & 0x03;
+	_viewX = readRegister(HQVGA_REG_FB_VIEW_X_LO) |
+	         ((readRegister(HQVGA_REG_FB_VIEW_X_HI) & 0x0F) << 8);
+	_viewY = readRegister(HQVGA_REG_FB_VIEW_Y_LO) |
+	         ((readRegister(HQVGA_REG_FB_VIEW_Y_HI) & 0x0F) << 8);
+	_border = readRegister(HQVGA_REG_FB_BORDER);
+	
+	// A raster op or state hold left on by an earlier run would garble
+	// every drawing call or freeze the picture
+	writeRegister(HQVGA_REG_ROP, ROP_REPLACE);
+	writeRegister(HQVGA_REG_STATE_CTRL, 0x00);
+	_rop = ROP_REPLACE;
+	_stateDepth = 0;
+	
+	// Pick up layers left enabled by an earlier run (reads 0 on bitstreams
+	// without them)
+	_layerCtrl = readRegister(HQVGA_REG_LAYER_CTRL) & 0x03;
+	_dual = (_layerCtrl & 0x01) && _format == HQVGA_FORMAT_INDEXED4;
+	if (_dual) {
+		_lCtrl[0] = readRegister(HQVGA_REG_L0_CTRL) & 0x3F;
+		_lCtrl[1] = readRegister(HQVGA_REG_L0_CTRL + HQVGA_LAYER_REG_STRIDE) & 0x3F;
+	}
+	_layer = 0;
+	return true;
+}
+
+bool VGA_class::setGeometry(unsigned width, unsigned height, uint8_t format, uint8_t scale) {
+	format &= 0x01;
+	unsigned stride = (format == HQVGA_FORMAT_INDEXED4) ? (width + 1) / 2 : width;
+	if (width == 0 || width > 511 || height == 0 || height > 511 ||
+	    stride * height > HQVGA_VRAM_SIZE)
+		return false;
+	if (_dual && (format != HQVGA_FORMAT_INDEXED4 || scale < 2 ||
+	              2 * stride * height > HQVGA_VRAM_SIZE))
+		return false;
+	if (scale < 1) scale = 1;
+	if (scale > 15) scale = 15;
+	
+	// New layout and its viewport show from the same frame
+	StateUpdate update(*this);
+	writeRegister(HQVGA_REG_FB_WIDTH_LO, width & 0xFF);
+	writeRegister(HQVGA_REG_FB_WIDTH_HI, width >> 8);
+	writeRegister(HQVGA_REG_FB_HEIGHT_LO, height & 0xFF);
+	writeRegister(HQVGA_REG_FB_HEIGHT_HI, height >> 8);
+	writeRegister(HQVGA_REG_FB_FORMAT, format);
+	writeRegister(HQVGA_REG_FB_SCALE, scale);
+	
+	// The window steps rows by the stride, so set it up again
+	_winW = 0;
+	_width = width;
+	_height = height;
+	_stride = stride;
+	_format = format;
+	_scale = scale;
+	
+	centerViewport();
+	return true;
+}
+
+void VGA_class::setViewport(unsigned x, unsigned y) {
+	_viewX = x & 0x0FFF;
+	_viewY = y & 0x0FFF;
+	StateUpdate update(*this);
+	writeRegister(HQVGA_REG_FB_VIEW_X_LO, x & 0xFF);
+	writeRegister(HQVGA_REG_FB_VIEW_X_HI, (x >> 8) & 0x0F);
+	writeRegister(HQVGA_REG_FB_VIEW_Y_LO, y & 0xFF);
+	writeRegister(HQVGA_REG_FB_VIEW_Y_HI, (y >> 8) & 0x0F);
+}
+
+void VGA_class::centerViewport() {
+	// Active resolution of the current timing preset (720p if unreadable)
+	unsigned hres = readRegister(HQVGA_REG_FB_HRES_LO) |
+	                ((readRegister(HQVGA_REG_FB_HRES_HI) & 0x0F) << 8);
+	unsigned vres = readRegister(HQVGA_REG_FB_VRES_LO) |
+	                ((readRegister(HQVGA_REG_FB_VRES_HI) & 0x0F) << 8);
+	if (hres == 0 || vres == 0) {
+		hres = 1280;
+		vres = 720;
+	}
+	
+	unsigned w = _width * _scale;
+	unsigned h = _height * _scale;
+	setViewport(w < hres ? (hres - w) / 2 : 0,
+	            h < vres ? (vres - h) / 2 : 0);
+}
+
+void VGA_class::setBorderColor(pixel_t color) {
+	_border = color;
+	writeRegister(HQVGA_REG_FB_BORDER, color);
+}
+
+void VGA_class::setPaletteEntry(uint8_t index, pixel_t color, uint8_t bank) {
+	_palette[bank ? 1 : 0][index & 0x0F] = color;
+	writeRegister((bank ? HQVGA_REG_FB_PALETTE1 : HQVGA_REG_FB_PALETTE) + (index & 0x0F), color);
+}
+
+bool VGA_class::enableDualPlayfield(bool enable) {
+	if (!enable) {
+		_layerCtrl &= ~0x01;
+		writeRegister(HQVGA_REG_LAYER_CTRL, _layerCtrl);
+		_dual = false;
+		_layer = 0;
+		return true;
+	}
+	
+	if (!_known || _format != HQVGA_FORMAT_INDEXED4 || _scale < 2 ||
+	    2 * _stride * _height > HQVGA_VRAM_SIZE)
+		return false;
+	
+	// Bitstreams with geometry registers but no layers read them back as 0
+	writeRegister(HQVGA_REG_LAYER_CTRL, _layerCtrl | 0x01);
+	if (!(readRegister(HQVGA_REG_LAYER_CTRL) & 0x01))
+		return false;
+	_layerCtrl |= 0x01;
+	_dual = true;
+	return true;
+}
+
+void VGA_class::setLayer(uint8_t layer) {
+	_layer = (_dual && layer) ? 1 : 0;
+}
+
+void VGA_class::writeLayerCtrl(uint8_t layer, uint8_t ctrl) {
+	_lCtrl[layer & 1] = ctrl;
+	writeRegister(HQVGA_REG_L0_CTRL + (layer & 1) * HQVGA_LAYER_REG_STRIDE, ctrl);
+}
+
+void VGA_class::setLayerScroll(uint8_t layer, int x, int y) {
+	x %= (int)_width;
+	y %= (int)_height;
+	if (x < 0) x += _width;
+	if (y < 0) y += _height;
+	
+	_scroll[layer & 1][0] = x;
+	_scroll[layer & 1][1] = y;
+	writeLayerScroll(layer);
+}
+
+void VGA_class::writeLayerScroll(uint8_t layer) {
+	uint16_t reg = HQVGA_REG_L0_SCROLL_X_LO + (layer & 1) * HQVGA_LAYER_REG_STRIDE;
+	const uint16_t *s = _scroll[layer & 1];
+	StateUpdate update(*this);
+	writeRegister(reg, s[0] & 0xFF);
+	writeRegister(reg + 1, s[0] >> 8);
+	writeRegister(reg + 2, s[1] & 0xFF);
+	writeRegister(reg + 3, s[1] >> 8);
+}
+
+void VGA_class::setLayerTransparent(uint8_t layer, int index) {
+	uint8_t ctrl = _lCtrl[layer & 1] & 0x20;
+	if (index >= 0)
+		ctrl |= 0x10 | (index & 0x0F);
+	writeLayerCtrl(layer, ctrl);
+}
+
+void VGA_class::setLayerPaletteBank(uint8_t layer, uint8_t bank) {
+	writeLayerCtrl(layer, (_lCtrl[layer & 1] & 0x1F) | (bank ? 0x20 : 0x00));
+}
+
+void VGA_class::setFrontLayer(uint8_t layer) {
+	_layerCtrl = (_layerCtrl & 0x01) | (layer ? 0x00 : 0x02);
+	writeRegister(HQVGA_REG_LAYER_CTRL, _layerCtrl);
+}
+
+// Fold a 16.8 value into [0, size)
+static int32_t wrapFixed(int32_t v, int32_t size) {
+	v %= size;
+	return v < 0 ? v + size : v;
+}
+
+bool VGA_class::enableAffine(uint8_t ctrl) {
+	// Without geometry registers the block aliases onto the text controller
+	if (!_known)
+		return false;
+	_affCtrl = ctrl;
+	writeRegister(HQVGA_REG_AFF_CTRL, ctrl);
+	if (_affine)
+		return true;
+	// Bitstreams with geometry registers but no affine block read it as 0
+	if (readRegister(HQVGA_REG_AFF_CTRL) != ctrl)
+		return false;
+	_affine = true;
+	return true;
+}
+
+bool VGA_class::setRasterOp(RasterOp op, pixel_t key) {
+	// Without geometry registers ROP and ROP_KEY alias onto the text RAM
+	// pointer and char RAM port, so nothing is written there
+	if (!_known)
+		return op == ROP_REPLACE;
+	writeRegister(HQVGA_REG_ROP, op);
+	// Bitstreams with geometry registers but no raster ops read it as 0
+	if (op != ROP_REPLACE && readRegister(HQVGA_REG_ROP) != op)
+		return false;
+	if (op == ROP_KEY) {
+		// 4bpp compares each nibble, so the index goes in both
+		if (_format == HQVGA_FORMAT_INDEXED4)
+			key = (key & 0x0F) * 0x11;
+		_ropKey = key;
+		writeRegister(HQVGA_REG_ROP_KEY, key);
+	}
+	_rop = op;
+	return true;
+}
+
+bool VGA_class::beginStateUpdate() {
+	if (_hold < 0) {
+		// Without geometry registers STATE_CTRL is the text attribute RAM
+		// port, so it is only probed where the block exists. Bitstreams
+		// with geometry registers but no hold read it back as 0.
+		_hold = 0;
+		if (_known) {
+			writeRegister(HQVGA_REG_STATE_CTRL, 0x01);
+			_hold = readRegister(HQVGA_REG_STATE_CTRL) & 0x01;
+			if (_hold) {
+				_stateDepth = 1;
+				return true;
+			}
+		}
+	}
+	if (_hold <= 0)
+		return false;
+	if (_stateDepth++ == 0)
+		writeRegister(HQVGA_REG_STATE_CTRL, 0x01);
+	return true;
+}
+
+void VGA_class::commitAtVBlank() {
+	if (_hold <= 0 || _stateDepth == 0)
+		return;
+	if (--_stateDepth == 0)
+		writeRegister(HQVGA_REG_STATE_CTRL, 0x00);
+}
+
+bool VGA_class::isCommitPending() {
+	return _hold > 0 && (readRegister(HQVGA_REG_STATE_CTRL) & 0x02);
+}
+
+bool VGA_class::hasFrameCrc() {
+	if (_frameCrc < 0) {
+		// Bitstreams without the CRC decode 0x0004-0x0008 as the video mode
+		// register, which reads back the same value every time; a real
+		// frame counter moves within 100 ms at any timing preset
+		_frameCrc = 0;
+		if (_known) {
+			uint8_t frame = getFrameCount();
+			unsigned long start = millis();
+			while (!_frameCrc && millis() - start < 100) {
+				delay(1);
+				_frameCrc = getFrameCount() != frame;
+			}
+		}
+	}
+	return _frameCrc > 0;
+}
+
+uint32_t VGA_class::readFrameCrc() {
+	if (!hasFrameCrc())
+		return 0;
+	// The low byte snapshots the other three, so all four are one frame's
+	BusSession bus(*this);
+	uint32_t crc = 0;
+	for (int i = 0; i < 4; i++)
+		crc |= (uint32_t)readRegister(HQVGA_REG_FRAME_CRC + i) << (8 * i);
+	return crc;
+}
+
+uint8_t VGA_class::getFrameCount() {
+	return readRegister(HQVGA_REG_FRAME_COUNT);
+}
+
+bool VGA_class::expectFrameCrc(uint32_t expected, unsigned long timeoutMs) {
+	if (!hasFrameCrc())
+		return false;
+	unsigned long start = millis();
+	do {
+		if (readFrameCrc() == expected)
+			return true;
+		delay(1);
+	} while (millis() - start < timeoutMs);
+	return false;
+}
+
+bool VGA_class::armEpoch() {
+	// A new token each time, never 0 (reset) or 0xFF (MISO with no FPGA)
+	_epoch = _epoch % 0xFE + 1;
+	writeRegister(HQVGA_REG_EPOCH, _epoch);
+	return readRegister(HQVGA_REG_EPOCH) == _epoch;
+}
+
+bool VGA_class::isAlive() {
+	return _epochReg <= 0 || readRegister(HQVGA_REG_EPOCH) == _epoch;
+}
+
+bool VGA_class::resync(const pixel_t *image, int imageStride, unsigned long timeoutMs) {
+	if (_epochReg <= 0)
+		return false;
+
+	// The token reads back once the FPGA is configured and out of reset
+	unsigned long start = millis();
+	while (!armEpoch()) {
+		if (millis() - start >= timeoutMs)
+			return false;
+		delay(10);
+	}
+
+	BusSession bus(*this);
+	{
+		StateUpdate update(*this);
+		writeRegister(HQVGA_REG_FB_WIDTH_LO, _width & 0xFF);
+		writeRegister(HQVGA_REG_FB_WIDTH_HI, _width >> 8);
+		writeRegister(HQVGA_REG_FB_HEIGHT_LO, _height & 0xFF);
+		writeRegister(HQVGA_REG_FB_HEIGHT_HI, _height >> 8);
+		writeRegister(HQVGA_REG_FB_FORMAT, _format);
+		writeRegister(HQVGA_REG_FB_SCALE, _scale);
+		setViewport(_viewX, _viewY);
+		writeRegister(HQVGA_REG_FB_BORDER, _border);
+		for (int i = 0; i < 16; i++) {
+			writeRegister(HQVGA_REG_FB_PALETTE + i, _palette[0][i]);
+			writeRegister(HQVGA_REG_FB_PALETTE1 + i, _palette[1][i]);
+		}
+
+		writeRegister(HQVGA_REG_LAYER_CTRL, _layerCtrl);
+		for (uint8_t layer = 0; layer < 2; layer++) {
+			writeLayerCtrl(layer, _lCtrl[layer]);
+			writeLayerScroll(layer);
+		}
+
+		if (_affine && !(_affCtrl & 0x02)) {
+			writeAffineParams();
+			writeRegister(HQVGA_REG_AFF_CTRL, _affCtrl);
+		} else {
+			_affine = false;
+			_affCtrl = 0x00;
+		}
+
+		if (_lsLine)
+			beginLineStream(_lsWidth, _lsHeight, _lsFormat, _lsScale);
+		writeRegister(HQVGA_REG_VIDEO_MODE, _mode);
+	}
+
+	// The window registers came back cleared; the upload runs before the
+	// raster op is restored so the picture lands as it is
+	_winW = 0;
+	writeRegister(HQVGA_REG_FB_WMASK, 0x03);
+	_wmask = 0x03;
+	if (image)
+		uploadImage(0, 0, _width, _height, image, imageStride);
+	if (_rop != ROP_REPLACE) {
+		writeRegister(HQVGA_REG_ROP_KEY, _ropKey);
+		writeRegister(HQVGA_REG_ROP, _rop);
+	}
+	return true;
+}
+
+bool VGA_class::setAffine(const Affine& m, bool clamp) {
+	if (!_known)
+		return false;
+	int32_t p[6] = { m.u0, m.v0, m.dudx, m.dvdx, m.dudy, m.dvdy };
+	if (!clamp) {
+		// The FPGA wraps incrementally: start inside the image, steps
+		// smaller than it
+		int32_t w = (int32_t)_width << 8, h = (int32_t)_height << 8;
+		p[0] = wrapFixed(p[0], w);
+		p[1] = wrapFixed(p[1], h);
+		p[2] %= w;
+		p[3] %= h;
+		p[4] %= w;
+		p[5] %= h;
+	}
+	
+	memcpy(_affParams, p, sizeof(p));
+	
+	beginBus();
+	beginStateUpdate();
+	writeAffineParams();
+	bool ok = enableAffine(clamp ? 0x05 : 0x01);
+	commitAtVBlank();
+	endBus();
+	return ok;
+}
+
+void VGA_class::writeAffineParams() {
+	for (int i = 0; i < 6; i++) {
+		uint16_t reg = HQVGA_REG_AFF_U0 + 4 * i;
+		writeRegister(reg, _affParams[i] & 0xFF);
+		writeRegister(reg + 1, (_affParams[i] >> 8) & 0xFF);
+		writeRegister(reg + 2, (_affParams[i] >> 16) & 0xFF);
+	}
+}
+
+bool VGA_class::setAffineRotZoom(float angle, float zoom, float cx, float cy, bool clamp) {
+	if (zoom <= 0)
+		return false;
+	float c = cosf(angle) / zoom, s = sinf(angle) / zoom;
+	float hx = _width * 0.5f, hy = _height * 0.5f;
+	
+	// Screen to texture is the inverse rotation, scaled down by the zoom
+	Affine m;
+	m.dudx = lroundf(c * 256);
+	m.dvdx = lroundf(-s * 256);
+	m.dudy = lroundf(s * 256);
+	m.dvdy = lroundf(c * 256);
+	m.u0 = lroundf((cx - hx * c - hy * s) * 256);
+	m.v0 = lroundf((cy + hx * s - hy * c) * 256);
+	return setAffine(m, clamp);
+}
+
+bool VGA_class::setAffineLines(unsigned first, unsigned count, const AffineLine *lines,
+                               bool clamp) {
+	if (!_known || first >= HQVGA_AFF_TABLE_LINES)
+		return false;
+	if (count > HQVGA_AFF_TABLE_LINES - first)
+		count = HQVGA_AFF_TABLE_LINES - first;
+	
+	int32_t w = (int32_t)_width << 8, h = (int32_t)_height << 8;
+	uint8_t entries[32 * 8];
+	
+	beginBus();
+	for (unsigned done = 0; done < count; ) {
+		unsigned n = count - done < 32 ? count - done : 32;
+		for (unsigned i = 0; i < n; i++) {
+			const AffineLine &l = lines[done + i];
+			int32_t u = l.u, v = l.v, du = l.dudx, dv = l.dvdx;
+			if (!clamp) {
+				u = wrapFixed(u, w);
+				v = wrapFixed(v, h);
+				du %= w;
+				dv %= h;
+			}
+			// Start as 12.4, step as 8.8
+			int16_t e[4] = {
+				(int16_t)constrain(u >> 4, -32768, 32767),
+				(int16_t)constrain(v >> 4, -32768, 32767),
+				(int16_t)constrain(du, -32768, 32767),
+				(int16_t)constrain(dv, -32768, 32767)
+			};
+			for (int k = 0; k < 4; k++) {
+				entries[i * 8 + k * 2] = e[k] & 0xFF;
+				entries[i * 8 + k * 2 + 1] = (e[k] >> 8) & 0xFF;
+			}
+		}
+		burstRow(HQVGA_AFF_TABLE + (first + done) * 8, entries, n * 8, false);
+		done += n;
+	}
+	bool ok = enableAffine(clamp ? 0x07 : 0x03);
+	endBus();
+	return ok;
+}
+
+void VGA_class::disableAffine() {
+	writeRegister(HQVGA_REG_AFF_CTRL, 0x00);
+	_affine = false;
+	_affCtrl = 0x00;
+}
+
+void VGA_class::setWriteMask(uint8_t mask) {
+	// Nibble write enables for 4bpp: bit 1 = high (even x), bit 0 = low (odd x)
+	if (mask == _wmask)
+		return;
+	writeRegister(HQVGA_REG_FB_WMASK, mask);
+	_wmask = mask;
 }
 
 void VGA_class::writeWishbone(uint16_t addr, uint8_t data) {
-	// HQVGA frame buffer: pixel address 0-19199 (160x120)
+	// HQVGA frame buffer: byte offset 0 to stride * height - 1
 	// Framebuffer starts at address 0x0100 in the Wishbone address map
 	// 4-byte SPI protocol: CMD | ADDR_HIGH | ADDR_LOW | DATA
 	
-	uint16_t wb_addr = 0x0100 + addr;  // Framebuffer base + pixel offset
+	uint16_t wb_addr = HQVGA_FB_BASE + addr;  // Framebuffer base + byte offset
+	if (fastBus()) {
+		_bus.write(wb_addr, data);
+		return;
+	}
 	
 	// Use faster speed for bulk writes (4MHz works well for writes)
 	_spi->beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE0));
@@ -336,11 +919,13 @@ void VGA_class::writeWishbone(uint16_t addr, uint8_t data) {
 }
 
 uint8_t VGA_class::readWishbone(uint16_t addr) {
-	// HQVGA frame buffer: pixel address 0-19199 (160x120)
+	// HQVGA frame buffer: byte offset 0 to stride * height - 1
 	// Framebuffer starts at address 0x0100 in the Wishbone address map
 	// 4-byte SPI protocol: CMD | ADDR_HIGH | ADDR_LOW | DATA
 	
-	uint16_t wb_addr = 0x0100 + addr;  // Framebuffer base + pixel offset
+	uint16_t wb_addr = HQVGA_FB_BASE + addr;  // Framebuffer base + byte offset
+	if (fastBus())
+		return _bus.read(wb_addr, 50);
 	
 	// Use slower speed for reads to allow FPGA time to respond
 	_spi->beginTransaction(SPISettings(100000, MSBFIRST, SPI_MODE0));
@@ -367,27 +952,38 @@ void VGA_class::putPixel(int x, int y) {
 }
 
 void VGA_class::putPixel(int x, int y, pixel_t color) {
-	if (x < 0 || x >= (int)VGA_HSIZE || y < 0 || y >= (int)VGA_VSIZE)
+	if (x < 0 || x >= (int)_width || y < 0 || y >= (int)_height)
 		return;
 	
 	uint16_t offset = getOffset(x, y);
-	writeWishbone(offset, color);
+	if (_format == HQVGA_FORMAT_INDEXED4) {
+		// Only the addressed nibble is written; no read-modify-write needed
+		setWriteMask((x & 1) ? 0x01 : 0x02);
+		writeWishbone(offset, (color & 0x0F) * 0x11);
+	} else {
+		setWriteMask(0x03);
+		writeWishbone(offset, color);
+	}
 }
 
 VGA_class::pixel_t VGA_class::getPixel(int x, int y) {
-	if (x < 0 || x >= (int)VGA_HSIZE || y < 0 || y >= (int)VGA_VSIZE)
+	if (x < 0 || x >= (int)_width || y < 0 || y >= (int)_height)
 		return 0;
 	
 	uint16_t offset = getOffset(x, y);
-	return readWishbone(offset);
+	pixel_t data = readWishbone(offset);
+	if (_format == HQVGA_FORMAT_INDEXED4)
+		return (x & 1) ? (data & 0x0F) : (data >> 4);
+	return data;
 }
 
 void VGA_class::clear() {
-	// Clear entire screen to background color
-	pixel_t oldFg = fg;
-	fg = bg;
-	drawRect(0, 0, VGA_HSIZE, VGA_VSIZE);
-	fg = oldFg;
+	// Clear entire screen to background color, one full VRAM byte at a time
+	pixel_t fill = (_format == HQVGA_FORMAT_INDEXED4) ? (bg & 0x0F) * 0x11 : bg;
+	setWriteMask(0x03);
+	for (unsigned offset = 0; offset < _stride * _height; offset++) {
+		writeWishbone(layerBase() + offset, fill);
+	}
 	
 	// Re-assert framebuffer mode after large write operation
 	// This ensures the video mode stays set
@@ -428,7 +1024,7 @@ void VGA_class::printchar(unsigned int x, unsigned int y, unsigned char c, bool
 			int px = x + cx;
 			int py = y + cy;
 			
-			if (px >= 0 && px < (int)VGA_HSIZE && py >= 0 && py < (int)VGA_VSIZE) {
+			if (px >= 0 && px < (int)_width && py >= 0 && py < (int)_height) {
 				// MSB is leftmost pixel
 				bool pixelOn = (rowBits >> (7 - cx)) & 0x01;
 				
@@ -450,20 +1046,128 @@ void VGA_class::printtext(unsigned x, unsigned y, const char *text, bool trans)
 	}
 }
 
+bool VGA_class::hasReadback() {
+	if (_readback < 0) {
+		_readback = 0;
+		if (_known) {
+			const uint16_t offset = HQVGA_VRAM_SIZE - 1;
+			BusSession bus(*this);
+			if (_rop != ROP_REPLACE)
+				writeRegister(HQVGA_REG_ROP, ROP_REPLACE);
+			setWriteMask(0x03);
+			uint8_t old = readWishbone(offset);
+			writeWishbone(offset, old ^ 0xA5);
+			_readback = readWishbone(offset) == (uint8_t)(old ^ 0xA5);
+			writeWishbone(offset, old);
+			if (_rop != ROP_REPLACE)
+				writeRegister(HQVGA_REG_ROP, _rop);
+		}
+	}
+	return _readback > 0;
+}
+
 void VGA_class::readArea(int x, int y, int width, int height, pixel_t *dest) {
+	// Each VRAM read waits for a free read-port clock on the FPGA (at most a
+	// scanline); one bus session avoids the slow per-read setup
+	beginBus();
 	for (int h = 0; h < height; h++) {
 		for (int w = 0; w < width; w++) {
 			*dest++ = getPixel(x + w, y + h);
 		}
 	}
+	endBus();
 }
 
 void VGA_class::writeArea(int x, int y, int width, int height, pixel_t *source) {
-	for (int h = 0; h < height; h++) {
-		for (int w = 0; w < width; w++) {
-			putPixel(x + w, y + h, *source++);
+	uploadImage(x, y, width, height, source);
+}
+
+// Convert n source pixels, starting at pixel first of a row, to RGB332
+static void convertRow(VGA_class::pixel_t *dst, const uint8_t *src, int first, int n,
+                       VGA_class::PixelFormat format, const VGA_class::pixel_t *palette,
+                       VGA_class::pixel_t fg, VGA_class::pixel_t bg) {
+	switch (format) {
+	case VGA_class::PIXEL_RGB565_LE:
+		src += first * 2;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		if (((uintptr_t)src & 1) == 0) {
+			hqvgaConvert565(dst, (const uint16_t *)src, n);
+			break;
+		}
+#endif
+		for (int i = 0; i < n; i++, src += 2)
+			dst[i] = hqvga565to332(src[0] | (src[1] << 8));
+		break;
+	case VGA_class::PIXEL_RGB565_BE:
+		src += first * 2;
+		for (int i = 0; i < n; i++, src += 2)
+			dst[i] = hqvga565to332((src[0] << 8) | src[1]);
+		break;
+	case VGA_class::PIXEL_RGB888:
+		src += first * 3;
+		for (int i = 0; i < n; i++, src += 3)
+			dst[i] = (src[0] & 0xE0) | ((src[1] >> 3) & 0x1C) | (src[2] >> 6);
+		break;
+	case VGA_class::PIXEL_MONO1:
+		hqvgaExpand1(dst, src, first, n, palette ? palette[1] : fg, palette ? palette[0] : bg);
+		break;
+	case VGA_class::PIXEL_INDEXED8:
+		src += first;
+		for (int i = 0; i < n; i++)
+			dst[i] = palette ? palette[src[i]] : src[i];
+		break;
+	default:
+		memcpy(dst, src + first, n);
+		break;
+	}
+}
+
+void VGA_class::writeArea(int x, int y, int width, int height, const void *source,
+                          int strideBytes, PixelFormat format, const pixel_t *palette) {
+	static const uint8_t bits[] = { 8, 16, 16, 24, 1, 8 };
+	const uint8_t *src = (const uint8_t *)source;
+	if (strideBytes <= 0)
+		strideBytes = (width * bits[format] + 7) / 8;
+	
+	// Clip to the framebuffer; first is the source pixel of column x
+	int first = 0;
+	if (x < 0) { first = -x; width += x; x = 0; }
+	if (y < 0) { src -= (long)y * strideBytes; height += y; y = 0; }
+	if (x + width > (int)_width) width = _width - x;
+	if (y + height > (int)_height) height = _height - y;
+	if (width <= 0 || height <= 0)
+		return;
+	
+	// Native bytes need no conversion
+	if (format == PIXEL_RGB332 || (format == PIXEL_INDEXED8 && !palette)) {
+		uploadImage(x, y, width, height, src + first, strideBytes);
+		return;
+	}
+	
+	pixel_t row[HQVGA_LINE_MAX_BYTES];
+	beginBus();
+	if (openWindow(x, y, width, height)) {
+		for (int j = 0; j < height; j++) {
+			const uint8_t *line = src + (long)j * strideBytes;
+			for (int i = 0; i < width; i += HQVGA_LINE_MAX_BYTES) {
+				int n = (width - i < HQVGA_LINE_MAX_BYTES) ? width - i : HQVGA_LINE_MAX_BYTES;
+				convertRow(row, line, first + i, n, format, palette, fg, bg);
+				windowPixels(row, n);
+			}
+		}
+		closeWindow();
+		endBus();
+		return;
+	}
+	for (int j = 0; j < height; j++) {
+		const uint8_t *line = src + (long)j * strideBytes;
+		for (int i = 0; i < width; i += HQVGA_LINE_MAX_BYTES) {
+			int n = (width - i < HQVGA_LINE_MAX_BYTES) ? width - i : HQVGA_LINE_MAX_BYTES;
+			convertRow(row, line, first + i, n, format, palette, fg, bg);
+			uploadImage(x + i, y + j, n, 1, row);
 		}
 	}
+	endBus();
 }
 
 void VGA_class::moveArea(unsigned x, unsigned y, unsigned width, unsigned height, unsigned tx, unsigned ty) {
@@ -477,23 +1181,365 @@ void VGA_class::moveArea(unsigned x, unsigned y, unsigned width, unsigned height
 	delete[] buffer;
 }
 
+// CRC-16/CCITT (polynomial 0x1021, MSB first), as crc16_write() in
+// video_top_modular.v
+static uint16_t linkCrc(uint16_t crc, const uint8_t *data, size_t len) {
+	while (len--) {
+		crc ^= (uint16_t)*data++ << 8;
+		for (int k = 0; k < 8; k++)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc;
+}
+
+bool VGA_class::enableLinkCheck(bool enable) {
+	if (!enable) {
+		_linkCheck = false;
+		return true;
+	}
+	// Without geometry registers LINK_CTRL is the text cursor_x register
+	if (!_known)
+		return false;
+	// After a restart the status reads present with nothing compared;
+	// bitstreams without the check read it as 0, a silent bus as 0xFF
+	writeRegister(HQVGA_REG_LINK_CTRL, 0x01);
+	_linkCheck = readRegister(HQVGA_REG_LINK_CTRL) == 0x80;
+	return _linkCheck;
+}
+
+void VGA_class::resetLinkStats() {
+	memset(&_linkStats, 0, sizeof(_linkStats));
+}
+
+unsigned VGA_class::getLinkErrors(bool reset) {
+	unsigned count = readRegister(HQVGA_REG_LINK_ERRORS_LO) |
+	                 (readRegister(HQVGA_REG_LINK_ERRORS_HI) << 8);
+	if (reset)
+		writeRegister(HQVGA_REG_LINK_ERRORS_LO, 0x00);
+	return count;
+}
+
+bool VGA_class::probeFrameBursts() {
+	// Two border writes under one CS; a bridge that only takes the first
+	// frame of each assertion leaves the inverted colour behind
+	const uint8_t frames[8] = {
+		0x01, HQVGA_REG_FB_BORDER >> 8, HQVGA_REG_FB_BORDER & 0xFF, (uint8_t)~_border,
+		0x01, HQVGA_REG_FB_BORDER >> 8, HQVGA_REG_FB_BORDER & 0xFF, _border
+	};
+	beginBus();
+	_bus.setFrameBursts(true);
+	_bus.writeFrames(frames, sizeof(frames));
+	bool ok = (readRegister(HQVGA_REG_FB_BORDER) == _border);
+	if (!ok)
+		writeRegister(HQVGA_REG_FB_BORDER, _border);
+	_bus.setFrameBursts(ok);
+	endBus();
+	return ok;
+}
+
+void VGA_class::sendBurst(const uint8_t *frames, size_t len) {
+	if (_frameBursts < 0)
+		_frameBursts = probeFrameBursts();
+	if (!_linkCheck) {
+		_bus.writeFrames(frames, len);
+		return;
+	}
+	
+	// The FPGA runs the CRC over ADDR_HIGH, ADDR_LOW and DATA of each write
+	uint16_t crc = 0xFFFF;
+	for (size_t i = 0; i < len; i += 4)
+		crc = linkCrc(crc, frames + i + 1, 3);
+	const uint8_t restart[4] = { 0x01, 0x00, (uint8_t)HQVGA_REG_LINK_CTRL, 0x01 };
+	const uint8_t expect[8] = {
+		0x01, 0x00, (uint8_t)HQVGA_REG_LINK_CRC_LO, (uint8_t)(crc & 0xFF),
+		0x01, 0x00, (uint8_t)HQVGA_REG_LINK_CRC_HI, (uint8_t)(crc >> 8)
+	};
+	
+	for (int attempt = 0; ; attempt++) {
+		_bus.writeFrames(restart, sizeof(restart));
+		_bus.writeFrames(frames, len);
+		_bus.writeFrames(expect, sizeof(expect));
+		_linkStats.checks++;
+		// Compared and matched; a corrupted read counts as a failure
+		if ((readRegister(HQVGA_REG_LINK_CTRL) & 0x83) == 0x82)
+			return;
+		_linkStats.errors++;
+		if (attempt == HQVGA_LINK_RETRIES || _rop == ROP_XOR) {
+			_linkStats.failures++;
+			return;
+		}
+		_linkStats.retries++;
+	}
+}
+
+void VGA_class::burstRow(uint16_t addr, const pixel_t *src, int count, bool packed) {
+	// Pixels are read straight from the source; only the framed bursts
+	// (CMD | ADDR_HIGH | ADDR_LOW | DATA per byte) are staged here. In 4bpp
+	// count is even or the last byte's low nibble is written as 0.
+	uint8_t frames[HQVGA_BURST_PIXELS * 4];
+	size_t n = 0;
+	
+	for (int i = 0; i < count; i += packed ? 2 : 1) {
+		frames[n++] = 0x01;
+		frames[n++] = addr >> 8;
+		frames[n++] = addr & 0xFF;
+		if (packed)
+			frames[n++] = ((src[i] & 0x0F) << 4) | (i + 1 < count ? src[i + 1] & 0x0F : 0);
+		else
+			frames[n++] = src[i];
+		addr++;
+		if (n == sizeof(frames)) {
+			sendBurst(frames, n);
+			n = 0;
+		}
+	}
+	if (n)
+		sendBurst(frames, n);
+}
+
+void VGA_class::uploadImage(int x, int y, int width, int height, const pixel_t *image,
+                            int imageStride) {
+	if (imageStride <= 0)
+		imageStride = width;
+	
+	// Clip to the framebuffer, advancing the source to match
+	if (x < 0) { image -= x; width += x; x = 0; }
+	if (y < 0) { image -= (long)y * imageStride; height += y; y = 0; }
+	if (x + width > (int)_width) width = _width - x;
+	if (y + height > (int)_height) height = _height - y;
+	if (width <= 0 || height <= 0)
+		return;
+	
+	bool packed = (_format == HQVGA_FORMAT_INDEXED4);
+	
+	beginBus();
+	if (openWindow(x, y, width, height)) {
+		for (int j = 0; j < height; j++)
+			windowPixels(image + (long)j * imageStride, width);
+		closeWindow();
+		endBus();
+		return;
+	}
+	for (int j = 0; j < height; j++) {
+		const pixel_t *src = image + (long)j * imageStride;
+		int i = 0;
+		int end = width;
+		
+		// 4bpp rows that start or end mid-byte write that nibble alone
+		if (packed && (x & 1)) {
+			putPixel(x, y + j, src[0]);
+			i = 1;
+		}
+		if (packed && ((width - i) & 1))
+			end--;
+		
+		setWriteMask(0x03);
+		if (i < end)
+			burstRow(HQVGA_FB_BASE + getOffset(x + i, y + j), src + i, end - i, packed);
+		
+		if (end < width)
+			putPixel(x + end, y + j, src[end]);
+	}
+	endBus();
+}
+
+bool VGA_class::openWindow(int x, int y, int width, int height) {
+	// Single rows gain nothing; in 4bpp the window holds whole bytes
+	bool packed = (_format == HQVGA_FORMAT_INDEXED4);
+	if (height < 2 || (packed && ((x | width) & 1)) || _linkCheck || _lsLine)
+		return false;
+	if (_win < 0) {
+		// Power-on width is 1. Bitstreams without geometry registers alias
+		// the block onto the text controller, whose cursor and attribute
+		// registers read back non-zero, so only probe where it can exist.
+		_win = _known &&
+		       (readRegister(HQVGA_REG_WIN_W_LO) | readRegister(HQVGA_REG_WIN_W_HI)) != 0;
+		_winW = 0;
+	}
+	if (!_win)
+		return false;
+	
+	// Any geometry write rewinds the pointer; write only what changed
+	uint16_t base = getOffset(x, y);
+	uint16_t w = packed ? width / 2 : width;
+	bool all = (_winW == 0);
+	if (all || (base & 0xFF) != (_winBase & 0xFF))
+		writeRegister(HQVGA_REG_WIN_BASE_LO, base & 0xFF);
+	if (all || (base >> 8) != (_winBase >> 8))
+		writeRegister(HQVGA_REG_WIN_BASE_HI, base >> 8);
+	if (all || (w & 0xFF) != (_winW & 0xFF))
+		writeRegister(HQVGA_REG_WIN_W_LO, w & 0xFF);
+	if (all || (w >> 8) != (_winW >> 8))
+		writeRegister(HQVGA_REG_WIN_W_HI, w >> 8);
+	if (all || (height & 0xFF) != (_winH & 0xFF))
+		writeRegister(HQVGA_REG_WIN_H_LO, height & 0xFF);
+	if (all || (height >> 8) != (_winH >> 8))
+		writeRegister(HQVGA_REG_WIN_H_HI, height >> 8);
+	_winBase = base;
+	_winW = w;
+	_winH = height;
+	
+	setWriteMask(0x03);
+	_winFill = 0;
+	return true;
+}
+
+void VGA_class::windowPixels(const pixel_t *src, int count) {
+	// Frames run on across rows; every one goes to the same address
+	bool packed = (_format == HQVGA_FORMAT_INDEXED4);
+	for (int i = 0; i < count; i += packed ? 2 : 1) {
+		_winFrames[_winFill++] = 0x01;
+		_winFrames[_winFill++] = HQVGA_REG_WIN_DATA >> 8;
+		_winFrames[_winFill++] = HQVGA_REG_WIN_DATA & 0xFF;
+		_winFrames[_winFill++] = packed ? ((src[i] & 0x0F) << 4) | (src[i + 1] & 0x0F) : src[i];
+		if (_winFill == sizeof(_winFrames)) {
+			sendBurst(_winFrames, _winFill);
+			_winFill = 0;
+		}
+	}
+}
+
+void VGA_class::closeWindow() {
+	if (_winFill)
+		sendBurst(_winFrames, _winFill);
+	_winFill = 0;
+}
+
 void VGA_class::blitStreamInit(int x, int y, int w) {
-	blitOffset = getOffset(x, y);
+	blitStreamFlush();
+	blitx = x;
+	blity = y;
 	blitw = w;
 	cblit = 0;
 }
 
 void VGA_class::blitStreamAppend(unsigned char c) {
-	uint16_t offset = blitOffset + cblit;
-	uint16_t x = offset % VGA_HSIZE;
-	uint16_t y = offset / VGA_HSIZE;
-	putPixel(x, y, c);
-	
+	_blitBuf[_blitFill++] = c;
 	cblit++;
-	if (cblit == blitw) {
-		cblit = 0;
-		blitOffset += VGA_HSIZE;
+	if (cblit == blitw || _blitFill == HQVGA_BURST_PIXELS) {
+		blitStreamFlush();
+		if (cblit == blitw) {
+			cblit = 0;
+			blity++;
+		}
+	}
+}
+
+void VGA_class::blitStreamFlush() {
+	if (!_blitFill)
+		return;
+	uploadImage(blitx + cblit - _blitFill, blity, _blitFill, 1, _blitBuf);
+	_blitFill = 0;
+}
+
+bool VGA_class::beginLineStream(unsigned width, unsigned height, uint8_t format, uint8_t scale) {
+	format &= 0x01;
+	unsigned stride = (format == HQVGA_FORMAT_INDEXED4) ? (width + 1) / 2 : width;
+	if (width == 0 || width > 511 || height == 0 || height > 511 ||
+	    stride > HQVGA_LINE_MAX_BYTES - 1)
+		return false;
+	if (scale < 1) scale = 1;
+	if (scale > 15) scale = 15;
+	
+	// Without geometry registers the block aliases onto the text
+	// controller; bitstreams with them but no line stream read it as 0
+	if (!_known || readRegister(HQVGA_REG_LS_LINES) == 0)
+		return false;
+	unsigned hres = readRegister(HQVGA_REG_FB_HRES_LO) |
+	                ((readRegister(HQVGA_REG_FB_HRES_HI) & 0x0F) << 8);
+	unsigned vres = readRegister(HQVGA_REG_FB_VRES_LO) |
+	                ((readRegister(HQVGA_REG_FB_VRES_HI) & 0x0F) << 8);
+	if (width * scale > hres || height * scale > vres)
+		return false;
+	
+	if (!_lsLine)
+		_lsLine = new pixel_t[width];
+	else if (width > _lsWidth) {
+		delete[] _lsLine;
+		_lsLine = new pixel_t[width];
+	}
+	_lsWidth = width;
+	_lsHeight = height;
+	_lsFormat = format;
+	_lsScale = scale;
+	// The FPGA now steps the window by the stream's stride; uploads skip
+	// the window until endLineStream() restores the VRAM layout
+	_winW = 0;
+	
+	BusSession bus(*this);
+	{
+		// The stream layout lands whole at one frame start
+		StateUpdate update(*this);
+		writeRegister(HQVGA_REG_FB_WIDTH_LO, width & 0xFF);
+		writeRegister(HQVGA_REG_FB_WIDTH_HI, width >> 8);
+		writeRegister(HQVGA_REG_FB_HEIGHT_LO, height & 0xFF);
+		writeRegister(HQVGA_REG_FB_HEIGHT_HI, height >> 8);
+		writeRegister(HQVGA_REG_FB_FORMAT, format);
+		writeRegister(HQVGA_REG_FB_SCALE, scale);
+		setViewport((hres - width * scale) / 2, (vres - height * scale) / 2);
 	}
+	// Streaming starts at the first vsync after LS_CTRL and is not held,
+	// so wait for the layout to land first
+	unsigned long start = millis();
+	while (isCommitPending() && millis() - start < 100)
+		delay(1);
+	writeRegister(HQVGA_REG_LS_CTRL, 0x01);
+	return true;
+}
+
+unsigned VGA_class::streamLines(LineRenderer render, void *ctx, unsigned maxLines) {
+	if (!_lsLine)
+		return 0;
+	
+	beginBus();
+	unsigned credit = readRegister(HQVGA_REG_LS_CREDIT);
+	if (maxLines && credit > maxLines)
+		credit = maxLines;
+	if (credit == 0) {
+		endBus();
+		return 0;
+	}
+	
+	// The FPGA says which line is next, so lines skipped by an underflow
+	// are skipped here too. An underflow can land between two commits of
+	// a batch, so the low byte is read again before every line and the
+	// high byte only when it moved somewhere unexpected.
+	unsigned y = readRegister(HQVGA_REG_LS_NEXT_LO) |
+	             ((readRegister(HQVGA_REG_LS_NEXT_HI) & 0x01) << 8);
+	bool packed = (_lsFormat == HQVGA_FORMAT_INDEXED4);
+	for (unsigned n = 0; n < credit; n++) {
+		if (n) {
+			if (++y == _lsHeight)
+				y = 0;
+			unsigned lo = readRegister(HQVGA_REG_LS_NEXT_LO);
+			if (lo != (y & 0xFF))
+				y = lo | ((readRegister(HQVGA_REG_LS_NEXT_HI) & 0x01) << 8);
+		}
+		render(y, _lsLine, ctx);
+		burstRow(HQVGA_LINE_BASE, _lsLine, _lsWidth, packed);
+		writeRegister(HQVGA_REG_LS_CREDIT, 0x01);
+	}
+	endBus();
+	return credit;
+}
+
+void VGA_class::endLineStream() {
+	if (!_lsLine)
+		return;
+	writeRegister(HQVGA_REG_LS_CTRL, 0x00);
+	delete[] _lsLine;
+	_lsLine = nullptr;
+	
+	// Back to the VRAM layout, which drawing calls kept using
+	setGeometry(_width, _height, _format, _scale);
+}
+
+unsigned VGA_class::getStreamUnderflows(bool reset) {
+	unsigned count = readRegister(HQVGA_REG_LS_UNDER_LO) |
+	                 (readRegister(HQVGA_REG_LS_UNDER_HI) << 8);
+	if (reset)
+		writeRegister(HQVGA_REG_LS_UNDER_LO, 0x00);
+	return count;
 }
 
 void VGA_class::drawLine(int x0, int y0, int x1, int y1) {
@@ -12,8 +12,11 @@
 
 #include <Arduino.h>
 #include <SPI.h>
+#include "WishboneBus.h"
 
-// HQVGA resolution: 160x120 pixels (scaled 5x5 to 800x600@72Hz)
+// Default HQVGA resolution: 160x120 pixels (scaled 6x to 960x720 in 720p).
+// The framebuffer geometry is runtime-configurable; VGA_class reads the
+// actual width/height from the FPGA in begin(), see getHSize()/getVSize().
 const unsigned int VGA_HSIZE = 160;
 const unsigned int VGA_VSIZE = 120;
 
@@ -30,6 +33,97 @@ const unsigned int VGA_VSIZE = 120;
 // New address map: HQVGA at 0x0000-0x7FFF, no base offset needed
 #define HQVGA_WISHBONE_BASE 0x00
 
+// Framebuffer control registers (video_top_modular address map)
+#define HQVGA_REG_VIDEO_MODE    0x0000
+#define HQVGA_REG_BOOT          0x0002  // [1:0] mode at reset, [6] text / [7] VRAM splash (RO)
+#define HQVGA_REG_FRAME_CRC     0x0004  // 4 bytes LE, read 0x0004 first (RO)
+#define HQVGA_REG_FRAME_COUNT   0x0008  // frames latched, wraps (RO)
+#define HQVGA_REG_FB_WIDTH_LO   0x0030
+#define HQVGA_REG_FB_WIDTH_HI   0x0031
+#define HQVGA_REG_FB_HEIGHT_LO  0x0032
+#define HQVGA_REG_FB_HEIGHT_HI  0x0033
+#define HQVGA_REG_FB_FORMAT     0x0034
+#define HQVGA_REG_FB_SCALE      0x0035
+#define HQVGA_REG_FB_VIEW_X_LO  0x0036
+#define HQVGA_REG_FB_VIEW_X_HI  0x0037
+#define HQVGA_REG_FB_VIEW_Y_LO  0x0038
+#define HQVGA_REG_FB_VIEW_Y_HI  0x0039
+#define HQVGA_REG_FB_BORDER     0x003A
+#define HQVGA_REG_FB_WMASK      0x003B
+#define HQVGA_REG_FB_HRES_LO    0x003C
+#define HQVGA_REG_FB_HRES_HI    0x003D
+#define HQVGA_REG_FB_VRES_LO    0x003E
+#define HQVGA_REG_FB_VRES_HI    0x003F
+#define HQVGA_REG_FB_PALETTE    0x0040  // 16 x RGB332, 4bpp format only
+#define HQVGA_FB_BASE           0x0100
+
+// Line stream registers (0x0050-0x005F) and write line (0x8000-0x81FF)
+#define HQVGA_REG_LS_CTRL       0x0050  // [0] stream from the line ring
+#define HQVGA_REG_LS_CREDIT     0x0051  // R: free line buffers, W: commit
+#define HQVGA_REG_LS_NEXT_LO    0x0052  // line the next commit is shown on
+#define HQVGA_REG_LS_NEXT_HI    0x0053
+#define HQVGA_REG_LS_UNDER_LO   0x0054  // lines shown without data
+#define HQVGA_REG_LS_UNDER_HI   0x0055
+#define HQVGA_REG_LS_LINES      0x0056  // ring depth (0 = not supported)
+#define HQVGA_LINE_BASE         0x8000
+#define HQVGA_LINE_MAX_BYTES    512
+
+// Dual playfield registers (0x0060-0x006F) and palette bank 1 (0x0070)
+#define HQVGA_REG_LAYER_CTRL    0x0060  // [0] dual playfield, [1] layer 0 in front
+#define HQVGA_REG_L0_CTRL       0x0061  // [3:0] transparent index, [4] enable, [5] bank
+#define HQVGA_REG_L0_SCROLL_X_LO 0x0062
+#define HQVGA_REG_L0_SCROLL_X_HI 0x0063
+#define HQVGA_REG_L0_SCROLL_Y_LO 0x0064
+#define HQVGA_REG_L0_SCROLL_Y_HI 0x0065
+#define HQVGA_LAYER_REG_STRIDE  5       // layer 1 registers follow layer 0's
+#define HQVGA_REG_FB_PALETTE1   0x0070  // 16 x RGB332, palette bank 1
+
+// Affine scanout registers (0x0080-0x009F) and line table (0x8800-0x8FFF)
+#define HQVGA_REG_AFF_CTRL      0x0080  // [0] enable, [1] line table, [2] clamp
+#define HQVGA_REG_AFF_U0        0x0084  // U0 V0 DUDX DVDX DUDY DVDY, 4 apart,
+                                        // signed 24-bit 16.8, LO byte first
+#define HQVGA_AFF_TABLE         0x8800  // 8 bytes per source line
+#define HQVGA_AFF_TABLE_LINES   256
+
+// Write window (0x00A0-0x00AF): WIN_DATA writes fill a rectangle of VRAM
+// row by row and wrap back to its top-left corner after the last row
+#define HQVGA_REG_WIN_BASE_LO   0x00A0  // VRAM byte offset of the top-left
+#define HQVGA_REG_WIN_BASE_HI   0x00A1
+#define HQVGA_REG_WIN_W_LO      0x00A2  // width in bytes (1-511)
+#define HQVGA_REG_WIN_W_HI      0x00A3
+#define HQVGA_REG_WIN_H_LO      0x00A4  // height in rows (1-511)
+#define HQVGA_REG_WIN_H_HI      0x00A5
+#define HQVGA_REG_WIN_DATA      0x00A6
+#define HQVGA_REG_ROP           0x00A7  // [2:0] VRAM write mode (VGA_class::RasterOp)
+#define HQVGA_REG_ROP_KEY       0x00A8  // colour skipped by ROP_KEY
+#define HQVGA_REG_STATE_CTRL    0x00A9  // [0] hold display state, [1] commit pending (RO)
+#define HQVGA_REG_EPOCH         0x00B0  // host token, cleared by FPGA reset
+// Link check: CRC-16/CCITT over ADDR_HI, ADDR_LO, DATA of received writes
+#define HQVGA_REG_LINK_CTRL     0x00B1  // W: [0] restart. R: [7] present, [1] compared, [0] mismatch
+#define HQVGA_REG_LINK_CRC_LO   0x00B2  // W: expected CRC, R: running CRC
+#define HQVGA_REG_LINK_CRC_HI   0x00B3  // writing it compares
+#define HQVGA_REG_LINK_ERRORS_LO 0x00B4 // mismatches, write clears
+#define HQVGA_REG_LINK_ERRORS_HI 0x00B5
+#define HQVGA_REG_LINK_CHECKS_LO 0x00B6 // compares
+#define HQVGA_REG_LINK_CHECKS_HI 0x00B7
+
+// Framebuffer pixel formats
+#define HQVGA_FORMAT_RGB332     0  // 8bpp, one RRRGGGBB byte per pixel
+#define HQVGA_FORMAT_INDEXED4   1  // 4bpp, two palette indices per byte
+
+// VRAM size in bytes (0x0100-0x7FFF); stride * height must fit
+#define HQVGA_VRAM_SIZE         32512
+
+// Frames per uploadImage() burst (4 bytes each; 64 fills the ESP32 SPI FIFO 4x)
+#ifndef HQVGA_BURST_PIXELS
+#define HQVGA_BURST_PIXELS      64
+#endif
+
+// Resends of a burst that fails the link check before it is given up
+#ifndef HQVGA_LINK_RETRIES
+#define HQVGA_LINK_RETRIES      3
+#endif
+
 class VGA_class {
 public:
 	typedef unsigned char pixel_t;
@@ -37,14 +131,47 @@ public:
 	VGA_class();
 	~VGA_class();
 
-	inline unsigned int getHSize() const { return VGA_HSIZE; }
-	inline unsigned int getVSize() const { return VGA_VSIZE; }
+	inline unsigned int getHSize() const { return _width; }
+	inline unsigned int getVSize() const { return _height; }
+	inline uint8_t getFormat() const { return _format; }
+	inline uint8_t getScale() const { return _scale; }
+	inline unsigned int getStride() const { return _stride; }
 
 	// Initialize with SPI interface and Wishbone base address
 	void begin(SPIClass* spi = nullptr, uint8_t csPin = 10, 
 	          uint8_t spiClk = 12, uint8_t spiMosi = 11, uint8_t spiMiso = 9,
 	          uint8_t wishboneBase = HQVGA_WISHBONE_BASE);
 
+	// SPI host this display is attached to (displays on different hosts
+	// can be driven concurrently, see HQVGA_MultiDisplay.h)
+	SPIClass* getSPI() const { return _spi; }
+
+	// Low-latency bus path
+	// enableHardwareCS() hands CS to the SPI peripheral so every 4-byte
+	// frame goes out as one polled FIFO burst instead of four transfer()
+	// calls between two digitalWrite()s. The CS pin must be the SS pin the
+	// SPIClass was begun with (begin() does this when it creates the bus).
+	// Returns false if the SPI driver cannot drive CS in hardware.
+	bool enableHardwareCS(bool enable = true);
+	// Clock used by the fast path and by bus sessions (default 8 MHz)
+	void setBusClock(uint32_t hz) { _bus.setClock(hz); }
+	// Hold the SPI bus across many accesses; nests. Prefer BusSession.
+	void beginBus();
+	void endBus();
+
+	// Scoped bus ownership: beginTransaction() runs once for the whole
+	// scope rather than once per register or pixel.
+	//   { VGA_class::BusSession bus(VGA); VGA.setViewport(x, y); ... }
+	class BusSession {
+	public:
+		explicit BusSession(VGA_class& vga) : _vga(vga) { _vga.beginBus(); }
+		~BusSession() { _vga.endBus(); }
+	private:
+		BusSession(const BusSession&);
+		BusSession& operator=(const BusSession&);
+		VGA_class& _vga;
+	};
+
 	// Wait for FPGA to be ready and set framebuffer mode
 	// Call this after begin() if display doesn't appear on power-on
 	// Returns true if framebuffer mode was successfully set
@@ -54,6 +181,169 @@ public:
 	void setVideoMode(uint8_t mode);
 	uint8_t getVideoMode();
 
+	// Boot splash
+	// A bitstream built with gateware/tools/splash2mem.py output shows its
+	// splash from configuration, before the sketch runs; begin() keeps it
+	// on screen. hasBootSplash() is true for such a bitstream, so the sketch
+	// can skip drawing its own. setBootMode() picks the video mode an FPGA
+	// reset comes up in (on bitstreams without the boot register it sets
+	// the video mode instead).
+	bool hasBootSplash();
+	void setBootMode(uint8_t mode);
+	uint8_t getBootMode();
+
+	// Framebuffer geometry
+	// readGeometry() refreshes width/height/format/scale from the FPGA (done
+	// in begin()); returns false and keeps 160x120 RGB332 on old bitstreams.
+	bool readGeometry();
+	// Program a new layout and center it in the active video area.
+	// Returns false if stride * height exceeds HQVGA_VRAM_SIZE.
+	bool setGeometry(unsigned width, unsigned height,
+	                 uint8_t format = HQVGA_FORMAT_RGB332, uint8_t scale = 1);
+	void setViewport(unsigned x, unsigned y);
+	void centerViewport();
+	void setBorderColor(pixel_t color);
+	void setPaletteEntry(uint8_t index, pixel_t color, uint8_t bank = 0);
+
+	// Dual playfield (4bpp)
+	// Two layers of the framebuffer size, each with its own scroll offset,
+	// palette bank and transparent index, composited at scanout with layer 1
+	// in front. Scrolling is a register write, so a moving background needs
+	// no upload. setLayer() picks the layer the drawing calls address.
+	// Returns false unless the geometry is 4bpp at scale 2 or more with room
+	// in VRAM for both layers, or if the bitstream has no layers.
+	bool enableDualPlayfield(bool enable = true);
+	bool isDualPlayfield() const { return _dual; }
+	void setLayer(uint8_t layer);
+	uint8_t getLayer() const { return _layer; }
+	// Offset of the layer's top-left pixel; wraps at the layer size
+	void setLayerScroll(uint8_t layer, int x, int y);
+	// Palette index that shows the layer behind; -1 makes the layer opaque
+	void setLayerTransparent(uint8_t layer, int index);
+	void setLayerPaletteBank(uint8_t layer, uint8_t bank);
+	void setFrontLayer(uint8_t layer);
+
+	// Affine scanout (rotate / zoom)
+	// Image pixel (x, y) shows texel (u0 + x*dudx + y*dudy, v0 + x*dvdx + y*dvdy)
+	// of the framebuffer image, all 16.8 fixed point (256 = one texel).
+	// Texels past the edge wrap, or repeat the edge with clamp. Latched per
+	// frame, so a rotating or zooming image costs register writes, not an
+	// upload. Returns false if the bitstream has no affine scanout.
+	struct Affine {
+		int32_t u0, v0;
+		int32_t dudx, dvdx;
+		int32_t dudy, dvdy;
+	};
+	bool setAffine(const Affine& m, bool clamp = false);
+	// Rotate by angle (radians) and zoom (2 = twice the size) about texel
+	// (cx, cy), which stays at the centre of the image
+	bool setAffineRotZoom(float angle, float zoom, float cx, float cy, bool clamp = false);
+	// Per-line mode: source line y starts at texel (u, v) and steps by
+	// (dudx, dvdx), e.g. for a perspective floor. Entries are stored as
+	// 12.4 start and 8.8 step; up to HQVGA_AFF_TABLE_LINES lines.
+	struct AffineLine {
+		int32_t u, v;
+		int32_t dudx, dvdx;
+	};
+	bool setAffineLines(unsigned first, unsigned count, const AffineLine *lines,
+	                    bool clamp = false);
+	void disableAffine();
+	bool isAffine() const { return _affine; }
+
+	// Raster ops
+	// Every VRAM write - drawing calls, uploads, clear() - is combined with
+	// VRAM on the FPGA until the mode is set back to ROP_REPLACE, with no
+	// read on the host. XOR twice restores the picture (rubber-band boxes,
+	// cursors); AND then OR stamps a masked sprite; ROP_KEY skips pixels
+	// equal to key (a palette index in 4bpp), so uploadImage() stamps a
+	// sprite with a transparent colour. Returns false if the bitstream has
+	// no raster ops.
+	enum RasterOp { ROP_REPLACE, ROP_XOR, ROP_AND, ROP_OR, ROP_KEY };
+	bool setRasterOp(RasterOp op, pixel_t key = 0);
+	RasterOp getRasterOp() const { return _rop; }
+
+	// Atomic display-state updates
+	// The FPGA latches geometry, viewport, border, layers, scroll, affine
+	// parameters, palettes and the video mode once per frame. Writes made
+	// between beginStateUpdate() and commitAtVBlank() are held back and
+	// all land at the same frame start, so a multi-register change never
+	// shows half done, and the host does not wait for vblank. Nests; the
+	// outermost commit releases. Returns false if the bitstream cannot
+	// hold (each register then lands at the next frame start on its own).
+	bool beginStateUpdate();
+	void commitAtVBlank();
+	// True from a commit until the FPGA has latched it
+	bool isCommitPending();
+
+	// Frame checksum
+	// CRC32 (as zlib crc32()) of the last complete frame sent to the HDMI
+	// output: R, G, B of every active pixel, borders included. A static
+	// screen gives the same value every frame, so record it from a
+	// known-good screen and check for it later. expectFrameCrc() polls
+	// until a frame matches or the timeout ends, which covers the frame or
+	// two a change takes to reach the screen. hasFrameCrc() is false on
+	// bitstreams without the CRC (checked once: geometry registers present
+	// and the frame count advancing); readFrameCrc() then returns 0 and
+	// expectFrameCrc() false.
+	bool hasFrameCrc();
+	uint32_t readFrameCrc();
+	uint8_t getFrameCount();
+	bool expectFrameCrc(uint32_t expected, unsigned long timeoutMs = 100);
+
+	// Reset recovery
+	// An FPGA reset or bitstream reload under a running sketch brings the
+	// display back in its power-on state. begin() writes a token to the
+	// epoch register, which reset clears; isAlive() reads it back, one
+	// register read, cheap enough to call every second or so. After a
+	// false, resync() waits for the FPGA, writes a new token and replays
+	// what the library last set: video mode, geometry, viewport, border,
+	// palettes, layers and scroll, affine parameters, line stream, write
+	// mask and raster op. VRAM is not kept on the host, so pass the
+	// sketch's own copy of the picture (width x height, the layer
+	// setLayer() addresses) as image to upload it in bursts; otherwise
+	// redraw after resync(). The affine line table is not kept either,
+	// so per-line mode comes back off. isAlive() is always true and
+	// resync() false on bitstreams without the epoch register.
+	bool isAlive();
+	bool resync(const pixel_t *image = nullptr, int imageStride = 0,
+	            unsigned long timeoutMs = 5000);
+
+	// Link check
+	// With the check on, each burst (uploads, writeArea(), line stream
+	// lines, affine table) is followed by its CRC-16, which the FPGA
+	// compares with one over the writes it received; a burst that fails
+	// is sent again, up to HQVGA_LINK_RETRIES times. The bus clock can
+	// then go to the edge of the signal-integrity margin with the picture
+	// kept right, and getLinkStats() shows how the link is doing. It costs
+	// a status read per burst. Single register writes are not covered. The
+	// write window is not used while checking (a resend would run its
+	// pointer on), and XOR bursts are counted but not resent. Returns false
+	// if the bitstream has no link check.
+	struct LinkStats {
+		uint32_t checks;    // bursts checked, resends included
+		uint32_t errors;    // checks that failed
+		uint32_t retries;   // bursts sent again
+		uint32_t failures;  // bursts left wrong after the last retry
+	};
+	bool enableLinkCheck(bool enable = true);
+	bool isLinkChecked() const { return _linkCheck; }
+	const LinkStats& getLinkStats() const { return _linkStats; }
+	void resetLinkStats();
+	// Failed checks counted by the FPGA (since the last reset)
+	unsigned getLinkErrors(bool reset = false);
+
+	// Scoped update, committed at the end of the scope:
+	//   { VGA_class::StateUpdate u(VGA); VGA.setLayerScroll(...); ... }
+	class StateUpdate {
+	public:
+		explicit StateUpdate(VGA_class& vga) : _vga(vga) { _vga.beginStateUpdate(); }
+		~StateUpdate() { _vga.commitAtVBlank(); }
+	private:
+		StateUpdate(const StateUpdate&);
+		StateUpdate& operator=(const StateUpdate&);
+		VGA_class& _vga;
+	};
+
 	// Color management
 	void setColor(pixel_t color) { fg = color; }
 	void setBackgroundColor(pixel_t color) { bg = color; }
@@ -77,21 +367,103 @@ public:
 	void printtext(unsigned x, unsigned y, const char *text, bool trans = false);
 
 	// Area operations
+	// hasReadback() is true if VRAM reads return VRAM, which needs the read
+	// arbiter in wb_video_framebuffer.v; older bitstreams read 0. Checked
+	// once by writing the last VRAM byte, outside the picture unless the
+	// layout fills VRAM, and reading it back.
+	bool hasReadback();
 	void readArea(int x, int y, int width, int height, pixel_t *dest);
 	void writeArea(int x, int y, int width, int height, pixel_t *source);
+	// Source layouts for the strided writeArea()
+	enum PixelFormat {
+		PIXEL_RGB332,     // 1 byte, written as is (palette index in 4bpp)
+		PIXEL_RGB565_LE,  // 2 bytes, low byte first (ESP32 / LVGL native)
+		PIXEL_RGB565_BE,  // 2 bytes, high byte first (byte-swapped TFT data)
+		PIXEL_RGB888,     // 3 bytes, R G B
+		PIXEL_MONO1,      // 1 bit, MSB leftmost: palette[1] if set, palette[0] if clear
+		PIXEL_INDEXED8    // 1 byte, looked up in palette
+	};
+	// Converts a row at a time on the host and sends each row as one burst.
+	// strideBytes 0 means tightly packed rows. Without a palette, MONO1 uses
+	// the foreground/background colours and INDEXED8 writes indices as is.
+	void writeArea(int x, int y, int width, int height, const void *source, int strideBytes,
+	               PixelFormat format, const pixel_t *palette = nullptr);
 	void moveArea(unsigned x, unsigned y, unsigned width, unsigned height, unsigned tx, unsigned ty);
+	// Burst upload straight from flash/PSRAM (e.g. a const image array):
+	// rows are clipped and sent in bursts of HQVGA_BURST_PIXELS frames
+	// directly from the source, with no copy of the image in RAM. One pixel
+	// per source byte (palette index in 4bpp mode); stride 0 means width.
+	// Frames go out back-to-back under one CS assertion when the SPI bridge
+	// re-arms for a new CMD byte after each DATA byte; the first burst
+	// checks that with the border register and falls back to one CS per
+	// frame if not. Bursts are sent with polled writeBytes() - there is no
+	// DMA path, so the CPU is busy for the whole upload. On
+	// bitstreams with the write window, a rectangle of two or more rows
+	// goes out as one stream to WIN_DATA with no per-row addressing.
+	void uploadImage(int x, int y, int width, int height, const pixel_t *image,
+	                 int imageStride = 0);
 
-	// Stream operations
+	// Stream operations: pixels fill a w-wide rectangle row by row and go
+	// out in bursts of HQVGA_BURST_PIXELS. A row is sent when it is full;
+	// call blitStreamFlush() after the last pixel of an unfinished row.
 	void blitStreamInit(int x, int y, int w);
 	void blitStreamAppend(unsigned char c);
+	void blitStreamFlush();
+
+	// Line stream ("race the beam") mode
+	// Scanout reads a small ring of line buffers that the host refills just
+	// ahead of the beam instead of VRAM, so the image size is not limited by
+	// BRAM (e.g. 320x240 RGB332). Call streamLines() often - every source
+	// line must reach the FPGA before it is scanned or it is shown in the
+	// border colour and counted as an underflow. The renderer fills one row
+	// of pixels (palette indices in 4bpp). VRAM is kept but not shown, and
+	// drawing calls keep addressing it (row by row, without the write
+	// window); endLineStream() shows it again.
+	typedef void (*LineRenderer)(unsigned y, pixel_t *line, void *ctx);
+	// Returns false if the bitstream has no line stream, the image is over
+	// 511 pixels either way or does not fit on screen at this scale
+	bool beginLineStream(unsigned width, unsigned height,
+	                     uint8_t format = HQVGA_FORMAT_RGB332, uint8_t scale = 1);
+	// Render and send as many lines as there are free buffers (at most
+	// maxLines, 0 = no limit); returns the number sent. The next line is
+	// read back from the FPGA before each one, so an underflow only loses
+	// a line; one that strikes while a line is being sent still shows that
+	// one line a row late for that frame.
+	unsigned streamLines(LineRenderer render, void *ctx = nullptr, unsigned maxLines = 0);
+	void endLineStream();
+	bool isLineStreaming() const { return _lsLine != nullptr; }
+	// Lines scanned without data since beginLineStream() (or the last reset)
+	unsigned getStreamUnderflows(bool reset = false);
 
  private:
 	// Wishbone SPI interface
 	void writeWishbone(uint16_t addr, uint8_t data);
 	uint8_t readWishbone(uint16_t addr);
+	void writeRegister(uint16_t addr, uint8_t data);
+	uint8_t readRegister(uint16_t addr);
+	void setWriteMask(uint8_t mask);
+	bool fastBus() const { return _bus.fast(); }
+	void sendBurst(const uint8_t *frames, size_t len);
+	bool probeFrameBursts();
+	void burstRow(uint16_t addr, const pixel_t *src, int count, bool packed);
+	// Write window: openWindow() returns false if the rectangle (already
+	// clipped) must go row by row; otherwise send exactly width * height
+	// pixels through windowPixels(), then closeWindow()
+	bool openWindow(int x, int y, int width, int height);
+	void windowPixels(const pixel_t *src, int count);
+	void closeWindow();
 	
-	// Internal offset calculation
-	uint16_t getOffset(unsigned x, unsigned y) { return x + (y * VGA_HSIZE); }
+	// Internal offset calculation (byte offset into VRAM)
+	uint16_t layerBase() const { return _layer ? _stride * _height : 0; }
+	uint16_t getOffset(unsigned x, unsigned y) {
+		return layerBase() + (y * _stride) +
+		       ((_format == HQVGA_FORMAT_INDEXED4) ? (x >> 1) : x);
+	}
+	void writeLayerCtrl(uint8_t layer, uint8_t ctrl);
+	void writeLayerScroll(uint8_t layer);
+	void writeAffineParams();
+	bool enableAffine(uint8_t ctrl);
+	bool armEpoch();
 	
 	SPIClass* _spi;
 	bool _ownSpi;
@@ -100,10 +472,60 @@ public:
 	uint8_t _mosi;
 	uint8_t _miso;
 	uint8_t _wbBase;
+	WishboneBus _bus;
+	
+	unsigned _width, _height, _stride;
+	uint8_t _format, _scale;
+	uint8_t _wmask;
+	bool _known;            // geometry registers present, see readGeometry()
 	
 	pixel_t fg, bg;
-	uint16_t blitOffset;
+	int blitx, blity;
 	int blitw, cblit;
+	pixel_t _blitBuf[HQVGA_BURST_PIXELS];
+	uint16_t _blitFill;
+	
+	// Write window: -1 not probed yet, 0 absent, 1 present. The last
+	// geometry written is kept (width 0 = unknown); a finished upload
+	// leaves the pointer at its top-left, so the same window needs no setup.
+	int8_t _win;
+	uint16_t _winBase, _winW, _winH;
+	uint8_t _winFrames[HQVGA_BURST_PIXELS * 4];
+	uint16_t _winFill;
+	
+	// Line stream state; _width etc. keep describing VRAM meanwhile
+	pixel_t *_lsLine;
+	unsigned _lsWidth, _lsHeight;
+	uint8_t _lsFormat;
+	
+	// Dual playfield state; the control bytes mirror the FPGA registers
+	bool _dual;
+	uint8_t _layer;
+	uint8_t _layerCtrl;
+	uint8_t _lCtrl[2];
+	bool _affine;
+	RasterOp _rop;
+	int8_t _hold;           // STATE_CTRL present: -1 not probed yet
+	uint8_t _stateDepth;
+	int8_t _frameCrc;       // frame CRC present: -1 not probed yet
+	int8_t _readback;       // VRAM reads return VRAM: -1 not probed yet
+	
+	// Display state as last written, for resync()
+	uint8_t _mode;
+	uint16_t _viewX, _viewY;
+	pixel_t _border;
+	pixel_t _palette[2][16];
+	uint16_t _scroll[2][2];
+	int32_t _affParams[6];
+	uint8_t _affCtrl;
+	pixel_t _ropKey;
+	uint8_t _lsScale;
+	int8_t _epochReg;       // epoch register present: -1 not probed yet
+	uint8_t _epoch;         // token last written to it
+	
+	bool _linkCheck;
+	int8_t _frameBursts;    // bridge takes many frames per CS: -1 not probed yet
+	LinkStats _linkStats;
 };
 
 const VGA_class::pixel_t RED = (((1<<COLOR_WEIGHT_R)-1) << COLOR_SHIFT_R);
@@ -0,0 +1,201 @@
+/**
+ * @file HQVGA_Affine.h
+ * @brief Fixed-point affine blits (rotate, scale, flip) between RGB332 buffers
+ *
+ * HQVGA_Affine holds the inverse mapping, destination pixel to source
+ * texel, as 16.16 steps. It is built once per transform; after that each
+ * destination row costs a few divides to find the span that lands inside
+ * the source, and each pixel is two adds and one lookup:
+ *
+ *   for each row:  u, v = texel under the first pixel of the span
+ *   for each pixel: dst = src[v >> 16][u >> 16]; u += dudx; v += dvdx
+ *
+ * Sampling is nearest-neighbour at pixel centres. hqvgaAffineBlit()
+ * draws into any RGB332 HQVGA_Surface (the HQVGA_TFT shadow, sprites,
+ * canvases) and reports the rectangle it touched, so the caller can upload
+ * just that part.
+ *
+ * Usage:
+ *   #include <HQVGA_Affine.h>
+ *
+ *   HQVGA_Affine m;
+ *   m.set(angle, 2.0f, 2.0f);               // rotate, twice the size
+ *   HQVGA_Rect r;
+ *   hqvgaAffineBlit(canvas, needle, 8, 40, 8, 80, 60, 4, 36, m, BLACK, &r);
+ */
+
+#ifndef HQVGA_AFFINE_H
+#define HQVGA_AFFINE_H
+
+#include <Arduino.h>
+#include <math.h>
+#include "HQVGA_Surface.h"
+
+/**
+ * @brief Destination rectangle touched by a blit (w or h 0 if none)
+ */
+struct HQVGA_Rect {
+    int16_t x, y, w, h;
+};
+
+/**
+ * @brief Destination-to-source mapping of an affine blit, 16.16 fixed point
+ *
+ * Moving one pixel right in the destination moves (dudx, dvdx) in the
+ * source; one pixel down moves (dudy, dvdy).
+ */
+struct HQVGA_Affine {
+    int32_t dudx, dvdx;
+    int32_t dudy, dvdy;
+
+    /**
+     * @brief Flip, then scale, then rotate the source by angle radians
+     *        (clockwise on screen, since y points down)
+     */
+    void set(float angle, float scaleX = 1.0f, float scaleY = 1.0f,
+             bool flipX = false, bool flipY = false) {
+        float c = cosf(angle), s = sinf(angle);
+        float fx = (flipX ? -65536.0f : 65536.0f) / scaleX;
+        float fy = (flipY ? -65536.0f : 65536.0f) / scaleY;
+        dudx = lroundf(c * fx);
+        dudy = lroundf(s * fx);
+        dvdx = lroundf(-s * fy);
+        dvdy = lroundf(c * fy);
+    }
+
+    /** @brief 1:1 copy */
+    void setIdentity() {
+        dudx = dvdy = 65536;
+        dvdx = dudy = 0;
+    }
+};
+
+// ===== Row kernels =====
+
+inline void hqvgaAffineRow(uint8_t* dst, int16_t n, const uint8_t* src, size_t srcStride,
+                           int32_t u, int32_t v, int32_t du, int32_t dv) {
+    for (int16_t i = 0; i < n; i++) {
+        dst[i] = src[(size_t)(v >> 16) * srcStride + (u >> 16)];
+        u += du;
+        v += dv;
+    }
+}
+
+/**
+ * @brief hqvgaAffineRow() that leaves dst untouched where the texel is key
+ */
+inline void hqvgaAffineRowKeyed(uint8_t* dst, int16_t n, const uint8_t* src, size_t srcStride,
+                                int32_t u, int32_t v, int32_t du, int32_t dv, uint8_t key) {
+    for (int16_t i = 0; i < n; i++) {
+        uint8_t c = src[(size_t)(v >> 16) * srcStride + (u >> 16)];
+        if (c != key) dst[i] = c;
+        u += du;
+        v += dv;
+    }
+}
+
+// ===== Span clipping =====
+
+inline int64_t hqvgaFloorDiv(int64_t a, int64_t b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+/**
+ * @brief Narrow [lo, hi] to the i where 0 <= base + i * step < limit
+ */
+inline void hqvgaAffineClip(int64_t base, int64_t step, int64_t limit, int32_t& lo, int32_t& hi) {
+    int64_t a, b;
+    if (step > 0) {
+        a = -hqvgaFloorDiv(base, step);
+        b = hqvgaFloorDiv(limit - 1 - base, step);
+    } else if (step < 0) {
+        a = -hqvgaFloorDiv(limit - 1 - base, -step);
+        b = hqvgaFloorDiv(base, -step);
+    } else {
+        if (base >= 0 && base < limit) return;
+        a = 1;
+        b = 0;
+    }
+    if (a > lo) lo = (int32_t)(a < hi + 1 ? a : hi + 1);
+    if (b < hi) hi = (int32_t)(b > lo - 1 ? b : lo - 1);
+}
+
+// ===== Surface helper (RGB332; src must not be inside dst) =====
+
+/**
+ * @brief Transformed copy of an RGB332 image into a surface
+ * @param src,sw,sh,srcStride Source pixels (srcStride 0 = sw)
+ * @param px,py Source pivot, the texel placed at (dx,dy)
+ * @param dx,dy Destination of the pivot
+ * @param key Source color left transparent, or -1 for none
+ * @param touched If set, receives the destination rectangle written
+ */
+template <int16_t W, int16_t H>
+void hqvgaAffineBlit(HQVGA_Surface<HQVGA_FormatRGB332, W, H>& dst,
+                     const uint8_t* src, int16_t sw, int16_t sh, size_t srcStride,
+                     int16_t px, int16_t py, int16_t dx, int16_t dy,
+                     const HQVGA_Affine& m, int16_t key = -1, HQVGA_Rect* touched = nullptr) {
+    if (touched) *touched = HQVGA_Rect{ 0, 0, 0, 0 };
+    if (!srcStride) srcStride = sw;
+    int64_t det = (int64_t)m.dudx * m.dvdy - (int64_t)m.dudy * m.dvdx;
+    if (det == 0 || sw <= 0 || sh <= 0) return;
+
+    // Bounding box of the source corners, mapped forward once per blit
+    float inv = 4294967296.0f / (float)det;
+    float minX = 1e9f, maxX = -1e9f, minY = 1e9f, maxY = -1e9f;
+    for (int k = 0; k < 4; k++) {
+        float u = ((k & 1) ? sw : 0) - px, v = ((k & 2) ? sh : 0) - py;
+        float x = (m.dvdy * u - m.dudy * v) * inv / 65536.0f;
+        float y = (-m.dvdx * u + m.dudx * v) * inv / 65536.0f;
+        if (x < minX) minX = x;
+        if (x > maxX) maxX = x;
+        if (y < minY) minY = y;
+        if (y > maxY) maxY = y;
+    }
+    int16_t x0 = dx + (int16_t)floorf(minX), x1 = dx + (int16_t)ceilf(maxX);
+    int16_t y0 = dy + (int16_t)floorf(minY), y1 = dy + (int16_t)ceilf(maxY);
+    int16_t bw = x1 - x0 + 1, bh = y1 - y0 + 1;
+    if (!hqvgaClipRect(x0, y0, bw, bh, W, H)) return;
+
+    // Texel under the centre of (x0, y0), pivot texel centre at (dx, dy)
+    int32_t ox = x0 - dx, oy = y0 - dy;
+    int64_t uRow = ((int64_t)px << 16) + 32768 + (int64_t)ox * m.dudx + (int64_t)oy * m.dudy;
+    int64_t vRow = ((int64_t)py << 16) + 32768 + (int64_t)ox * m.dvdx + (int64_t)oy * m.dvdy;
+    int64_t uLim = (int64_t)sw << 16, vLim = (int64_t)sh << 16;
+
+    int16_t tx0 = W, tx1 = -1, ty0 = H, ty1 = -1;
+    for (int16_t j = 0; j < bh; j++, uRow += m.dudy, vRow += m.dvdy) {
+        int32_t lo = 0, hi = bw - 1;
+        hqvgaAffineClip(uRow, m.dudx, uLim, lo, hi);
+        hqvgaAffineClip(vRow, m.dvdx, vLim, lo, hi);
+        if (lo > hi) continue;
+
+        int32_t u = (int32_t)(uRow + (int64_t)lo * m.dudx);
+        int32_t v = (int32_t)(vRow + (int64_t)lo * m.dvdx);
+        uint8_t* out = dst.row(y0 + j) + x0 + lo;
+        if (key < 0)
+            hqvgaAffineRow(out, hi - lo + 1, src, srcStride, u, v, m.dudx, m.dvdx);
+        else
+            hqvgaAffineRowKeyed(out, hi - lo + 1, src, srcStride, u, v, m.dudx, m.dvdx, key);
+
+        if (x0 + lo < tx0) tx0 = x0 + lo;
+        if (x0 + hi > tx1) tx1 = x0 + hi;
+        if (y0 + j < ty0) ty0 = y0 + j;
+        ty1 = y0 + j;
+    }
+    if (touched && tx1 >= tx0) *touched = HQVGA_Rect{ tx0, ty0, (int16_t)(tx1 - tx0 + 1),
+                                                      (int16_t)(ty1 - ty0 + 1) };
+}
+
+/**
+ * @brief hqvgaAffineBlit() from another RGB332 surface (e.g. a sprite)
+ */
+template <int16_t W, int16_t H, int16_t SW, int16_t SH>
+void hqvgaAffineBlit(HQVGA_Surface<HQVGA_FormatRGB332, W, H>& dst,
+                     const HQVGA_Surface<HQVGA_FormatRGB332, SW, SH>& src,
+                     int16_t px, int16_t py, int16_t dx, int16_t dy,
+                     const HQVGA_Affine& m, int16_t key = -1, HQVGA_Rect* touched = nullptr) {
+    hqvgaAffineBlit(dst, src.pixels, SW, SH, src.stride(), px, py, dx, dy, m, key, touched);
+}
+
+#endif // HQVGA_AFFINE_H
@@ -0,0 +1,218 @@
+/**
+ * @file HQVGA_Blend.h
+ * @brief RGB332 alpha blending and color operations via small lookup tables
+ *
+ * RGB332 only has 8 red, 8 green and 4 blue levels, so any per-channel
+ * operation on two colors fits in 64 + 64 + 16 byte tables (HQVGA_BlendLUT)
+ * and any operation on one color fits in a 256 byte table (HQVGA_ColorLUT).
+ * Build a table once, then every pixel is three lookups (or one), with no
+ * RGB888 round trip:
+ *
+ *   HQVGA_BlendLUT   src/dst ops: N-level alpha, additive, multiply
+ *   HQVGA_ColorLUT   dst-only ops: brightness fade, fade to a color,
+ *                    translucent fill with a fixed color
+ *   hqvgaAverage332  50% blend with no table at all
+ *
+ * Kernels work a row at a time; the surface helpers clip and walk the rows
+ * of any RGB332 HQVGA_Surface (the HQVGA_TFT shadow, sprites, canvases).
+ *
+ * Usage:
+ *   #include <HQVGA_Blend.h>
+ *
+ *   HQVGA_BlendLUT glass;
+ *   glass.setAlpha(4);                      // 25% src, 75% dst
+ *   hqvgaBlendBlit(canvas, sprite, 10, 20, glass);
+ *
+ *   HQVGA_ColorLUT dim;
+ *   dim.setFade(8);                         // half brightness
+ *   hqvgaMapRect(canvas, 0, 0, 160, 120, dim);
+ */
+
+#ifndef HQVGA_BLEND_H
+#define HQVGA_BLEND_H
+
+#include <Arduino.h>
+#include "HQVGA_Surface.h"
+
+/**
+ * @brief 50% blend of two RGB332 colors (per channel, rounded down)
+ *
+ * Averages all three fields in one add by masking off each field's low
+ * bit before the shift so nothing carries into the neighbouring field.
+ */
+inline uint8_t hqvgaAverage332(uint8_t a, uint8_t b) {
+    return (a & b) + (((a ^ b) & 0xDA) >> 1);
+}
+
+/**
+ * @brief Two-input RGB332 operation as three per-channel tables
+ *
+ * Each table is indexed by (src channel << bits) | dst channel and holds
+ * the result already shifted into place, so apply() is three lookups ORed.
+ */
+struct HQVGA_BlendLUT {
+    uint8_t r[64];
+    uint8_t g[64];
+    uint8_t b[16];
+
+    uint8_t apply(uint8_t src, uint8_t dst) const {
+        return r[((src >> 2) & 0x38) | (dst >> 5)] |
+               g[((src << 1) & 0x38) | ((dst >> 2) & 0x07)] |
+               b[((src & 0x03) << 2) | (dst & 0x03)];
+    }
+
+    /**
+     * @brief dst = (src * level + dst * (levels - level)) / levels, rounded
+     *
+     * setAlpha(8) is 50%, setAlpha(4) is 25%; any level count up to 255.
+     */
+    void setAlpha(uint8_t level, uint8_t levels = 16) {
+        if (levels == 0) levels = 1;
+        if (level > levels) level = levels;
+        build(OP_ALPHA, level, levels);
+    }
+
+    /** @brief dst = min(src + dst, max) per channel */
+    void setAdditive() { build(OP_ADD, 0, 1); }
+
+    /** @brief dst = src * dst / max per channel (darkens; white is identity) */
+    void setMultiply() { build(OP_MULTIPLY, 0, 1); }
+
+private:
+    enum { OP_ALPHA, OP_ADD, OP_MULTIPLY };
+
+    static uint8_t channel(uint8_t op, unsigned s, unsigned d, unsigned max,
+                           unsigned level, unsigned levels) {
+        switch (op) {
+        case OP_ADD:      return (s + d > max) ? max : s + d;
+        case OP_MULTIPLY: return (s * d + max / 2) / max;
+        default:          return (s * level + d * (levels - level) + levels / 2) / levels;
+        }
+    }
+
+    void build(uint8_t op, uint8_t level, uint8_t levels) {
+        for (unsigned s = 0; s < 8; s++) {
+            for (unsigned d = 0; d < 8; d++) {
+                r[(s << 3) | d] = channel(op, s, d, 7, level, levels) << 5;
+                g[(s << 3) | d] = channel(op, s, d, 7, level, levels) << 2;
+            }
+        }
+        for (unsigned s = 0; s < 4; s++) {
+            for (unsigned d = 0; d < 4; d++) {
+                b[(s << 2) | d] = channel(op, s, d, 3, level, levels);
+            }
+        }
+    }
+};
+
+/**
+ * @brief One-input RGB332 operation as a 256 entry table
+ */
+struct HQVGA_ColorLUT {
+    uint8_t map[256];
+
+    uint8_t apply(uint8_t c) const { return map[c]; }
+
+    void setIdentity() {
+        for (unsigned c = 0; c < 256; c++) map[c] = c;
+    }
+
+    /**
+     * @brief Scale brightness to level / levels (0 = black, levels = unchanged)
+     */
+    void setFade(uint8_t level, uint8_t levels = 16) {
+        setFadeTo(0x00, levels - (level > levels ? levels : level), levels);
+    }
+
+    /**
+     * @brief Move every color level / levels of the way towards color
+     */
+    void setFadeTo(uint8_t color, uint8_t level, uint8_t levels = 16) {
+        HQVGA_BlendLUT lut;
+        lut.setAlpha(level, levels);
+        setBlend(lut, color);
+    }
+
+    /**
+     * @brief map[dst] = lut.apply(src, dst) - a fixed-color blend, e.g. a
+     *        translucent fill, at one lookup per pixel
+     */
+    void setBlend(const HQVGA_BlendLUT& lut, uint8_t src) {
+        for (unsigned c = 0; c < 256; c++) map[c] = lut.apply(src, c);
+    }
+};
+
+// ===== Row kernels =====
+
+inline void hqvgaBlendRow(uint8_t* dst, const uint8_t* src, int16_t n,
+                          const HQVGA_BlendLUT& lut) {
+    for (int16_t i = 0; i < n; i++) {
+        dst[i] = lut.apply(src[i], dst[i]);
+    }
+}
+
+/**
+ * @brief Blend a row, leaving dst untouched where src is the key color
+ */
+inline void hqvgaBlendRowKeyed(uint8_t* dst, const uint8_t* src, int16_t n,
+                               const HQVGA_BlendLUT& lut, uint8_t key) {
+    for (int16_t i = 0; i < n; i++) {
+        if (src[i] != key) dst[i] = lut.apply(src[i], dst[i]);
+    }
+}
+
+inline void hqvgaAverageRow(uint8_t* dst, const uint8_t* src, int16_t n) {
+    for (int16_t i = 0; i < n; i++) {
+        dst[i] = hqvgaAverage332(dst[i], src[i]);
+    }
+}
+
+inline void hqvgaMapRow(uint8_t* dst, int16_t n, const HQVGA_ColorLUT& lut) {
+    for (int16_t i = 0; i < n; i++) {
+        dst[i] = lut.map[dst[i]];
+    }
+}
+
+// ===== Surface helpers (RGB332 only; src and dst must not overlap) =====
+
+/**
+ * @brief Blend all of src onto dst with its top-left corner at (x,y)
+ */
+template <int16_t W, int16_t H, int16_t SW, int16_t SH>
+void hqvgaBlendBlit(HQVGA_Surface<HQVGA_FormatRGB332, W, H>& dst,
+                    const HQVGA_Surface<HQVGA_FormatRGB332, SW, SH>& src,
+                    int16_t x, int16_t y, const HQVGA_BlendLUT& lut) {
+    int16_t sx = 0, sy = 0, w = SW, h = SH;
+    if (!hqvgaClipBlit(x, y, sx, sy, w, h, W, H, SW, SH)) return;
+    for (int16_t j = 0; j < h; j++) {
+        hqvgaBlendRow(dst.row(y + j) + x, src.row(sy + j) + sx, w, lut);
+    }
+}
+
+/**
+ * @brief hqvgaBlendBlit() that skips src pixels of the key color
+ */
+template <int16_t W, int16_t H, int16_t SW, int16_t SH>
+void hqvgaBlendBlitKeyed(HQVGA_Surface<HQVGA_FormatRGB332, W, H>& dst,
+                         const HQVGA_Surface<HQVGA_FormatRGB332, SW, SH>& src,
+                         int16_t x, int16_t y, const HQVGA_BlendLUT& lut, uint8_t key) {
+    int16_t sx = 0, sy = 0, w = SW, h = SH;
+    if (!hqvgaClipBlit(x, y, sx, sy, w, h, W, H, SW, SH)) return;
+    for (int16_t j = 0; j < h; j++) {
+        hqvgaBlendRowKeyed(dst.row(y + j) + x, src.row(sy + j) + sx, w, lut, key);
+    }
+}
+
+/**
+ * @brief Run a color table over a rectangle (fades, tints, translucent fills)
+ */
+template <int16_t W, int16_t H>
+void hqvgaMapRect(HQVGA_Surface<HQVGA_FormatRGB332, W, H>& dst,
+                  int16_t x, int16_t y, int16_t w, int16_t h, const HQVGA_ColorLUT& lut) {
+    if (!hqvgaClipRect(x, y, w, h, W, H)) return;
+    for (int16_t j = 0; j < h; j++) {
+        hqvgaMapRow(dst.row(y + j) + x, w, lut);
+    }
+}
+
+#endif // HQVGA_BLEND_H
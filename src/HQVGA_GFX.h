@@ -13,7 +13,7 @@
     #include <SPI.h>
     #include <HQVGA_GFX.h>
     
-    HQVGA_GFX display;
+    HQVGA_GFX display;            // or HQVGA_GFX display(myVga);
     
     void setup() {
       SPIClass *spi = new SPIClass(HSPI);
@@ -33,29 +33,30 @@
 
 #include <Adafruit_GFX.h>
 #include <HQVGA.h>
+#include "HQVGA_Blend.h"
 
 class HQVGA_GFX : public Adafruit_GFX {
 public:
-  // Constructor - 160x120 display
-  HQVGA_GFX() : Adafruit_GFX(160, 120) {}
+  // Constructor - 160x120 display on the given VGA_class (default: global VGA)
+  HQVGA_GFX(VGA_class& vga = VGA) : Adafruit_GFX(160, 120), _vga(vga) {}
   
-  // Initialize the display (wraps VGA.begin)
+  // Initialize the display (wraps _vga.begin)
   void begin(SPIClass* spi = nullptr, uint8_t csPin = 10, 
              uint8_t spiClk = 12, uint8_t spiMosi = 11, uint8_t spiMiso = 9,
              uint8_t wishboneBase = 0x00) {
-    VGA.begin(spi, csPin, spiClk, spiMosi, spiMiso, wishboneBase);
+    _vga.begin(spi, csPin, spiClk, spiMosi, spiMiso, wishboneBase);
   }
   
   // Required by Adafruit_GFX - draw a single pixel
   void drawPixel(int16_t x, int16_t y, uint16_t color) override {
     if (x < 0 || x >= width() || y < 0 || y >= height()) return;
-    VGA.putPixel(x, y, (uint8_t)color);
+    _vga.putPixel(x, y, (uint8_t)color);
   }
   
   // Override fillScreen for better performance
   void fillScreen(uint16_t color) override {
-    VGA.setBackgroundColor((uint8_t)color);
-    VGA.clear();
+    _vga.setBackgroundColor((uint8_t)color);
+    _vga.clear();
   }
   
   // Override drawFastHLine for better performance
@@ -65,9 +66,9 @@ public:
     if (x + w > width()) w = width() - x;
     if (w <= 0) return;
     
-    for (int16_t i = 0; i < w; i++) {
-      VGA.putPixel(x + i, y, (uint8_t)color);
-    }
+    uint8_t row[160];
+    hqvgaFill8(row, (uint8_t)color, w);
+    _vga.uploadImage(x, y, w, 1, row);
   }
   
   // Override drawFastVLine for better performance
@@ -77,9 +78,10 @@ public:
     if (y + h > height()) h = height() - y;
     if (h <= 0) return;
     
-    for (int16_t i = 0; i < h; i++) {
-      VGA.putPixel(x, y + i, (uint8_t)color);
-    }
+    // One 1-wide image: a single window stream where the bitstream has it
+    uint8_t col[120];
+    hqvgaFill8(col, (uint8_t)color, h);
+    _vga.uploadImage(x, y, 1, h, col, 1);
   }
   
   // Override fillRect for better performance
@@ -91,11 +93,44 @@ public:
     if (y + h > height()) h = height() - y;
     if (w <= 0 || h <= 0) return;
     
+    // One filled row, burst once per line
+    uint8_t row[160];
+    hqvgaFill8(row, (uint8_t)color, w);
+    VGA_class::BusSession bus(_vga);
+    for (int16_t j = 0; j < h; j++) {
+      _vga.uploadImage(x, y + j, w, 1, row);
+    }
+  }
+  
+  // Translucent filled rectangle, alpha 0 (invisible) to 255 (opaque).
+  // There is no local copy of the screen, so this reads each row back from
+  // VRAM first; use HQVGA_TFT (shadow buffer) for per-frame effects.
+  // Returns false without VRAM readback, or in 4bpp, where pixels are
+  // palette indices, not RGB332.
+  bool fillRectAlpha(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, uint8_t alpha) {
+    HQVGA_ColorLUT lut;
+    lut.setFadeTo((uint8_t)color, alpha, 255);
+    return applyColorLUT(x, y, w, h, lut);
+  }
+  
+  // Run a color table (fade, tint) over a rectangle, a row at a time.
+  // Rows come back through VGA_class::readArea(), so this needs VRAM
+  // readback (VGA_class::hasReadback()). Returns false, and changes
+  // nothing, without it or in 4bpp.
+  bool applyColorLUT(int16_t x, int16_t y, int16_t w, int16_t h, const HQVGA_ColorLUT& lut) {
+    if (_vga.getFormat() == HQVGA_FORMAT_INDEXED4 || !_vga.hasReadback()) return false;
+    if (!hqvgaClipRect(x, y, w, h, width(), height())) return true;
+    
+    uint8_t row[160];
     for (int16_t j = 0; j < h; j++) {
-      for (int16_t i = 0; i < w; i++) {
-        VGA.putPixel(x + i, y + j, (uint8_t)color);
+      for (int16_t i = 0; i < w; i += sizeof(row)) {
+        int16_t n = (w - i < (int16_t)sizeof(row)) ? w - i : (int16_t)sizeof(row);
+        _vga.readArea(x + i, y + j, n, 1, row);
+        hqvgaMapRow(row, n, lut);
+        _vga.uploadImage(x + i, y + j, n, 1, row);
       }
     }
+    return true;
   }
   
   // Helper: Convert RGB888 to RGB332 color format
@@ -114,7 +149,10 @@ public:
   static const uint8_t WHITE   = 0xFF;
   
   // Access to underlying VGA object for advanced operations
-  VGA_class& getVGA() { return VGA; }
+  VGA_class& getVGA() { return _vga; }
+
+private:
+  VGA_class& _vga;
 };
 
 #endif
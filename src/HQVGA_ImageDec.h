@@ -10,6 +10,13 @@
  * All decoders output directly to the HQVGA framebuffer with automatic
  * RGB888/RGB565 to RGB332 color conversion and optional scaling.
  * 
+ * Each helper class (HQVGA_JPEG, HQVGA_PNG, HQVGA_GIF) carries its own
+ * HQVGA_ImageContext, passed to the HQVGA_*DrawCtx callbacks as pUser, so
+ * decoders bound to different VGA_class instances can run side by side.
+ * The plain HQVGA_*Draw callbacks still draw through the global
+ * hqvgaImageCtx and never touch pUser, so sketches that drive the decoders
+ * directly keep their own user pointer.
+ * 
  * Dependencies (add to platformio.ini lib_deps):
  *   bitbank2/JPEGDEC
  *   bitbank2/PNGdec
@@ -73,9 +80,11 @@ struct HQVGA_ImageContext {
     int16_t offsetY;     // Y offset for drawing
     uint8_t* buffer;     // Optional local buffer for buffered mode
     bool buffered;       // Use local buffer instead of direct write
+    uint16_t* lineBuffer; // RGB565 scratch line (PNG)
     
     HQVGA_ImageContext(VGA_class* v = &VGA) : 
-        vga(v), offsetX(0), offsetY(0), buffer(nullptr), buffered(false) {}
+        vga(v), offsetX(0), offsetY(0), buffer(nullptr), buffered(false),
+        lineBuffer(nullptr) {}
     
     void setOffset(int16_t x, int16_t y) { offsetX = x; offsetY = y; }
     void setBuffer(uint8_t* buf) { buffer = buf; buffered = (buf != nullptr); }
@@ -91,20 +100,21 @@ extern HQVGA_ImageContext hqvgaImageCtx;
 #ifdef JPEGDEC_H
 
 /**
- * @brief JPEG draw callback for HQVGA framebuffer
- * 
- * Use with: jpeg.setDrawFunction(HQVGA_JPEGDraw);
- * 
- * Handles MCU blocks from JPEGDEC and writes pixels to framebuffer.
- * Supports 8-bit grayscale and 16-bit RGB565 output.
+ * @brief Write one JPEGDEC MCU block through the given context
  */
-inline int HQVGA_JPEGDraw(JPEGDRAW *pDraw) {
-    int16_t x = pDraw->x + hqvgaImageCtx.offsetX;
-    int16_t y = pDraw->y + hqvgaImageCtx.offsetY;
+inline int hqvgaJPEGDrawTo(HQVGA_ImageContext& ctx, JPEGDRAW *pDraw) {
+    int16_t x = pDraw->x + ctx.offsetX;
+    int16_t y = pDraw->y + ctx.offsetY;
     int16_t w = pDraw->iWidth;
     int16_t h = pDraw->iHeight;
     uint16_t *pixels = pDraw->pPixels;
     
+    if (!(ctx.buffered && ctx.buffer)) {
+        // Whole MCU block as one rectangle; writeArea() clips it
+        ctx.vga->writeArea(x, y, w, h, pixels, w * 2, VGA_class::PIXEL_RGB565_LE);
+        return 1;
+    }
+    
     for (int16_t row = 0; row < h; row++) {
         int16_t py = y + row;
         if (py < 0 || py >= HQVGA_IMG_HEIGHT) {
@@ -115,14 +125,7 @@ inline int HQVGA_JPEGDraw(JPEGDRAW *pDraw) {
         for (int16_t col = 0; col < w; col++) {
             int16_t px = x + col;
             if (px >= 0 && px < HQVGA_IMG_WIDTH) {
-                uint16_t color565 = *pixels;
-                uint8_t color332 = rgb565to332(color565);
-                
-                if (hqvgaImageCtx.buffered && hqvgaImageCtx.buffer) {
-                    hqvgaImageCtx.buffer[py * HQVGA_IMG_WIDTH + px] = color332;
-                } else {
-                    hqvgaImageCtx.vga->putPixel(px, py, color332);
-                }
+                ctx.buffer[py * HQVGA_IMG_WIDTH + px] = rgb565to332(*pixels);
             }
             pixels++;
         }
@@ -130,16 +133,37 @@ inline int HQVGA_JPEGDraw(JPEGDRAW *pDraw) {
     return 1;  // Continue decoding
 }
 
+/**
+ * @brief JPEG draw callback for HQVGA framebuffer
+ * 
+ * Use with: jpeg.setDrawFunction(HQVGA_JPEGDraw);
+ * 
+ * Handles MCU blocks from JPEGDEC and writes pixels to framebuffer.
+ * Supports 8-bit grayscale and 16-bit RGB565 output.
+ * Output goes through hqvgaImageCtx; pUser is left to the sketch.
+ */
+inline int HQVGA_JPEGDraw(JPEGDRAW *pDraw) {
+    return hqvgaJPEGDrawTo(hqvgaImageCtx, pDraw);
+}
+
+/**
+ * @brief JPEG draw callback where pUser is an HQVGA_ImageContext
+ *        (set with jpeg.setUserPointer()) - used by HQVGA_JPEG
+ */
+inline int HQVGA_JPEGDrawCtx(JPEGDRAW *pDraw) {
+    return hqvgaJPEGDrawTo(*(HQVGA_ImageContext*)pDraw->pUser, pDraw);
+}
+
 /**
  * @brief Helper class for JPEG decoding to HQVGA
  */
 class HQVGA_JPEG {
 public:
     JPEGDEC jpeg;
+    HQVGA_ImageContext ctx;
     
-    HQVGA_JPEG(VGA_class* vga = &VGA) {
-        hqvgaImageCtx.vga = vga;
-    }
+    HQVGA_JPEG(VGA_class& vga = VGA) : ctx(&vga) {}
+    HQVGA_JPEG(VGA_class* vga) : ctx(vga) {}
     
     /**
      * @brief Decode JPEG from memory buffer
@@ -151,14 +175,15 @@ public:
      * @return true on success
      */
     bool decode(const uint8_t* data, size_t size, int16_t x = -1, int16_t y = -1, uint8_t* buffer = nullptr) {
-        hqvgaImageCtx.setBuffer(buffer);
+        ctx.setBuffer(buffer);
         
-        if (jpeg.openRAM((uint8_t*)data, size, HQVGA_JPEGDraw)) {
+        if (jpeg.openRAM((uint8_t*)data, size, HQVGA_JPEGDrawCtx)) {
+            jpeg.setUserPointer(&ctx);
             // Auto-center if coordinates are -1
             if (x < 0) x = (HQVGA_IMG_WIDTH - jpeg.getWidth()) / 2;
             if (y < 0) y = (HQVGA_IMG_HEIGHT - jpeg.getHeight()) / 2;
             
-            hqvgaImageCtx.setOffset(x, y);
+            ctx.setOffset(x, y);
             jpeg.setPixelType(RGB565_LITTLE_ENDIAN);
             jpeg.decode(0, 0, 0);  // Decode full image
             jpeg.close();
@@ -171,16 +196,17 @@ public:
      * @brief Decode JPEG with scaling (1/2, 1/4, or 1/8)
      */
     bool decodeScaled(const uint8_t* data, size_t size, int scale, int16_t x = -1, int16_t y = -1, uint8_t* buffer = nullptr) {
-        hqvgaImageCtx.setBuffer(buffer);
+        ctx.setBuffer(buffer);
         
-        if (jpeg.openRAM((uint8_t*)data, size, HQVGA_JPEGDraw)) {
+        if (jpeg.openRAM((uint8_t*)data, size, HQVGA_JPEGDrawCtx)) {
+            jpeg.setUserPointer(&ctx);
             int scaledW = jpeg.getWidth() / scale;
             int scaledH = jpeg.getHeight() / scale;
             
             if (x < 0) x = (HQVGA_IMG_WIDTH - scaledW) / 2;
             if (y < 0) y = (HQVGA_IMG_HEIGHT - scaledH) / 2;
             
-            hqvgaImageCtx.setOffset(x, y);
+            ctx.setOffset(x, y);
             jpeg.setPixelType(RGB565_LITTLE_ENDIAN);
             
             int options = 0;
@@ -208,18 +234,15 @@ public:
 #ifdef __PNGDEC__
 
 /**
- * @brief PNG draw callback for HQVGA framebuffer
- * 
- * Use with: png.setDrawCallback(HQVGA_PNGDraw);
+ * @brief Write one decoded PNG line through the given context
+ * @param pixels RGB565 scratch line at least pDraw->iWidth long
  */
-inline int HQVGA_PNGDraw(PNGDRAW *pDraw) {
-    int16_t x = hqvgaImageCtx.offsetX;
-    int16_t y = pDraw->y + hqvgaImageCtx.offsetY;
+inline int hqvgaPNGDrawTo(HQVGA_ImageContext& ctx, PNGDRAW *pDraw, uint16_t *pixels) {
+    int16_t x = ctx.offsetX;
+    int16_t y = pDraw->y + ctx.offsetY;
     
     if (y < 0 || y >= HQVGA_IMG_HEIGHT) return 1;  // Skip but continue
     
-    uint16_t *pixels = (uint16_t*)pDraw->pUser;  // RGB565 line buffer
-    
     // Convert indexed/RGB to RGB565 line
     if (pDraw->pPalette) {
         // Indexed color
@@ -233,21 +256,38 @@ inline int HQVGA_PNGDraw(PNGDRAW *pDraw) {
     }
     
     // Write to framebuffer
+    if (!(ctx.buffered && ctx.buffer)) {
+        ctx.vga->writeArea(x, y, pDraw->iWidth, 1, pixels, 0, VGA_class::PIXEL_RGB565_LE);
+        return 1;
+    }
     for (int16_t col = 0; col < pDraw->iWidth; col++) {
         int16_t px = x + col;
         if (px >= 0 && px < HQVGA_IMG_WIDTH) {
-            uint8_t color332 = rgb565to332(pixels[col]);
-            
-            if (hqvgaImageCtx.buffered && hqvgaImageCtx.buffer) {
-                hqvgaImageCtx.buffer[y * HQVGA_IMG_WIDTH + px] = color332;
-            } else {
-                hqvgaImageCtx.vga->putPixel(px, y, color332);
-            }
+            ctx.buffer[y * HQVGA_IMG_WIDTH + px] = rgb565to332(pixels[col]);
         }
     }
     return 1;  // Continue decoding
 }
 
+/**
+ * @brief PNG draw callback for HQVGA framebuffer
+ * 
+ * Use with: png.setDrawCallback(HQVGA_PNGDraw);
+ * pUser is the RGB565 line buffer; output goes through hqvgaImageCtx.
+ */
+inline int HQVGA_PNGDraw(PNGDRAW *pDraw) {
+    return hqvgaPNGDrawTo(hqvgaImageCtx, pDraw, (uint16_t*)pDraw->pUser);
+}
+
+/**
+ * @brief PNG draw callback where pUser is an HQVGA_ImageContext
+ *        (with lineBuffer set) - used by HQVGA_PNG
+ */
+inline int HQVGA_PNGDrawCtx(PNGDRAW *pDraw) {
+    HQVGA_ImageContext* ctx = (HQVGA_ImageContext*)pDraw->pUser;
+    return hqvgaPNGDrawTo(*ctx, pDraw, ctx->lineBuffer);
+}
+
 /**
  * @brief Helper class for PNG decoding to HQVGA
  */
@@ -255,26 +295,27 @@ class HQVGA_PNG {
 public:
     PNG png;
     uint8_t lineBuffer[HQVGA_IMG_WIDTH * 4];  // Line buffer for RGBA decoding
+    HQVGA_ImageContext ctx;
     
-    HQVGA_PNG(VGA_class* vga = &VGA) {
-        hqvgaImageCtx.vga = vga;
-    }
+    HQVGA_PNG(VGA_class& vga = VGA) : ctx(&vga) {}
+    HQVGA_PNG(VGA_class* vga) : ctx(vga) {}
     
     /**
      * @brief Decode PNG from memory buffer
      */
     bool decode(const uint8_t* data, size_t size, int16_t x = -1, int16_t y = -1, uint8_t* buffer = nullptr) {
-        hqvgaImageCtx.setBuffer(buffer);
+        ctx.setBuffer(buffer);
+        ctx.lineBuffer = (uint16_t*)lineBuffer;
         
-        int rc = png.openRAM((uint8_t*)data, size, HQVGA_PNGDraw);
+        int rc = png.openRAM((uint8_t*)data, size, HQVGA_PNGDrawCtx);
         if (rc == PNG_SUCCESS) {
             // Auto-center if coordinates are -1
             if (x < 0) x = (HQVGA_IMG_WIDTH - png.getWidth()) / 2;
             if (y < 0) y = (HQVGA_IMG_HEIGHT - png.getHeight()) / 2;
             
-            hqvgaImageCtx.setOffset(x, y);
+            ctx.setOffset(x, y);
             png.setBuffer((uint8_t*)lineBuffer);
-            png.decode((void*)lineBuffer, 0);
+            png.decode((void*)&ctx, 0);
             png.close();
             return true;
         }
@@ -294,14 +335,11 @@ public:
 #ifdef __AnimatedGIF__
 
 /**
- * @brief GIF draw callback for HQVGA framebuffer
- * 
- * Use with: gif.begin(GIF_PALETTE_RGB565_LE);
- *           and set pUser to point to HQVGA_ImageContext
+ * @brief Write one GIF line through the given context
  */
-inline void HQVGA_GIFDraw(GIFDRAW *pDraw) {
-    int16_t x = hqvgaImageCtx.offsetX;
-    int16_t y = pDraw->y + hqvgaImageCtx.offsetY + pDraw->iY;
+inline void hqvgaGIFDrawTo(HQVGA_ImageContext& ctx, GIFDRAW *pDraw) {
+    int16_t x = ctx.offsetX;
+    int16_t y = pDraw->y + ctx.offsetY + pDraw->iY;
     
     if (y < 0 || y >= HQVGA_IMG_HEIGHT) return;
     if (pDraw->iY + pDraw->iHeight > HQVGA_IMG_HEIGHT) return;
@@ -325,15 +363,33 @@ inline void HQVGA_GIFDraw(GIFDRAW *pDraw) {
             uint16_t color565 = palette[idx];
             uint8_t color332 = rgb565to332(color565);
             
-            if (hqvgaImageCtx.buffered && hqvgaImageCtx.buffer) {
-                hqvgaImageCtx.buffer[y * HQVGA_IMG_WIDTH + px] = color332;
+            if (ctx.buffered && ctx.buffer) {
+                ctx.buffer[y * HQVGA_IMG_WIDTH + px] = color332;
             } else {
-                hqvgaImageCtx.vga->putPixel(px, y, color332);
+                ctx.vga->putPixel(px, y, color332);
             }
         }
     }
 }
 
+/**
+ * @brief GIF draw callback for HQVGA framebuffer
+ * 
+ * Use with: gif.begin(GIF_PALETTE_RGB565_LE);
+ *           output goes through hqvgaImageCtx; pUser is left to the sketch
+ */
+inline void HQVGA_GIFDraw(GIFDRAW *pDraw) {
+    hqvgaGIFDrawTo(hqvgaImageCtx, pDraw);
+}
+
+/**
+ * @brief GIF draw callback where playFrame()'s pUser is an
+ *        HQVGA_ImageContext - used by HQVGA_GIF
+ */
+inline void HQVGA_GIFDrawCtx(GIFDRAW *pDraw) {
+    hqvgaGIFDrawTo(*(HQVGA_ImageContext*)pDraw->pUser, pDraw);
+}
+
 /**
  * @brief Helper class for GIF playback to HQVGA
  */
@@ -343,25 +399,25 @@ public:
     bool playing;
     unsigned long lastFrameTime;
     int frameDelay;
+    HQVGA_ImageContext ctx;
     
-    HQVGA_GIF(VGA_class* vga = &VGA) : playing(false), lastFrameTime(0), frameDelay(0) {
-        hqvgaImageCtx.vga = vga;
-    }
+    HQVGA_GIF(VGA_class& vga = VGA) : playing(false), lastFrameTime(0), frameDelay(0), ctx(&vga) {}
+    HQVGA_GIF(VGA_class* vga) : playing(false), lastFrameTime(0), frameDelay(0), ctx(vga) {}
     
     /**
      * @brief Open GIF from memory buffer
      */
     bool open(const uint8_t* data, size_t size, int16_t x = -1, int16_t y = -1, uint8_t* buffer = nullptr) {
-        hqvgaImageCtx.setBuffer(buffer);
+        ctx.setBuffer(buffer);
         
         gif.begin(GIF_PALETTE_RGB565_LE);
         
-        if (gif.open((uint8_t*)data, size, HQVGA_GIFDraw)) {
+        if (gif.open((uint8_t*)data, size, HQVGA_GIFDrawCtx)) {
             // Auto-center if coordinates are -1
             if (x < 0) x = (HQVGA_IMG_WIDTH - gif.getCanvasWidth()) / 2;
             if (y < 0) y = (HQVGA_IMG_HEIGHT - gif.getCanvasHeight()) / 2;
             
-            hqvgaImageCtx.setOffset(x, y);
+            ctx.setOffset(x, y);
             playing = true;
             lastFrameTime = millis();
             return true;
@@ -381,7 +437,7 @@ public:
             return false;  // Not time for next frame yet
         }
         
-        int result = gif.playFrame(false, &frameDelay);
+        int result = gif.playFrame(false, &frameDelay, &ctx);
         lastFrameTime = now;
         
         if (result == 0) {
@@ -397,7 +453,7 @@ public:
      */
     bool playSingleFrame() {
         if (!playing) return false;
-        gif.playFrame(true, nullptr);
+        gif.playFrame(true, nullptr, &ctx);
         return true;
     }
     
@@ -0,0 +1,386 @@
+/**
+ * @file HQVGA_Kernels.h
+ * @brief Vectorized row kernels for host-side pixel buffers
+ *
+ * The inner loops behind surfaces, sprites and the adapters: fills, copies,
+ * transparent (color-keyed) copies, 1bpp to 8bpp expansion and RGB565 to
+ * RGB332 conversion. Every kernel has a portable scalar reference
+ * (hqvgaRef*) and a dispatching entry point (hqvga*) that picks the widest
+ * implementation available at compile time:
+ *
+ *   HQVGA_KERNELS_SSE2    x86 host builds (16 pixels per step)
+ *   HQVGA_KERNELS_NEON    ARM host builds (16 pixels per step)
+ *   HQVGA_KERNELS_SWAR    ESP32 / other 32-bit targets (4 pixels per word)
+ *   HQVGA_KERNELS_SCALAR  reference only (define to force it)
+ *
+ * There is no ESP32-S3 PIE (128-bit Xtensa SIMD) path; the S3 runs the
+ * SWAR kernels. The compiler does not emit PIE instructions and the
+ * Arduino core has no intrinsics for them, so each kernel would need its
+ * own inline assembly. That is not worth it for spans of one 160-pixel
+ * row, which take far longer to upload over SPI than to convert.
+ *
+ * HQVGA_KERNEL_ISA names the selected implementation. Fills and plain
+ * copies go to memset/memmove, which are already word or vector wide in
+ * every libc this library builds against. Kernels take pre-clipped spans:
+ * no bounds checks inside the loops. src and dst must not overlap except
+ * for hqvgaCopy8.
+ *
+ * examples/kernel_benchmark times each kernel and checks it against the
+ * scalar reference; extras/virtual_papilio/perf.sh runs that check for the
+ * host (SSE2/NEON) and SWAR builds and fails on a mismatch.
+ */
+
+#ifndef HQVGA_KERNELS_H
+#define HQVGA_KERNELS_H
+
+#include <Arduino.h>
+#include <string.h>
+
+#if !defined(HQVGA_KERNELS_SCALAR) && !defined(HQVGA_KERNELS_SSE2) && \
+    !defined(HQVGA_KERNELS_NEON) && !defined(HQVGA_KERNELS_SWAR)
+  #if defined(__SSE2__)
+    #define HQVGA_KERNELS_SSE2
+  #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define HQVGA_KERNELS_NEON
+  #else
+    #define HQVGA_KERNELS_SWAR
+  #endif
+#endif
+
+#if defined(HQVGA_KERNELS_SSE2)
+  #include <emmintrin.h>
+  #define HQVGA_KERNEL_ISA "sse2"
+#elif defined(HQVGA_KERNELS_NEON)
+  #include <arm_neon.h>
+  #define HQVGA_KERNEL_ISA "neon"
+#elif defined(HQVGA_KERNELS_SWAR)
+  #define HQVGA_KERNEL_ISA "swar32"
+#else
+  #define HQVGA_KERNEL_ISA "scalar"
+#endif
+
+// ===== Scalar reference =====
+
+inline void hqvgaRefFill8(uint8_t* dst, uint8_t c, int16_t n) {
+    while (n-- > 0) *dst++ = c;
+}
+
+inline void hqvgaRefCopy8(uint8_t* dst, const uint8_t* src, int16_t n) {
+    if (dst > src) {
+        while (n-- > 0) dst[n] = src[n];
+    } else {
+        for (int16_t i = 0; i < n; i++) dst[i] = src[i];
+    }
+}
+
+inline void hqvgaRefCopyKeyed8(uint8_t* dst, const uint8_t* src, int16_t n, uint8_t key) {
+    for (int16_t i = 0; i < n; i++) {
+        if (src[i] != key) dst[i] = src[i];
+    }
+}
+
+/**
+ * @brief 1bpp (MSB = leftmost) to 8bpp: set bits become fg, clear bits bg
+ * @param bit Index of the first source bit (need not be byte-aligned)
+ */
+inline void hqvgaRefExpand1(uint8_t* dst, const uint8_t* bits, uint16_t bit, int16_t n,
+                            uint8_t fg, uint8_t bg) {
+    for (int16_t i = 0; i < n; i++, bit++) {
+        dst[i] = (bits[bit >> 3] & (0x80 >> (bit & 7))) ? fg : bg;
+    }
+}
+
+/**
+ * @brief 1bpp to 8bpp where clear bits leave dst untouched
+ */
+inline void hqvgaRefExpand1Keyed(uint8_t* dst, const uint8_t* bits, uint16_t bit, int16_t n,
+                                 uint8_t fg) {
+    for (int16_t i = 0; i < n; i++, bit++) {
+        if (bits[bit >> 3] & (0x80 >> (bit & 7))) dst[i] = fg;
+    }
+}
+
+inline uint8_t hqvga565to332(uint16_t c) {
+    return ((c >> 8) & 0xE0) | ((c >> 6) & 0x1C) | ((c >> 3) & 0x03);
+}
+
+inline void hqvgaRefConvert565(uint8_t* dst, const uint16_t* src, int16_t n) {
+    for (int16_t i = 0; i < n; i++) dst[i] = hqvga565to332(src[i]);
+}
+
+// ===== Dispatch =====
+
+inline void hqvgaFill8(uint8_t* dst, uint8_t c, int16_t n) {
+    if (n > 0) memset(dst, c, n);
+}
+
+inline void hqvgaCopy8(uint8_t* dst, const uint8_t* src, int16_t n) {
+    if (n > 0) memmove(dst, src, n);
+}
+
+#if defined(HQVGA_KERNELS_SSE2)
+
+inline void hqvgaCopyKeyed8(uint8_t* dst, const uint8_t* src, int16_t n, uint8_t key) {
+    const __m128i k = _mm_set1_epi8((char)key);
+    for (; n >= 16; n -= 16, src += 16, dst += 16) {
+        __m128i s = _mm_loadu_si128((const __m128i*)src);
+        __m128i d = _mm_loadu_si128((const __m128i*)dst);
+        __m128i m = _mm_cmpeq_epi8(s, k);
+        _mm_storeu_si128((__m128i*)dst, _mm_or_si128(_mm_and_si128(m, d), _mm_andnot_si128(m, s)));
+    }
+    hqvgaRefCopyKeyed8(dst, src, n, key);
+}
+
+// Byte i of the result is 0xFF if bit i (MSB first) of b0:b1 is set
+inline __m128i hqvgaSse2BitMask(uint8_t b0, uint8_t b1) {
+    const __m128i sel = _mm_set1_epi64x(0x0102040810204080LL);
+    __m128i v = _mm_set_epi64x((long long)(b1 * 0x0101010101010101ULL),
+                               (long long)(b0 * 0x0101010101010101ULL));
+    return _mm_cmpeq_epi8(_mm_and_si128(v, sel), sel);
+}
+
+inline void hqvgaExpand1(uint8_t* dst, const uint8_t* bits, uint16_t bit, int16_t n,
+                         uint8_t fg, uint8_t bg) {
+    int16_t head = (8 - (bit & 7)) & 7;
+    if (head > n) head = n;
+    hqvgaRefExpand1(dst, bits, bit, head, fg, bg);
+    dst += head; bit += head; n -= head;
+    const uint8_t* p = bits + (bit >> 3);
+    const __m128i f = _mm_set1_epi8((char)fg);
+    const __m128i b = _mm_set1_epi8((char)bg);
+    for (; n >= 16; n -= 16, p += 2, dst += 16) {
+        __m128i m = hqvgaSse2BitMask(p[0], p[1]);
+        _mm_storeu_si128((__m128i*)dst, _mm_or_si128(_mm_and_si128(m, f), _mm_andnot_si128(m, b)));
+    }
+    hqvgaRefExpand1(dst, p, 0, n, fg, bg);
+}
+
+inline void hqvgaExpand1Keyed(uint8_t* dst, const uint8_t* bits, uint16_t bit, int16_t n,
+                              uint8_t fg) {
+    int16_t head = (8 - (bit & 7)) & 7;
+    if (head > n) head = n;
+    hqvgaRefExpand1Keyed(dst, bits, bit, head, fg);
+    dst += head; bit += head; n -= head;
+    const uint8_t* p = bits + (bit >> 3);
+    const __m128i f = _mm_set1_epi8((char)fg);
+    for (; n >= 16; n -= 16, p += 2, dst += 16) {
+        __m128i m = hqvgaSse2BitMask(p[0], p[1]);
+        __m128i d = _mm_loadu_si128((const __m128i*)dst);
+        _mm_storeu_si128((__m128i*)dst, _mm_or_si128(_mm_and_si128(m, f), _mm_andnot_si128(m, d)));
+    }
+    hqvgaRefExpand1Keyed(dst, p, 0, n, fg);
+}
+
+inline __m128i hqvgaSse2Pack332(__m128i c) {
+    __m128i r = _mm_and_si128(_mm_srli_epi16(c, 8), _mm_set1_epi16(0xE0));
+    __m128i g = _mm_and_si128(_mm_srli_epi16(c, 6), _mm_set1_epi16(0x1C));
+    __m128i b = _mm_and_si128(_mm_srli_epi16(c, 3), _mm_set1_epi16(0x03));
+    return _mm_or_si128(_mm_or_si128(r, g), b);
+}
+
+inline void hqvgaConvert565(uint8_t* dst, const uint16_t* src, int16_t n) {
+    for (; n >= 16; n -= 16, src += 16, dst += 16) {
+        __m128i lo = hqvgaSse2Pack332(_mm_loadu_si128((const __m128i*)src));
+        __m128i hi = hqvgaSse2Pack332(_mm_loadu_si128((const __m128i*)(src + 8)));
+        _mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(lo, hi));
+    }
+    hqvgaRefConvert565(dst, src, n);
+}
+
+#elif defined(HQVGA_KERNELS_NEON)
+
+inline void hqvgaCopyKeyed8(uint8_t* dst, const uint8_t* src, int16_t n, uint8_t key) {
+    const uint8x16_t k = vdupq_n_u8(key);
+    for (; n >= 16; n -= 16, src += 16, dst += 16) {
+        uint8x16_t s = vld1q_u8(src);
+        uint8x16_t m = vceqq_u8(s, k);
+        vst1q_u8(dst, vbslq_u8(m, vld1q_u8(dst), s));
+    }
+    hqvgaRefCopyKeyed8(dst, src, n, key);
+}
+
+// Lane i is 0xFF if bit i (MSB first) of b0:b1 is set
+inline uint8x16_t hqvgaNeonBitMask(uint8_t b0, uint8_t b1) {
+    static const uint8_t sel[16] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+                                     0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+    uint8x16_t v = vcombine_u8(vdup_n_u8(b0), vdup_n_u8(b1));
+    return vtstq_u8(v, vld1q_u8(sel));
+}
+
+inline void hqvgaExpand1(uint8_t* dst, const uint8_t* bits, uint16_t bit, int16_t n,
+                         uint8_t fg, uint8_t bg) {
+    int16_t head = (8 - (bit & 7)) & 7;
+    if (head > n) head = n;
+    hqvgaRefExpand1(dst, bits, bit, head, fg, bg);
+    dst += head; bit += head; n -= head;
+    const uint8_t* p = bits + (bit >> 3);
+    const uint8x16_t f = vdupq_n_u8(fg);
+    const uint8x16_t b = vdupq_n_u8(bg);
+    for (; n >= 16; n -= 16, p += 2, dst += 16) {
+        vst1q_u8(dst, vbslq_u8(hqvgaNeonBitMask(p[0], p[1]), f, b));
+    }
+    hqvgaRefExpand1(dst, p, 0, n, fg, bg);
+}
+
+inline void hqvgaExpand1Keyed(uint8_t* dst, const uint8_t* bits, uint16_t bit, int16_t n,
+                              uint8_t fg) {
+    int16_t head = (8 - (bit & 7)) & 7;
+    if (head > n) head = n;
+    hqvgaRefExpand1Keyed(dst, bits, bit, head, fg);
+    dst += head; bit += head; n -= head;
+    const uint8_t* p = bits + (bit >> 3);
+    const uint8x16_t f = vdupq_n_u8(fg);
+    for (; n >= 16; n -= 16, p += 2, dst += 16) {
+        vst1q_u8(dst, vbslq_u8(hqvgaNeonBitMask(p[0], p[1]), f, vld1q_u8(dst)));
+    }
+    hqvgaRefExpand1Keyed(dst, p, 0, n, fg);
+}
+
+inline uint8x8_t hqvgaNeonPack332(uint16x8_t c) {
+    uint16x8_t r = vandq_u16(vshrq_n_u16(c, 8), vdupq_n_u16(0xE0));
+    uint16x8_t g = vandq_u16(vshrq_n_u16(c, 6), vdupq_n_u16(0x1C));
+    uint16x8_t b = vandq_u16(vshrq_n_u16(c, 3), vdupq_n_u16(0x03));
+    return vmovn_u16(vorrq_u16(vorrq_u16(r, g), b));
+}
+
+inline void hqvgaConvert565(uint8_t* dst, const uint16_t* src, int16_t n) {
+    for (; n >= 16; n -= 16, src += 16, dst += 16) {
+        vst1q_u8(dst, vcombine_u8(hqvgaNeonPack332(vld1q_u16(src)),
+                                  hqvgaNeonPack332(vld1q_u16(src + 8))));
+    }
+    hqvgaRefConvert565(dst, src, n);
+}
+
+#elif defined(HQVGA_KERNELS_SWAR)
+
+// 32-bit SIMD-within-a-register: four pixels per aligned word
+
+inline uint32_t hqvgaLoad32(const uint8_t* p) {
+    uint32_t w;
+    memcpy(&w, __builtin_assume_aligned(p, 4), 4);
+    return w;
+}
+
+inline void hqvgaStore32(uint8_t* p, uint32_t w) {
+    memcpy(__builtin_assume_aligned(p, 4), &w, 4);
+}
+
+inline void hqvgaCopyKeyed8(uint8_t* dst, const uint8_t* src, int16_t n, uint8_t key) {
+    while (n > 0 && ((uintptr_t)dst & 3)) {
+        if (*src != key) *dst = *src;
+        src++; dst++; n--;
+    }
+    if (((uintptr_t)src & 3) == 0) {
+        const uint32_t k = key * 0x01010101u;
+        for (; n >= 4; n -= 4, src += 4, dst += 4) {
+            uint32_t s = hqvgaLoad32(src);
+            uint32_t x = s ^ k;
+            // High bit of each byte set where that byte of s differs from key
+            uint32_t nz = (((x & 0x7F7F7F7Fu) + 0x7F7F7F7Fu) | x) & 0x80808080u;
+            uint32_t m = (nz >> 7) * 0xFF;
+            hqvgaStore32(dst, (s & m) | (hqvgaLoad32(dst) & ~m));
+        }
+    }
+    hqvgaRefCopyKeyed8(dst, src, n, key);
+}
+
+// Byte masks for a nibble, leftmost pixel (MSB) in the lowest address
+inline uint32_t hqvgaSwarNibbleMask(uint8_t nib) {
+    uint32_t m = 0;
+    if (nib & 8) m |= 0x000000FFu;
+    if (nib & 4) m |= 0x0000FF00u;
+    if (nib & 2) m |= 0x00FF0000u;
+    if (nib & 1) m |= 0xFF000000u;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    m = __builtin_bswap32(m);
+#endif
+    return m;
+}
+
+inline void hqvgaExpand1(uint8_t* dst, const uint8_t* bits, uint16_t bit, int16_t n,
+                         uint8_t fg, uint8_t bg) {
+    int16_t head = (8 - (bit & 7)) & 7;
+    if (head > n) head = n;
+    hqvgaRefExpand1(dst, bits, bit, head, fg, bg);
+    dst += head; bit += head; n -= head;
+    const uint8_t* p = bits + (bit >> 3);
+    if (((uintptr_t)dst & 3) == 0) {
+        const uint32_t f = fg * 0x01010101u;
+        const uint32_t b = bg * 0x01010101u;
+        for (; n >= 8; n -= 8, p++, dst += 8) {
+            uint32_t m0 = hqvgaSwarNibbleMask(*p >> 4);
+            uint32_t m1 = hqvgaSwarNibbleMask(*p & 0x0F);
+            hqvgaStore32(dst, (f & m0) | (b & ~m0));
+            hqvgaStore32(dst + 4, (f & m1) | (b & ~m1));
+        }
+    }
+    hqvgaRefExpand1(dst, p, 0, n, fg, bg);
+}
+
+inline void hqvgaExpand1Keyed(uint8_t* dst, const uint8_t* bits, uint16_t bit, int16_t n,
+                              uint8_t fg) {
+    int16_t head = (8 - (bit & 7)) & 7;
+    if (head > n) head = n;
+    hqvgaRefExpand1Keyed(dst, bits, bit, head, fg);
+    dst += head; bit += head; n -= head;
+    const uint8_t* p = bits + (bit >> 3);
+    if (((uintptr_t)dst & 3) == 0) {
+        const uint32_t f = fg * 0x01010101u;
+        for (; n >= 8; n -= 8, p++, dst += 8) {
+            if (!*p) continue;
+            uint32_t m0 = hqvgaSwarNibbleMask(*p >> 4);
+            uint32_t m1 = hqvgaSwarNibbleMask(*p & 0x0F);
+            hqvgaStore32(dst, (f & m0) | (hqvgaLoad32(dst) & ~m0));
+            hqvgaStore32(dst + 4, (f & m1) | (hqvgaLoad32(dst + 4) & ~m1));
+        }
+    }
+    hqvgaRefExpand1Keyed(dst, p, 0, n, fg);
+}
+
+// Two RGB565 pixels per word: each 16-bit lane packs to RGB332 in its low
+// byte (the masks drop the bits shifted in from the other lane)
+inline uint32_t hqvgaSwarPack332(uint32_t w) {
+    return ((w >> 8) & 0x00E000E0u) | ((w >> 6) & 0x001C001Cu) | ((w >> 3) & 0x00030003u);
+}
+
+inline void hqvgaConvert565(uint8_t* dst, const uint16_t* src, int16_t n) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (n > 0 && ((uintptr_t)dst & 3)) {
+        *dst++ = hqvga565to332(*src++);
+        n--;
+    }
+    if (((uintptr_t)src & 3) == 0) {
+        for (; n >= 4; n -= 4, src += 4, dst += 4) {
+            uint32_t c0 = hqvgaSwarPack332(hqvgaLoad32((const uint8_t*)src));
+            uint32_t c1 = hqvgaSwarPack332(hqvgaLoad32((const uint8_t*)(src + 2)));
+            hqvgaStore32(dst, (c0 & 0xFFu) | ((c0 >> 8) & 0xFF00u) |
+                              ((c1 & 0xFFu) << 16) | ((c1 << 8) & 0xFF000000u));
+        }
+    }
+#endif
+    hqvgaRefConvert565(dst, src, n);
+}
+
+#else
+
+inline void hqvgaCopyKeyed8(uint8_t* dst, const uint8_t* src, int16_t n, uint8_t key) {
+    hqvgaRefCopyKeyed8(dst, src, n, key);
+}
+
+inline void hqvgaExpand1(uint8_t* dst, const uint8_t* bits, uint16_t bit, int16_t n,
+                         uint8_t fg, uint8_t bg) {
+    hqvgaRefExpand1(dst, bits, bit, n, fg, bg);
+}
+
+inline void hqvgaExpand1Keyed(uint8_t* dst, const uint8_t* bits, uint16_t bit, int16_t n,
+                              uint8_t fg) {
+    hqvgaRefExpand1Keyed(dst, bits, bit, n, fg);
+}
+
+inline void hqvgaConvert565(uint8_t* dst, const uint16_t* src, int16_t n) {
+    hqvgaRefConvert565(dst, src, n);
+}
+
+#endif
+
+#endif // HQVGA_KERNELS_H
@@ -53,7 +53,7 @@
 
 class HQVGA_LVGL {
 public:
-  HQVGA_LVGL() : _initialized(false) {}
+  HQVGA_LVGL(VGA_class& vga = VGA) : _vga(vga), _initialized(false) {}
   
   // Initialize display and LVGL driver
   // Call lv_init() BEFORE calling this!
@@ -62,7 +62,7 @@ public:
              uint8_t wishboneBase = 0x00) {
     
     // Initialize HQVGA hardware
-    VGA.begin(spi, csPin, spiClk, spiMosi, spiMiso, wishboneBase);
+    _vga.begin(spi, csPin, spiClk, spiMosi, spiMiso, wishboneBase);
     
     // Store instance for static callback
     _instance = this;
@@ -108,7 +108,7 @@ public:
   bool isInitialized() const { return _initialized; }
   
   // Access underlying VGA object
-  VGA_class& getVGA() { return VGA; }
+  VGA_class& getVGA() { return _vga; }
   
   // Convert RGB888 to RGB332 for HQVGA display
   static uint8_t toRGB332(uint8_t r, uint8_t g, uint8_t b) {
@@ -136,6 +136,7 @@ public:
   }
 
 private:
+  VGA_class& _vga;
   bool _initialized;
   lv_color_t* _buf1;
   static HQVGA_LVGL* _instance;
@@ -155,14 +156,24 @@ private:
     HQVGA_LVGL* instance = (HQVGA_LVGL*)disp->user_data;
 #endif
     
-    // Write pixels to HQVGA framebuffer
+    // VGA_class converts a row at a time and bursts it to the framebuffer
+    int16_t w = area->x2 - area->x1 + 1;
+#if LV_COLOR_DEPTH == 16 && !LV_COLOR_16_SWAP
+    instance->_vga.writeArea(area->x1, area->y1, w, area->y2 - area->y1 + 1, color_p, 0, VGA_class::PIXEL_RGB565_LE);
+#elif LV_COLOR_DEPTH == 16
+    instance->_vga.writeArea(area->x1, area->y1, w, area->y2 - area->y1 + 1, color_p, 0, VGA_class::PIXEL_RGB565_BE);
+#else
+    uint8_t row[HQVGA_LVGL_WIDTH];
     for (int y = area->y1; y <= area->y2; y++) {
-      for (int x = area->x1; x <= area->x2; x++) {
-        uint8_t rgb332 = lvColorToRGB332(*color_p);
-        VGA.putPixel(x, y, rgb332);
-        color_p++;
+      for (int16_t x = 0; x < w; x += HQVGA_LVGL_WIDTH) {
+        int16_t n = (w - x < HQVGA_LVGL_WIDTH) ? w - x : HQVGA_LVGL_WIDTH;
+        for (int16_t i = 0; i < n; i++) {
+          row[i] = lvColorToRGB332(*color_p++);
+        }
+        instance->_vga.uploadImage(area->x1 + x, y, n, 1, row);
       }
     }
+#endif
     
     // Tell LVGL we're done flushing
 #if LV_VERSION_CHECK(9, 0, 0)
@@ -0,0 +1,186 @@
+/**
+ * @file HQVGA_MultiDisplay.h
+ * @brief Present surfaces to several Papilio FPGAs at once (video walls)
+ *
+ * Each display is its own VGA_class on its own CS line. Displays attached
+ * to different SPI hosts (e.g. HSPI and FSPI on the ESP32-S3) are uploaded
+ * concurrently, one FreeRTOS task per host, so aggregate bandwidth grows
+ * with the number of links. Displays sharing a host are uploaded in turn
+ * by that host's task.
+ *
+ * Usage:
+ *   #include <HQVGA_MultiDisplay.h>
+ *
+ *   VGA_class left, right;
+ *   HQVGA_Surface<HQVGA_FormatRGB332, 160, 120> leftFb, rightFb;
+ *   HQVGA_MultiDisplay wall;
+ *
+ *   void setup() {
+ *     SPIClass* hspi = new SPIClass(HSPI);
+ *     SPIClass* fspi = new SPIClass(FSPI);
+ *     hspi->begin(12, 9, 11, 10);
+ *     fspi->begin(36, 37, 35, 34);
+ *     left.begin(hspi, 10, 12, 11, 9);
+ *     right.begin(fspi, 34, 36, 35, 37);
+ *     wall.add(left);
+ *     wall.add(right);
+ *   }
+ *
+ *   void loop() {
+ *     // ... draw into leftFb / rightFb ...
+ *     const HQVGA_Surface<HQVGA_FormatRGB332, 160, 120>* frames[] = { &leftFb, &rightFb };
+ *     wall.present(frames);
+ *   }
+ */
+
+#ifndef HQVGA_MULTIDISPLAY_H
+#define HQVGA_MULTIDISPLAY_H
+
+#include <Arduino.h>
+#include "HQVGA.h"
+#include "HQVGA_Surface.h"
+
+class HQVGA_MultiDisplay {
+public:
+    static const uint8_t MAX_DISPLAYS = 8;
+
+    HQVGA_MultiDisplay() : _count(0) {}
+
+    /**
+     * @brief Register a display (call after its begin())
+     * @param x,y Where the surface's top-left pixel lands on this display
+     * @return false if MAX_DISPLAYS are already registered
+     */
+    bool add(VGA_class& vga, int16_t x = 0, int16_t y = 0) {
+        if (_count >= MAX_DISPLAYS) return false;
+        _entries[_count].vga = &vga;
+        _entries[_count].x = x;
+        _entries[_count].y = y;
+        _count++;
+        return true;
+    }
+
+    uint8_t count() const { return _count; }
+    VGA_class& display(uint8_t i) { return *_entries[i].vga; }
+
+    /**
+     * @brief Upload one surface per display (in add() order), in parallel
+     *        across SPI hosts. Returns when every display is done.
+     */
+    template <class S>
+    void present(const S* const* surfaces) {
+        Job jobs[MAX_DISPLAYS];
+        for (uint8_t i = 0; i < _count; i++) {
+            jobs[i].vga = _entries[i].vga;
+            jobs[i].surface = surfaces[i];
+            jobs[i].x = _entries[i].x;
+            jobs[i].y = _entries[i].y;
+            jobs[i].upload = &uploadSurface<S>;
+        }
+        run(jobs);
+    }
+
+    /**
+     * @brief Upload the same surface to every display (mirroring)
+     */
+    template <class S>
+    void mirror(const S& surface) {
+        const S* surfaces[MAX_DISPLAYS];
+        for (uint8_t i = 0; i < _count; i++) surfaces[i] = &surface;
+        present<S>(surfaces);
+    }
+
+private:
+    struct Entry {
+        VGA_class* vga;
+        int16_t x, y;
+    };
+
+    struct Job {
+        VGA_class* vga;
+        const void* surface;
+        int16_t x, y;
+        void (*upload)(const Job&);
+    };
+
+    // All jobs that share one SPI host
+    struct Group {
+        SPIClass* spi;
+        const Job* jobs[MAX_DISPLAYS];
+        uint8_t count;
+#if defined(ESP32)
+        SemaphoreHandle_t done;
+#endif
+    };
+
+    Entry _entries[MAX_DISPLAYS];
+    uint8_t _count;
+
+    template <class S>
+    static void uploadSurface(const Job& job) {
+        static_cast<const S*>(job.surface)->present(*job.vga, job.x, job.y);
+    }
+
+    static void runGroup(const Group& g) {
+        for (uint8_t i = 0; i < g.count; i++) {
+            g.jobs[i]->upload(*g.jobs[i]);
+        }
+    }
+
+#if defined(ESP32)
+    static void groupTask(void* arg) {
+        Group* g = (Group*)arg;
+        runGroup(*g);
+        xSemaphoreGive(g->done);
+        vTaskDelete(NULL);
+    }
+#endif
+
+    void run(const Job* jobs) {
+        Group groups[MAX_DISPLAYS];
+        uint8_t groupCount = 0;
+
+        for (uint8_t i = 0; i < _count; i++) {
+            SPIClass* spi = jobs[i].vga->getSPI();
+            uint8_t g = 0;
+            while (g < groupCount && groups[g].spi != spi) g++;
+            if (g == groupCount) {
+                groups[g].spi = spi;
+                groups[g].count = 0;
+                groupCount++;
+            }
+            groups[g].jobs[groups[g].count++] = &jobs[i];
+        }
+
+#if defined(ESP32)
+        if (groupCount > 1) {
+            // Hosts 1..n-1 get their own task; this task drives host 0
+            SemaphoreHandle_t done = xSemaphoreCreateCounting(groupCount, 0);
+            if (done) {
+                UBaseType_t prio = uxTaskPriorityGet(NULL);
+                for (uint8_t g = 1; g < groupCount; g++) {
+                    groups[g].done = done;
+                    if (xTaskCreatePinnedToCore(groupTask, "hqvga_present", 4096, &groups[g],
+                                                prio, NULL, tskNO_AFFINITY) != pdPASS) {
+                        // Out of heap: do this host inline instead
+                        runGroup(groups[g]);
+                        xSemaphoreGive(done);
+                    }
+                }
+                runGroup(groups[0]);
+                for (uint8_t g = 1; g < groupCount; g++) {
+                    xSemaphoreTake(done, portMAX_DELAY);
+                }
+                vSemaphoreDelete(done);
+                return;
+            }
+        }
+#endif
+
+        for (uint8_t g = 0; g < groupCount; g++) {
+            runGroup(groups[g]);
+        }
+    }
+};
+
+#endif // HQVGA_MULTIDISPLAY_H
@@ -0,0 +1,382 @@
+/**
+ * @file HQVGA_Surface.h
+ * @brief Compile-time pixel-format and geometry templates for offscreen surfaces
+ *
+ * HQVGA_Surface<Format, Width, Height> is a fixed-size pixel buffer whose
+ * stride, size and offset math are all constexpr. The format tag supplies
+ * the packing and the span kernels (fill, copy, keyed copy), so every
+ * primitive compiles down to the right code for the format with no runtime
+ * switches:
+ *
+ *   HQVGA_FormatRGB332    8bpp RRRGGGBB (native framebuffer format)
+ *   HQVGA_FormatIndexed8  8bpp palette index
+ *   HQVGA_FormatIndexed4  4bpp palette index, even x in the high nibble
+ *                         (same packing as the FPGA 4bpp framebuffer)
+ *   HQVGA_FormatMono1     1bpp, MSB is the leftmost pixel
+ *
+ * Usage:
+ *   #include <HQVGA_Surface.h>
+ *
+ *   HQVGA_Surface<HQVGA_FormatRGB332, 32, 32> canvas;
+ *   canvas.fill(BLACK);
+ *   canvas.fillRect(4, 4, 24, 24, RED);
+ *   canvas.present(VGA, 64, 44);   // upload at (64,44)
+ *
+ * All drawing calls clip against the surface; hqvgaClipRect() and
+ * hqvgaClipBlit() are exposed for code that needs the clipped rectangle.
+ */
+
+#ifndef HQVGA_SURFACE_H
+#define HQVGA_SURFACE_H
+
+#include <Arduino.h>
+#include <string.h>
+#include "HQVGA.h"
+#include "HQVGA_Kernels.h"
+
+// ===== Clipping helpers =====
+
+/**
+ * @brief Clip a rectangle to [0,maxW) x [0,maxH)
+ * @return false if nothing is left to draw
+ */
+inline bool hqvgaClipRect(int16_t& x, int16_t& y, int16_t& w, int16_t& h,
+                          int16_t maxW, int16_t maxH) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > maxW) w = maxW - x;
+    if (y + h > maxH) h = maxH - y;
+    return w > 0 && h > 0;
+}
+
+/**
+ * @brief Clip a copy of a w x h block from (sx,sy) to (dx,dy) against both
+ *        the source and destination bounds
+ * @return false if nothing is left to copy
+ */
+inline bool hqvgaClipBlit(int16_t& dx, int16_t& dy, int16_t& sx, int16_t& sy,
+                          int16_t& w, int16_t& h,
+                          int16_t dstW, int16_t dstH, int16_t srcW, int16_t srcH) {
+    if (sx < 0) { dx -= sx; w += sx; sx = 0; }
+    if (sy < 0) { dy -= sy; h += sy; sy = 0; }
+    if (sx + w > srcW) w = srcW - sx;
+    if (sy + h > srcH) h = srcH - sy;
+    if (dx < 0) { sx -= dx; w += dx; dx = 0; }
+    if (dy < 0) { sy -= dy; h += dy; dy = 0; }
+    if (dx + w > dstW) w = dstW - dx;
+    if (dy + h > dstH) h = dstH - dy;
+    return w > 0 && h > 0;
+}
+
+// ===== Pixel formats =====
+
+/**
+ * @brief One byte per pixel - spans go to the HQVGA_Kernels.h row kernels
+ */
+struct HQVGA_Format8 {
+    typedef uint8_t color_t;
+    static constexpr uint8_t bpp = 8;
+
+    static constexpr size_t strideFor(int16_t w) { return (size_t)w; }
+    static constexpr size_t byteOffset(int16_t x) { return (size_t)x; }
+    static constexpr uint8_t replicate(color_t c) { return c; }
+
+    static inline color_t get(const uint8_t* row, int16_t x) { return row[x]; }
+    static inline void set(uint8_t* row, int16_t x, color_t c) { row[x] = c; }
+
+    static inline void fillSpan(uint8_t* row, int16_t x, int16_t n, color_t c) {
+        hqvgaFill8(row + x, c, n);
+    }
+
+    static inline void copySpan(uint8_t* dst, int16_t dx, const uint8_t* src, int16_t sx, int16_t n) {
+        hqvgaCopy8(dst + dx, src + sx, n);
+    }
+
+    static inline void copySpanKeyed(uint8_t* dst, int16_t dx, const uint8_t* src, int16_t sx,
+                                     int16_t n, color_t key) {
+        hqvgaCopyKeyed8(dst + dx, src + sx, n, key);
+    }
+};
+
+/**
+ * @brief Sub-byte packed pixels (1, 2 or 4 bpp), leftmost pixel in the MSBs
+ *
+ * Spans whose start is byte-aligned (or equally misaligned on both sides)
+ * are filled/copied a byte at a time; only the ragged edges go per pixel.
+ */
+template <uint8_t BPP>
+struct HQVGA_PackedFormat {
+    typedef uint8_t color_t;
+    static constexpr uint8_t bpp = BPP;
+    static constexpr uint8_t perByte = 8 / BPP;
+    static constexpr uint8_t mask = (1 << BPP) - 1;
+
+    static constexpr size_t strideFor(int16_t w) { return ((size_t)w * BPP + 7) / 8; }
+    static constexpr size_t byteOffset(int16_t x) { return (size_t)x / perByte; }
+    static constexpr uint8_t shift(int16_t x) { return (perByte - 1 - x % perByte) * BPP; }
+    static constexpr uint8_t replicate(color_t c) { return (c & mask) * (0xFF / mask); }
+
+    static inline color_t get(const uint8_t* row, int16_t x) {
+        return (row[x / perByte] >> shift(x)) & mask;
+    }
+
+    static inline void set(uint8_t* row, int16_t x, color_t c) {
+        uint8_t& b = row[x / perByte];
+        uint8_t s = shift(x);
+        b = (b & ~(mask << s)) | ((c & mask) << s);
+    }
+
+    static inline void fillSpan(uint8_t* row, int16_t x, int16_t n, color_t c) {
+        while (n > 0 && (x % perByte)) { set(row, x++, c); n--; }
+        int16_t bytes = n / perByte;
+        hqvgaFill8(row + x / perByte, replicate(c), bytes);
+        x += bytes * perByte;
+        n -= bytes * perByte;
+        while (n-- > 0) set(row, x++, c);
+    }
+
+    static inline void copySpan(uint8_t* dst, int16_t dx, const uint8_t* src, int16_t sx, int16_t n) {
+        if (dst == src && dx > sx) {
+            // Overlapping move to the right within one row: go backwards
+            while (n-- > 0) set(dst, dx + n, get(src, sx + n));
+            return;
+        }
+        if ((dx % perByte) == (sx % perByte)) {
+            while (n > 0 && (dx % perByte)) { set(dst, dx++, get(src, sx++)); n--; }
+            int16_t bytes = n / perByte;
+            hqvgaCopy8(dst + dx / perByte, src + sx / perByte, bytes);
+            dx += bytes * perByte;
+            sx += bytes * perByte;
+            n -= bytes * perByte;
+        }
+        while (n-- > 0) set(dst, dx++, get(src, sx++));
+    }
+
+    static inline void copySpanKeyed(uint8_t* dst, int16_t dx, const uint8_t* src, int16_t sx,
+                                     int16_t n, color_t key) {
+        while (n-- > 0) {
+            color_t c = get(src, sx++);
+            if (c != key) set(dst, dx, c);
+            dx++;
+        }
+    }
+};
+
+struct HQVGA_FormatRGB332 : HQVGA_Format8 {
+    static constexpr bool indexed = false;
+};
+
+struct HQVGA_FormatIndexed8 : HQVGA_Format8 {
+    static constexpr bool indexed = true;
+};
+
+struct HQVGA_FormatIndexed4 : HQVGA_PackedFormat<4> {
+    static constexpr bool indexed = true;
+};
+
+struct HQVGA_FormatMono1 : HQVGA_PackedFormat<1> {
+    static constexpr bool indexed = true;
+};
+
+// ===== Surface =====
+
+template <class Format, int16_t W, int16_t H>
+class HQVGA_Surface {
+public:
+    typedef Format format_t;
+    typedef typename Format::color_t color_t;
+
+    // Packed pixel storage, row-major, stride() bytes per row
+    uint8_t pixels[Format::strideFor(W) * H];
+
+    HQVGA_Surface() { memset(pixels, 0, sizeof(pixels)); }
+
+    // ===== Geometry (all compile-time) =====
+
+    static constexpr int16_t width() { return W; }
+    static constexpr int16_t height() { return H; }
+    static constexpr size_t stride() { return Format::strideFor(W); }
+    static constexpr size_t size() { return Format::strideFor(W) * H; }
+    static constexpr size_t offset(int16_t x, int16_t y) {
+        return (size_t)y * Format::strideFor(W) + Format::byteOffset(x);
+    }
+    static constexpr bool contains(int16_t x, int16_t y) {
+        return x >= 0 && x < W && y >= 0 && y < H;
+    }
+
+    uint8_t* row(int16_t y) { return pixels + (size_t)y * stride(); }
+    const uint8_t* row(int16_t y) const { return pixels + (size_t)y * stride(); }
+
+    // ===== Pixel access =====
+
+    /**
+     * @brief Set a pixel if it is inside the surface
+     * @return true if the pixel was written
+     */
+    bool setPixel(int16_t x, int16_t y, color_t c) {
+        if (!contains(x, y)) return false;
+        Format::set(row(y), x, c);
+        return true;
+    }
+
+    /**
+     * @brief Read a pixel (0 outside the surface)
+     */
+    color_t getPixel(int16_t x, int16_t y) const {
+        return contains(x, y) ? Format::get(row(y), x) : 0;
+    }
+
+    // Unchecked variants for inner loops that have already clipped
+    void setPixelFast(int16_t x, int16_t y, color_t c) { Format::set(row(y), x, c); }
+    color_t getPixelFast(int16_t x, int16_t y) const { return Format::get(row(y), x); }
+
+    // ===== Fill kernels =====
+
+    void fill(color_t c) { memset(pixels, Format::replicate(c), sizeof(pixels)); }
+
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, color_t c) {
+        if (!hqvgaClipRect(x, y, w, h, W, H)) return;
+        for (int16_t j = 0; j < h; j++) {
+            Format::fillSpan(row(y + j), x, w, c);
+        }
+    }
+
+    void hline(int16_t x, int16_t y, int16_t w, color_t c) { fillRect(x, y, w, 1, c); }
+    void vline(int16_t x, int16_t y, int16_t h, color_t c) { fillRect(x, y, 1, h, c); }
+
+    // ===== Copy / blit kernels =====
+
+    /**
+     * @brief Copy a w x h block of another surface of the same format
+     *
+     * Source and destination may be the same surface; overlapping moves are
+     * handled. Defaults copy the whole source to (dx,dy).
+     */
+    template <int16_t SW, int16_t SH>
+    void blit(const HQVGA_Surface<Format, SW, SH>& src, int16_t dx, int16_t dy,
+              int16_t sx = 0, int16_t sy = 0, int16_t w = SW, int16_t h = SH) {
+        if (!hqvgaClipBlit(dx, dy, sx, sy, w, h, W, H, SW, SH)) return;
+        if ((const void*)&src == (const void*)this && dy > sy) {
+            for (int16_t j = h - 1; j >= 0; j--) {
+                Format::copySpan(row(dy + j), dx, src.row(sy + j), sx, w);
+            }
+        } else {
+            for (int16_t j = 0; j < h; j++) {
+                Format::copySpan(row(dy + j), dx, src.row(sy + j), sx, w);
+            }
+        }
+    }
+
+    /**
+     * @brief Copy a whole surface, skipping pixels equal to key (sprites)
+     */
+    template <int16_t SW, int16_t SH>
+    void blitKeyed(const HQVGA_Surface<Format, SW, SH>& src, int16_t dx, int16_t dy, color_t key) {
+        int16_t sx = 0, sy = 0, w = SW, h = SH;
+        if (!hqvgaClipBlit(dx, dy, sx, sy, w, h, W, H, SW, SH)) return;
+        for (int16_t j = 0; j < h; j++) {
+            Format::copySpanKeyed(row(dy + j), dx, src.row(sy + j), sx, w, key);
+        }
+    }
+
+    /**
+     * @brief Copy raw pixels in this surface's format (e.g. from flash)
+     * @param srcStride Bytes per source row (0 = tightly packed)
+     */
+    void writePixels(int16_t x, int16_t y, int16_t w, int16_t h,
+                     const uint8_t* data, size_t srcStride = 0) {
+        if (!srcStride) srcStride = Format::strideFor(w);
+        int16_t srcW = w, srcH = h, sx = 0, sy = 0;
+        if (!hqvgaClipBlit(x, y, sx, sy, w, h, W, H, srcW, srcH)) return;
+        for (int16_t j = 0; j < h; j++) {
+            Format::copySpan(row(y + j), x, data + (size_t)(sy + j) * srcStride, sx, w);
+        }
+    }
+
+    /**
+     * @brief Draw a 1bpp bitmap (MSB = leftmost pixel, rows padded to bytes)
+     *        with set bits in fg and clear bits in bg
+     */
+    void drawBitmap(int16_t x, int16_t y, const uint8_t* bits, int16_t bw, int16_t bh,
+                    color_t fg, color_t bg) {
+        size_t srcStride = ((size_t)bw + 7) / 8;
+        int16_t sx = 0, sy = 0, w = bw, h = bh;
+        if (!hqvgaClipBlit(x, y, sx, sy, w, h, W, H, bw, bh)) return;
+        for (int16_t j = 0; j < h; j++) {
+            const uint8_t* src = bits + (size_t)(sy + j) * srcStride;
+            if (Format::bpp == 8) {
+                hqvgaExpand1(row(y + j) + x, src, sx, w, fg, bg);
+            } else {
+                for (int16_t i = 0; i < w; i++) {
+                    uint16_t b = sx + i;
+                    Format::set(row(y + j), x + i, (src[b >> 3] & (0x80 >> (b & 7))) ? fg : bg);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Draw a 1bpp bitmap with clear bits left transparent
+     */
+    void drawBitmap(int16_t x, int16_t y, const uint8_t* bits, int16_t bw, int16_t bh, color_t fg) {
+        size_t srcStride = ((size_t)bw + 7) / 8;
+        int16_t sx = 0, sy = 0, w = bw, h = bh;
+        if (!hqvgaClipBlit(x, y, sx, sy, w, h, W, H, bw, bh)) return;
+        for (int16_t j = 0; j < h; j++) {
+            const uint8_t* src = bits + (size_t)(sy + j) * srcStride;
+            if (Format::bpp == 8) {
+                hqvgaExpand1Keyed(row(y + j) + x, src, sx, w, fg);
+            } else {
+                for (int16_t i = 0; i < w; i++) {
+                    uint16_t b = sx + i;
+                    if (src[b >> 3] & (0x80 >> (b & 7))) Format::set(row(y + j), x + i, fg);
+                }
+            }
+        }
+    }
+
+    // ===== Upload to the FPGA =====
+
+    /**
+     * @brief Upload part of the surface to the display
+     * @param ox,oy Display position of surface pixel (0,0)
+     * @param palette RGB332 colour of each index (2, 16 or 256 entries),
+     *        used for indexed formats on an RGB332 framebuffer. On a 4bpp
+     *        framebuffer indices go up as they are.
+     * @return false if an indexed surface meets an RGB332 framebuffer
+     *         without a palette; nothing is uploaded then
+     */
+    bool presentRegion(VGA_class& vga, int16_t x, int16_t y, int16_t w, int16_t h,
+                       int16_t ox = 0, int16_t oy = 0,
+                       const VGA_class::pixel_t* palette = nullptr) const {
+        bool map = Format::indexed && vga.getFormat() == HQVGA_FORMAT_RGB332;
+        if (map && !palette) return false;
+        if (!hqvgaClipRect(x, y, w, h, W, H)) return true;
+        if (Format::bpp == 8 && !map) {
+            // Byte rows go up as they are, in one window stream if possible
+            vga.uploadImage(ox + x, oy + y, w, h, row(y) + x, stride());
+            return true;
+        }
+        uint8_t line[W];
+        VGA_class::BusSession bus(vga);
+        for (int16_t j = y; j < y + h; j++) {
+            const uint8_t* r = row(j);
+            for (int16_t i = 0; i < w; i++) {
+                color_t c = Format::get(r, x + i);
+                line[i] = map ? palette[c] : c;
+            }
+            vga.uploadImage(ox + x, oy + j, w, 1, line);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Upload the whole surface with its top-left corner at (x,y)
+     */
+    bool present(VGA_class& vga, int16_t x = 0, int16_t y = 0,
+                 const VGA_class::pixel_t* palette = nullptr) const {
+        return presentRegion(vga, 0, 0, W, H, x, y, palette);
+    }
+};
+
+#endif // HQVGA_SURFACE_H
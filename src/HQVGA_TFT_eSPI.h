@@ -27,6 +27,9 @@
 
 #include <Arduino.h>
 #include "HQVGA.h"
+#include "HQVGA_Surface.h"
+#include "HQVGA_Blend.h"
+#include "HQVGA_Affine.h"
 
 // Convenience macros for display dimensions
 #define HQVGA_WIDTH  VGA_HSIZE
@@ -78,24 +81,57 @@
 #define FONT_SIZE_2  2
 #define FONT_SIZE_4  4
 
+// Shadow buffer type used by HQVGA_TFT (RGB332, display-sized)
+typedef HQVGA_Surface<HQVGA_FormatRGB332, HQVGA_WIDTH, HQVGA_HEIGHT> HQVGA_Shadow;
+
 class HQVGA_TFT {
 public:
     // Local framebuffer for fast drawing (synced to FPGA)
-    uint8_t frameBuffer[HQVGA_FRAMEBUFFER_SIZE];
+    HQVGA_Shadow shadow;
+    // Raw view of shadow.pixels (HQVGA_WIDTH * HQVGA_HEIGHT bytes)
+    uint8_t* frameBuffer() { return shadow.pixels; }
     
-    HQVGA_TFT() : _vga(nullptr), _ownsVga(true), _textColor(0xFF), _textBgColor(0x00),
+    HQVGA_TFT() : _vga(nullptr), _ownsVga(true),
+                  _textColor(0xFF), _textBgColor(0x00),
                   _textSize(1), _textDatum(TL_DATUM), _cursorX(0), _cursorY(0),
                   _wrap(true), _buffered(false) {
-        memset(frameBuffer, 0, HQVGA_FRAMEBUFFER_SIZE);
     }
     
     /**
      * @brief Initialize with existing VGA instance
      */
-    HQVGA_TFT(VGA_class* vga) : _vga(vga), _ownsVga(false), _textColor(0xFF), 
-                                 _textBgColor(0x00), _textSize(1), _textDatum(TL_DATUM),
+    HQVGA_TFT(VGA_class* vga) : _vga(vga), _ownsVga(false),
+                                 _textColor(0xFF), _textBgColor(0x00),
+                                 _textSize(1), _textDatum(TL_DATUM),
                                  _cursorX(0), _cursorY(0), _wrap(true), _buffered(false) {
-        memset(frameBuffer, 0, HQVGA_FRAMEBUFFER_SIZE);
+    }
+    
+    /**
+     * @brief Copy the shadow and text state; the copy draws through the
+     *        original's VGA_class without owning it
+     */
+    HQVGA_TFT(const HQVGA_TFT& other) : _vga(nullptr), _ownsVga(false) {
+        *this = other;
+    }
+    
+    HQVGA_TFT& operator=(const HQVGA_TFT& other) {
+        if (this != &other) {
+            if (_ownsVga && _vga) {
+                delete _vga;
+            }
+            shadow = other.shadow;
+            _vga = other._vga;
+            _ownsVga = false;
+            _textColor = other._textColor;
+            _textBgColor = other._textBgColor;
+            _textSize = other._textSize;
+            _textDatum = other._textDatum;
+            _cursorX = other._cursorX;
+            _cursorY = other._cursorY;
+            _wrap = other._wrap;
+            _buffered = other._buffered;
+        }
+        return *this;
     }
     
     ~HQVGA_TFT() {
@@ -159,11 +195,7 @@ public:
      * Call this after drawing when in buffered mode
      */
     void syncBuffer() {
-        for (int y = 0; y < HQVGA_HEIGHT; y++) {
-            for (int x = 0; x < HQVGA_WIDTH; x++) {
-                _vga->putPixel(x, y, frameBuffer[y * HQVGA_WIDTH + x]);
-            }
-        }
+        shadow.present(*_vga);
     }
     
     /**
@@ -171,27 +203,14 @@ public:
      * More efficient than full sync for partial updates
      */
     void syncRegion(int16_t x, int16_t y, int16_t w, int16_t h) {
-        if (x < 0) { w += x; x = 0; }
-        if (y < 0) { h += y; y = 0; }
-        if (x + w > HQVGA_WIDTH) w = HQVGA_WIDTH - x;
-        if (y + h > HQVGA_HEIGHT) h = HQVGA_HEIGHT - y;
-        if (w <= 0 || h <= 0) return;
-        
-        for (int16_t py = y; py < y + h; py++) {
-            for (int16_t px = x; px < x + w; px++) {
-                _vga->putPixel(px, py, frameBuffer[py * HQVGA_WIDTH + px]);
-            }
-        }
+        shadow.presentRegion(*_vga, x, y, w, h);
     }
     
     /**
      * @brief Convert RGB565 to RGB332
      */
     static uint8_t color565to332(uint16_t color565) {
-        uint8_t r = (color565 >> 11) & 0x1F;  // 5 bits
-        uint8_t g = (color565 >> 5) & 0x3F;   // 6 bits
-        uint8_t b = color565 & 0x1F;          // 5 bits
-        return ((r >> 2) << 5) | ((g >> 3) << 2) | (b >> 3);
+        return hqvga565to332(color565);
     }
     
     /**
@@ -214,28 +233,16 @@ public:
      * @brief Draw a single pixel (updates local buffer, syncs to FPGA unless buffered)
      */
     void drawPixel(int16_t x, int16_t y, uint16_t color) {
-        if (x >= 0 && x < HQVGA_WIDTH && y >= 0 && y < HQVGA_HEIGHT) {
-            uint8_t c332 = color565to332(color);
-            frameBuffer[y * HQVGA_WIDTH + x] = c332;
-            if (!_buffered) {
-                _vga->putPixel(x, y, c332);
-            }
-        }
+        plot332(x, y, color565to332(color));
     }
     
     /**
      * @brief Fill the entire screen with a color
      */
     void fillScreen(uint16_t color) {
-        uint8_t c332 = color565to332(color);
-        memset(frameBuffer, c332, HQVGA_FRAMEBUFFER_SIZE);
+        shadow.fill(color565to332(color));
         if (!_buffered) {
-            // Sync to FPGA
-            for (int y = 0; y < HQVGA_HEIGHT; y++) {
-                for (int x = 0; x < HQVGA_WIDTH; x++) {
-                    _vga->putPixel(x, y, c332);
-                }
-            }
+            syncBuffer();
         }
     }
     
@@ -243,42 +250,14 @@ public:
      * @brief Draw a horizontal line
      */
     void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
-        if (y < 0 || y >= HQVGA_HEIGHT || w <= 0) return;
-        if (x < 0) { w += x; x = 0; }
-        if (x + w > HQVGA_WIDTH) w = HQVGA_WIDTH - x;
-        if (w <= 0) return;
-        
-        uint8_t c332 = color565to332(color);
-        uint8_t* ptr = &frameBuffer[y * HQVGA_WIDTH + x];
-        memset(ptr, c332, w);
-        if (!_buffered) {
-            // Sync to FPGA
-            for (int16_t i = 0; i < w; i++) {
-                _vga->putPixel(x + i, y, c332);
-            }
-        }
+        fillRect(x, y, w, 1, color);
     }
     
     /**
      * @brief Draw a vertical line
      */
     void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
-        if (x < 0 || x >= HQVGA_WIDTH || h <= 0) return;
-        if (y < 0) { h += y; y = 0; }
-        if (y + h > HQVGA_HEIGHT) h = HQVGA_HEIGHT - y;
-        if (h <= 0) return;
-        
-        uint8_t c332 = color565to332(color);
-        uint8_t* ptr = &frameBuffer[y * HQVGA_WIDTH + x];
-        for (int16_t i = 0; i < h; i++) {
-            *ptr = c332;
-            ptr += HQVGA_WIDTH;
-        }
-        if (!_buffered) {
-            for (int16_t i = 0; i < h; i++) {
-                _vga->putPixel(x, y + i, c332);
-            }
-        }
+        fillRect(x, y, 1, h, color);
     }
     
     /**
@@ -343,25 +322,11 @@ public:
      * @brief Draw a filled rectangle
      */
     void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
-        if (w <= 0 || h <= 0) return;
-        if (x < 0) { w += x; x = 0; }
-        if (y < 0) { h += y; y = 0; }
-        if (x + w > HQVGA_WIDTH) w = HQVGA_WIDTH - x;
-        if (y + h > HQVGA_HEIGHT) h = HQVGA_HEIGHT - y;
-        if (w <= 0 || h <= 0) return;
+        if (!hqvgaClipRect(x, y, w, h, HQVGA_WIDTH, HQVGA_HEIGHT)) return;
         
-        uint8_t c332 = color565to332(color);
-        for (int16_t j = 0; j < h; j++) {
-            uint8_t* ptr = &frameBuffer[(y + j) * HQVGA_WIDTH + x];
-            memset(ptr, c332, w);
-        }
+        shadow.fillRect(x, y, w, h, color565to332(color));
         if (!_buffered) {
-            // Sync to FPGA
-            for (int16_t j = 0; j < h; j++) {
-                for (int16_t i = 0; i < w; i++) {
-                    _vga->putPixel(x + i, y + j, c332);
-                }
-            }
+            syncRegion(x, y, w, h);
         }
     }
     
@@ -685,10 +650,35 @@ public:
      * @brief Push a rectangular area of RGB565 pixels
      */
     void pushImage(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t* data) {
+        int16_t sx = 0, sy = 0, srcW = w, srcH = h;
+        if (!hqvgaClipBlit(x, y, sx, sy, w, h, HQVGA_WIDTH, HQVGA_HEIGHT, srcW, srcH)) return;
+        
         for (int16_t j = 0; j < h; j++) {
-            for (int16_t i = 0; i < w; i++) {
-                drawPixel(x + i, y + j, data[j * w + i]);
-            }
+            hqvgaConvert565(shadow.row(y + j) + x, data + (size_t)(sy + j) * srcW + sx, w);
+        }
+        if (!_buffered) {
+            syncRegion(x, y, w, h);
+        }
+    }
+    
+    /**
+     * @brief Draw a 1bpp bitmap (MSB first); clear bits are transparent
+     */
+    void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t fgcolor) {
+        shadow.drawBitmap(x, y, bitmap, w, h, color565to332(fgcolor));
+        if (!_buffered) {
+            syncRegion(x, y, w, h);
+        }
+    }
+    
+    /**
+     * @brief Draw a 1bpp bitmap (MSB first) with clear bits in bgcolor
+     */
+    void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h,
+                    uint16_t fgcolor, uint16_t bgcolor) {
+        shadow.drawBitmap(x, y, bitmap, w, h, color565to332(fgcolor), color565to332(bgcolor));
+        if (!_buffered) {
+            syncRegion(x, y, w, h);
         }
     }
     
@@ -696,27 +686,126 @@ public:
      * @brief Push a rectangular area of RGB332 pixels (native format)
      */
     void pushImage332(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t* data) {
-        for (int16_t j = 0; j < h; j++) {
-            for (int16_t i = 0; i < w; i++) {
-                int16_t px = x + i;
-                int16_t py = y + j;
-                if (px >= 0 && px < HQVGA_WIDTH && py >= 0 && py < HQVGA_HEIGHT) {
-                    uint8_t c = data[j * w + i];
-                    frameBuffer[py * HQVGA_WIDTH + px] = c;
-                    if (!_buffered) {
-                        _vga->putPixel(px, py, c);
-                    }
-                }
-            }
+        shadow.writePixels(x, y, w, h, data);
+        if (!_buffered) {
+            // Burst straight from the caller's buffer (may be in flash)
+            _vga->uploadImage(x, y, w, h, data);
+        }
+    }
+    
+    /**
+     * @brief Copy an RGB332 surface (sprite, canvas) into the display
+     */
+    template <int16_t SW, int16_t SH>
+    void pushSurface(const HQVGA_Surface<HQVGA_FormatRGB332, SW, SH>& src, int16_t x, int16_t y) {
+        shadow.blit(src, x, y);
+        if (!_buffered) {
+            syncRegion(x, y, SW, SH);
         }
     }
     
+    /**
+     * @brief Copy an RGB332 surface, skipping pixels of the transparent color
+     */
+    template <int16_t SW, int16_t SH>
+    void pushSurface(const HQVGA_Surface<HQVGA_FormatRGB332, SW, SH>& src, int16_t x, int16_t y,
+                     uint8_t transparent332) {
+        shadow.blitKeyed(src, x, y, transparent332);
+        if (!_buffered) {
+            syncRegion(x, y, SW, SH);
+        }
+    }
+    
+    /**
+     * @brief Blend an RGB332 surface into the display through a blend table
+     */
+    template <int16_t SW, int16_t SH>
+    void pushSurfaceBlend(const HQVGA_Surface<HQVGA_FormatRGB332, SW, SH>& src, int16_t x, int16_t y,
+                          const HQVGA_BlendLUT& lut) {
+        hqvgaBlendBlit(shadow, src, x, y, lut);
+        if (!_buffered) {
+            syncRegion(x, y, SW, SH);
+        }
+    }
+    
+    /**
+     * @brief Blend an RGB332 surface, skipping pixels of the transparent color
+     */
+    template <int16_t SW, int16_t SH>
+    void pushSurfaceBlend(const HQVGA_Surface<HQVGA_FormatRGB332, SW, SH>& src, int16_t x, int16_t y,
+                          const HQVGA_BlendLUT& lut, uint8_t transparent332) {
+        hqvgaBlendBlitKeyed(shadow, src, x, y, lut, transparent332);
+        if (!_buffered) {
+            syncRegion(x, y, SW, SH);
+        }
+    }
+    
+    /**
+     * @brief Rotated / scaled / flipped copy of RGB332 pixels
+     * @param px,py Source pivot, drawn at (x,y)
+     * @param transparent332 Source color to skip, or -1 for none
+     *
+     * Only the rectangle the image covers is sent, in bursts from the
+     * shadow buffer. Returns that rectangle (w 0 if off screen).
+     */
+    HQVGA_Rect pushImageAffine(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t* data,
+                               int16_t px, int16_t py, const HQVGA_Affine& m, int16_t transparent332 = -1) {
+        HQVGA_Rect r;
+        hqvgaAffineBlit(shadow, data, w, h, 0, px, py, x, y, m, transparent332, &r);
+        syncAffine(r);
+        return r;
+    }
+    
+    /**
+     * @brief pushImageAffine() from an RGB332 surface
+     */
+    template <int16_t SW, int16_t SH>
+    HQVGA_Rect pushSurfaceAffine(const HQVGA_Surface<HQVGA_FormatRGB332, SW, SH>& src, int16_t x, int16_t y,
+                                 int16_t px, int16_t py, const HQVGA_Affine& m, int16_t transparent332 = -1) {
+        HQVGA_Rect r;
+        hqvgaAffineBlit(shadow, src, px, py, x, y, m, transparent332, &r);
+        syncAffine(r);
+        return r;
+    }
+    
+    /**
+     * @brief Translucent filled rectangle
+     * @param alpha 0 (invisible) to 255 (opaque)
+     */
+    void fillRectAlpha(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, uint8_t alpha) {
+        HQVGA_ColorLUT lut;
+        lut.setFadeTo(color565to332(color), alpha, 255);
+        applyColorLUT(x, y, w, h, lut);
+    }
+    
+    /**
+     * @brief Run a color table over a rectangle of the display
+     */
+    void applyColorLUT(int16_t x, int16_t y, int16_t w, int16_t h, const HQVGA_ColorLUT& lut) {
+        if (!hqvgaClipRect(x, y, w, h, HQVGA_WIDTH, HQVGA_HEIGHT)) return;
+        
+        hqvgaMapRect(shadow, x, y, w, h, lut);
+        if (!_buffered) {
+            syncRegion(x, y, w, h);
+        }
+    }
+    
+    /**
+     * @brief Scale the brightness of the whole screen to level / levels
+     *        (call with decreasing levels for a fade-out)
+     */
+    void fadeScreen(uint8_t level, uint8_t levels = 16) {
+        HQVGA_ColorLUT lut;
+        lut.setFade(level, levels);
+        applyColorLUT(0, 0, HQVGA_WIDTH, HQVGA_HEIGHT, lut);
+    }
+    
     /**
      * @brief Read a pixel color from local framebuffer
      */
     uint16_t readPixel(int16_t x, int16_t y) {
-        if (x < 0 || x >= HQVGA_WIDTH || y < 0 || y >= HQVGA_HEIGHT) return 0;
-        uint8_t c332 = frameBuffer[y * HQVGA_WIDTH + x];
+        if (!HQVGA_Shadow::contains(x, y)) return 0;
+        uint8_t c332 = shadow.getPixelFast(x, y);
         // Convert RGB332 to RGB565
         uint8_t r = (c332 >> 5) & 0x07;
         uint8_t g = (c332 >> 2) & 0x07;
@@ -732,7 +821,12 @@ public:
     /**
      * @brief Get direct access to local framebuffer
      */
-    uint8_t* getFrameBuffer() { return frameBuffer; }
+    uint8_t* getFrameBuffer() { return shadow.pixels; }
+    
+    /**
+     * @brief Get the local framebuffer as a surface (for blits and kernels)
+     */
+    HQVGA_Shadow& getSurface() { return shadow; }
 
 private:
     VGA_class* _vga;
@@ -746,9 +840,21 @@ private:
     bool _wrap;
     bool _buffered;  // When true, drawing only updates local buffer; call syncBuffer() to update display
     
+    void syncAffine(const HQVGA_Rect& r) {
+        if (!_buffered && r.w > 0) {
+            _vga->uploadImage(r.x, r.y, r.w, r.h, shadow.row(r.y) + r.x, shadow.stride());
+        }
+    }
+    
     // Simple 5x7 font data (ASCII 32-127)
     static const uint8_t font5x7[];
     
+    void plot332(int16_t x, int16_t y, uint8_t c332) {
+        if (shadow.setPixel(x, y, c332) && !_buffered) {
+            _vga->putPixel(x, y, c332);
+        }
+    }
+    
     void drawChar(char c) {
         if (c < 32 || c > 127) c = '?';
         
@@ -757,17 +863,9 @@ private:
         
         // Draw background if different from foreground
         if (_textBgColor != _textColor) {
-            for (int16_t j = 0; j < 8 * _textSize; j++) {
-                for (int16_t i = 0; i < 6 * _textSize; i++) {
-                    int16_t px = _cursorX + i;
-                    int16_t py = _cursorY + j;
-                    if (px >= 0 && px < HQVGA_WIDTH && py >= 0 && py < HQVGA_HEIGHT) {
-                        frameBuffer[py * HQVGA_WIDTH + px] = _textBgColor;
-                        if (!_buffered) {
-                            _vga->putPixel(px, py, _textBgColor);
-                        }
-                    }
-                }
+            shadow.fillRect(_cursorX, _cursorY, 6 * _textSize, 8 * _textSize, _textBgColor);
+            if (!_buffered) {
+                syncRegion(_cursorX, _cursorY, 6 * _textSize, 8 * _textSize);
             }
         }
         
@@ -778,25 +876,12 @@ private:
             for (int8_t row = 0; row < 7; row++) {
                 if (line & (1 << row)) {
                     if (_textSize == 1) {
-                        int16_t px = _cursorX + col;
-                        int16_t py = _cursorY + row;
-                        if (px >= 0 && px < HQVGA_WIDTH && py >= 0 && py < HQVGA_HEIGHT) {
-                            frameBuffer[py * HQVGA_WIDTH + px] = _textColor;
-                            if (!_buffered) {
-                                _vga->putPixel(px, py, _textColor);
-                            }
-                        }
+                        plot332(_cursorX + col, _cursorY + row, _textColor);
                     } else {
                         for (uint8_t sy = 0; sy < _textSize; sy++) {
                             for (uint8_t sx = 0; sx < _textSize; sx++) {
-                                int16_t px = _cursorX + col * _textSize + sx;
-                                int16_t py = _cursorY + row * _textSize + sy;
-                                if (px >= 0 && px < HQVGA_WIDTH && py >= 0 && py < HQVGA_HEIGHT) {
-                                    frameBuffer[py * HQVGA_WIDTH + px] = _textColor;
-                                    if (!_buffered) {
-                                        _vga->putPixel(px, py, _textColor);
-                                    }
-                                }
+                                plot332(_cursorX + col * _textSize + sx,
+                                        _cursorY + row * _textSize + sy, _textColor);
                             }
                         }
                     }
@@ -985,4 +1070,116 @@ const uint8_t HQVGA_TFT::font5x7[] = {
     0x08, 0x1C, 0x2A, 0x08, 0x08  // DEL (arrow)
 };
 
+/**
+ * @brief TFT_eSprite-style offscreen sprite with compile-time size
+ *
+ * Draw into the sprite with RGB565 colors, then pushSprite() it onto the
+ * display's local framebuffer. Storage is an RGB332 HQVGA_Surface, so the
+ * push is a clipped row copy.
+ *
+ *   HQVGA_Sprite<16, 16> ship(&tft);
+ *   ship.fillSprite(TFT_BLACK);
+ *   ship.fillRect(4, 4, 8, 8, TFT_GREEN);
+ *   ship.pushSprite(x, y, TFT_BLACK);   // black is transparent
+ */
+template <int16_t W, int16_t H>
+class HQVGA_Sprite : public HQVGA_Surface<HQVGA_FormatRGB332, W, H> {
+public:
+    typedef HQVGA_Surface<HQVGA_FormatRGB332, W, H> Surface_t;
+    
+    HQVGA_Sprite(HQVGA_TFT* tft) : _tft(tft) {}
+    
+    void fillSprite(uint16_t color) {
+        Surface_t::fill(HQVGA_TFT::color565to332(color));
+    }
+    
+    void drawPixel(int16_t x, int16_t y, uint16_t color) {
+        Surface_t::setPixel(x, y, HQVGA_TFT::color565to332(color));
+    }
+    
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        Surface_t::fillRect(x, y, w, h, HQVGA_TFT::color565to332(color));
+    }
+    
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+        Surface_t::hline(x, y, w, HQVGA_TFT::color565to332(color));
+    }
+    
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+        Surface_t::vline(x, y, h, HQVGA_TFT::color565to332(color));
+    }
+    
+    void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t fgcolor) {
+        Surface_t::drawBitmap(x, y, bitmap, w, h, HQVGA_TFT::color565to332(fgcolor));
+    }
+    
+    void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h,
+                    uint16_t fgcolor, uint16_t bgcolor) {
+        Surface_t::drawBitmap(x, y, bitmap, w, h, HQVGA_TFT::color565to332(fgcolor),
+                              HQVGA_TFT::color565to332(bgcolor));
+    }
+    
+    /**
+     * @brief Translucent filled rectangle within the sprite
+     * @param alpha 0 (invisible) to 255 (opaque)
+     */
+    void fillRectAlpha(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, uint8_t alpha) {
+        HQVGA_ColorLUT lut;
+        lut.setFadeTo(HQVGA_TFT::color565to332(color), alpha, 255);
+        hqvgaMapRect(*this, x, y, w, h, lut);
+    }
+    
+    /**
+     * @brief Run a color table over a rectangle of the sprite
+     */
+    void applyColorLUT(int16_t x, int16_t y, int16_t w, int16_t h, const HQVGA_ColorLUT& lut) {
+        hqvgaMapRect(*this, x, y, w, h, lut);
+    }
+    
+    /**
+     * @brief Copy the sprite to the display at (x,y)
+     */
+    void pushSprite(int16_t x, int16_t y) {
+        _tft->pushSurface(*this, x, y);
+    }
+    
+    /**
+     * @brief Copy the sprite, leaving pixels of the transparent color untouched
+     */
+    void pushSprite(int16_t x, int16_t y, uint16_t transparent) {
+        _tft->pushSurface(*this, x, y, HQVGA_TFT::color565to332(transparent));
+    }
+    
+    /**
+     * @brief Rotate / scale / flip the sprite around its centre onto (x,y)
+     */
+    HQVGA_Rect pushSpriteAffine(int16_t x, int16_t y, const HQVGA_Affine& m) {
+        return _tft->pushSurfaceAffine(*this, x, y, W / 2, H / 2, m);
+    }
+    
+    /**
+     * @brief pushSpriteAffine(), leaving pixels of the transparent color untouched
+     */
+    HQVGA_Rect pushSpriteAffine(int16_t x, int16_t y, const HQVGA_Affine& m, uint16_t transparent) {
+        return _tft->pushSurfaceAffine(*this, x, y, W / 2, H / 2, m, HQVGA_TFT::color565to332(transparent));
+    }
+    
+    /**
+     * @brief Blend the sprite onto the display through a blend table
+     */
+    void pushSpriteBlend(int16_t x, int16_t y, const HQVGA_BlendLUT& lut) {
+        _tft->pushSurfaceBlend(*this, x, y, lut);
+    }
+    
+    /**
+     * @brief Blend the sprite, leaving pixels of the transparent color untouched
+     */
+    void pushSpriteBlend(int16_t x, int16_t y, const HQVGA_BlendLUT& lut, uint16_t transparent) {
+        _tft->pushSurfaceBlend(*this, x, y, lut, HQVGA_TFT::color565to332(transparent));
+    }
+
+private:
+    HQVGA_TFT* _tft;
+};
+
 #endif // HQVGA_TFT_ESPI_H
@@ -56,7 +56,7 @@
 // Custom U8g2 class for HQVGA framebuffer
 class HQVGA_U8g2 : public U8G2 {
 public:
-  HQVGA_U8g2() : _fgColor(0xFF), _bgColor(0x00), _spi(nullptr) {
+  HQVGA_U8g2(VGA_class& vga = VGA) : _vga(vga), _fgColor(0xFF), _bgColor(0x00), _spi(nullptr) {
     // Use full framebuffer mode (F = full buffer)
     // We'll handle the actual drawing ourselves
   }
@@ -69,7 +69,7 @@ public:
     _spi = spi;
     
     // Initialize HQVGA hardware
-    VGA.begin(spi, csPin, spiClk, spiMosi, spiMiso, wishboneBase);
+    _vga.begin(spi, csPin, spiClk, spiMosi, spiMiso, wishboneBase);
     
     // Initialize U8g2 with our custom callback
     // Using a generic full-buffer setup
@@ -113,8 +113,8 @@ public:
       memset(_buffer, 0, (HQVGA_U8G2_WIDTH * HQVGA_U8G2_HEIGHT + 7) / 8);
     }
     // Also clear the HQVGA framebuffer
-    VGA.setBackgroundColor(_bgColor);
-    VGA.clear();
+    _vga.setBackgroundColor(_bgColor);
+    _vga.clear();
   }
   
   // Send the U8g2 buffer to the HQVGA framebuffer
@@ -129,7 +129,7 @@ public:
         int bitIndex = y % 8;
         
         if (_buffer[byteIndex] & (1 << bitIndex)) {
-          VGA.putPixel(x, y, _fgColor);
+          _vga.putPixel(x, y, _fgColor);
         }
         // Background pixels already set by clearBuffer()
       }
@@ -139,7 +139,7 @@ public:
   // Draw a pixel (for direct drawing, bypasses U8g2 buffer)
   void drawPixelDirect(int16_t x, int16_t y, uint8_t color) {
     if (x >= 0 && x < HQVGA_U8G2_WIDTH && y >= 0 && y < HQVGA_U8G2_HEIGHT) {
-      VGA.putPixel(x, y, color);
+      _vga.putPixel(x, y, color);
     }
   }
   
@@ -168,9 +168,10 @@ public:
   static const uint8_t PINK    = 0xF3;
   
   // Access to underlying VGA object
-  VGA_class& getVGA() { return VGA; }
+  VGA_class& getVGA() { return _vga; }
 
 private:
+  VGA_class& _vga;
   uint8_t _fgColor;
   uint8_t _bgColor;
   uint8_t* _buffer;
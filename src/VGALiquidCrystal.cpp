@@ -9,29 +9,38 @@
 #include <Arduino.h>
 
 // Default constructor
-VGALiquidCrystal::VGALiquidCrystal() {
+VGALiquidCrystal::VGALiquidCrystal() : _vga(&VGA) {
+  init(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+}
+
+// Draw on a specific display (for multiple FPGAs on one MCU)
+VGALiquidCrystal::VGALiquidCrystal(VGA_class& vga) : _vga(&vga) {
   init(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
 }
 
 VGALiquidCrystal::VGALiquidCrystal(uint8_t rs, uint8_t rw, uint8_t enable,
                                    uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3,
-                                   uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7) {
+                                   uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7)
+  : _vga(&VGA) {
   init(0, rs, rw, enable, d0, d1, d2, d3, d4, d5, d6, d7);
 }
 
 VGALiquidCrystal::VGALiquidCrystal(uint8_t rs, uint8_t enable,
                                    uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3,
-                                   uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7) {
+                                   uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7)
+  : _vga(&VGA) {
   init(0, rs, 255, enable, d0, d1, d2, d3, d4, d5, d6, d7);
 }
 
 VGALiquidCrystal::VGALiquidCrystal(uint8_t rs, uint8_t rw, uint8_t enable,
-                                   uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3) {
+                                   uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3)
+  : _vga(&VGA) {
   init(1, rs, rw, enable, d0, d1, d2, d3, 0, 0, 0, 0);
 }
 
 VGALiquidCrystal::VGALiquidCrystal(uint8_t rs, uint8_t enable,
-                                   uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3) {
+                                   uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3)
+  : _vga(&VGA) {
   init(1, rs, 255, enable, d0, d1, d2, d3, 0, 0, 0, 0);
 }
 
@@ -63,8 +72,8 @@ void VGALiquidCrystal::begin(uint8_t cols, uint8_t lines, uint8_t dotsize) {
   _lines = lines;
   _cols = cols;
   
-  // Ensure video mode is framebuffer (VGA.begin() should have been called first)
-  // VGA.setVideoMode(2) is called by VGA.begin() already
+  // Ensure video mode is framebuffer (vga.begin() should have been called first)
+  // setVideoMode(2) is called by VGA_class::begin() already
   
   if (_lines > 1)
     displayRange = 32;
@@ -115,28 +124,28 @@ void VGALiquidCrystal::drawBorder(uint8_t color, uint8_t thickness) {
   // Top border
   for (int t = 0; t < thickness; t++) {
     for (int x = _x0 - thickness; x < _x0 + lcdWidth + thickness; x++) {
-      VGA.putPixel(x, _y0 - thickness + t, color);
+      _vga->putPixel(x, _y0 - thickness + t, color);
     }
   }
   
   // Bottom border
   for (int t = 0; t < thickness; t++) {
     for (int x = _x0 - thickness; x < _x0 + lcdWidth + thickness; x++) {
-      VGA.putPixel(x, _y0 + lcdHeight + t, color);
+      _vga->putPixel(x, _y0 + lcdHeight + t, color);
     }
   }
   
   // Left border
   for (int t = 0; t < thickness; t++) {
     for (int y = _y0; y < _y0 + lcdHeight; y++) {
-      VGA.putPixel(_x0 - thickness + t, y, color);
+      _vga->putPixel(_x0 - thickness + t, y, color);
     }
   }
   
   // Right border
   for (int t = 0; t < thickness; t++) {
     for (int y = _y0; y < _y0 + lcdHeight; y++) {
-      VGA.putPixel(_x0 + lcdWidth + t, y, color);
+      _vga->putPixel(_x0 + lcdWidth + t, y, color);
     }
   }
 }
@@ -259,12 +268,12 @@ void VGALiquidCrystal::putcharat(uint8_t chr, int pos, bool reverse) {
       int py = startY + row;
       
       // Bounds check
-      if (px >= 0 && px < VGA_HSIZE && py >= 0 && py < VGA_VSIZE) {
+      if (px >= 0 && px < (int)_vga->getHSize() && py >= 0 && py < (int)_vga->getVSize()) {
         bool pixelOn = (v >> (4 - c)) & 0x01;
         if (pixelOn) {
-          VGA.putPixel(px, py, reverse ? _bgColor : _textColor);
+          _vga->putPixel(px, py, reverse ? _bgColor : _textColor);
         } else {
-          VGA.putPixel(px, py, reverse ? _textColor : _bgColor);
+          _vga->putPixel(px, py, reverse ? _textColor : _bgColor);
         }
       }
     }
@@ -39,6 +39,9 @@ public:
   
   // Default constructor for simple usage
   VGALiquidCrystal();
+  
+  // Draw on a specific display instead of the global VGA
+  VGALiquidCrystal(VGA_class& vga);
 
   void init(uint8_t fourbitmode, uint8_t rs, uint8_t rw, uint8_t enable,
             uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3,
@@ -109,6 +112,8 @@ private:
   
   uint8_t _textColor;
   uint8_t _bgColor;
+  
+  VGA_class* _vga;
 
   static unsigned char chrtbl[2048];
 };
@@ -0,0 +1,87 @@
+#include "WishboneBus.h"
+
+bool WishboneBus::enableHardwareCS(bool enable) {
+#if defined(ESP32)
+	// The peripheral can only frame the pin it was begun with
+	if (!_spi || _spi->pinSS() != _cs)
+		return !enable;
+	_spi->setHwCs(enable);
+	if (!enable) {
+		pinMode(_cs, OUTPUT);
+		digitalWrite(_cs, HIGH);
+	}
+	_hwCs = enable;
+	return true;
+#else
+	return !enable;
+#endif
+}
+
+void WishboneBus::begin() {
+	if (_spi && _depth++ == 0)
+		_spi->beginTransaction(SPISettings(_hz, MSBFIRST, SPI_MODE0));
+}
+
+void WishboneBus::end() {
+	if (_spi && _depth && --_depth == 0)
+		_spi->endTransaction();
+}
+
+void WishboneBus::write(uint16_t addr, uint8_t data) {
+	// With hardware CS the peripheral asserts CS around the burst, so
+	// there is no per-byte or GPIO overhead
+	uint8_t frame[4] = { 0x01, (uint8_t)(addr >> 8), (uint8_t)addr, data };
+
+	if (!_spi)
+		return;
+	if (_depth == 0)
+		_spi->beginTransaction(SPISettings(_hz, MSBFIRST, SPI_MODE0));
+	writeFrames(frame, sizeof(frame));
+	if (_depth == 0)
+		_spi->endTransaction();
+}
+
+uint8_t WishboneBus::read(uint16_t addr, unsigned settleUs) {
+	uint8_t frame[3] = { 0x00, (uint8_t)(addr >> 8), (uint8_t)addr };
+
+	if (!_spi)
+		return 0;
+	if (_depth == 0)
+		_spi->beginTransaction(SPISettings(_hz, MSBFIRST, SPI_MODE0));
+#if defined(ESP32)
+	// Once the peripheral owns the pin a GPIO write does nothing, so it
+	// has to be made a GPIO output again for the frame
+	if (_hwCs) {
+		_spi->setHwCs(false);
+		pinMode(_cs, OUTPUT);
+	}
+#endif
+	digitalWrite(_cs, LOW);
+	_spi->writeBytes(frame, sizeof(frame));
+	delayMicroseconds(settleUs);
+	uint8_t result = _spi->transfer(0x00);
+	digitalWrite(_cs, HIGH);
+#if defined(ESP32)
+	if (_hwCs)
+		_spi->setHwCs(true);
+#endif
+	if (_depth == 0)
+		_spi->endTransaction();
+
+	return result;
+}
+
+void WishboneBus::writeFrames(const uint8_t *frames, size_t len) {
+	if (!_bursts && len > 4) {
+		for (size_t i = 0; i < len; i += 4)
+			writeFrames(frames + i, 4);
+		return;
+	}
+	if (_hwCs) {
+		_spi->writeBytes(frames, len);
+	} else {
+		digitalWrite(_cs, LOW);
+		_spi->writeBytes(frames, len);
+		digitalWrite(_cs, HIGH);
+	}
+}
@@ -0,0 +1,65 @@
+/**
+ * @file WishboneBus.h
+ * @brief Low-latency SPI-to-Wishbone link shared by VGA_class and HDMIController
+ *
+ * Every register access is a 4-byte frame: CMD (0x01 write, 0x00 read),
+ * ADDR_HIGH, ADDR_LOW, DATA. The drivers keep their original per-byte
+ * transfer() path for plain calls; this class holds the fast path they
+ * switch to inside a bus session or with hardware CS: one polled burst per
+ * frame, and many frames per burst for uploads.
+ */
+
+#ifndef WISHBONE_BUS_H
+#define WISHBONE_BUS_H
+
+#include <Arduino.h>
+#include <SPI.h>
+
+class WishboneBus {
+public:
+	WishboneBus() : _spi(nullptr), _cs(10), _hwCs(false), _bursts(true), _depth(0), _hz(8000000) {}
+
+	// Bus and CS pin the frames go out on; call again after re-begin()
+	void attach(SPIClass* spi, uint8_t csPin) { _spi = spi; _cs = csPin; }
+
+	// Hand CS to the SPI peripheral. The CS pin must be the SS pin the
+	// SPIClass was begun with; returns false if that cannot be done.
+	bool enableHardwareCS(bool enable = true);
+	bool hardwareCS() const { return _hwCs; }
+	// Clock used by sessions and the fast path (default 8 MHz)
+	void setClock(uint32_t hz) { _hz = hz; }
+
+	// Hold the SPI bus across many accesses; nests
+	void begin();
+	void end();
+	bool inSession() const { return _depth != 0; }
+	// True when register accesses should take write()/read()
+	bool fast() const { return _hwCs || _depth; }
+
+	// One frame as one polled burst
+	void write(uint16_t addr, uint8_t data);
+	// Reads need a gap between the address and the data byte for the
+	// Wishbone cycle, which one hardware-CS burst cannot express, so CS is
+	// briefly handed back to GPIO. Reads are rare next to writes.
+	uint8_t read(uint16_t addr, unsigned settleUs);
+	// Back-to-back write frames under one CS assertion; the caller holds
+	// the bus (begin()/end()). Sent with polled writeBytes(), not DMA.
+	void writeFrames(const uint8_t *frames, size_t len);
+	// Whether the bridge takes more than one frame per CS assertion; when
+	// off, writeFrames() frames each 4 bytes with its own CS
+	void setFrameBursts(bool on) { _bursts = on; }
+	bool frameBursts() const { return _bursts; }
+
+private:
+	WishboneBus(const WishboneBus&);
+	WishboneBus& operator=(const WishboneBus&);
+
+	SPIClass* _spi;
+	uint8_t _cs;
+	bool _hwCs;
+	bool _bursts;
+	uint8_t _depth;
+	uint32_t _hz;
+};
+
+#endif // WISHBONE_BUS_H